@@ -99,7 +99,18 @@ enum nx_bad_request_code {
     NXBRC_NXM_BAD_PREREQ = 0x104,
 
     /* A given nxm_type was specified more than once. */
-    NXBRC_NXM_DUP_TYPE = 0x105
+    NXBRC_NXM_DUP_TYPE = 0x105,
+
+/* Flow table modification batch (NXT_FLOW_MOD_BATCH) errors. */
+
+    /* NXFMB_OPEN was sent when a batch was already open on the connection, or
+     * NXFMB_COMMIT or NXFMB_DISCARD was sent when none was open. */
+    NXBRC_BATCH_BAD_STATE = 0x106,
+
+    /* NXFMB_COMMIT was sent for a batch in which at least one flow_mod had
+     * been rejected.  The switch discarded the batch without applying any of
+     * its flow_mods. */
+    NXBRC_BATCH_FAILED = 0x107
 };
 
 /* Additional "code" values for OFPET_FLOW_MOD_FAILED. */
@@ -149,7 +160,11 @@ enum nicira_type {
     /* Flexible flow specification (aka NXM = Nicira Extended Match). */
     NXT_SET_FLOW_FORMAT,        /* Set flow format. */
     NXT_FLOW_MOD,               /* Analogous to OFPT_FLOW_MOD. */
-    NXT_FLOW_REMOVED            /* Analogous to OFPT_FLOW_REMOVED. */
+    NXT_FLOW_REMOVED,           /* Analogous to OFPT_FLOW_REMOVED. */
+
+    /* Flow table modification batches.  The request body is struct
+     * nxt_flow_mod_batch.  There is no reply. */
+    NXT_FLOW_MOD_BATCH
 };
 
 /* Header for Nicira vendor stats request and reply messages. */
@@ -1133,6 +1148,46 @@ struct nxt_set_flow_format {
 };
 OFP_ASSERT(sizeof(struct nxt_set_flow_format) == 20);
 
+/* NXT_FLOW_MOD_BATCH request.
+ *
+ * A controller that needs to make many changes to the flow table at once, e.g.
+ * to install its complete set of flows after reconnecting, may group them into
+ * a batch:
+ *
+ *    - NXFMB_OPEN starts a batch on the connection on which it is received.
+ *
+ *    - Each OFPT_FLOW_MOD or NXT_FLOW_MOD subsequently received on that
+ *      connection is checked as usual.  If it is valid, the switch queues it
+ *      without applying it to the flow table.  Otherwise, the switch sends an
+ *      error reply for it, as usual, and marks the batch as failed.
+ *
+ *    - NXFMB_COMMIT closes the batch.  If the batch has not failed, the switch
+ *      applies its flow_mods in the order received, all at once, so that no
+ *      packet is forwarded based on a partially updated flow table.  A
+ *      flow_mod can still fail at this point, e.g. because of
+ *      OFPFF_CHECK_OVERLAP, in which case the switch sends the same error
+ *      reply, with the same xid, that it would have sent for the flow_mod
+ *      outside a batch.  If the batch has failed, the switch discards it
+ *      and replies with NXBRC_BATCH_FAILED.
+ *
+ *    - NXFMB_DISCARD closes the batch and discards its flow_mods.
+ *
+ * The switch also discards a batch when its connection closes.  Messages other
+ * than flow_mods, including barrier requests, are processed immediately even
+ * while a batch is open. */
+enum nx_flow_mod_batch_command {
+    NXFMB_OPEN,                 /* Start queuing flow_mods. */
+    NXFMB_COMMIT,               /* Apply the queued flow_mods. */
+    NXFMB_DISCARD               /* Discard the queued flow_mods. */
+};
+
+struct nxt_flow_mod_batch {
+    struct nicira_header nxh;
+    ovs_be32 command;           /* One of NXFMB_*. */
+    uint8_t pad[4];
+};
+OFP_ASSERT(sizeof(struct nxt_flow_mod_batch) == 24);
+
 /* NXT_FLOW_MOD (analogous to OFPT_FLOW_MOD). */
 struct nx_flow_mod {
     struct nicira_header nxh;
@@ -26,6 +26,8 @@ lib_libopenvswitch_a_SOURCES = \
 	lib/compiler.h \
 	lib/coverage.c \
 	lib/coverage.h \
+	lib/crc32c.c \
+	lib/crc32c.h \
 	lib/csum.c \
 	lib/csum.h \
 	lib/daemon.c \
@@ -49,6 +51,8 @@ lib_libopenvswitch_a_SOURCES = \
 	lib/flow.h \
 	lib/hash.c \
 	lib/hash.h \
+	lib/heap.c \
+	lib/heap.h \
 	lib/hmap.c \
 	lib/hmap.h \
 	lib/json.c \
@@ -107,6 +111,8 @@ lib_libopenvswitch_a_SOURCES = \
 	lib/pcap.h \
 	lib/poll-loop.c \
 	lib/poll-loop.h \
+	lib/pool.c \
+	lib/pool.h \
 	lib/process.c \
 	lib/process.h \
 	lib/random.c \
@@ -192,6 +198,7 @@ lib_libopenvswitch_a_SOURCES += \
 	lib/dpif-linux.c \
 	lib/dpif-linux.h \
 	lib/netdev-linux.c \
+	lib/netdev-linux.h \
 	lib/netdev-vport.c \
 	lib/netdev-vport.h \
 	lib/netlink-protocol.h \
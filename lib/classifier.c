@@ -26,6 +26,7 @@
 #include "odp-util.h"
 #include "ofp-util.h"
 #include "packets.h"
+#include "tag.h"
 
 static struct cls_table *find_table(const struct classifier *,
                                     const struct flow_wildcards *);
@@ -36,12 +37,21 @@ static struct cls_table *classifier_first_table(const struct classifier *);
 static struct cls_table *classifier_next_table(const struct classifier *,
                                                const struct cls_table *);
 static void destroy_table(struct classifier *, struct cls_table *);
-
+static void update_tables_after_insertion(struct classifier *,
+                                          struct cls_table *,
+                                          unsigned int new_priority);
+static void update_tables_after_removal(struct classifier *,
+                                        struct cls_table *,
+                                        unsigned int del_priority);
+
+static uint32_t table_hash(const struct cls_table *, const struct flow *,
+                           uint32_t partial_hashes[]);
 static struct cls_rule *find_match(const struct cls_table *,
-                                   const struct flow *);
+                                   const struct flow *, uint32_t *hashp);
 static struct cls_rule *find_equal(struct cls_table *, const struct flow *,
                                    uint32_t hash);
 static struct cls_rule *insert_rule(struct cls_table *, struct cls_rule *);
+static void remove_rule(struct cls_table *, struct cls_rule *);
 
 static bool flow_equal_except(const struct flow *, const struct flow *,
                                 const struct flow_wildcards *);
@@ -64,6 +74,39 @@ cls_table_from_hmap_node(const struct hmap_node *node)
     return node ? CONTAINER_OF(node, struct cls_table, hmap_node) : NULL;
 }
 
+/* An entry in one of the 'indices' of a struct cls_table. */
+struct cls_index {
+    struct hmap_node hmap_node; /* Hash is the partial hash. */
+    unsigned int n_rules;       /* Number of rule heads with this hash. */
+};
+
+/* The masked fields of one stage of a struct flow, packed for hashing.  The
+ * largest stage, CLS_STAGE_L3, needs 54 bytes. */
+struct stage_key {
+    uint32_t words[14];
+    size_t n_bytes;
+};
+
+static size_t mask_stage(const struct flow *, const struct flow_wildcards *,
+                         enum cls_stage, struct stage_key *);
+
+static void
+stage_key_put(struct stage_key *key, const void *data, size_t n)
+{
+    memcpy((uint8_t *) key->words + key->n_bytes, data, n);
+    key->n_bytes += n;
+}
+
+static void
+stage_key_put_eth(struct stage_key *key, const uint8_t ea[ETH_ADDR_LEN],
+                  bool wildcarded)
+{
+    if (!wildcarded) {
+        memcpy((uint8_t *) key->words + key->n_bytes, ea, ETH_ADDR_LEN);
+    }
+    key->n_bytes += ETH_ADDR_LEN;
+}
+
 /* Converts the flow in 'flow' into a cls_rule in 'rule', with the given
  * 'wildcards' and 'priority'. */
 void
@@ -647,6 +690,7 @@ classifier_init(struct classifier *cls)
 {
     cls->n_rules = 0;
     hmap_init(&cls->tables);
+    list_init(&cls->tables_priority);
 }
 
 /* Destroys 'cls'.  Rules within 'cls', if any, are not freed; this is the
@@ -658,9 +702,7 @@ classifier_destroy(struct classifier *cls)
         struct cls_table *table, *next_table;
 
         HMAP_FOR_EACH_SAFE (table, next_table, hmap_node, &cls->tables) {
-            hmap_destroy(&table->rules);
-            hmap_remove(&cls->tables, &table->hmap_node);
-            free(table);
+            destroy_table(cls, table);
         }
         hmap_destroy(&cls->tables);
     }
@@ -707,6 +749,7 @@ classifier_insert(struct classifier *cls, struct cls_rule *rule)
     if (!old_rule) {
         table->n_table_rules++;
         cls->n_rules++;
+        update_tables_after_insertion(cls, table, rule->priority);
     }
     return old_rule;
 }
@@ -724,7 +767,7 @@ classifier_remove(struct classifier *cls, struct cls_rule *rule)
     if (head != rule) {
         list_remove(&rule->list);
     } else if (list_is_empty(&rule->list)) {
-        hmap_remove(&table->rules, &rule->hmap_node);
+        remove_rule(table, rule);
     } else {
         struct cls_rule *next = CONTAINER_OF(rule->list.next,
                                              struct cls_rule, list);
@@ -735,30 +778,70 @@ classifier_remove(struct classifier *cls, struct cls_rule *rule)
 
     if (--table->n_table_rules == 0) {
         destroy_table(cls, table);
+    } else {
+        update_tables_after_removal(cls, table, rule->priority);
     }
 
     cls->n_rules--;
 }
 
-/* Finds and returns the highest-priority rule in 'cls' that matches 'flow'.
- * Returns a null pointer if no rules in 'cls' match 'flow'.  If multiple rules
- * of equal priority match 'flow', returns one arbitrarily. */
-struct cls_rule *
-classifier_lookup(const struct classifier *cls, const struct flow *flow)
+static struct cls_rule *
+classifier_lookup__(const struct classifier *cls, const struct flow *flow,
+                    tag_type *tags)
 {
     struct cls_table *table;
     struct cls_rule *best;
 
     best = NULL;
-    HMAP_FOR_EACH (table, hmap_node, &cls->tables) {
-        struct cls_rule *rule = find_match(table, flow);
+    LIST_FOR_EACH (table, list_node, &cls->tables_priority) {
+        struct cls_rule *rule;
+        uint32_t hash;
+
+        if (best && table->max_priority <= best->priority) {
+            break;
+        }
+
+        rule = find_match(table, flow, tags ? &hash : NULL);
         if (rule && (!best || rule->priority > best->priority)) {
             best = rule;
         }
+        if (tags) {
+            *tags |= tag_create_deterministic(hash);
+        }
     }
     return best;
 }
 
+/* Finds and returns the highest-priority rule in 'cls' that matches 'flow'.
+ * Returns a null pointer if no rules in 'cls' match 'flow'.  If multiple rules
+ * of equal priority match 'flow', returns one arbitrarily.
+ *
+ * Tables are visited in decreasing order of the highest priority rule that
+ * they contain, so the search stops at the first table that cannot contain a
+ * rule with higher priority than the best match found so far. */
+struct cls_rule *
+classifier_lookup(const struct classifier *cls, const struct flow *flow)
+{
+    return classifier_lookup__(cls, flow, NULL);
+}
+
+/* Same as classifier_lookup(), except that this function also adds to '*tags'
+ * a tag for each table in 'cls' that the lookup searched.  The tag is derived
+ * from the hash that the search computed anyhow, so it costs little extra.
+ *
+ * Adding a rule to 'cls', or modifying or removing a rule in 'cls', can only
+ * change the result of a lookup that included cls_rule_tag() of that rule
+ * among its tags, except that adding a rule with a higher priority than any
+ * other in its table (or in a new table) can also change the result of a
+ * lookup that stopped before reaching that table.  See
+ * classifier_rule_is_reachable(). */
+struct cls_rule *
+classifier_lookup_tags(const struct classifier *cls, const struct flow *flow,
+                       tag_type *tags)
+{
+    return classifier_lookup__(cls, flow, tags);
+}
+
 /* Finds and returns a rule in 'cls' with exactly the same priority and
  * matching criteria as 'target'.  Returns a null pointer if 'cls' doesn't
  * contain an exact match.
@@ -777,7 +860,8 @@ classifier_find_rule_exactly(const struct classifier *cls,
         return NULL;
     }
 
-    head = find_equal(table, &target->flow, flow_hash(&target->flow, 0));
+    head = find_equal(table, &target->flow,
+                      table_hash(table, &target->flow, NULL));
     if (flow_wildcards_is_exact(&target->wc)) {
         return head;
     }
@@ -789,6 +873,30 @@ classifier_find_rule_exactly(const struct classifier *cls,
     return NULL;
 }
 
+/* Returns true if every lookup in 'cls' whose result 'rule' could change if
+ * it were inserted into 'cls' searches the table that 'rule' would go into,
+ * that is, if that table already exists and already contains a rule with
+ * priority at least as high as 'rule''s.  Returns false otherwise, in which
+ * case some lookups that stopped before reaching that table may need to be
+ * repeated after 'rule' is inserted. */
+bool
+classifier_rule_is_reachable(const struct classifier *cls,
+                             const struct cls_rule *rule)
+{
+    const struct cls_table *table = find_table(cls, &rule->wc);
+
+    return table && rule->priority <= table->max_priority;
+}
+
+/* Returns the tag for 'rule', which must be in a classifier, that
+ * classifier_lookup_tags() adds for each lookup that searches the table
+ * containing 'rule' for a flow that 'rule' matches. */
+tag_type
+cls_rule_tag(const struct cls_rule *rule)
+{
+    return tag_create_deterministic(rule->hmap_node.hash);
+}
+
 /* Checks if 'target' would overlap any other rule in 'cls'.  Two rules are
  * considered to overlap if both rules have the same priority and a packet
  * could match both. */
@@ -956,11 +1064,33 @@ static struct cls_table *
 insert_table(struct classifier *cls, const struct flow_wildcards *wc)
 {
     struct cls_table *table;
+    struct flow all_ones;
+    int i;
 
     table = xzalloc(sizeof *table);
     hmap_init(&table->rules);
     table->wc = *wc;
     hmap_insert(&cls->tables, &table->hmap_node, flow_wildcards_hash(wc));
+    list_push_back(&cls->tables_priority, &table->list_node);
+
+    /* A stage needs to be hashed only if 'wc' leaves at least one bit of its
+     * fields significant. */
+    memset(&all_ones, 0xff, sizeof all_ones);
+    for (i = 0; i < CLS_N_STAGES; i++) {
+        struct stage_key key;
+        size_t j, n_words;
+
+        n_words = mask_stage(&all_ones, wc, i, &key);
+        for (j = 0; j < n_words; j++) {
+            if (key.words[j]) {
+                table->stages[table->n_stages++] = i;
+                break;
+            }
+        }
+    }
+    for (i = 0; i < CLS_N_STAGES - 1; i++) {
+        hmap_init(&table->indices[i]);
+    }
 
     return table;
 }
@@ -982,22 +1112,306 @@ classifier_next_table(const struct classifier *cls,
 static void
 destroy_table(struct classifier *cls, struct cls_table *table)
 {
+    int i;
+
+    for (i = 0; i < CLS_N_STAGES - 1; i++) {
+        struct cls_index *index, *next;
+
+        HMAP_FOR_EACH_SAFE (index, next, hmap_node, &table->indices[i]) {
+            hmap_remove(&table->indices[i], &index->hmap_node);
+            free(index);
+        }
+        hmap_destroy(&table->indices[i]);
+    }
+
     hmap_remove(&cls->tables, &table->hmap_node);
+    list_remove(&table->list_node);
     hmap_destroy(&table->rules);
     free(table);
 }
 
+/* Moves 'table' within 'cls->tables_priority' so that the list stays sorted
+ * in decreasing order of 'max_priority'. */
+static void
+sort_table(struct classifier *cls, struct cls_table *table)
+{
+    struct list *pos;
+
+    /* Move toward the front past tables with lower 'max_priority'. */
+    for (pos = table->list_node.prev; pos != &cls->tables_priority;
+         pos = pos->prev) {
+        struct cls_table *prev = CONTAINER_OF(pos, struct cls_table,
+                                              list_node);
+        if (prev->max_priority >= table->max_priority) {
+            break;
+        }
+    }
+    if (pos != table->list_node.prev) {
+        list_remove(&table->list_node);
+        list_insert(pos->next, &table->list_node);
+        return;
+    }
+
+    /* Move toward the back past tables with higher 'max_priority'. */
+    for (pos = table->list_node.next; pos != &cls->tables_priority;
+         pos = pos->next) {
+        struct cls_table *next = CONTAINER_OF(pos, struct cls_table,
+                                              list_node);
+        if (next->max_priority <= table->max_priority) {
+            break;
+        }
+    }
+    if (pos != table->list_node.next) {
+        list_remove(&table->list_node);
+        list_insert(pos, &table->list_node);
+    }
+}
+
+/* Updates 'table''s 'max_priority' and position in 'cls' after a rule with
+ * 'new_priority' has been added to it. */
+static void
+update_tables_after_insertion(struct classifier *cls, struct cls_table *table,
+                              unsigned int new_priority)
+{
+    if (new_priority == table->max_priority) {
+        table->max_count++;
+    } else if (new_priority > table->max_priority || !table->max_count) {
+        table->max_priority = new_priority;
+        table->max_count = 1;
+        sort_table(cls, table);
+    }
+}
+
+/* Updates 'table''s 'max_priority' and position in 'cls' after a rule with
+ * 'del_priority' has been removed from it.  'table' must not be empty. */
+static void
+update_tables_after_removal(struct classifier *cls, struct cls_table *table,
+                            unsigned int del_priority)
+{
+    struct cls_rule *head;
+
+    if (del_priority != table->max_priority || --table->max_count) {
+        return;
+    }
+
+    /* The head of each list has the highest priority in the list, so only
+     * heads need to be considered. */
+    table->max_priority = 0;
+    HMAP_FOR_EACH (head, hmap_node, &table->rules) {
+        if (head->priority > table->max_priority || !table->max_count) {
+            table->max_priority = head->priority;
+            table->max_count = 1;
+        } else if (head->priority == table->max_priority) {
+            table->max_count++;
+        }
+    }
+    sort_table(cls, table);
+}
+
+/* Stores into 'key' the fields of 'flow' that belong to 'stage', with the
+ * bits wildcarded by 'wc' set to 0 exactly as zero_wildcards() would, and
+ * returns the number of significant words in 'key'. */
+static size_t
+mask_stage(const struct flow *flow, const struct flow_wildcards *wc,
+           enum cls_stage stage, struct stage_key *key)
+{
+    const flow_wildcards_t w = wc->wildcards;
+
+    memset(key->words, 0, sizeof key->words);
+    key->n_bytes = 0;
+
+    switch (stage) {
+    case CLS_STAGE_METADATA: {
+        ovs_be64 tun_id = flow->tun_id & wc->tun_id_mask;
+        uint16_t in_port = w & FWW_IN_PORT ? 0 : flow->in_port;
+        int i;
+
+        stage_key_put(key, &tun_id, sizeof tun_id);
+        for (i = 0; i < FLOW_N_REGS; i++) {
+            uint32_t reg = flow->regs[i] & wc->reg_masks[i];
+            stage_key_put(key, &reg, sizeof reg);
+        }
+        stage_key_put(key, &in_port, sizeof in_port);
+        break;
+    }
+
+    case CLS_STAGE_L2: {
+        ovs_be16 vlan_tci = flow->vlan_tci & wc->vlan_tci_mask;
+        ovs_be16 dl_type = w & FWW_DL_TYPE ? 0 : flow->dl_type;
+        uint8_t dl_dst[ETH_ADDR_LEN];
+
+        memcpy(dl_dst, flow->dl_dst, ETH_ADDR_LEN);
+        if (w & FWW_DL_DST) {
+            dl_dst[0] &= 0x01;
+            memset(&dl_dst[1], 0, 5);
+        }
+        if (w & FWW_ETH_MCAST) {
+            dl_dst[0] &= 0xfe;
+        }
+
+        stage_key_put_eth(key, flow->dl_src, w & FWW_DL_SRC);
+        stage_key_put(key, dl_dst, ETH_ADDR_LEN);
+        stage_key_put(key, &vlan_tci, sizeof vlan_tci);
+        stage_key_put(key, &dl_type, sizeof dl_type);
+        break;
+    }
+
+    case CLS_STAGE_L3: {
+        ovs_be32 nw_src = flow->nw_src & wc->nw_src_mask;
+        ovs_be32 nw_dst = flow->nw_dst & wc->nw_dst_mask;
+        struct in6_addr ipv6_src = ipv6_addr_bitand(&flow->ipv6_src,
+                                                    &wc->ipv6_src_mask);
+        struct in6_addr ipv6_dst = ipv6_addr_bitand(&flow->ipv6_dst,
+                                                    &wc->ipv6_dst_mask);
+        uint8_t nw_proto = w & FWW_NW_PROTO ? 0 : flow->nw_proto;
+        uint8_t nw_tos = w & FWW_NW_TOS ? 0 : flow->nw_tos;
+
+        stage_key_put(key, &nw_src, sizeof nw_src);
+        stage_key_put(key, &nw_dst, sizeof nw_dst);
+        stage_key_put(key, &ipv6_src, sizeof ipv6_src);
+        stage_key_put(key, &ipv6_dst, sizeof ipv6_dst);
+        stage_key_put_eth(key, flow->arp_sha, w & FWW_ARP_SHA);
+        stage_key_put_eth(key, flow->arp_tha, w & FWW_ARP_THA);
+        stage_key_put(key, &nw_proto, sizeof nw_proto);
+        stage_key_put(key, &nw_tos, sizeof nw_tos);
+        break;
+    }
+
+    case CLS_STAGE_L4: {
+        ovs_be16 tp_src = w & FWW_TP_SRC ? 0 : flow->tp_src;
+        ovs_be16 tp_dst = w & FWW_TP_DST ? 0 : flow->tp_dst;
+
+        stage_key_put(key, &tp_src, sizeof tp_src);
+        stage_key_put(key, &tp_dst, sizeof tp_dst);
+        if (!(w & FWW_ND_TARGET)) {
+            stage_key_put(key, &flow->nd_target, sizeof flow->nd_target);
+        }
+        break;
+    }
+
+    case CLS_N_STAGES:
+    default:
+        NOT_REACHED();
+    }
+
+    return DIV_ROUND_UP(key->n_bytes, 4);
+}
+
+/* Returns the hash of the fields of 'flow' in 'stage', after masking them
+ * with 'wc', using 'basis' as the hash basis. */
+static uint32_t
+hash_stage(const struct flow *flow, const struct flow_wildcards *wc,
+           enum cls_stage stage, uint32_t basis)
+{
+    struct stage_key key;
+    size_t n_words;
+
+    n_words = mask_stage(flow, wc, stage, &key);
+    return hash_words(key.words, n_words, basis);
+}
+
+/* Returns the hash of 'flow' within 'table', that is, the hash used for the
+ * rules in 'table->rules'.  If 'partial_hashes' is nonnull, stores the hash
+ * after each of the first 'table->n_stages - 1' stages into it. */
+static uint32_t
+table_hash(const struct cls_table *table, const struct flow *flow,
+           uint32_t partial_hashes[])
+{
+    uint32_t hash = 0;
+    int i;
+
+    for (i = 0; i < table->n_stages; i++) {
+        hash = hash_stage(flow, &table->wc, table->stages[i], hash);
+        if (partial_hashes && i < table->n_stages - 1) {
+            partial_hashes[i] = hash;
+        }
+    }
+    return hash;
+}
+
+static struct cls_index *
+find_index(const struct hmap *indices, uint32_t hash)
+{
+    struct hmap_node *node = hmap_first_with_hash(indices, hash);
+    return node ? CONTAINER_OF(node, struct cls_index, hmap_node) : NULL;
+}
+
+/* Adds the partial hashes of 'rule', which is being added to 'table->rules',
+ * to 'table''s indices. */
+static void
+index_rule(struct cls_table *table, const struct cls_rule *rule)
+{
+    uint32_t partial_hashes[CLS_N_STAGES];
+    int i;
+
+    table_hash(table, &rule->flow, partial_hashes);
+    for (i = 0; i < table->n_stages - 1; i++) {
+        struct cls_index *index;
+
+        index = find_index(&table->indices[i], partial_hashes[i]);
+        if (!index) {
+            index = xmalloc(sizeof *index);
+            index->n_rules = 0;
+            hmap_insert(&table->indices[i], &index->hmap_node,
+                        partial_hashes[i]);
+        }
+        index->n_rules++;
+    }
+}
+
+/* Removes the partial hashes of 'rule', which is being removed from
+ * 'table->rules', from 'table''s indices. */
+static void
+unindex_rule(struct cls_table *table, const struct cls_rule *rule)
+{
+    uint32_t partial_hashes[CLS_N_STAGES];
+    int i;
+
+    table_hash(table, &rule->flow, partial_hashes);
+    for (i = 0; i < table->n_stages - 1; i++) {
+        struct cls_index *index;
+
+        index = find_index(&table->indices[i], partial_hashes[i]);
+        if (!--index->n_rules) {
+            hmap_remove(&table->indices[i], &index->hmap_node);
+            free(index);
+        }
+    }
+}
+
+/* Returns the highest-priority rule in 'table' that matches 'flow', or a null
+ * pointer if there is none.  Gives up as soon as the partial hash of the
+ * stages hashed so far does not appear in the corresponding index, except
+ * that if 'hashp' is nonnull it first finishes hashing 'flow' and stores the
+ * hash of 'flow' within 'table' into '*hashp'. */
 static struct cls_rule *
-find_match(const struct cls_table *table, const struct flow *flow)
+find_match(const struct cls_table *table, const struct flow *flow,
+           uint32_t *hashp)
 {
     struct cls_rule *rule;
-    struct flow f;
+    uint32_t hash = 0;
+    int i;
 
-    f = *flow;
-    zero_wildcards(&f, &table->wc);
-    HMAP_FOR_EACH_WITH_HASH (rule, hmap_node, flow_hash(&f, 0),
-                             &table->rules) {
-        if (flow_equal(&f, &rule->flow)) {
+    for (i = 0; i < table->n_stages; i++) {
+        hash = hash_stage(flow, &table->wc, table->stages[i], hash);
+        if (i < table->n_stages - 1
+            && !find_index(&table->indices[i], hash)) {
+            if (hashp) {
+                while (++i < table->n_stages) {
+                    hash = hash_stage(flow, &table->wc, table->stages[i],
+                                      hash);
+                }
+                *hashp = hash;
+            }
+            return NULL;
+        }
+    }
+    if (hashp) {
+        *hashp = hash;
+    }
+
+    HMAP_FOR_EACH_WITH_HASH (rule, hmap_node, hash, &table->rules) {
+        if (flow_equal_except(flow, &rule->flow, &table->wc)) {
             return rule;
         }
     }
@@ -1022,11 +1436,12 @@ insert_rule(struct cls_table *table, struct cls_rule *new)
 {
     struct cls_rule *head;
 
-    new->hmap_node.hash = flow_hash(&new->flow, 0);
+    new->hmap_node.hash = table_hash(table, &new->flow, NULL);
 
     head = find_equal(table, &new->flow, new->hmap_node.hash);
     if (!head) {
         hmap_insert(&table->rules, &new->hmap_node, new->hmap_node.hash);
+        index_rule(table, new);
         list_init(&new->list);
         return NULL;
     } else {
@@ -1057,6 +1472,15 @@ insert_rule(struct cls_table *table, struct cls_rule *new)
     }
 }
 
+/* Removes 'rule', which must be the only rule in its list, from
+ * 'table->rules'. */
+static void
+remove_rule(struct cls_table *table, struct cls_rule *rule)
+{
+    hmap_remove(&table->rules, &rule->hmap_node);
+    unindex_rule(table, rule);
+}
+
 static struct cls_rule *
 next_rule_in_list__(struct cls_rule *rule)
 {
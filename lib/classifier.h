@@ -24,6 +24,15 @@
  *              a hash map from fixed field values to "struct cls_rule",
  *                      which can contain a list of otherwise identical rules
  *                      with lower priorities.
+ *
+ * The classifier also keeps its tables on a list sorted in decreasing order of
+ * the highest priority of any rule that they contain, so that a lookup can
+ * stop as soon as no remaining table can contain a better match.
+ *
+ * Within a table, a lookup hashes the flow in stages (see "enum cls_stage"
+ * below).  Each stage except the last has an index of the partial hashes of
+ * the rules in the table, so that a lookup that cannot match any rule in the
+ * table usually stops after hashing just the first few fields.
  */
 
 #include "flow.h"
@@ -31,19 +40,42 @@
 #include "list.h"
 #include "openflow/nicira-ext.h"
 #include "openflow/openflow.h"
+#include "tag.h"
 
 /* A flow classifier. */
 struct classifier {
     int n_rules;                /* Total number of rules. */
     struct hmap tables;         /* Contains "struct cls_table"s.  */
+    struct list tables_priority; /* Tables in descending 'max_priority'. */
+};
+
+/* Stages of a lookup within a cls_table, in the order that they are hashed.
+ * Each stage covers a group of fields in struct flow. */
+enum cls_stage {
+    CLS_STAGE_METADATA,         /* tun_id, regs, in_port. */
+    CLS_STAGE_L2,               /* dl_src, dl_dst, vlan_tci, dl_type. */
+    CLS_STAGE_L3,               /* nw_*, ipv6_*, arp_*. */
+    CLS_STAGE_L4,               /* tp_src, tp_dst, nd_target. */
+    CLS_N_STAGES
 };
 
 /* A set of rules that all have the same fields wildcarded. */
 struct cls_table {
-    struct hmap_node hmap_node; /* Within struct classifier 'wctables'. */
+    struct hmap_node hmap_node; /* Within struct classifier 'tables'. */
+    struct list list_node;      /* In struct classifier 'tables_priority'. */
     struct hmap rules;          /* Contains "struct cls_rule"s. */
     struct flow_wildcards wc;   /* Wildcards for fields. */
     int n_table_rules;          /* Number of rules, including duplicates. */
+    unsigned int max_priority;  /* Max priority of any rule in the table. */
+    unsigned int max_count;     /* Number of rules with 'max_priority'. */
+
+    /* Staged lookup.  'stages' lists the stages in which 'wc' has at least
+     * one significant bit.  indices[i], for i < n_stages - 1, contains a
+     * "struct cls_index" for each distinct hash of the fields in stages[0]
+     * through stages[i] among the rules in 'rules'. */
+    uint8_t stages[CLS_N_STAGES];
+    int n_stages;
+    struct hmap indices[CLS_N_STAGES - 1];
 };
 
 /* A flow classification rule.
@@ -128,6 +160,13 @@ struct cls_rule *classifier_lookup(const struct classifier *,
 bool classifier_rule_overlaps(const struct classifier *,
                               const struct cls_rule *);
 
+/* Tagging support. */
+struct cls_rule *classifier_lookup_tags(const struct classifier *,
+                                        const struct flow *, tag_type *tags);
+bool classifier_rule_is_reachable(const struct classifier *,
+                                  const struct cls_rule *);
+tag_type cls_rule_tag(const struct cls_rule *);
+
 typedef void cls_cb_func(struct cls_rule *, void *aux);
 
 struct cls_rule *classifier_find_rule_exactly(const struct classifier *,
@@ -17,6 +17,7 @@
 #include <config.h>
 #include "coverage.h"
 #include <inttypes.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include "dynamic-string.h"
 #include "hash.h"
@@ -47,6 +48,14 @@ struct coverage_counter *coverage_counters[] = {
 
 static unsigned int epoch;
 
+__thread unsigned int *coverage_thread_counts;
+
+/* Counts flushed by threads other than the main thread, not yet added into the
+ * counters.  Protected by 'thread_mutex'. */
+static pthread_mutex_t thread_mutex = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int *thread_counts;
+static bool thread_counts_pending;
+
 static void
 coverage_unixctl_log(struct unixctl_conn *conn, const char *args OVS_UNUSED,
                      void *aux OVS_UNUSED)
@@ -58,9 +67,72 @@ coverage_unixctl_log(struct unixctl_conn *conn, const char *args OVS_UNUSED,
 void
 coverage_init(void)
 {
+    size_t i;
+
+    for (i = 0; i < n_coverage_counters; i++) {
+        coverage_counters[i]->idx = i;
+    }
     unixctl_command_register("coverage/log", coverage_unixctl_log, NULL);
 }
 
+/* Gives the calling thread, which must not be the main thread, counters of
+ * its own.  The thread must call coverage_thread_exit() before it exits. */
+void
+coverage_thread_start(void)
+{
+    coverage_thread_counts = xcalloc(n_coverage_counters,
+                                     sizeof *coverage_thread_counts);
+}
+
+/* Passes the calling thread's counts along to the main thread, which adds them
+ * into the counters the next time it advances the epoch or logs them.  A
+ * thread should call this periodically. */
+void
+coverage_thread_flush(void)
+{
+    size_t i;
+
+    pthread_mutex_lock(&thread_mutex);
+    if (!thread_counts) {
+        thread_counts = xcalloc(n_coverage_counters, sizeof *thread_counts);
+    }
+    for (i = 0; i < n_coverage_counters; i++) {
+        if (coverage_thread_counts[i]) {
+            thread_counts[i] += coverage_thread_counts[i];
+            coverage_thread_counts[i] = 0;
+            thread_counts_pending = true;
+        }
+    }
+    pthread_mutex_unlock(&thread_mutex);
+}
+
+/* Flushes the calling thread's counts and frees its counters. */
+void
+coverage_thread_exit(void)
+{
+    coverage_thread_flush();
+    free(coverage_thread_counts);
+    coverage_thread_counts = NULL;
+}
+
+/* Adds the counts flushed by other threads into the counters.  Only the main
+ * thread may call this. */
+static void
+coverage_fold_threads(void)
+{
+    size_t i;
+
+    pthread_mutex_lock(&thread_mutex);
+    if (thread_counts_pending) {
+        for (i = 0; i < n_coverage_counters; i++) {
+            coverage_counters[i]->count += thread_counts[i];
+            thread_counts[i] = 0;
+        }
+        thread_counts_pending = false;
+    }
+    pthread_mutex_unlock(&thread_mutex);
+}
+
 /* Sorts coverage counters in descending order by count, within equal counts
  * alphabetically by name. */
 static int
@@ -156,6 +228,7 @@ coverage_log(enum vlog_level level, bool suppress_dups)
         return;
     }
 
+    coverage_fold_threads();
     hash = coverage_hash();
     if (suppress_dups) {
         if (coverage_hit(hash)) {
@@ -193,6 +266,7 @@ coverage_clear(void)
 {
     size_t i;
 
+    coverage_fold_threads();
     epoch++;
     for (i = 0; i < n_coverage_counters; i++) {
         struct coverage_counter *c = coverage_counters[i];
@@ -25,8 +25,14 @@
  * This form of coverage instrumentation is intended to be so lightweight that
  * it can be enabled in production builds.  It is obviously not a substitute
  * for traditional coverage instrumentation with e.g. "gcov", but it is still
- * a useful debugging tool. */
+ * a useful debugging tool.
+ *
+ * Threads other than the main thread may use COVERAGE_INC and COVERAGE_ADD
+ * between calls to coverage_thread_start() and coverage_thread_exit().  Their
+ * counts go to counters of their own, which coverage_thread_flush() makes
+ * available for the main thread to add into the counters below. */
 
+#include <stddef.h>
 #include "vlog.h"
 
 /* A coverage counter. */
@@ -34,8 +40,13 @@ struct coverage_counter {
     const char *name;           /* Textual name. */
     unsigned int count;         /* Count within the current epoch. */
     unsigned long long int total; /* Total count over all epochs. */
+    size_t idx;                 /* Index into per-thread counts. */
 };
 
+/* This thread's own counts, indexed by 'idx', or a null pointer in the main
+ * thread. */
+extern __thread unsigned int *coverage_thread_counts;
+
 /* Defines COUNTER.  There must be exactly one such definition at file scope
  * within a program. */
 #if USE_LINKER_SECTIONS
@@ -49,17 +60,25 @@ struct coverage_counter {
 #endif
 
 /* Adds 1 to COUNTER. */
-#define COVERAGE_INC(COUNTER) counter_##COUNTER.count++;
+#define COVERAGE_INC(COUNTER) COVERAGE_ADD(COUNTER, 1)
 
 /* Adds AMOUNT to COUNTER. */
-#define COVERAGE_ADD(COUNTER, AMOUNT) counter_##COUNTER.count += (AMOUNT);
+#define COVERAGE_ADD(COUNTER, AMOUNT)                                   \
+        (coverage_thread_counts                                         \
+         ? (void) (coverage_thread_counts[counter_##COUNTER.idx]        \
+                   += (AMOUNT))                                         \
+         : (void) (counter_##COUNTER.count += (AMOUNT)))
 
 void coverage_init(void);
 void coverage_log(enum vlog_level, bool suppress_dups);
 void coverage_clear(void);
 
+void coverage_thread_start(void);
+void coverage_thread_flush(void);
+void coverage_thread_exit(void);
+
 /* Implementation detail. */
 #define COVERAGE_DEFINE__(COUNTER)                              \
-        struct coverage_counter counter_##COUNTER = { #COUNTER, 0, 0 }
+        struct coverage_counter counter_##COUNTER = { #COUNTER, 0, 0, 0 }
 
 #endif /* coverage.h */
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2011 Nicira Networks.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <config.h>
+#include "crc32c.h"
+#include <stdbool.h>
+
+/* The CRC-32C (Castagnoli) polynomial, bit-reversed. */
+#define CRC32C_POLY 0x82f63b78
+
+/* crc32c_table[i][b] is the CRC of byte 'b' followed by 'i' zero bytes, so
+ * that the main loop can process 4 bytes per step. */
+static uint32_t crc32c_table[4][256];
+
+static void
+crc32c_init(void)
+{
+    int i, j;
+
+    for (i = 0; i < 256; i++) {
+        uint32_t crc = i;
+
+        for (j = 0; j < 8; j++) {
+            crc = crc & 1 ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+        }
+        crc32c_table[0][i] = crc;
+    }
+    for (i = 0; i < 256; i++) {
+        uint32_t crc = crc32c_table[0][i];
+
+        for (j = 1; j < 4; j++) {
+            crc = (crc >> 8) ^ crc32c_table[0][crc & 0xff];
+            crc32c_table[j][i] = crc;
+        }
+    }
+}
+
+/* Returns the CRC-32C, as used by iSCSI (RFC 3720) and SCTP (RFC 4960), of
+ * the 'n' bytes in 'data'. */
+uint32_t
+crc32c(const void *data_, size_t n)
+{
+    static bool inited;
+    const uint8_t *data = data_;
+    uint32_t crc = 0xffffffff;
+
+    if (!inited) {
+        crc32c_init();
+        inited = true;
+    }
+
+    for (; n >= 4; n -= 4, data += 4) {
+        crc ^= data[0] | (data[1] << 8) | (data[2] << 16)
+               | ((uint32_t) data[3] << 24);
+        crc = (crc32c_table[3][crc & 0xff]
+               ^ crc32c_table[2][(crc >> 8) & 0xff]
+               ^ crc32c_table[1][(crc >> 16) & 0xff]
+               ^ crc32c_table[0][crc >> 24]);
+    }
+    for (; n > 0; n--, data++) {
+        crc = (crc >> 8) ^ crc32c_table[0][(crc ^ *data) & 0xff];
+    }
+    return ~crc;
+}
@@ -25,6 +25,9 @@
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <net/if.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -32,6 +35,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include "coverage.h"
 #include "csum.h"
 #include "dpif.h"
 #include "dpif-provider.h"
@@ -48,7 +52,9 @@
 #include "packets.h"
 #include "poll-loop.h"
 #include "shash.h"
+#include "socket-util.h"
 #include "timeval.h"
+#include "unixctl.h"
 #include "util.h"
 #include "vlog.h"
 
@@ -57,6 +63,14 @@ VLOG_DEFINE_THIS_MODULE(dpif_netdev);
 /* Configuration parameters. */
 enum { MAX_PORTS = 256 };       /* Maximum number of ports. */
 enum { MAX_FLOWS = 65536 };     /* Maximum number of flows in flow table. */
+enum { MAX_THREADS = 16 };      /* Maximum number of forwarding threads. */
+enum { COVERAGE_FLUSH_INTERVAL = 100 }; /* Forwarding threads' coverage flush
+                                         * interval, in ms. */
+
+/* Exact-match cache. */
+enum { EMC_SHIFT = 10 };
+enum { EMC_ENTRIES = 1 << EMC_SHIFT }; /* Entries per exact-match cache. */
+enum { EMC_MASK = EMC_ENTRIES - 1 };
 
 /* Enough headroom to add a vlan tag, plus an extra 2 bytes to allow IP
  * headers to be aligned on a 4-byte boundary.  */
@@ -73,7 +87,82 @@ struct dp_netdev_queue {
     unsigned int head, tail;
 };
 
-/* Datapath based on the network device interface from netdev.h. */
+/* Datapath statistics.  dpif_netdev_get_stats() sums up the copies kept by
+ * each thread. */
+struct dp_netdev_stats {
+    long long int n_frags;      /* Number of dropped IP fragments. */
+    long long int n_hit;        /* Number of flow table matches. */
+    long long int n_missed;     /* Number of flow table misses. */
+    long long int n_emc_hit;    /* Matches found in the exact-match cache. */
+    long long int n_emc_miss;   /* Lookups that missed the exact-match cache. */
+};
+
+/* An entry in an exact-match cache.
+ *
+ * The exact-match cache is a direct-mapped cache, indexed by a signature
+ * computed over the most commonly varying fields of a flow, that maps
+ * packets of a recently seen flow straight to its dp_netdev_flow without
+ * hashing the entire flow and searching the flow table.  Only hits are
+ * cached, so adding a flow never invalidates an entry, but deleting a flow
+ * must remove it from every cache (see dp_netdev_emc_remove()). */
+struct dp_netdev_emc_entry {
+    uint32_t sig;
+    struct dp_netdev_flow *flow; /* Null if the entry is unused. */
+};
+
+/* State kept separately by each thread that processes packets for a
+ * dp_netdev.  Allocated on a cache line boundary and padded out to a whole
+ * number of cache lines, so that threads never write to the same lines. */
+struct dp_netdev_perthread {
+    struct dp_netdev_emc_entry emc[EMC_ENTRIES]; /* Exact-match cache. */
+    struct dp_netdev_stats stats;
+    uint8_t pad[CACHE_LINE_SIZE - sizeof(struct dp_netdev_stats)];
+};
+BUILD_ASSERT_DECL(sizeof(struct dp_netdev_stats) < CACHE_LINE_SIZE);
+BUILD_ASSERT_DECL(sizeof(struct dp_netdev_perthread) % CACHE_LINE_SIZE == 0);
+
+/* A thread that forwards packets received on a subset of a dp_netdev's
+ * ports. */
+struct dp_netdev_thread {
+    struct dp_netdev *dp;
+    pthread_t thread;
+    int id;                     /* Index into per-thread stats, 1-based. */
+};
+
+/* Datapath based on the network device interface from netdev.h.
+ *
+ * Normally all of a dp_netdev's packet processing happens in dp_netdev_run(),
+ * in the main thread.  Optionally, with "dpif-netdev/set-threads", ports may
+ * instead be polled by up to MAX_THREADS forwarding threads.  In that case:
+ *
+ *     - Forwarding threads hold 'rwlock' for reading while they receive and
+ *       forward packets.  Readers do not exclude each other.  The main thread
+ *       holds 'rwlock' for writing whenever it modifies the flow table, a
+ *       flow's actions, or the set of ports.  Reading those from the main
+ *       thread requires no locking, since only the main thread writes them.
+ *
+ *     - 'queue_mutex' protects 'queues' and 'n_lost'.  A forwarding thread
+ *       that queues an upcall also writes a byte to 'wakeup_fds[1]' to wake
+ *       up the main thread.
+ *
+ *     - Statistics and exact-match caches are kept per thread, in
+ *       'perthread', and flow statistics in each flow's 'stats'.  Statistics
+ *       are summed when they are read.
+ *
+ *     - Forwarding threads call into the netdev library only through
+ *       netdev_recv_batch(), on the ports that they own, and netdev_send(),
+ *       on the ports that they output to, which the main thread and other
+ *       forwarding threads may be sending on at the same time.  A netdev
+ *       provider must make those calls safe to make that way for its ports to
+ *       be used with forwarding threads.  netdev-dummy and netdev-linux do.
+ *
+ *     - Forwarding threads also extract flows, log, read the clock, and
+ *       bump coverage counters, along their own path and in the netdev
+ *       library.  The vlog library serializes logging.  The timeval library
+ *       gives threads other than the main thread the time straight from the
+ *       clock instead of refreshing its cached time.  Each forwarding thread
+ *       counts coverage events in counters of its own, which it flushes every
+ *       COVERAGE_FLUSH_INTERVAL ms for the main thread to fold in. */
 struct dp_netdev {
     const struct dpif_class *class;
     char *name;
@@ -85,16 +174,24 @@ struct dp_netdev {
     struct hmap flow_table;     /* Flow table. */
 
     /* Statistics. */
-    long long int n_frags;      /* Number of dropped IP fragments. */
-    long long int n_hit;        /* Number of flow table matches. */
-    long long int n_missed;     /* Number of flow table misses. */
+    struct dp_netdev_perthread *perthread; /* One per thread, [0] for main. */
     long long int n_lost;       /* Number of misses not passed to client. */
+    long long int n_ops;        /* Operations passed to dpif_operate(). */
+    long long int n_op_batches; /* Calls to dpif_operate(). */
 
     /* Ports. */
     int n_ports;
     struct dp_netdev_port *ports[MAX_PORTS];
     struct list port_list;
     unsigned int serial;
+
+    /* Forwarding threads. */
+    int n_threads;
+    struct dp_netdev_thread *threads;
+    bool stop_threads;          /* Tells forwarding threads to exit. */
+    pthread_rwlock_t rwlock;
+    pthread_mutex_t queue_mutex;
+    int wakeup_fds[2];
 };
 
 /* A port in a netdev-based datapath. */
@@ -105,16 +202,21 @@ struct dp_netdev_port {
     bool internal;              /* Internal port? */
 };
 
+/* Statistics for a dp_netdev_flow, kept separately for each thread. */
+struct dp_netdev_flow_stats {
+    long long int used;         /* Last used time, in monotonic msecs. */
+    long long int packet_count; /* Number of packets matched. */
+    long long int byte_count;   /* Number of bytes matched. */
+    uint16_t tcp_ctl;           /* Bitwise-OR of seen tcp_ctl values. */
+};
+
 /* A flow in dp_netdev's 'flow_table'. */
 struct dp_netdev_flow {
     struct hmap_node node;      /* Element in dp_netdev's 'flow_table'. */
     struct flow key;
 
-    /* Statistics. */
-    long long int used;         /* Last used time, in monotonic msecs. */
-    long long int packet_count; /* Number of packets matched. */
-    long long int byte_count;   /* Number of bytes matched. */
-    uint16_t tcp_ctl;           /* Bitwise-OR of seen tcp_ctl values. */
+    /* Statistics, one per thread, plus [0] for the main thread. */
+    struct dp_netdev_flow_stats *stats;
 
     /* Actions. */
     struct nlattr *actions;
@@ -153,6 +255,17 @@ static int dp_netdev_execute_actions(struct dp_netdev *,
                                      struct ofpbuf *, struct flow *,
                                      const struct nlattr *actions,
                                      size_t actions_len);
+static void dp_netdev_emc_remove(struct dp_netdev *,
+                                 const struct dp_netdev_flow *);
+static void dp_netdev_stop_threads(struct dp_netdev *);
+static void dp_netdev_unixctl_set_threads(struct unixctl_conn *,
+                                          const char *args, void *aux);
+static void dp_netdev_unixctl_show(struct unixctl_conn *,
+                                   const char *args, void *aux);
+static void dp_netdev_unixctl_dump_flows(struct unixctl_conn *,
+                                         const char *args, void *aux);
+static void dp_netdev_unixctl_add_flow(struct unixctl_conn *,
+                                       const char *args, void *aux);
 
 static struct dpif_class dpif_dummy_class;
 
@@ -190,10 +303,24 @@ static int
 create_dp_netdev(const char *name, const struct dpif_class *class,
                  struct dp_netdev **dpp)
 {
+    static bool registered;
+    pthread_rwlockattr_t attr;
     struct dp_netdev *dp;
     int error;
     int i;
 
+    if (!registered) {
+        unixctl_command_register("dpif-netdev/set-threads",
+                                 dp_netdev_unixctl_set_threads, NULL);
+        unixctl_command_register("dpif-netdev/show",
+                                 dp_netdev_unixctl_show, NULL);
+        unixctl_command_register("dpif-netdev/dump-flows",
+                                 dp_netdev_unixctl_dump_flows, NULL);
+        unixctl_command_register("dpif-netdev/add-flow",
+                                 dp_netdev_unixctl_add_flow, NULL);
+        registered = true;
+    }
+
     dp = xzalloc(sizeof *dp);
     dp->class = class;
     dp->name = xstrdup(name);
@@ -203,7 +330,23 @@ create_dp_netdev(const char *name, const struct dpif_class *class,
         dp->queues[i].head = dp->queues[i].tail = 0;
     }
     hmap_init(&dp->flow_table);
+    dp->perthread = xzalloc_cacheline(sizeof *dp->perthread);
     list_init(&dp->port_list);
+
+    pthread_rwlockattr_init(&attr);
+#ifdef HAVE_PTHREAD_RWLOCKATTR_SETKIND_NP
+    /* Forwarding threads take the lock for reading over and over, so without
+     * this the main thread could starve waiting to take it for writing. */
+    pthread_rwlockattr_setkind_np(&attr,
+                                  PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    pthread_rwlock_init(&dp->rwlock, &attr);
+    pthread_rwlockattr_destroy(&attr);
+    pthread_mutex_init(&dp->queue_mutex, NULL);
+    xpipe(dp->wakeup_fds);
+    set_nonblocking(dp->wakeup_fds[0]);
+    set_nonblocking(dp->wakeup_fds[1]);
+
     error = do_add_port(dp, name, "internal", ODPP_LOCAL);
     if (error) {
         dp_netdev_free(dp);
@@ -250,6 +393,7 @@ dp_netdev_purge_queues(struct dp_netdev *dp)
 {
     int i;
 
+    pthread_mutex_lock(&dp->queue_mutex);
     for (i = 0; i < N_QUEUES; i++) {
         struct dp_netdev_queue *q = &dp->queues[i];
 
@@ -260,11 +404,13 @@ dp_netdev_purge_queues(struct dp_netdev *dp)
             free(upcall);
         }
     }
+    pthread_mutex_unlock(&dp->queue_mutex);
 }
 
 static void
 dp_netdev_free(struct dp_netdev *dp)
 {
+    dp_netdev_stop_threads(dp);
     dp_netdev_flow_flush(dp);
     while (dp->n_ports > 0) {
         struct dp_netdev_port *port = CONTAINER_OF(
@@ -273,6 +419,11 @@ dp_netdev_free(struct dp_netdev *dp)
     }
     dp_netdev_purge_queues(dp);
     hmap_destroy(&dp->flow_table);
+    pthread_rwlock_destroy(&dp->rwlock);
+    pthread_mutex_destroy(&dp->queue_mutex);
+    close(dp->wakeup_fds[0]);
+    close(dp->wakeup_fds[1]);
+    free(dp->perthread);
     free(dp->name);
     free(dp);
 }
@@ -297,15 +448,41 @@ dpif_netdev_destroy(struct dpif *dpif)
     return 0;
 }
 
+/* Sums the per-thread statistics for 'dp' into '*stats' and stores the
+ * number of lost upcalls into '*n_lost'. */
+static void
+dp_netdev_get_stats(struct dp_netdev *dp, struct dp_netdev_stats *stats,
+                    uint64_t *n_lost)
+{
+    int i;
+
+    memset(stats, 0, sizeof *stats);
+    for (i = 0; i <= dp->n_threads; i++) {
+        const struct dp_netdev_stats *s = &dp->perthread[i].stats;
+
+        stats->n_frags += s->n_frags;
+        stats->n_hit += s->n_hit;
+        stats->n_missed += s->n_missed;
+        stats->n_emc_hit += s->n_emc_hit;
+        stats->n_emc_miss += s->n_emc_miss;
+    }
+
+    pthread_mutex_lock(&dp->queue_mutex);
+    *n_lost = dp->n_lost;
+    pthread_mutex_unlock(&dp->queue_mutex);
+}
+
 static int
 dpif_netdev_get_stats(const struct dpif *dpif, struct odp_stats *stats)
 {
     struct dp_netdev *dp = get_dp_netdev(dpif);
+    struct dp_netdev_stats dp_stats;
+
     memset(stats, 0, sizeof *stats);
-    stats->n_frags = dp->n_frags;
-    stats->n_hit = dp->n_hit;
-    stats->n_missed = dp->n_missed;
-    stats->n_lost = dp->n_lost;
+    dp_netdev_get_stats(dp, &dp_stats, &stats->n_lost);
+    stats->n_frags = dp_stats.n_frags;
+    stats->n_hit = dp_stats.n_hit;
+    stats->n_missed = dp_stats.n_missed;
     return 0;
 }
 
@@ -379,9 +556,11 @@ do_add_port(struct dp_netdev *dp, const char *devname, const char *type,
         max_mtu = mtu;
     }
 
+    pthread_rwlock_wrlock(&dp->rwlock);
     list_push_back(&dp->port_list, &port->node);
     dp->ports[port_no] = port;
     dp->n_ports++;
+    pthread_rwlock_unlock(&dp->rwlock);
     dp->serial++;
 
     return 0;
@@ -457,9 +636,11 @@ do_del_port(struct dp_netdev *dp, uint16_t port_no)
         return error;
     }
 
+    pthread_rwlock_wrlock(&dp->rwlock);
     list_remove(&port->node);
     dp->ports[port->port_no] = NULL;
     dp->n_ports--;
+    pthread_rwlock_unlock(&dp->rwlock);
     dp->serial++;
 
     name = xstrdup(netdev_get_name(port->netdev));
@@ -516,10 +697,14 @@ dpif_netdev_get_max_ports(const struct dpif *dpif OVS_UNUSED)
     return MAX_PORTS;
 }
 
+/* Removes 'flow' from 'dp''s flow table and frees it.  The caller must hold
+ * 'dp->rwlock' for writing. */
 static void
 dp_netdev_free_flow(struct dp_netdev *dp, struct dp_netdev_flow *flow)
 {
+    dp_netdev_emc_remove(dp, flow);
     hmap_remove(&dp->flow_table, &flow->node);
+    free(flow->stats);
     free(flow->actions);
     free(flow);
 }
@@ -529,9 +714,11 @@ dp_netdev_flow_flush(struct dp_netdev *dp)
 {
     struct dp_netdev_flow *flow, *next;
 
+    pthread_rwlock_wrlock(&dp->rwlock);
     HMAP_FOR_EACH_SAFE (flow, next, node, &dp->flow_table) {
         dp_netdev_free_flow(dp, flow);
     }
+    pthread_rwlock_unlock(&dp->rwlock);
 }
 
 static int
@@ -607,6 +794,57 @@ dpif_netdev_port_poll_wait(const struct dpif *dpif_)
     }
 }
 
+/* Returns the exact-match cache signature for 'key'.  The signature covers
+ * the fields from 'nw_src' through the first four bytes of 'dl_dst', which
+ * in practice are enough to tell flows apart.  Flows that differ only in
+ * other fields share a signature, which costs only hit rate, since a hit
+ * also requires the whole flow to match. */
+static uint32_t
+dp_netdev_emc_sig(const struct flow *key)
+{
+    BUILD_ASSERT_DECL(offsetof(struct flow, nw_src) % 4 == 0);
+    BUILD_ASSERT_DECL(offsetof(struct flow, dl_dst)
+                      == offsetof(struct flow, nw_src) + 24);
+
+    return hash_words((const uint32_t *) &key->nw_src, 7, 0);
+}
+
+static struct dp_netdev_flow *
+dp_netdev_emc_lookup(struct dp_netdev_emc_entry *emc, const struct flow *key,
+                     uint32_t sig)
+{
+    struct dp_netdev_emc_entry *e = &emc[sig & EMC_MASK];
+
+    return (e->flow && e->sig == sig && flow_equal(&e->flow->key, key)
+            ? e->flow : NULL);
+}
+
+static void
+dp_netdev_emc_insert(struct dp_netdev_emc_entry *emc,
+                     struct dp_netdev_flow *flow, uint32_t sig)
+{
+    struct dp_netdev_emc_entry *e = &emc[sig & EMC_MASK];
+
+    e->sig = sig;
+    e->flow = flow;
+}
+
+/* Removes 'flow' from all of 'dp''s exact-match caches.  The caller must hold
+ * 'dp->rwlock' for writing. */
+static void
+dp_netdev_emc_remove(struct dp_netdev *dp, const struct dp_netdev_flow *flow)
+{
+    size_t idx = dp_netdev_emc_sig(&flow->key) & EMC_MASK;
+    int i;
+
+    for (i = 0; i <= dp->n_threads; i++) {
+        struct dp_netdev_emc_entry *e = &dp->perthread[i].emc[idx];
+        if (e->flow == flow) {
+            e->flow = NULL;
+        }
+    }
+}
+
 static struct dp_netdev_flow *
 dp_netdev_lookup_flow(const struct dp_netdev *dp, const struct flow *key)
 {
@@ -621,12 +859,24 @@ dp_netdev_lookup_flow(const struct dp_netdev *dp, const struct flow *key)
 }
 
 static void
-get_dpif_flow_stats(struct dp_netdev_flow *flow, struct dpif_flow_stats *stats)
+get_dpif_flow_stats(const struct dp_netdev *dp,
+                    const struct dp_netdev_flow *flow,
+                    struct dpif_flow_stats *stats)
 {
-    stats->n_packets = flow->packet_count;
-    stats->n_bytes = flow->byte_count;
-    stats->used = flow->used;
-    stats->tcp_flags = TCP_FLAGS(flow->tcp_ctl);
+    uint16_t tcp_ctl;
+    int i;
+
+    memset(stats, 0, sizeof *stats);
+    tcp_ctl = 0;
+    for (i = 0; i <= dp->n_threads; i++) {
+        const struct dp_netdev_flow_stats *s = &flow->stats[i];
+
+        stats->n_packets += s->packet_count;
+        stats->n_bytes += s->byte_count;
+        stats->used = MAX(stats->used, s->used);
+        tcp_ctl |= s->tcp_ctl;
+    }
+    stats->tcp_flags = TCP_FLAGS(tcp_ctl);
 }
 
 static int
@@ -676,7 +926,7 @@ dpif_netdev_flow_get(const struct dpif *dpif,
     }
 
     if (stats) {
-        get_dpif_flow_stats(flow, stats);
+        get_dpif_flow_stats(dp, flow, stats);
     }
     if (actionsp) {
         *actionsp = ofpbuf_clone_data(flow->actions, flow->actions_len);
@@ -746,7 +996,7 @@ dpif_netdev_validate_actions(const struct nlattr *actions,
 }
 
 static int
-set_flow_actions(struct dp_netdev_flow *flow,
+set_flow_actions(struct dp_netdev *dp, struct dp_netdev_flow *flow,
                  const struct nlattr *actions, size_t actions_len)
 {
     bool mutates;
@@ -757,40 +1007,44 @@ set_flow_actions(struct dp_netdev_flow *flow,
         return error;
     }
 
+    pthread_rwlock_wrlock(&dp->rwlock);
     flow->actions = xrealloc(flow->actions, actions_len);
     flow->actions_len = actions_len;
     memcpy(flow->actions, actions, actions_len);
+    pthread_rwlock_unlock(&dp->rwlock);
     return 0;
 }
 
 static int
-add_flow(struct dpif *dpif, const struct flow *key,
+add_flow(struct dp_netdev *dp, const struct flow *key,
          const struct nlattr *actions, size_t actions_len)
 {
-    struct dp_netdev *dp = get_dp_netdev(dpif);
     struct dp_netdev_flow *flow;
     int error;
 
     flow = xzalloc(sizeof *flow);
     flow->key = *key;
+    flow->stats = xcalloc(dp->n_threads + 1, sizeof *flow->stats);
 
-    error = set_flow_actions(flow, actions, actions_len);
+    error = set_flow_actions(dp, flow, actions, actions_len);
     if (error) {
+        free(flow->stats);
         free(flow);
         return error;
     }
 
+    pthread_rwlock_wrlock(&dp->rwlock);
     hmap_insert(&dp->flow_table, &flow->node, flow_hash(&flow->key, 0));
+    pthread_rwlock_unlock(&dp->rwlock);
     return 0;
 }
 
 static void
-clear_stats(struct dp_netdev_flow *flow)
+clear_stats(struct dp_netdev *dp, struct dp_netdev_flow *flow)
 {
-    flow->used = 0;
-    flow->packet_count = 0;
-    flow->byte_count = 0;
-    flow->tcp_ctl = 0;
+    pthread_rwlock_wrlock(&dp->rwlock);
+    memset(flow->stats, 0, (dp->n_threads + 1) * sizeof *flow->stats);
+    pthread_rwlock_unlock(&dp->rwlock);
 }
 
 static int
@@ -816,7 +1070,7 @@ dpif_netdev_flow_put(struct dpif *dpif, enum dpif_flow_put_flags flags,
                 if (stats) {
                     memset(stats, 0, sizeof *stats);
                 }
-                return add_flow(dpif, &key, actions, actions_len);
+                return add_flow(dp, &key, actions, actions_len);
             } else {
                 return EFBIG;
             }
@@ -825,13 +1079,13 @@ dpif_netdev_flow_put(struct dpif *dpif, enum dpif_flow_put_flags flags,
         }
     } else {
         if (flags & DPIF_FP_MODIFY) {
-            int error = set_flow_actions(flow, actions, actions_len);
+            int error = set_flow_actions(dp, flow, actions, actions_len);
             if (!error) {
                 if (stats) {
-                    get_dpif_flow_stats(flow, stats);
+                    get_dpif_flow_stats(dp, flow, stats);
                 }
                 if (flags & DPIF_FP_ZERO_STATS) {
-                    clear_stats(flow);
+                    clear_stats(dp, flow);
                 }
             }
             return error;
@@ -859,9 +1113,11 @@ dpif_netdev_flow_del(struct dpif *dpif,
     flow = dp_netdev_lookup_flow(dp, &key);
     if (flow) {
         if (stats) {
-            get_dpif_flow_stats(flow, stats);
+            get_dpif_flow_stats(dp, flow, stats);
         }
+        pthread_rwlock_wrlock(&dp->rwlock);
         dp_netdev_free_flow(dp, flow);
+        pthread_rwlock_unlock(&dp->rwlock);
         return 0;
     } else {
         return ENOENT;
@@ -925,7 +1181,7 @@ dpif_netdev_flow_dump_next(const struct dpif *dpif, void *state_,
     }
 
     if (stats) {
-        get_dpif_flow_stats(flow, &state->stats);
+        get_dpif_flow_stats(dp, flow, &state->stats);
         *stats = &state->stats;
     }
 
@@ -983,6 +1239,52 @@ dpif_netdev_execute(struct dpif *dpif,
     return error;
 }
 
+static void
+dpif_netdev_operate(struct dpif *dpif, union dpif_op **ops, size_t n_ops)
+{
+    struct dp_netdev *dp = get_dp_netdev(dpif);
+    size_t i;
+
+    if (!n_ops) {
+        return;
+    }
+
+    dp->n_ops += n_ops;
+    dp->n_op_batches++;
+    for (i = 0; i < n_ops; i++) {
+        union dpif_op *op = ops[i];
+        struct dpif_flow_put *put;
+        struct dpif_flow_del *del;
+        struct dpif_execute *execute;
+
+        switch (op->type) {
+        case DPIF_OP_FLOW_PUT:
+            put = &op->flow_put;
+            put->error = dpif_netdev_flow_put(dpif, put->flags,
+                                              put->key, put->key_len,
+                                              put->actions, put->actions_len,
+                                              put->stats);
+            break;
+
+        case DPIF_OP_FLOW_DEL:
+            del = &op->flow_del;
+            del->error = dpif_netdev_flow_del(dpif, del->key, del->key_len,
+                                              del->stats);
+            break;
+
+        case DPIF_OP_EXECUTE:
+            execute = &op->execute;
+            execute->error = dpif_netdev_execute(dpif, execute->actions,
+                                                 execute->actions_len,
+                                                 execute->packet);
+            break;
+
+        default:
+            NOT_REACHED();
+        }
+    }
+}
+
 static int
 dpif_netdev_recv_get_mask(const struct dpif *dpif, int *listen_mask)
 {
@@ -1019,27 +1321,39 @@ find_nonempty_queue(struct dpif *dpif)
 static int
 dpif_netdev_recv(struct dpif *dpif, struct dpif_upcall *upcall)
 {
-    struct dp_netdev_queue *q = find_nonempty_queue(dpif);
+    struct dp_netdev *dp = get_dp_netdev(dpif);
+    struct dp_netdev_queue *q;
+    int error;
+
+    pthread_mutex_lock(&dp->queue_mutex);
+    q = find_nonempty_queue(dpif);
     if (q) {
         struct dpif_upcall *u = q->upcalls[q->tail++ & QUEUE_MASK];
         *upcall = *u;
         free(u);
 
-        return 0;
+        error = 0;
     } else {
-        return EAGAIN;
+        error = EAGAIN;
     }
+    pthread_mutex_unlock(&dp->queue_mutex);
+
+    return error;
 }
 
 static void
 dpif_netdev_recv_wait(struct dpif *dpif)
 {
+    struct dp_netdev *dp = get_dp_netdev(dpif);
+
+    pthread_mutex_lock(&dp->queue_mutex);
     if (find_nonempty_queue(dpif)) {
         poll_immediate_wake();
     } else {
         /* No messages ready to be received, and dp_wait() will ensure that we
          * wake up to queue new messages, so there is nothing to do. */
     }
+    pthread_mutex_unlock(&dp->queue_mutex);
 }
 
 static void
@@ -1051,73 +1365,189 @@ dpif_netdev_recv_purge(struct dpif *dpif)
 
 static void
 dp_netdev_flow_used(struct dp_netdev_flow *flow, struct flow *key,
-                    const struct ofpbuf *packet)
+                    const struct ofpbuf *packet, int thread_id,
+                    long long int now)
 {
-    flow->used = time_msec();
-    flow->packet_count++;
-    flow->byte_count += packet->size;
+    struct dp_netdev_flow_stats *stats = &flow->stats[thread_id];
+
+    stats->used = now;
+    stats->packet_count++;
+    stats->byte_count += packet->size;
     if (key->dl_type == htons(ETH_TYPE_IP) && key->nw_proto == IPPROTO_TCP) {
         struct tcp_header *th = packet->l4;
-        flow->tcp_ctl |= th->tcp_ctl;
+        stats->tcp_ctl |= th->tcp_ctl;
     }
 }
 
+/* A set of buffers for receiving a batch of packets with
+ * netdev_recv_batch(). */
+struct dp_netdev_rxbufs {
+    struct ofpbuf bufs[NETDEV_MAX_BATCH];
+    struct ofpbuf *ptrs[NETDEV_MAX_BATCH];
+    size_t size;                /* Allocated size of each buffer. */
+};
+
 static void
-dp_netdev_port_input(struct dp_netdev *dp, struct dp_netdev_port *port,
-                     struct ofpbuf *packet)
+dp_netdev_rxbufs_init(struct dp_netdev_rxbufs *rx)
 {
-    struct dp_netdev_flow *flow;
-    struct flow key;
+    int i;
 
-    if (packet->size < ETH_HEADER_LEN) {
-        return;
+    for (i = 0; i < NETDEV_MAX_BATCH; i++) {
+        ofpbuf_init(&rx->bufs[i], 0);
+        rx->ptrs[i] = &rx->bufs[i];
     }
-    if (flow_extract(packet, 0, port->port_no, &key) && dp->drop_frags) {
-        dp->n_frags++;
-        return;
+    rx->size = 0;
+}
+
+static void
+dp_netdev_rxbufs_uninit(struct dp_netdev_rxbufs *rx)
+{
+    int i;
+
+    for (i = 0; i < NETDEV_MAX_BATCH; i++) {
+        ofpbuf_uninit(&rx->bufs[i]);
     }
+}
 
-    flow = dp_netdev_lookup_flow(dp, &key);
-    if (flow) {
-        dp_netdev_flow_used(flow, &key, packet);
-        dp_netdev_execute_actions(dp, packet, &key,
-                                  flow->actions, flow->actions_len);
-        dp->n_hit++;
-    } else {
-        dp->n_missed++;
-        dp_netdev_output_control(dp, packet, DPIF_UC_MISS, &key, 0);
+/* Makes each of the buffers in 'rx' empty and big enough to receive a
+ * packet on any port.  Also restores any pointers that the last call to
+ * netdev_recv_batch() replaced by pointers to buffers owned by the netdev. */
+static void
+dp_netdev_rxbufs_reset(struct dp_netdev_rxbufs *rx)
+{
+    size_t size = DP_NETDEV_HEADROOM + VLAN_ETH_HEADER_LEN + max_mtu;
+    int i;
+
+    for (i = 0; i < NETDEV_MAX_BATCH; i++) {
+        struct ofpbuf *b = &rx->bufs[i];
+
+        if (size != rx->size) {
+            ofpbuf_uninit(b);
+            ofpbuf_init(b, size);
+        } else {
+            ofpbuf_clear(b);
+        }
+        ofpbuf_reserve(b, DP_NETDEV_HEADROOM);
+        rx->ptrs[i] = b;
+    }
+    rx->size = size;
+}
+
+/* Processes the 'n' packets in 'packets', received on 'port', within 'dp'.
+ * 'thread_id' is 0 if called from the main thread, otherwise the id of the
+ * forwarding thread.
+ *
+ * All of the packets are parsed and looked up before any of them is
+ * forwarded, which keeps each of those loops tight. */
+static void
+dp_netdev_port_input(struct dp_netdev *dp, struct dp_netdev_port *port,
+                     struct ofpbuf **packets, int n, int thread_id)
+{
+    struct dp_netdev_perthread *perthread = &dp->perthread[thread_id];
+    struct dp_netdev_stats *stats = &perthread->stats;
+    struct dp_netdev_flow *flows[NETDEV_MAX_BATCH];
+    struct flow keys[NETDEV_MAX_BATCH];
+    bool drop[NETDEV_MAX_BATCH];
+    long long int now;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        struct ofpbuf *packet = packets[i];
+        struct flow *key = &keys[i];
+        struct dp_netdev_flow *flow;
+        uint32_t sig;
+
+        drop[i] = false;
+        if (packet->size < ETH_HEADER_LEN) {
+            drop[i] = true;
+            continue;
+        }
+        if (flow_extract(packet, 0, port->port_no, key) && dp->drop_frags) {
+            stats->n_frags++;
+            drop[i] = true;
+            continue;
+        }
+
+        sig = dp_netdev_emc_sig(key);
+        flow = dp_netdev_emc_lookup(perthread->emc, key, sig);
+        if (flow) {
+            stats->n_emc_hit++;
+        } else {
+            stats->n_emc_miss++;
+            flow = dp_netdev_lookup_flow(dp, key);
+            if (flow) {
+                dp_netdev_emc_insert(perthread->emc, flow, sig);
+            }
+        }
+        flows[i] = flow;
+    }
+
+    now = time_msec();
+    for (i = 0; i < n; i++) {
+        struct ofpbuf *packet = packets[i];
+        struct dp_netdev_flow *flow = flows[i];
+
+        if (drop[i]) {
+            continue;
+        } else if (flow) {
+            dp_netdev_flow_used(flow, &keys[i], packet, thread_id, now);
+            dp_netdev_execute_actions(dp, packet, &keys[i],
+                                      flow->actions, flow->actions_len);
+            stats->n_hit++;
+        } else {
+            stats->n_missed++;
+            dp_netdev_output_control(dp, packet, DPIF_UC_MISS, &keys[i], 0);
+        }
+    }
+}
+
+/* Receives and processes a batch of packets from 'port' in 'dp', using the
+ * buffers in 'rx'.  Returns the number of packets received. */
+static int
+dp_netdev_port_run(struct dp_netdev *dp, struct dp_netdev_port *port,
+                   struct dp_netdev_rxbufs *rx, int thread_id)
+{
+    int error;
+    int n;
+
+    dp_netdev_rxbufs_reset(rx);
+    error = netdev_recv_batch(port->netdev, rx->ptrs, NETDEV_MAX_BATCH, &n);
+    if (!error) {
+        dp_netdev_port_input(dp, port, rx->ptrs, n, thread_id);
+    } else if (error != EAGAIN && error != EOPNOTSUPP) {
+        static struct vlog_rate_limit rl = VLOG_RATE_LIMIT_INIT(1, 5);
+        VLOG_ERR_RL(&rl, "error receiving data from %s: %s",
+                    netdev_get_name(port->netdev), strerror(error));
     }
+    return n;
 }
 
 static void
 dp_netdev_run(void)
 {
+    static struct dp_netdev_rxbufs *rx;
     struct shash_node *node;
-    struct ofpbuf packet;
 
-    ofpbuf_init(&packet, DP_NETDEV_HEADROOM + VLAN_ETH_HEADER_LEN + max_mtu);
+    if (!rx) {
+        rx = xmalloc(sizeof *rx);
+        dp_netdev_rxbufs_init(rx);
+    }
+
     SHASH_FOR_EACH (node, &dp_netdevs) {
         struct dp_netdev *dp = node->data;
         struct dp_netdev_port *port;
 
-        LIST_FOR_EACH (port, node, &dp->port_list) {
-            int error;
-
-            /* Reset packet contents. */
-            ofpbuf_clear(&packet);
-            ofpbuf_reserve(&packet, DP_NETDEV_HEADROOM);
+        if (dp->n_threads) {
+            /* The forwarding threads own the ports. */
+            char buf[_POSIX_PIPE_BUF];
+            ignore(read(dp->wakeup_fds[0], buf, sizeof buf));
+            continue;
+        }
 
-            error = netdev_recv(port->netdev, &packet);
-            if (!error) {
-                dp_netdev_port_input(dp, port, &packet);
-            } else if (error != EAGAIN && error != EOPNOTSUPP) {
-                static struct vlog_rate_limit rl = VLOG_RATE_LIMIT_INIT(1, 5);
-                VLOG_ERR_RL(&rl, "error receiving data from %s: %s",
-                            netdev_get_name(port->netdev), strerror(error));
-            }
+        LIST_FOR_EACH (port, node, &dp->port_list) {
+            dp_netdev_port_run(dp, port, rx, 0);
         }
     }
-    ofpbuf_uninit(&packet);
 }
 
 static void
@@ -1129,12 +1559,328 @@ dp_netdev_wait(void)
         struct dp_netdev *dp = node->data;
         struct dp_netdev_port *port;
 
+        if (dp->n_threads) {
+            poll_fd_wait(dp->wakeup_fds[0], POLLIN);
+            continue;
+        }
+
         LIST_FOR_EACH (port, node, &dp->port_list) {
             netdev_recv_wait(port->netdev);
         }
     }
 }
 
+static void *
+dp_netdev_thread_main(void *thread_)
+{
+    struct dp_netdev_thread *thread = thread_;
+    struct dp_netdev *dp = thread->dp;
+    struct dp_netdev_rxbufs rx;
+    long long int next_flush;
+
+    coverage_thread_start();
+    dp_netdev_rxbufs_init(&rx);
+    next_flush = time_msec() + COVERAGE_FLUSH_INTERVAL;
+    for (;;) {
+        struct dp_netdev_port *port;
+        long long int now;
+        int n = 0;
+
+        pthread_rwlock_rdlock(&dp->rwlock);
+        if (dp->stop_threads) {
+            pthread_rwlock_unlock(&dp->rwlock);
+            break;
+        }
+
+        LIST_FOR_EACH (port, node, &dp->port_list) {
+            if (port->port_no % dp->n_threads == thread->id - 1) {
+                n += dp_netdev_port_run(dp, port, &rx, thread->id);
+            }
+        }
+        pthread_rwlock_unlock(&dp->rwlock);
+
+        now = time_msec();
+        if (now >= next_flush) {
+            coverage_thread_flush();
+            next_flush = now + COVERAGE_FLUSH_INTERVAL;
+        }
+
+        if (!n) {
+            /* Nothing to do.  netdevs do not provide a file descriptor that
+             * we could wait on outside the poll loop, so back off briefly
+             * before polling again. */
+            poll(NULL, 0, 1);
+        }
+    }
+    dp_netdev_rxbufs_uninit(&rx);
+    coverage_thread_exit();
+
+    return NULL;
+}
+
+/* Stops all of 'dp''s forwarding threads, if any, and returns packet
+ * processing to the main thread. */
+static void
+dp_netdev_stop_threads(struct dp_netdev *dp)
+{
+    int i;
+
+    if (!dp->n_threads) {
+        return;
+    }
+
+    pthread_rwlock_wrlock(&dp->rwlock);
+    dp->stop_threads = true;
+    pthread_rwlock_unlock(&dp->rwlock);
+
+    for (i = 0; i < dp->n_threads; i++) {
+        pthread_join(dp->threads[i].thread, NULL);
+    }
+    free(dp->threads);
+    dp->threads = NULL;
+    dp->stop_threads = false;
+}
+
+/* Sets the number of per-thread slots in 'dp' and its flows to 'n_slots',
+ * folding the statistics in any slots that go away into slot 0.  Must be
+ * called only when no forwarding threads are running. */
+static void
+dp_netdev_resize_stats(struct dp_netdev *dp, int n_slots)
+{
+    int old_n_slots = dp->n_threads + 1;
+    struct dp_netdev_perthread *perthread;
+    struct dp_netdev_flow *flow;
+    uint64_t n_lost;
+    int i;
+
+    /* Exact-match caches are not carried over. */
+    perthread = xzalloc_cacheline(n_slots * sizeof *perthread);
+    dp_netdev_get_stats(dp, &perthread[0].stats, &n_lost);
+    free(dp->perthread);
+    dp->perthread = perthread;
+
+    HMAP_FOR_EACH (flow, node, &dp->flow_table) {
+        struct dp_netdev_flow_stats *s0 = &flow->stats[0];
+
+        for (i = 1; i < old_n_slots; i++) {
+            const struct dp_netdev_flow_stats *s = &flow->stats[i];
+
+            s0->used = MAX(s0->used, s->used);
+            s0->packet_count += s->packet_count;
+            s0->byte_count += s->byte_count;
+            s0->tcp_ctl |= s->tcp_ctl;
+        }
+        flow->stats = xrealloc(flow->stats, n_slots * sizeof *flow->stats);
+        memset(&flow->stats[1], 0, (n_slots - 1) * sizeof *flow->stats);
+    }
+}
+
+/* Changes the number of threads that forward packets for 'dp' to 'n_threads'.
+ * If 'n_threads' is 0, packets are processed in the main thread, by
+ * dp_netdev_run().  Otherwise, each port is polled by one of the threads. */
+static int
+dp_netdev_set_threads(struct dp_netdev *dp, int n_threads)
+{
+    sigset_t sigs, oldsigs;
+    int error = 0;
+    int i;
+
+    if (n_threads < 0 || n_threads > MAX_THREADS) {
+        return EINVAL;
+    } else if (n_threads == dp->n_threads) {
+        return 0;
+    }
+
+    dp_netdev_stop_threads(dp);
+    dp_netdev_resize_stats(dp, n_threads + 1);
+    dp->n_threads = n_threads;
+    if (!n_threads) {
+        return 0;
+    }
+
+    /* Block all signals while creating the threads, so that they start out
+     * with every signal blocked and leave signal handling to the main
+     * thread. */
+    sigfillset(&sigs);
+    pthread_sigmask(SIG_BLOCK, &sigs, &oldsigs);
+
+    dp->threads = xmalloc(n_threads * sizeof *dp->threads);
+    for (i = 0; i < n_threads; i++) {
+        struct dp_netdev_thread *thread = &dp->threads[i];
+
+        thread->dp = dp;
+        thread->id = i + 1;
+        error = pthread_create(&thread->thread, NULL,
+                               dp_netdev_thread_main, thread);
+        if (error) {
+            break;
+        }
+    }
+
+    pthread_sigmask(SIG_SETMASK, &oldsigs, NULL);
+
+    if (error) {
+        VLOG_ERR("%s: failed to create forwarding thread (%s)",
+                 dp->name, strerror(error));
+
+        /* Stop the threads that did start, then fall back to forwarding in
+         * the main thread. */
+        dp->n_threads = i;
+        dp_netdev_stop_threads(dp);
+        dp_netdev_resize_stats(dp, 1);
+        dp->n_threads = 0;
+        return error;
+    }
+    VLOG_INFO("%s: forwarding with %d thread%s",
+              dp->name, n_threads, n_threads > 1 ? "s" : "");
+
+    return 0;
+}
+
+static void
+dp_netdev_unixctl_set_threads(struct unixctl_conn *conn, const char *args_,
+                              void *aux OVS_UNUSED)
+{
+    char *args = xstrdup(args_);
+    char *save_ptr = NULL;
+    const char *dp_name, *n_threads_s;
+    struct dp_netdev *dp;
+    int error;
+
+    dp_name = strtok_r(args, " ", &save_ptr);
+    n_threads_s = strtok_r(NULL, " ", &save_ptr);
+    if (!dp_name || !n_threads_s) {
+        unixctl_command_reply(conn, 501, "usage: dpif-netdev/set-threads DP "
+                              "N_THREADS");
+        goto exit;
+    }
+
+    dp = shash_find_data(&dp_netdevs, dp_name);
+    if (!dp) {
+        unixctl_command_reply(conn, 501, "no such datapath");
+        goto exit;
+    }
+
+    error = dp_netdev_set_threads(dp, atoi(n_threads_s));
+    if (error) {
+        unixctl_command_reply(conn, 501, strerror(error));
+    } else {
+        unixctl_command_reply(conn, 200, "");
+    }
+
+exit:
+    free(args);
+}
+
+static void
+dp_netdev_unixctl_show(struct unixctl_conn *conn, const char *args,
+                       void *aux OVS_UNUSED)
+{
+    struct dp_netdev_stats stats;
+    struct dp_netdev *dp;
+    uint64_t n_lost;
+    struct ds ds;
+
+    dp = shash_find_data(&dp_netdevs, args);
+    if (!dp) {
+        unixctl_command_reply(conn, 501, "no such datapath");
+        return;
+    }
+
+    dp_netdev_get_stats(dp, &stats, &n_lost);
+
+    ds_init(&ds);
+    ds_put_format(&ds, "%s:\n", dp->name);
+    ds_put_format(&ds, "\tforwarding threads: %d\n", dp->n_threads);
+    ds_put_format(&ds, "\tlookups: hit:%lld missed:%lld lost:%"PRIu64"\n",
+                  stats.n_hit, stats.n_missed, n_lost);
+    ds_put_format(&ds, "\texact-match cache: hit:%lld missed:%lld\n",
+                  stats.n_emc_hit, stats.n_emc_miss);
+    ds_put_format(&ds, "\tflows: %zu\n", hmap_count(&dp->flow_table));
+    ds_put_format(&ds, "\tbatched operations: %lld in %lld batches\n",
+                  dp->n_ops, dp->n_op_batches);
+    unixctl_command_reply(conn, 200, ds_cstr(&ds));
+    ds_destroy(&ds);
+}
+
+static void
+dp_netdev_unixctl_dump_flows(struct unixctl_conn *conn, const char *args,
+                             void *aux OVS_UNUSED)
+{
+    struct dp_netdev_flow *flow;
+    struct dp_netdev *dp;
+    struct ds ds;
+
+    dp = shash_find_data(&dp_netdevs, args);
+    if (!dp) {
+        unixctl_command_reply(conn, 501, "no such datapath");
+        return;
+    }
+
+    ds_init(&ds);
+    HMAP_FOR_EACH (flow, node, &dp->flow_table) {
+        flow_format(&ds, &flow->key);
+        ds_put_char(&ds, '\n');
+    }
+    unixctl_command_reply(conn, 200, ds_cstr(&ds));
+    ds_destroy(&ds);
+}
+
+/* Adds a flow with no actions to a datapath, behind the back of whatever
+ * client has the datapath open.  For testing how clients cope with datapath
+ * flows that they did not install. */
+static void
+dp_netdev_unixctl_add_flow(struct unixctl_conn *conn, const char *args_,
+                           void *aux OVS_UNUSED)
+{
+    char *args = xstrdup(args_);
+    char *save_ptr = NULL;
+    const char *dp_name, *in_port_s, *hex;
+    struct ofpbuf packet;
+    struct dp_netdev *dp;
+    struct flow key;
+    int error;
+
+    ofpbuf_init(&packet, 0);
+    dp_name = strtok_r(args, " ", &save_ptr);
+    in_port_s = strtok_r(NULL, " ", &save_ptr);
+    hex = strtok_r(NULL, " ", &save_ptr);
+    if (!dp_name || !in_port_s || !hex) {
+        unixctl_command_reply(conn, 501, "usage: dpif-netdev/add-flow DP "
+                              "IN_PORT PACKET");
+        goto exit;
+    }
+
+    dp = shash_find_data(&dp_netdevs, dp_name);
+    if (!dp) {
+        unixctl_command_reply(conn, 501, "no such datapath");
+        goto exit;
+    }
+
+    if (ofpbuf_put_hex(&packet, hex, NULL)[0] != '\0'
+        || packet.size < ETH_HEADER_LEN) {
+        unixctl_command_reply(conn, 501, "bad packet syntax");
+        goto exit;
+    }
+    flow_extract(&packet, 0, atoi(in_port_s), &key);
+
+    if (dp_netdev_lookup_flow(dp, &key)) {
+        error = EEXIST;
+    } else if (hmap_count(&dp->flow_table) >= MAX_FLOWS) {
+        error = EFBIG;
+    } else {
+        error = add_flow(dp, &key, NULL, 0);
+    }
+    if (error) {
+        unixctl_command_reply(conn, 501, strerror(error));
+    } else {
+        unixctl_command_reply(conn, 200, "");
+    }
+
+exit:
+    ofpbuf_uninit(&packet);
+    free(args);
+}
 
 /* Modify the TCI field of 'packet'.  If a VLAN tag is present, its TCI field
  * is replaced by 'tci'.  If a VLAN tag is not present, one is added with the
@@ -1295,11 +2041,6 @@ dp_netdev_output_control(struct dp_netdev *dp, const struct ofpbuf *packet,
     struct ofpbuf *buf;
     size_t key_len;
 
-    if (q->head - q->tail >= MAX_QUEUE_LEN) {
-        dp->n_lost++;
-        return ENOBUFS;
-    }
-
     buf = ofpbuf_new(ODPUTIL_FLOW_KEY_BYTES + 2 + packet->size);
     odp_flow_key_from_flow(buf, flow);
     key_len = buf->size;
@@ -1314,7 +2055,20 @@ dp_netdev_output_control(struct dp_netdev *dp, const struct ofpbuf *packet,
     upcall->key_len = key_len;
     upcall->userdata = arg;
 
+    pthread_mutex_lock(&dp->queue_mutex);
+    if (q->head - q->tail >= MAX_QUEUE_LEN) {
+        dp->n_lost++;
+        pthread_mutex_unlock(&dp->queue_mutex);
+        ofpbuf_delete(buf);
+        free(upcall);
+        return ENOBUFS;
+    }
     q->upcalls[q->head++ & QUEUE_MASK] = upcall;
+    pthread_mutex_unlock(&dp->queue_mutex);
+
+    if (dp->n_threads) {
+        ignore(write(dp->wakeup_fds[1], "", 1));
+    }
 
     return 0;
 }
@@ -1435,6 +2189,7 @@ const struct dpif_class dpif_netdev_class = {
     dpif_netdev_flow_dump_next,
     dpif_netdev_flow_dump_done,
     dpif_netdev_execute,
+    dpif_netdev_operate,
     dpif_netdev_recv_get_mask,
     dpif_netdev_recv_set_mask,
     NULL,                       /* get_sflow_probability */
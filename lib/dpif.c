@@ -54,6 +54,7 @@ COVERAGE_DEFINE(dpif_flow_del);
 COVERAGE_DEFINE(dpif_flow_query_list);
 COVERAGE_DEFINE(dpif_flow_query_list_n);
 COVERAGE_DEFINE(dpif_execute);
+COVERAGE_DEFINE(dpif_operate);
 COVERAGE_DEFINE(dpif_purge);
 
 static const struct dpif_class *base_dpif_classes[] = {
@@ -85,6 +86,16 @@ static void log_flow_message(const struct dpif *dpif, int error,
 static void log_operation(const struct dpif *, const char *operation,
                           int error);
 static bool should_log_flow_message(int error);
+static void log_flow_put(struct dpif *, enum dpif_flow_put_flags,
+                         const struct nlattr *key, size_t key_len,
+                         const struct nlattr *actions, size_t actions_len,
+                         const struct dpif_flow_stats *, int error);
+static void log_flow_del(struct dpif *, const struct nlattr *key,
+                         size_t key_len, const struct dpif_flow_stats *,
+                         int error);
+static void log_execute(struct dpif *,
+                        const struct nlattr *actions, size_t actions_len,
+                        const struct ofpbuf *, int error);
 
 static void
 dp_initialize(void)
@@ -774,24 +785,8 @@ dpif_flow_put(struct dpif *dpif, enum dpif_flow_put_flags flags,
     if (error && stats) {
         memset(stats, 0, sizeof *stats);
     }
-    if (should_log_flow_message(error)) {
-        struct ds s;
-
-        ds_init(&s);
-        ds_put_cstr(&s, "put");
-        if (flags & DPIF_FP_CREATE) {
-            ds_put_cstr(&s, "[create]");
-        }
-        if (flags & DPIF_FP_MODIFY) {
-            ds_put_cstr(&s, "[modify]");
-        }
-        if (flags & DPIF_FP_ZERO_STATS) {
-            ds_put_cstr(&s, "[zero]");
-        }
-        log_flow_message(dpif, error, ds_cstr(&s), key, key_len, stats,
-                         actions, actions_len);
-        ds_destroy(&s);
-    }
+    log_flow_put(dpif, flags, key, key_len, actions, actions_len,
+                 stats, error);
     return error;
 }
 
@@ -814,10 +809,7 @@ dpif_flow_del(struct dpif *dpif,
     if (error && stats) {
         memset(stats, 0, sizeof *stats);
     }
-    if (should_log_flow_message(error)) {
-        log_flow_message(dpif, error, "flow_del", key, key_len,
-                         !error ? stats : NULL, NULL, 0);
-    }
+    log_flow_del(dpif, key, key_len, stats, error);
     return error;
 }
 
@@ -930,20 +922,99 @@ dpif_execute(struct dpif *dpif,
         error = 0;
     }
 
-    if (!(error ? VLOG_DROP_WARN(&error_rl) : VLOG_DROP_DBG(&dpmsg_rl))) {
-        struct ds ds = DS_EMPTY_INITIALIZER;
-        char *packet = ofp_packet_to_string(buf->data, buf->size, buf->size);
-        ds_put_format(&ds, "%s: execute ", dpif_name(dpif));
-        format_odp_actions(&ds, actions, actions_len);
-        if (error) {
-            ds_put_format(&ds, " failed (%s)", strerror(error));
+    log_execute(dpif, actions, actions_len, buf, error);
+    return error;
+}
+
+/* Executes each of the 'n_ops' operations in 'ops' on 'dpif', in the order in
+ * which they are specified, placing each operation's results in the "output"
+ * members documented in comments.
+ *
+ * This function exists because some datapaths can perform batched operations
+ * faster than individual operations. */
+void
+dpif_operate(struct dpif *dpif, union dpif_op **ops, size_t n_ops)
+{
+    size_t i;
+
+    COVERAGE_INC(dpif_operate);
+    if (dpif->dpif_class->operate) {
+        dpif->dpif_class->operate(dpif, ops, n_ops);
+
+        for (i = 0; i < n_ops; i++) {
+            union dpif_op *op = ops[i];
+            struct dpif_flow_put *put;
+            struct dpif_flow_del *del;
+            struct dpif_execute *execute;
+
+            switch (op->type) {
+            case DPIF_OP_FLOW_PUT:
+                put = &op->flow_put;
+                COVERAGE_INC(dpif_flow_put);
+                if (put->error && put->stats) {
+                    memset(put->stats, 0, sizeof *put->stats);
+                }
+                log_flow_put(dpif, put->flags, put->key, put->key_len,
+                             put->actions, put->actions_len, put->stats,
+                             put->error);
+                break;
+
+            case DPIF_OP_FLOW_DEL:
+                del = &op->flow_del;
+                COVERAGE_INC(dpif_flow_del);
+                if (del->error && del->stats) {
+                    memset(del->stats, 0, sizeof *del->stats);
+                }
+                log_flow_del(dpif, del->key, del->key_len, del->stats,
+                             del->error);
+                break;
+
+            case DPIF_OP_EXECUTE:
+                execute = &op->execute;
+                COVERAGE_INC(dpif_execute);
+                log_execute(dpif, execute->actions, execute->actions_len,
+                            execute->packet, execute->error);
+                break;
+
+            default:
+                NOT_REACHED();
+            }
+        }
+        return;
+    }
+
+    for (i = 0; i < n_ops; i++) {
+        union dpif_op *op = ops[i];
+        struct dpif_flow_put *put;
+        struct dpif_flow_del *del;
+        struct dpif_execute *execute;
+
+        switch (op->type) {
+        case DPIF_OP_FLOW_PUT:
+            put = &op->flow_put;
+            put->error = dpif_flow_put(dpif, put->flags,
+                                       put->key, put->key_len,
+                                       put->actions, put->actions_len,
+                                       put->stats);
+            break;
+
+        case DPIF_OP_FLOW_DEL:
+            del = &op->flow_del;
+            del->error = dpif_flow_del(dpif, del->key, del->key_len,
+                                       del->stats);
+            break;
+
+        case DPIF_OP_EXECUTE:
+            execute = &op->execute;
+            execute->error = dpif_execute(dpif, execute->actions,
+                                          execute->actions_len,
+                                          execute->packet);
+            break;
+
+        default:
+            NOT_REACHED();
         }
-        ds_put_format(&ds, " on packet %s", packet);
-        vlog(THIS_MODULE, error ? VLL_WARN : VLL_DBG, "%s", ds_cstr(&ds));
-        ds_destroy(&ds);
-        free(packet);
     }
-    return error;
 }
 
 static bool OVS_UNUSED
@@ -1192,3 +1263,59 @@ log_flow_message(const struct dpif *dpif, int error, const char *operation,
     vlog(THIS_MODULE, flow_message_log_level(error), "%s", ds_cstr(&ds));
     ds_destroy(&ds);
 }
+
+static void
+log_flow_put(struct dpif *dpif, enum dpif_flow_put_flags flags,
+             const struct nlattr *key, size_t key_len,
+             const struct nlattr *actions, size_t actions_len,
+             const struct dpif_flow_stats *stats, int error)
+{
+    if (should_log_flow_message(error)) {
+        struct ds s;
+
+        ds_init(&s);
+        ds_put_cstr(&s, "put");
+        if (flags & DPIF_FP_CREATE) {
+            ds_put_cstr(&s, "[create]");
+        }
+        if (flags & DPIF_FP_MODIFY) {
+            ds_put_cstr(&s, "[modify]");
+        }
+        if (flags & DPIF_FP_ZERO_STATS) {
+            ds_put_cstr(&s, "[zero]");
+        }
+        log_flow_message(dpif, error, ds_cstr(&s), key, key_len, stats,
+                         actions, actions_len);
+        ds_destroy(&s);
+    }
+}
+
+static void
+log_flow_del(struct dpif *dpif, const struct nlattr *key, size_t key_len,
+             const struct dpif_flow_stats *stats, int error)
+{
+    if (should_log_flow_message(error)) {
+        log_flow_message(dpif, error, "flow_del", key, key_len,
+                         !error ? stats : NULL, NULL, 0);
+    }
+}
+
+static void
+log_execute(struct dpif *dpif,
+            const struct nlattr *actions, size_t actions_len,
+            const struct ofpbuf *buf, int error)
+{
+    if (!(error ? VLOG_DROP_WARN(&error_rl) : VLOG_DROP_DBG(&dpmsg_rl))) {
+        struct ds ds = DS_EMPTY_INITIALIZER;
+        char *packet = ofp_packet_to_string(buf->data, buf->size, buf->size);
+        ds_put_format(&ds, "%s: execute ", dpif_name(dpif));
+        format_odp_actions(&ds, actions, actions_len);
+        if (error) {
+            ds_put_format(&ds, " failed (%s)", strerror(error));
+        }
+        ds_put_format(&ds, " on packet %s", packet);
+        vlog(THIS_MODULE, error ? VLL_WARN : VLL_DBG, "%s", ds_cstr(&ds));
+        ds_destroy(&ds);
+        free(packet);
+    }
+}
@@ -22,10 +22,13 @@
  * testing.  A client program might call this function if it is designed
  * specifically for testing or the user enables it on the command line.
  *
+ * If 'override' is true, then "internal" network devices are dummy devices
+ * too, so that bridges on a dummy dpif can have internal ports.
+ *
  * There is no strong reason why dummy devices shouldn't always be enabled. */
 void
-dummy_enable(void)
+dummy_enable(bool override)
 {
-    netdev_dummy_register();
+    netdev_dummy_register(override);
     dpif_dummy_register();
 }
@@ -17,11 +17,13 @@
 #ifndef DUMMY_H
 #define DUMMY_H 1
 
+#include <stdbool.h>
+
 /* For client programs to call directly to enable dummy support. */
-void dummy_enable(void);
+void dummy_enable(bool override);
 
 /* Implementation details. */
 void dpif_dummy_register(void);
-void netdev_dummy_register(void);
+void netdev_dummy_register(bool override);
 
 #endif /* dummy.h */
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2011 Nicira Networks.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <config.h>
+#include "heap.h"
+#include <assert.h>
+#include <stdlib.h>
+#include "util.h"
+
+static void put_node(struct heap *, struct heap_node *, size_t i);
+static void float_up(struct heap *, size_t i);
+static void float_down(struct heap *, size_t i);
+
+/* Initializes 'heap' as an empty heap. */
+void
+heap_init(struct heap *heap)
+{
+    heap->array = NULL;
+    heap->n = 0;
+    heap->allocated = 0;
+}
+
+/* Frees memory owned internally by 'heap'.  The caller is responsible for
+ * freeing 'heap' itself, if necessary, and the nodes that it contained. */
+void
+heap_destroy(struct heap *heap)
+{
+    if (heap) {
+        free(heap->array);
+    }
+}
+
+/* Removes all of the nodes from 'heap', without freeing them. */
+void
+heap_clear(struct heap *heap)
+{
+    heap->n = 0;
+}
+
+/* Inserts 'node' into 'heap' with the specified 'priority'. */
+void
+heap_insert(struct heap *heap, struct heap_node *node, long long int priority)
+{
+    if (heap->n >= heap->allocated) {
+        heap->allocated = heap->n == 0 ? 1 : 2 * heap->n;
+        heap->array = xrealloc(heap->array,
+                               (heap->allocated + 1) * sizeof *heap->array);
+    }
+
+    heap->n++;
+    node->priority = priority;
+    put_node(heap, node, heap->n);
+    float_up(heap, heap->n);
+}
+
+/* Removes 'node' from 'heap'. */
+void
+heap_remove(struct heap *heap, struct heap_node *node)
+{
+    size_t i = node->idx;
+
+    assert(i >= 1 && i <= heap->n && heap->array[i] == node);
+    if (i < heap->n) {
+        /* Move the last node into the hole and restore heap order. */
+        struct heap_node *moved = heap->array[heap->n];
+
+        put_node(heap, moved, i);
+        heap->n--;
+        float_up(heap, i);
+        float_down(heap, moved->idx);
+    } else {
+        heap->n--;
+    }
+}
+
+/* Changes the priority of 'node' (which must be in 'heap') to 'priority'. */
+void
+heap_change(struct heap *heap, struct heap_node *node, long long int priority)
+{
+    long long int old_priority = node->priority;
+
+    assert(node->idx >= 1 && node->idx <= heap->n);
+    node->priority = priority;
+    if (priority < old_priority) {
+        float_up(heap, node->idx);
+    } else if (priority > old_priority) {
+        float_down(heap, node->idx);
+    }
+}
+
+/* Removes and returns the node in 'heap' with the smallest priority, or
+ * returns a null pointer if 'heap' is empty. */
+struct heap_node *
+heap_pop(struct heap *heap)
+{
+    struct heap_node *min = heap_min(heap);
+    if (min) {
+        heap_remove(heap, min);
+    }
+    return min;
+}
+
+static void
+put_node(struct heap *heap, struct heap_node *node, size_t i)
+{
+    heap->array[i] = node;
+    node->idx = i;
+}
+
+static void
+float_up(struct heap *heap, size_t i)
+{
+    struct heap_node *node = heap->array[i];
+
+    while (i > 1 && heap->array[i / 2]->priority > node->priority) {
+        put_node(heap, heap->array[i / 2], i);
+        i /= 2;
+    }
+    put_node(heap, node, i);
+}
+
+static void
+float_down(struct heap *heap, size_t i)
+{
+    struct heap_node *node = heap->array[i];
+
+    for (;;) {
+        size_t child = 2 * i;
+
+        if (child > heap->n) {
+            break;
+        }
+        if (child < heap->n
+            && heap->array[child + 1]->priority < heap->array[child]->priority) {
+            child++;
+        }
+        if (heap->array[child]->priority >= node->priority) {
+            break;
+        }
+        put_node(heap, heap->array[child], i);
+        i = child;
+    }
+    put_node(heap, node, i);
+}
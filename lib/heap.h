@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2011 Nicira Networks.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HEAP_H
+#define HEAP_H 1
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* A heap node, to be embedded inside the data structure in the heap. */
+struct heap_node {
+    size_t idx;                 /* Position in heap's 'array', 1-based. */
+    long long int priority;     /* Smaller values are closer to the top. */
+};
+
+/* A min-heap: an array-based binary heap whose top node, the one that
+ * heap_min() returns, has the smallest priority.  Inserting, removing, or
+ * changing the priority of any node takes O(log n) time. */
+struct heap {
+    struct heap_node **array;   /* Data in elements 1...n, element 0 unused. */
+    size_t n;                   /* Number of nodes currently in the heap. */
+    size_t allocated;           /* Max 'n' before 'array' must be enlarged. */
+};
+
+void heap_init(struct heap *);
+void heap_destroy(struct heap *);
+void heap_clear(struct heap *);
+
+static inline size_t heap_count(const struct heap *);
+static inline bool heap_is_empty(const struct heap *);
+static inline struct heap_node *heap_min(const struct heap *);
+
+void heap_insert(struct heap *, struct heap_node *, long long int priority);
+void heap_remove(struct heap *, struct heap_node *);
+void heap_change(struct heap *, struct heap_node *, long long int priority);
+struct heap_node *heap_pop(struct heap *);
+
+/* Returns the number of nodes in 'heap'. */
+static inline size_t
+heap_count(const struct heap *heap)
+{
+    return heap->n;
+}
+
+/* Returns true if 'heap' contains no nodes, false if it contains at least
+ * one. */
+static inline bool
+heap_is_empty(const struct heap *heap)
+{
+    return heap->n == 0;
+}
+
+/* Returns the node in 'heap' with the smallest priority, or a null pointer if
+ * 'heap' is empty.  Ties are broken arbitrarily. */
+static inline struct heap_node *
+heap_min(const struct heap *heap)
+{
+    return heap->n ? heap->array[1] : NULL;
+}
+
+#endif /* heap.h */
@@ -26,6 +26,10 @@
 #include <math.h>
 #include <string.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "dynamic-string.h"
 #include "hash.h"
 #include "shash.h"
@@ -95,6 +99,7 @@ struct json_parser_node {
 /* A JSON parser. */
 struct json_parser {
     int flags;
+    struct json_arena *arena;   /* Allocate tree from here, if nonnull. */
 
     /* Lexical analysis. */
     enum json_lex_state lex_state;
@@ -579,6 +584,241 @@ json_equal(const struct json *a, const struct json *b)
     }
 }
 
+/* Arena allocation. */
+
+/* Alignment of every allocation from an arena. */
+#define JSON_ARENA_ALIGN 8
+
+/* Size of an ordinary arena block.  Requests larger than a quarter of this get
+ * a block of their own. */
+#define JSON_ARENA_BLOCK_SIZE 65536
+
+/* A block of memory, followed by the memory carved out of it. */
+struct json_arena_block {
+    struct json_arena_block *next;
+};
+
+#define JSON_ARENA_BLOCK_HEADER \
+    ROUND_UP(sizeof(struct json_arena_block), JSON_ARENA_ALIGN)
+
+struct json_arena {
+    struct json_arena_block *blocks; /* Block being carved up, then others. */
+    char *next;                 /* Next free byte in the first block. */
+    size_t left;                /* Number of free bytes at 'next'. */
+
+    /* Objects allocated from the arena.  An object's hash table allocates
+     * its own buckets with malloc(), so these must be freed separately. */
+    struct shash **objects;
+    size_t n_objects, allocated_objects;
+};
+
+/* Creates and returns a new, empty arena. */
+struct json_arena *
+json_arena_create(void)
+{
+    return xzalloc(sizeof(struct json_arena));
+}
+
+/* Frees every tree parsed into 'arena', leaving it empty. */
+void
+json_arena_clear(struct json_arena *arena)
+{
+    struct json_arena_block *block, *next;
+    size_t i;
+
+    for (i = 0; i < arena->n_objects; i++) {
+        hmap_destroy(&arena->objects[i]->map);
+    }
+    arena->n_objects = 0;
+
+    for (block = arena->blocks; block; block = next) {
+        next = block->next;
+        free(block);
+    }
+    arena->blocks = NULL;
+    arena->next = NULL;
+    arena->left = 0;
+}
+
+/* Frees 'arena' and every tree parsed into it. */
+void
+json_arena_destroy(struct json_arena *arena)
+{
+    if (arena) {
+        json_arena_clear(arena);
+        free(arena->objects);
+        free(arena);
+    }
+}
+
+static void *
+json_arena_alloc(struct json_arena *arena, size_t size)
+{
+    struct json_arena_block *block;
+    void *p;
+
+    size = ROUND_UP(size, JSON_ARENA_ALIGN);
+    if (size <= arena->left) {
+        p = arena->next;
+        arena->next += size;
+        arena->left -= size;
+        return p;
+    }
+
+    if (size > JSON_ARENA_BLOCK_SIZE / 4) {
+        /* Put a large request in a block of its own, behind the block being
+         * carved up so that the latter's free space is not wasted. */
+        block = xmalloc(JSON_ARENA_BLOCK_HEADER + size);
+        if (arena->blocks) {
+            block->next = arena->blocks->next;
+            arena->blocks->next = block;
+        } else {
+            block->next = NULL;
+            arena->blocks = block;
+        }
+        return (char *) block + JSON_ARENA_BLOCK_HEADER;
+    }
+
+    block = xmalloc(JSON_ARENA_BLOCK_SIZE);
+    block->next = arena->blocks;
+    arena->blocks = block;
+    p = (char *) block + JSON_ARENA_BLOCK_HEADER;
+    arena->next = (char *) p + size;
+    arena->left = JSON_ARENA_BLOCK_SIZE - JSON_ARENA_BLOCK_HEADER - size;
+    return p;
+}
+
+static char *
+json_arena_strdup(struct json_arena *arena, const char *s)
+{
+    size_t size = strlen(s) + 1;
+    return memcpy(json_arena_alloc(arena, size), s, size);
+}
+
+/* Creating parse trees.
+ *
+ * These functions create the values that make up a parse tree, either with
+ * the ordinary constructors or, if the parser has one, from its arena. */
+
+static struct json *
+json_parser_create_json(struct json_parser *p, enum json_type type)
+{
+    struct json *json;
+
+    if (!p->arena) {
+        return json_create(type);
+    }
+    json = json_arena_alloc(p->arena, sizeof *json);
+    json->type = type;
+    return json;
+}
+
+static struct json *
+json_parser_create_string(struct json_parser *p, const char *s)
+{
+    struct json *json;
+
+    if (!p->arena) {
+        return json_string_create(s);
+    }
+    json = json_parser_create_json(p, JSON_STRING);
+    json->u.string = json_arena_strdup(p->arena, s);
+    return json;
+}
+
+static struct json *
+json_parser_create_object(struct json_parser *p)
+{
+    struct json_arena *arena = p->arena;
+    struct json *json;
+
+    if (!arena) {
+        return json_object_create();
+    }
+    json = json_parser_create_json(p, JSON_OBJECT);
+    json->u.object = json_arena_alloc(arena, sizeof *json->u.object);
+    shash_init(json->u.object);
+    if (arena->n_objects >= arena->allocated_objects) {
+        arena->objects = x2nrealloc(arena->objects, &arena->allocated_objects,
+                                    sizeof *arena->objects);
+    }
+    arena->objects[arena->n_objects++] = json->u.object;
+    return json;
+}
+
+static struct json *
+json_parser_create_array(struct json_parser *p)
+{
+    struct json *json;
+
+    if (!p->arena) {
+        return json_array_create_empty();
+    }
+    json = json_parser_create_json(p, JSON_ARRAY);
+    json->u.array.elems = NULL;
+    json->u.array.n = 0;
+    json->u.array.n_allocated = 0;
+    return json;
+}
+
+/* Adds 'value' to 'object' under the name in 'p->member_name', which this
+ * function takes over.  As with json_object_put(), if 'object' already has a
+ * member with that name, then 'value' replaces its value. */
+static void
+json_parser_object_put(struct json_parser *p, struct json *object,
+                       struct json *value)
+{
+    struct shash *shash = object->u.object;
+    char *name = p->member_name;
+    struct shash_node *node;
+    size_t hash;
+
+    p->member_name = NULL;
+    hash = hash_string(name, 0);
+    HMAP_FOR_EACH_WITH_HASH (node, node, hash, &shash->map) {
+        if (!strcmp(node->name, name)) {
+            if (!p->arena) {
+                json_destroy(node->data);
+                free(name);
+            }
+            node->data = value;
+            return;
+        }
+    }
+
+    node = (p->arena
+            ? json_arena_alloc(p->arena, sizeof *node)
+            : xmalloc(sizeof *node));
+    node->name = name;
+    node->data = value;
+    hmap_insert(&shash->map, &node->node, hash);
+}
+
+static void
+json_parser_array_add(struct json_parser *p, struct json *array_,
+                      struct json *element)
+{
+    struct json_array *array = &array_->u.array;
+
+    if (!p->arena) {
+        json_array_add(array_, element);
+        return;
+    }
+
+    if (array->n >= array->n_allocated) {
+        /* Arena memory cannot be resized, so copy into a new, larger block.
+         * Doubling keeps the total wasted to less than the final size. */
+        size_t n_allocated = array->n_allocated ? array->n_allocated * 2 : 4;
+        struct json **elems;
+
+        elems = json_arena_alloc(p->arena, n_allocated * sizeof *elems);
+        memcpy(elems, array->elems, array->n * sizeof *elems);
+        array->elems = elems;
+        array->n_allocated = n_allocated;
+    }
+    array->elems[array->n++] = element;
+}
+
 /* Lexical analysis. */
 
 static void
@@ -1087,11 +1327,120 @@ json_parser_create(int flags)
     return p;
 }
 
+/* Creates and returns a parser that allocates the tree that it parses from
+ * 'arena'.  See the comment on json_arena_create() in json.h for details. */
+struct json_parser *
+json_parser_create_arena(int flags, struct json_arena *arena)
+{
+    struct json_parser *p = json_parser_create(flags);
+    p->arena = arena;
+    return p;
+}
+
+/* Returns the number of bytes at the beginning of the 'n' bytes in 's' that
+ * may appear literally within a quoted string, that is, bytes other than '"',
+ * '\\', and control characters. */
+static size_t
+json_lex_string_run(const char *s, size_t n)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1f);
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *) &s[i]);
+        __m128i special;
+        int mask;
+
+        /* A byte is <= 0x1f (unsigned) if and only if min(byte, 0x1f) is the
+         * byte itself. */
+        special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                         _mm_cmpeq_epi8(v, backslash)),
+            _mm_cmpeq_epi8(_mm_min_epu8(v, control), v));
+        mask = _mm_movemask_epi8(special);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    for (; i < n; i++) {
+        unsigned char c = s[i];
+        if (c == '"' || c == '\\' || c < 0x20) {
+            break;
+        }
+    }
+    return i;
+}
+
+/* Returns the number of bytes at the beginning of the 'n' bytes in 's' that
+ * continue a token in lexer state 'state', or 0 if 'state' is not one in
+ * which json_parser_feed() can consume input in bulk. */
+static size_t
+json_lex_run(enum json_lex_state state, const char *s, size_t n)
+{
+    size_t i;
+
+    switch (state) {
+    case JSON_LEX_STRING:
+        return json_lex_string_run(s, n);
+
+    case JSON_LEX_NUMBER:
+        for (i = 0; i < n; i++) {
+            unsigned char c = s[i];
+            if (!isdigit(c) && c != '.' && c != 'e' && c != 'E'
+                && c != '-' && c != '+') {
+                break;
+            }
+        }
+        return i;
+
+    case JSON_LEX_KEYWORD:
+        for (i = 0; i < n && isalpha((unsigned char) s[i]); i++) {
+            continue;
+        }
+        return i;
+
+    case JSON_LEX_START:
+    case JSON_LEX_ESCAPE:
+    default:
+        return 0;
+    }
+}
+
 size_t
 json_parser_feed(struct json_parser *p, const char *input, size_t n)
 {
     size_t i;
     for (i = 0; !p->done && i < n; ) {
+        size_t run;
+
+        if (p->lex_state == JSON_LEX_START) {
+            /* Skip white space other than new-lines, which must be counted. */
+            while (input[i] == ' ' || input[i] == '\t' || input[i] == '\r') {
+                p->byte_number++;
+                p->column_number++;
+                if (++i >= n) {
+                    return i;
+                }
+            }
+        } else {
+            /* Consume the bytes that just extend the token in bulk.  None of
+             * them is a new-line. */
+            run = json_lex_run(p->lex_state, &input[i], n - i);
+            if (run) {
+                ds_put_buffer(&p->buffer, &input[i], run);
+                p->byte_number += run;
+                p->column_number += run;
+                i += run;
+                continue;
+            }
+        }
+
         if (json_lex_input(p, input[i])) {
             i++;
         }
@@ -1135,6 +1484,8 @@ json_parser_finish(struct json_parser *p)
         assert(p->height == 1);
         assert(p->stack[0].json != NULL);
         json = p->stack[--p->height].json;
+    } else if (p->arena) {
+        json = json_parser_create_string(p, p->error);
     } else {
         json = json_string_create_nocopy(p->error);
         p->error = NULL;
@@ -1150,11 +1501,13 @@ json_parser_abort(struct json_parser *p)
 {
     if (p) {
         ds_destroy(&p->buffer);
-        if (p->height) {
-            json_destroy(p->stack[0].json);
+        if (!p->arena) {
+            if (p->height) {
+                json_destroy(p->stack[0].json);
+            }
+            free(p->member_name);
         }
         free(p->stack);
-        free(p->member_name);
         free(p->error);
         free(p);
     }
@@ -1171,11 +1524,9 @@ json_parser_put_value(struct json_parser *p, struct json *value)
 {
     struct json_parser_node *node = json_parser_top(p);
     if (node->json->type == JSON_OBJECT) {
-        json_object_put(node->json, p->member_name, value);
-        free(p->member_name);
-        p->member_name = NULL;
+        json_parser_object_put(p, node->json, value);
     } else if (node->json->type == JSON_ARRAY) {
-        json_array_add(node->json, value);
+        json_parser_array_add(p, node->json, value);
     } else {
         NOT_REACHED();
     }
@@ -1201,7 +1552,9 @@ json_parser_push(struct json_parser *p,
         node->json = new_json;
         p->parse_state = new_state;
     } else {
-        json_destroy(new_json);
+        if (!p->arena) {
+            json_destroy(new_json);
+        }
         json_error(p, "input exceeds maximum nesting depth %d",
                    JSON_MAX_HEIGHT);
     }
@@ -1210,13 +1563,14 @@ json_parser_push(struct json_parser *p,
 static void
 json_parser_push_object(struct json_parser *p)
 {
-    json_parser_push(p, json_object_create(), JSON_PARSE_OBJECT_INIT);
+    json_parser_push(p, json_parser_create_object(p),
+                     JSON_PARSE_OBJECT_INIT);
 }
 
 static void
 json_parser_push_array(struct json_parser *p)
 {
-    json_parser_push(p, json_array_create_empty(), JSON_PARSE_ARRAY_INIT);
+    json_parser_push(p, json_parser_create_array(p), JSON_PARSE_ARRAY_INIT);
 }
 
 static void
@@ -1227,15 +1581,15 @@ json_parse_value(struct json_parser *p, struct json_token *token,
 
     switch (token->type) {
     case T_FALSE:
-        value = json_boolean_create(false);
+        value = json_parser_create_json(p, JSON_FALSE);
         break;
 
     case T_NULL:
-        value = json_null_create();
+        value = json_parser_create_json(p, JSON_NULL);
         break;
 
     case T_TRUE:
-        value = json_boolean_create(true);
+        value = json_parser_create_json(p, JSON_TRUE);
         break;
 
     case '{':
@@ -1247,15 +1601,17 @@ json_parse_value(struct json_parser *p, struct json_token *token,
         return;
 
     case T_INTEGER:
-        value = json_integer_create(token->u.integer);
+        value = json_parser_create_json(p, JSON_INTEGER);
+        value->u.integer = token->u.integer;
         break;
 
     case T_REAL:
-        value = json_real_create(token->u.real);
+        value = json_parser_create_json(p, JSON_REAL);
+        value->u.real = token->u.real;
         break;
 
     case T_STRING:
-        value = json_string_create(token->u.string);
+        value = json_parser_create_string(p, token->u.string);
         break;
 
     case T_EOF:
@@ -1279,7 +1635,7 @@ json_parser_pop(struct json_parser *p)
 
     /* Conserve memory. */
     node = json_parser_top(p);
-    if (node->json->type == JSON_ARRAY) {
+    if (node->json->type == JSON_ARRAY && !p->arena) {
         json_array_trim(node->json);
     }
 
@@ -1328,7 +1684,9 @@ json_parser_input(struct json_parser *p, struct json_token *token)
         /* Fall through. */
     case JSON_PARSE_OBJECT_NAME:
         if (token->type == T_STRING) {
-            p->member_name = xstrdup(token->u.string);
+            p->member_name = (p->arena
+                              ? json_arena_strdup(p->arena, token->u.string)
+                              : xstrdup(token->u.string));
             p->parse_state = JSON_PARSE_OBJECT_COLON;
         } else {
             json_error(p, "syntax error parsing object expecting string");
@@ -1426,7 +1784,6 @@ static void json_serialize_object(const struct shash *object,
                                   struct json_serializer *);
 static void json_serialize_array(const struct json_array *,
                                  struct json_serializer *);
-static void json_serialize_string(const char *, struct ds *);
 
 /* Converts 'json' to a string in JSON format, encoded in UTF-8, and returns
  * that string.  The caller is responsible for freeing the returned string,
@@ -1499,7 +1856,7 @@ json_serialize(const struct json *json, struct json_serializer *s)
         break;
 
     case JSON_STRING:
-        json_serialize_string(json->u.string, ds);
+        json_string_escape(json->u.string, ds);
         break;
 
     case JSON_N_TYPES:
@@ -1528,7 +1885,7 @@ json_serialize_object_member(size_t i, const struct shash_node *node,
         indent_line(s);
     }
 
-    json_serialize_string(node->name, ds);
+    json_string_escape(node->name, ds);
     ds_put_char(ds, ':');
     if (s->flags & JSSF_PRETTY) {
         ds_put_char(ds, ' ');
@@ -1595,8 +1952,10 @@ json_serialize_array(const struct json_array *array, struct json_serializer *s)
     ds_put_char(ds, ']');
 }
 
-static void
-json_serialize_string(const char *string, struct ds *ds)
+/* Appends 'string' to 'ds' as a JSON string literal, that is, in double
+ * quotes with any special characters escaped. */
+void
+json_string_escape(const char *string, struct ds *ds)
 {
     uint8_t c;
 
@@ -37,6 +37,7 @@ extern "C" {
 #endif
 
 struct ds;
+struct json_arena;
 
 /* Type of a JSON value. */
 enum json_type {
@@ -110,6 +111,7 @@ enum {
 };
 
 struct json_parser *json_parser_create(int flags);
+struct json_parser *json_parser_create_arena(int flags, struct json_arena *);
 size_t json_parser_feed(struct json_parser *, const char *, size_t);
 bool json_parser_is_done(const struct json_parser *);
 struct json *json_parser_finish(struct json_parser *);
@@ -118,6 +120,19 @@ void json_parser_abort(struct json_parser *);
 struct json *json_from_string(const char *string);
 struct json *json_from_file(const char *file_name);
 struct json *json_from_stream(FILE *stream);
+
+/* Arena allocation of parse trees.
+ *
+ * A parser created with json_parser_create_arena() allocates the tree that it
+ * returns, including an error string, from an arena instead of with malloc().
+ * Building a large tree this way is much cheaper, but the tree may not be
+ * modified or passed to json_destroy().  Instead, it is freed along with
+ * every other tree parsed into the same arena by json_arena_clear() or
+ * json_arena_destroy().  Use json_clone() to obtain an ordinary copy of any
+ * part of the tree that must outlive the arena. */
+struct json_arena *json_arena_create(void);
+void json_arena_clear(struct json_arena *);
+void json_arena_destroy(struct json_arena *);
 
 /* Serializing JSON. */
 
@@ -127,6 +142,7 @@ enum {
 };
 char *json_to_string(const struct json *, int flags);
 void json_to_ds(const struct json *, int flags, struct ds *);
+void json_string_escape(const char *, struct ds *);
 
 /* JSON string formatting operations. */
 
@@ -45,16 +45,34 @@ struct jsonrpc {
     struct json_parser *parser;
     struct jsonrpc_msg *received;
 
-    /* Output. */
+    /* Output.
+     *
+     * A jsonrpc_generator is represented in 'output' by an empty placeholder
+     * ofpbuf whose 'private_p' points to the generator.  Every other ofpbuf
+     * in 'output' is nonempty. */
     struct list output;         /* Contains "struct ofpbuf"s. */
     size_t backlog;
 };
 
+/* Number of bytes that a jsonrpc_generator is asked for at a time. */
+#define JSONRPC_CHUNK_SIZE 65536
+
+/* Serialized JSON shared among any number of connections' output queues.  An
+ * ofpbuf in a 'struct jsonrpc''s output queue that points into a
+ * jsonrpc_shared holds a reference to it in its 'private_p'. */
+struct jsonrpc_shared {
+    char *string;               /* Serialized JSON. */
+    size_t length;              /* strlen(string). */
+    unsigned int n_refs;        /* Reference count. */
+};
+
 /* Rate limit for error messages. */
 static struct vlog_rate_limit rl = VLOG_RATE_LIMIT_INIT(5, 5);
 
 static void jsonrpc_received(struct jsonrpc *);
 static void jsonrpc_cleanup(struct jsonrpc *);
+static void jsonrpc_output_delete(struct ofpbuf *);
+static void jsonrpc_generate(struct jsonrpc *, struct ofpbuf *placeholder);
 
 /* This is just the same as stream_open() except that it uses the default
  * JSONRPC ports if none is specified. */
@@ -112,13 +130,18 @@ jsonrpc_run(struct jsonrpc *rpc)
         struct ofpbuf *buf = ofpbuf_from_list(rpc->output.next);
         int retval;
 
+        if (!buf->size) {
+            jsonrpc_generate(rpc, buf);
+            continue;
+        }
+
         retval = stream_send(rpc->stream, buf->data, buf->size);
         if (retval >= 0) {
             rpc->backlog -= retval;
             ofpbuf_pull(buf, retval);
             if (!buf->size) {
                 list_remove(&buf->list_node);
-                ofpbuf_delete(buf);
+                jsonrpc_output_delete(buf);
             }
         } else {
             if (retval != -EAGAIN) {
@@ -230,6 +253,227 @@ jsonrpc_send(struct jsonrpc *rpc, struct jsonrpc_msg *msg)
     return rpc->status;
 }
 
+/* Serializes 'json' and returns it as a new jsonrpc_shared with a single
+ * reference, which the caller must eventually release with
+ * jsonrpc_shared_unref(). */
+struct jsonrpc_shared *
+jsonrpc_shared_create(const struct json *json)
+{
+    struct jsonrpc_shared *shared = xmalloc(sizeof *shared);
+    shared->string = json_to_string(json, 0);
+    shared->length = strlen(shared->string);
+    shared->n_refs = 1;
+    return shared;
+}
+
+/* Adds a reference to 'shared' and returns it. */
+struct jsonrpc_shared *
+jsonrpc_shared_ref(struct jsonrpc_shared *shared)
+{
+    shared->n_refs++;
+    return shared;
+}
+
+/* Releases a reference to 'shared', freeing it if it was the last one. */
+void
+jsonrpc_shared_unref(struct jsonrpc_shared *shared)
+{
+    if (shared) {
+        assert(shared->n_refs > 0);
+        if (!--shared->n_refs) {
+            free(shared->string);
+            free(shared);
+        }
+    }
+}
+
+/* Returns the number of bytes in 'shared''s serialized JSON. */
+size_t
+jsonrpc_shared_size(const struct jsonrpc_shared *shared)
+{
+    return shared->length;
+}
+
+static void
+jsonrpc_output_delete(struct ofpbuf *buf)
+{
+    jsonrpc_shared_unref(buf->private_p);
+    ofpbuf_delete(buf);
+}
+
+/* Deletes 'placeholder', which represents a jsonrpc_generator in an output
+ * queue, and the generator itself. */
+static void
+jsonrpc_placeholder_delete(struct ofpbuf *placeholder)
+{
+    struct jsonrpc_generator *generator = placeholder->private_p;
+
+    generator->class->destroy(generator);
+    ofpbuf_delete(placeholder);
+}
+
+/* Asks the generator that 'placeholder' represents, which must be at the head
+ * of 'rpc''s output queue, for its next piece of output, and queues that
+ * piece just ahead of 'placeholder'.  Deletes 'placeholder' once the
+ * generator has produced all of its output. */
+static void
+jsonrpc_generate(struct jsonrpc *rpc, struct ofpbuf *placeholder)
+{
+    struct jsonrpc_generator *generator = placeholder->private_p;
+    struct ds ds;
+    bool more;
+
+    ds_init(&ds);
+    more = generator->class->generate(generator, &ds, JSONRPC_CHUNK_SIZE);
+    if (ds.length) {
+        struct ofpbuf *buf = xmalloc(sizeof *buf);
+
+        ofpbuf_use(buf, ds.string, ds.allocated);
+        buf->size = ds.length;
+        list_insert(&placeholder->list_node, &buf->list_node);
+        rpc->backlog += buf->size;
+    } else {
+        assert(!more);
+        ds_destroy(&ds);
+    }
+
+    if (!more) {
+        list_remove(&placeholder->list_node);
+        jsonrpc_placeholder_delete(placeholder);
+    }
+}
+
+/* Sends on 'rpc' a reply to the request with the given 'id', whose result is
+ * serialized by 'result' a piece at a time as 'rpc' drains its output queue.
+ * Thus, the reply's content is produced only as fast as the peer receives it
+ * and only a piece at a time is ever held in memory.  Messages sent later are
+ * queued behind the reply.
+ *
+ * Always takes ownership of 'result', regardless of success.  Does not take
+ * ownership of 'id'. */
+int
+jsonrpc_send_reply_generated(struct jsonrpc *rpc, const struct json *id,
+                             struct jsonrpc_generator *result)
+{
+    static const char tail[] = "}";
+    struct ofpbuf *head, *placeholder, *end;
+    bool was_empty;
+    struct ds ds;
+
+    if (rpc->status) {
+        result->class->destroy(result);
+        return rpc->status;
+    }
+
+    if (VLOG_IS_DBG_ENABLED()) {
+        struct ds s = DS_EMPTY_INITIALIZER;
+        json_to_ds(id, 0, &s);
+        VLOG_DBG("%s: send reply, result=<generated>, id=%s",
+                 rpc->name, ds_cstr(&s));
+        ds_destroy(&s);
+    }
+
+    /* Everything before the result. */
+    ds_init(&ds);
+    ds_put_cstr(&ds, "{\"id\":");
+    json_to_ds(id, 0, &ds);
+    ds_put_cstr(&ds, ",\"error\":null,\"result\":");
+
+    head = xmalloc(sizeof *head);
+    ofpbuf_use(head, ds.string, ds.allocated);
+    head->size = ds.length;
+
+    placeholder = xmalloc(sizeof *placeholder);
+    ofpbuf_use(placeholder, NULL, 0);
+    placeholder->private_p = result;
+
+    end = xmalloc(sizeof *end);
+    ofpbuf_use_const(end, tail, strlen(tail));
+
+    was_empty = list_is_empty(&rpc->output);
+    list_push_back(&rpc->output, &head->list_node);
+    list_push_back(&rpc->output, &placeholder->list_node);
+    list_push_back(&rpc->output, &end->list_node);
+    rpc->backlog += head->size + end->size;
+
+    if (was_empty) {
+        jsonrpc_run(rpc);
+    }
+    return rpc->status;
+}
+
+/* Sends on 'rpc' a notification for 'method' whose parameters are the
+ * elements of 'params', which must be an array, followed by 'last_param'.
+ * This has the same effect as jsonrpc_send() with an equivalent message, but
+ * 'last_param' is queued for sending by reference instead of being serialized
+ * again.
+ *
+ * Always takes ownership of 'params', regardless of success.  Does not take
+ * ownership of 'last_param'. */
+int
+jsonrpc_send_notify_shared(struct jsonrpc *rpc, const char *method,
+                           struct json *params,
+                           struct jsonrpc_shared *last_param)
+{
+    static const char tail[] = "]}";
+    const struct json_array *array;
+    struct ofpbuf *head, *shared, *end;
+    struct json *method_json;
+    bool was_empty;
+    struct ds ds;
+    size_t i;
+
+    if (rpc->status) {
+        json_destroy(params);
+        return rpc->status;
+    }
+
+    if (VLOG_IS_DBG_ENABLED()) {
+        struct ds s = DS_EMPTY_INITIALIZER;
+        json_to_ds(params, 0, &s);
+        VLOG_DBG("%s: send notification, method=\"%s\", params=%s "
+                 "+ %zu shared bytes",
+                 rpc->name, method, ds_cstr(&s), last_param->length);
+        ds_destroy(&s);
+    }
+
+    /* Everything before 'last_param'. */
+    ds_init(&ds);
+    ds_put_cstr(&ds, "{\"id\":null,\"method\":");
+    method_json = json_string_create(method);
+    json_to_ds(method_json, 0, &ds);
+    json_destroy(method_json);
+    ds_put_cstr(&ds, ",\"params\":[");
+    array = json_array(params);
+    for (i = 0; i < array->n; i++) {
+        json_to_ds(array->elems[i], 0, &ds);
+        ds_put_char(&ds, ',');
+    }
+    json_destroy(params);
+
+    head = xmalloc(sizeof *head);
+    ofpbuf_use(head, ds.string, ds.allocated);
+    head->size = ds.length;
+
+    shared = xmalloc(sizeof *shared);
+    ofpbuf_use_const(shared, last_param->string, last_param->length);
+    shared->private_p = jsonrpc_shared_ref(last_param);
+
+    end = xmalloc(sizeof *end);
+    ofpbuf_use_const(end, tail, strlen(tail));
+
+    was_empty = list_is_empty(&rpc->output);
+    list_push_back(&rpc->output, &head->list_node);
+    list_push_back(&rpc->output, &shared->list_node);
+    list_push_back(&rpc->output, &end->list_node);
+    rpc->backlog += head->size + shared->size + end->size;
+
+    if (was_empty) {
+        jsonrpc_run(rpc);
+    }
+    return rpc->status;
+}
+
 int
 jsonrpc_recv(struct jsonrpc *rpc, struct jsonrpc_msg **msgp)
 {
@@ -418,7 +662,14 @@ jsonrpc_cleanup(struct jsonrpc *rpc)
     jsonrpc_msg_destroy(rpc->received);
     rpc->received = NULL;
 
-    ofpbuf_list_delete(&rpc->output);
+    while (!list_is_empty(&rpc->output)) {
+        struct ofpbuf *buf = ofpbuf_from_list(list_pop_front(&rpc->output));
+        if (buf->size) {
+            jsonrpc_output_delete(buf);
+        } else {
+            jsonrpc_placeholder_delete(buf);
+        }
+    }
     rpc->backlog = 0;
 }
 
@@ -896,6 +1147,40 @@ jsonrpc_session_send(struct jsonrpc_session *s, struct jsonrpc_msg *msg)
     }
 }
 
+/* Same as jsonrpc_send_reply_generated(), for 's''s current connection.
+ *
+ * Always takes ownership of 'result', regardless of success.  Does not take
+ * ownership of 'id'. */
+int
+jsonrpc_session_send_reply_generated(struct jsonrpc_session *s,
+                                     const struct json *id,
+                                     struct jsonrpc_generator *result)
+{
+    if (s->rpc) {
+        return jsonrpc_send_reply_generated(s->rpc, id, result);
+    } else {
+        result->class->destroy(result);
+        return ENOTCONN;
+    }
+}
+
+/* Same as jsonrpc_send_notify_shared(), for 's''s current connection.
+ *
+ * Always takes ownership of 'params', regardless of success.  Does not take
+ * ownership of 'last_param'. */
+int
+jsonrpc_session_send_notify_shared(struct jsonrpc_session *s,
+                                   const char *method, struct json *params,
+                                   struct jsonrpc_shared *last_param)
+{
+    if (s->rpc) {
+        return jsonrpc_send_notify_shared(s->rpc, method, params, last_param);
+    } else {
+        json_destroy(params);
+        return ENOTCONN;
+    }
+}
+
 struct jsonrpc_msg *
 jsonrpc_session_recv(struct jsonrpc_session *s)
 {
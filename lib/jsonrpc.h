@@ -23,7 +23,9 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+struct ds;
 struct json;
+struct jsonrpc_generator_class;
 struct jsonrpc_msg;
 struct pstream;
 struct reconnect_stats;
@@ -61,6 +63,39 @@ int jsonrpc_recv_block(struct jsonrpc *, struct jsonrpc_msg **);
 int jsonrpc_transact_block(struct jsonrpc *, struct jsonrpc_msg *,
                            struct jsonrpc_msg **);
 
+/* Reference-counted serialized JSON, for sending the same content to many
+ * JSON-RPC connections while serializing it only once. */
+struct jsonrpc_shared *jsonrpc_shared_create(const struct json *);
+struct jsonrpc_shared *jsonrpc_shared_ref(struct jsonrpc_shared *);
+void jsonrpc_shared_unref(struct jsonrpc_shared *);
+size_t jsonrpc_shared_size(const struct jsonrpc_shared *);
+
+int jsonrpc_send_notify_shared(struct jsonrpc *, const char *method,
+                               struct json *params,
+                               struct jsonrpc_shared *last_param);
+
+/* Serialized JSON produced a piece at a time, on demand, as a JSON-RPC
+ * connection drains its output queue, for sending content too large to be
+ * worth holding in memory all at once. */
+struct jsonrpc_generator {
+    const struct jsonrpc_generator_class *class;
+};
+
+struct jsonrpc_generator_class {
+    /* Appends the next piece of output, normally about 'max' bytes, to 'ds'.
+     * Returns true if more output remains, false if this was the last piece.
+     *
+     * Each call should append at least one byte, so that the connection makes
+     * progress. */
+    bool (*generate)(struct jsonrpc_generator *, struct ds *, size_t max);
+
+    /* Frees 'generator', whether or not it generated all of its output. */
+    void (*destroy)(struct jsonrpc_generator *);
+};
+
+int jsonrpc_send_reply_generated(struct jsonrpc *, const struct json *id,
+                                 struct jsonrpc_generator *result);
+
 /* Messages. */
 enum jsonrpc_msg_type {
     JSONRPC_REQUEST,           /* Request. */
@@ -108,6 +143,13 @@ size_t jsonrpc_session_get_backlog(const struct jsonrpc_session *);
 const char *jsonrpc_session_get_name(const struct jsonrpc_session *);
 
 int jsonrpc_session_send(struct jsonrpc_session *, struct jsonrpc_msg *);
+int jsonrpc_session_send_reply_generated(struct jsonrpc_session *,
+                                         const struct json *id,
+                                         struct jsonrpc_generator *result);
+int jsonrpc_session_send_notify_shared(struct jsonrpc_session *,
+                                       const char *method,
+                                       struct json *params,
+                                       struct jsonrpc_shared *last_param);
 struct jsonrpc_msg *jsonrpc_session_recv(struct jsonrpc_session *);
 void jsonrpc_session_recv_wait(struct jsonrpc_session *);
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Nicira Networks.
+ * Copyright (c) 2010, 2011 Nicira Networks.
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -19,11 +19,16 @@
 #include "dummy.h"
 
 #include <errno.h>
+#include <pthread.h>
 
+#include "dynamic-string.h"
 #include "list.h"
 #include "netdev-provider.h"
+#include "ofpbuf.h"
 #include "packets.h"
+#include "poll-loop.h"
 #include "shash.h"
+#include "unixctl.h"
 #include "vlog.h"
 
 VLOG_DEFINE_THIS_MODULE(netdev_dummy);
@@ -40,15 +45,23 @@ struct netdev_dev_dummy {
     int mtu;
     struct netdev_stats stats;
     enum netdev_flags flags;
+    struct list devs;           /* Contains "struct netdev_dummy"s. */
 };
 
 struct netdev_dummy {
     struct netdev netdev;
+    struct list node;           /* In netdev_dev_dummy's "devs" list. */
+    struct list recv_queue;     /* Contains "struct ofpbuf"s. */
 };
 
 static struct shash netdev_dummy_notifiers =
     SHASH_INITIALIZER(&netdev_dummy_notifiers);
 
+/* Protects each netdev_dummy's 'recv_queue' and each netdev_dev_dummy's
+ * 'stats', which dpif-netdev forwarding threads access through
+ * netdev_recv() and netdev_send() while the main thread injects packets. */
+static pthread_mutex_t dummy_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 static int netdev_dummy_create(const struct netdev_class *, const char *,
                                const struct shash *, struct netdev_dev **);
 static void netdev_dummy_poll_notify(const struct netdev *);
@@ -92,6 +105,7 @@ netdev_dummy_create(const struct netdev_class *class, const char *name,
     netdev_dev->hwaddr[5] = n;
     netdev_dev->mtu = 1500;
     netdev_dev->flags = 0;
+    list_init(&netdev_dev->devs);
 
     n++;
 
@@ -112,10 +126,13 @@ static int
 netdev_dummy_open(struct netdev_dev *netdev_dev_, int ethertype OVS_UNUSED,
                   struct netdev **netdevp)
 {
+    struct netdev_dev_dummy *netdev_dev = netdev_dev_dummy_cast(netdev_dev_);
     struct netdev_dummy *netdev;
 
     netdev = xmalloc(sizeof *netdev);
     netdev_init(&netdev->netdev, netdev_dev_);
+    list_push_back(&netdev_dev->devs, &netdev->node);
+    list_init(&netdev->recv_queue);
 
     *netdevp = &netdev->netdev;
     return 0;
@@ -125,9 +142,82 @@ static void
 netdev_dummy_close(struct netdev *netdev_)
 {
     struct netdev_dummy *netdev = netdev_dummy_cast(netdev_);
+    list_remove(&netdev->node);
+    pthread_mutex_lock(&dummy_mutex);
+    ofpbuf_list_delete(&netdev->recv_queue);
+    pthread_mutex_unlock(&dummy_mutex);
     free(netdev);
 }
 
+static int
+netdev_dummy_recv(struct netdev *netdev_, void *buffer, size_t size)
+{
+    struct netdev_dummy *netdev = netdev_dummy_cast(netdev_);
+    struct ofpbuf *packet;
+    size_t packet_size;
+
+    pthread_mutex_lock(&dummy_mutex);
+    if (list_is_empty(&netdev->recv_queue)) {
+        pthread_mutex_unlock(&dummy_mutex);
+        return -EAGAIN;
+    }
+    packet = ofpbuf_from_list(list_pop_front(&netdev->recv_queue));
+    pthread_mutex_unlock(&dummy_mutex);
+
+    if (packet->size > size) {
+        ofpbuf_delete(packet);
+        return -EMSGSIZE;
+    }
+    packet_size = packet->size;
+
+    memcpy(buffer, packet->data, packet->size);
+    ofpbuf_delete(packet);
+
+    return packet_size;
+}
+
+static void
+netdev_dummy_recv_wait(struct netdev *netdev_)
+{
+    struct netdev_dummy *netdev = netdev_dummy_cast(netdev_);
+    bool empty;
+
+    pthread_mutex_lock(&dummy_mutex);
+    empty = list_is_empty(&netdev->recv_queue);
+    pthread_mutex_unlock(&dummy_mutex);
+
+    if (!empty) {
+        poll_immediate_wake();
+    }
+}
+
+static int
+netdev_dummy_drain(struct netdev *netdev_)
+{
+    struct netdev_dummy *netdev = netdev_dummy_cast(netdev_);
+
+    pthread_mutex_lock(&dummy_mutex);
+    ofpbuf_list_delete(&netdev->recv_queue);
+    pthread_mutex_unlock(&dummy_mutex);
+    return 0;
+}
+
+/* Discards the 'size' bytes in 'buffer', counting them as transmitted on
+ * 'netdev'. */
+static int
+netdev_dummy_send(struct netdev *netdev, const void *buffer OVS_UNUSED,
+                  size_t size)
+{
+    struct netdev_dev_dummy *dev =
+        netdev_dev_dummy_cast(netdev_get_dev(netdev));
+
+    pthread_mutex_lock(&dummy_mutex);
+    dev->stats.tx_packets++;
+    dev->stats.tx_bytes += size;
+    pthread_mutex_unlock(&dummy_mutex);
+    return 0;
+}
+
 static int
 netdev_dummy_set_etheraddr(struct netdev *netdev,
                            const uint8_t mac[ETH_ADDR_LEN])
@@ -170,7 +260,9 @@ netdev_dummy_get_stats(const struct netdev *netdev, struct netdev_stats *stats)
     const struct netdev_dev_dummy *dev =
         netdev_dev_dummy_cast(netdev_get_dev(netdev));
 
+    pthread_mutex_lock(&dummy_mutex);
     *stats = dev->stats;
+    pthread_mutex_unlock(&dummy_mutex);
     return 0;
 }
 
@@ -180,7 +272,9 @@ netdev_dummy_set_stats(struct netdev *netdev, const struct netdev_stats *stats)
     struct netdev_dev_dummy *dev =
         netdev_dev_dummy_cast(netdev_get_dev(netdev));
 
+    pthread_mutex_lock(&dummy_mutex);
     dev->stats = *stats;
+    pthread_mutex_unlock(&dummy_mutex);
     return 0;
 }
 
@@ -215,7 +309,7 @@ netdev_dummy_poll_add(struct netdev *netdev,
     struct list *list;
     struct shash_node *shash_node;
 
-    shash_node = shash_find_data(&netdev_dummy_notifiers, name);
+    shash_node = shash_find(&netdev_dummy_notifiers, name);
     if (!shash_node) {
         list = xmalloc(sizeof *list);
         list_init(list);
@@ -284,11 +378,12 @@ static const struct netdev_class dummy_class = {
 
     NULL,                       /* enumerate */
 
-    NULL,                       /* recv */
-    NULL,                       /* recv_wait */
-    NULL,                       /* drain */
+    netdev_dummy_recv,
+    NULL,                       /* recv_batch */
+    netdev_dummy_recv_wait,
+    netdev_dummy_drain,
 
-    NULL,                       /* send */
+    netdev_dummy_send,
     NULL,                       /* send_wait */
 
     netdev_dummy_set_etheraddr,
@@ -298,6 +393,7 @@ static const struct netdev_class dummy_class = {
     NULL,                       /* get_carrier */
     NULL,                       /* get_miimon */
     netdev_dummy_get_stats,
+    NULL,                       /* get_stats_multiple */
     netdev_dummy_set_stats,
 
     NULL,                       /* get_features */
@@ -330,8 +426,92 @@ static const struct netdev_class dummy_class = {
     netdev_dummy_poll_remove,
 };
 
+/* Parses 's', a sequence of pairs of hexadecimal digits, into a new ofpbuf.
+ * Returns NULL if 's' is malformed. */
+static struct ofpbuf *
+parse_hex_packet(const char *s)
+{
+    struct ofpbuf *packet;
+
+    packet = ofpbuf_new(strlen(s) / 2);
+    while (*s) {
+        uint8_t byte;
+        bool ok;
+
+        byte = hexits_value(s, 2, &ok);
+        if (!ok) {
+            ofpbuf_delete(packet);
+            return NULL;
+        }
+        ofpbuf_put(packet, &byte, 1);
+        s += 2;
+    }
+    return packet;
+}
+
+static void
+netdev_dummy_receive(struct unixctl_conn *conn, const char *args_,
+                     void *aux OVS_UNUSED)
+{
+    struct netdev_dev_dummy *dummy_dev;
+    struct netdev_dummy *dev;
+    char *args = xstrdup(args_);
+    char *save_ptr = NULL;
+    const char *name;
+    char *hex;
+
+    name = strtok_r(args, " ", &save_ptr);
+    dummy_dev = NULL;
+    if (name) {
+        struct netdev_dev *netdev_dev = netdev_dev_from_name(name);
+        if (netdev_dev
+            && is_dummy_class(netdev_dev_get_class(netdev_dev))) {
+            dummy_dev = netdev_dev_dummy_cast(netdev_dev);
+        }
+    }
+    if (!dummy_dev) {
+        unixctl_command_reply(conn, 501, "no such dummy netdev");
+        goto exit;
+    }
+
+    while ((hex = strtok_r(NULL, " ", &save_ptr)) != NULL) {
+        struct ofpbuf *packet = parse_hex_packet(hex);
+        if (!packet || packet->size < ETH_HEADER_LEN) {
+            ofpbuf_delete(packet);
+            unixctl_command_reply(conn, 501, "bad packet syntax");
+            goto exit;
+        }
+
+        pthread_mutex_lock(&dummy_mutex);
+        dummy_dev->stats.rx_packets++;
+        dummy_dev->stats.rx_bytes += packet->size;
+        LIST_FOR_EACH (dev, node, &dummy_dev->devs) {
+            list_push_back(&dev->recv_queue,
+                           &ofpbuf_clone(packet)->list_node);
+        }
+        pthread_mutex_unlock(&dummy_mutex);
+        ofpbuf_delete(packet);
+    }
+    unixctl_command_reply(conn, 200, "");
+
+exit:
+    free(args);
+}
+
 void
-netdev_dummy_register(void)
+netdev_dummy_register(bool override)
 {
     netdev_register_provider(&dummy_class);
+    if (override) {
+        static struct netdev_class dummy_internal_class;
+
+        if (netdev_lookup_provider("internal")) {
+            netdev_unregister_provider("internal");
+        }
+        dummy_internal_class = dummy_class;
+        dummy_internal_class.type = "internal";
+        netdev_register_provider(&dummy_internal_class);
+    }
+    unixctl_command_register("netdev-dummy/receive", netdev_dummy_receive,
+                             NULL);
 }
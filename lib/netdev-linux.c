@@ -32,6 +32,7 @@
 #include <linux/version.h>
 #include <sys/types.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 #include <netpacket/packet.h>
 #include <net/ethernet.h>
@@ -42,6 +43,7 @@
 #include <net/route.h>
 #include <netinet/in.h>
 #include <poll.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -52,6 +54,7 @@
 #include "fatal-signal.h"
 #include "hash.h"
 #include "hmap.h"
+#include "netdev-linux.h"
 #include "netdev-provider.h"
 #include "netdev-vport.h"
 #include "netlink.h"
@@ -65,6 +68,7 @@
 #include "socket-util.h"
 #include "shash.h"
 #include "sset.h"
+#include "unixctl.h"
 #include "vlog.h"
 
 VLOG_DEFINE_THIS_MODULE(netdev_linux);
@@ -76,6 +80,11 @@ COVERAGE_DEFINE(netdev_get_ifindex);
 COVERAGE_DEFINE(netdev_get_hwaddr);
 COVERAGE_DEFINE(netdev_set_hwaddr);
 COVERAGE_DEFINE(netdev_ethtool);
+COVERAGE_DEFINE(netdev_linux_ring_rx);
+COVERAGE_DEFINE(netdev_linux_ring_tx);
+COVERAGE_DEFINE(netdev_linux_ring_truncated);
+COVERAGE_DEFINE(netdev_linux_stats_dump);
+COVERAGE_DEFINE(netdev_linux_stats_query);
 
 /* These were introduced in Linux 2.6.14, so they might be missing if we have
  * old headers. */
@@ -92,6 +101,47 @@ COVERAGE_DEFINE(netdev_ethtool);
 #define TC_RTAB_SIZE 1024
 #endif
 
+/* PACKET_TX_RING was introduced in Linux 2.6.31, after TPACKET_V2.  The
+ * structures below mirror those in <linux/if_packet.h>, which cannot be
+ * included alongside the glibc headers that this file already uses. */
+#ifdef PACKET_TX_RING
+#define HAVE_PACKET_MMAP 1
+
+#define NETDEV_LINUX_TPACKET_V2 1
+
+#define NETDEV_LINUX_TP_STATUS_KERNEL        0
+#define NETDEV_LINUX_TP_STATUS_USER          (1 << 0)
+#define NETDEV_LINUX_TP_STATUS_AVAILABLE     0
+#define NETDEV_LINUX_TP_STATUS_SEND_REQUEST  (1 << 0)
+#define NETDEV_LINUX_TP_STATUS_WRONG_FORMAT  (1 << 2)
+
+#define NETDEV_LINUX_TPACKET_ALIGN(X) ROUND_UP(X, 16)
+
+struct netdev_linux_tpacket_req {
+    unsigned int tp_block_size;   /* Minimal size of contiguous block. */
+    unsigned int tp_block_nr;     /* Number of blocks. */
+    unsigned int tp_frame_size;   /* Size of frame. */
+    unsigned int tp_frame_nr;     /* Total number of frames. */
+};
+
+struct netdev_linux_tpacket2_hdr {
+    uint32_t tp_status;
+    uint32_t tp_len;
+    uint32_t tp_snaplen;
+    uint16_t tp_mac;
+    uint16_t tp_net;
+    uint32_t tp_sec;
+    uint32_t tp_nsec;
+    uint16_t tp_vlan_tci;
+    uint16_t tp_padding;
+};
+
+/* Offset of the packet data in a transmit frame, and of the sockaddr_ll that
+ * the kernel writes into a receive frame. */
+#define NETDEV_LINUX_TPACKET2_HDRLEN \
+    NETDEV_LINUX_TPACKET_ALIGN(sizeof(struct netdev_linux_tpacket2_hdr))
+#endif /* PACKET_TX_RING */
+
 static struct rtnetlink_notifier netdev_linux_cache_notifier;
 static int cache_notifier_refcount;
 
@@ -366,14 +416,63 @@ struct netdev_dev_linux {
 struct netdev_linux {
     struct netdev netdev;
     int fd;
+    struct netdev_linux_rings *rings; /* PACKET_MMAP rings, if any. */
+};
+
+/* Number of frames in each of the receive and transmit PACKET_MMAP rings. */
+#define NETDEV_LINUX_RING_FRAMES 256
+
+/* One PACKET_MMAP ring of fixed-size frames. */
+struct netdev_linux_ring {
+    uint8_t *frames;            /* First frame. */
+    size_t frame_size;          /* Size of each frame, a power of 2. */
+    unsigned int head;          /* Index of next frame to use. */
+};
+
+/* Memory-mapped receive and transmit rings on an AF_PACKET socket.
+ *
+ * Packets received from the ring are handed out as OFPBUF_RING buffers in
+ * 'held' that point directly into the receive ring.  Their frames stay owned
+ * by userspace until the next receive operation on the netdev (or until it is
+ * closed), at which point they are handed back to the kernel.
+ *
+ * A netdev may be sent on from more than one thread at a time (e.g. by
+ * dpif-netdev's forwarding threads and by the main thread executing
+ * packet-outs), so claiming, filling, and advancing past a transmit frame
+ * happens under 'tx_mutex'. */
+struct netdev_linux_rings {
+    void *mapping;              /* Start of mmap()'d region. */
+    size_t mapping_len;         /* Length of mmap()'d region. */
+    struct netdev_linux_ring rx;
+    struct netdev_linux_ring tx;    /* Protected by 'tx_mutex'. */
+    pthread_mutex_t tx_mutex;
+
+    struct ofpbuf held[NETDEV_MAX_BATCH];
+    void *held_frames[NETDEV_MAX_BATCH];
+    int n_held;
 };
 
+/* Whether netdev_linux_open() should try to set up PACKET_MMAP rings.  Set
+ * with "ovs-appctl netdev-linux/set-mmap-rings". */
+static bool use_mmap_rings;
+
 /* An AF_INET socket (used for ioctl operations). */
 static int af_inet_sock = -1;
 
 /* A Netlink routing socket that is not subscribed to any multicast groups. */
 static struct nl_sock *rtnl_sock;
 
+/* Whether RTM_GETLINK can report network device statistics: 1 if so, 0 if
+ * not, -1 if not yet known.  See check_for_working_netlink_stats(). */
+static int use_netlink_stats = -1;
+
+/* Statistics for one network device, obtained from dump_link_stats(). */
+struct link_stats {
+    struct hmap_node hmap_node; /* In map from ifindex, hashed on ifindex. */
+    int ifindex;
+    struct netdev_stats stats;
+};
+
 struct netdev_linux_notifier {
     struct netdev_notifier notifier;
     struct list node;
@@ -399,6 +498,11 @@ static int get_flags(const struct netdev *, int *flagsp);
 static int set_flags(struct netdev *, int flags);
 static int do_get_ifindex(const char *netdev_name);
 static int get_ifindex(const struct netdev *, int *ifindexp);
+static int netdev_linux_get_mtu(const struct netdev *, int *mtup);
+static void netdev_linux_rings_setup(struct netdev_linux *);
+static void netdev_linux_rings_destroy(struct netdev_linux *);
+static void netdev_linux_unixctl_set_mmap_rings(struct unixctl_conn *,
+                                                const char *args, void *aux);
 static int do_set_addr(struct netdev *netdev,
                        int ioctl_nr, const char *ioctl_name,
                        struct in_addr addr);
@@ -406,6 +510,10 @@ static int get_etheraddr(const char *netdev_name, uint8_t ea[ETH_ADDR_LEN]);
 static int set_etheraddr(const char *netdev_name, int hwaddr_family,
                          const uint8_t[ETH_ADDR_LEN]);
 static int get_stats_via_netlink(int ifindex, struct netdev_stats *stats);
+static void dump_link_stats(struct hmap *link_stats);
+static const struct link_stats *find_link_stats(const struct hmap *,
+                                                int ifindex);
+static void free_link_stats(struct hmap *link_stats);
 static int get_stats_via_proc(const char *netdev_name, struct netdev_stats *stats);
 
 static bool
@@ -453,6 +561,9 @@ netdev_linux_init(void)
                             strerror(status));
             }
         }
+
+        unixctl_command_register("netdev-linux/set-mmap-rings",
+                                 netdev_linux_unixctl_set_mmap_rings, NULL);
     }
     return status;
 }
@@ -707,6 +818,10 @@ netdev_linux_open(struct netdev_dev *netdev_dev_, int ethertype,
         if (error) {
             goto error;
         }
+
+        if (use_mmap_rings) {
+            netdev_linux_rings_setup(netdev);
+        }
     }
 
     *netdevp = &netdev->netdev;
@@ -723,6 +838,7 @@ netdev_linux_close(struct netdev *netdev_)
 {
     struct netdev_linux *netdev = netdev_linux_cast(netdev_);
 
+    netdev_linux_rings_destroy(netdev);
     if (netdev->fd > 0 && strcmp(netdev_get_type(netdev_), "tap")) {
         close(netdev->fd);
     }
@@ -751,6 +867,314 @@ netdev_linux_enumerate(struct sset *sset)
     }
 }
 
+#ifdef HAVE_PACKET_MMAP
+static struct netdev_linux_tpacket2_hdr *
+netdev_linux_ring_frame(const struct netdev_linux_ring *ring)
+{
+    return (void *) (ring->frames + ring->head * ring->frame_size);
+}
+
+static void
+netdev_linux_ring_advance(struct netdev_linux_ring *ring)
+{
+    ring->head = (ring->head + 1) % NETDEV_LINUX_RING_FRAMES;
+}
+
+/* Attempts to set up PACKET_MMAP receive and transmit rings on 'netdev''s
+ * AF_PACKET socket.  On failure, logs a warning and leaves 'netdev' using
+ * read() and write(). */
+static void
+netdev_linux_rings_setup(struct netdev_linux *netdev)
+{
+    const char *name = netdev_get_name(&netdev->netdev);
+    struct netdev_linux_tpacket_req req;
+    struct netdev_linux_rings *rings;
+    size_t frame_size, ring_len;
+    int version, reserve, mtu;
+    void *mapping;
+    int error;
+
+    /* Each frame holds the tpacket2_hdr and sockaddr_ll, up to 16 bytes of
+     * padding ahead of the Ethernet header, some headroom for pushing a VLAN
+     * header, and a maximum-length VLAN-tagged frame. */
+    if (netdev_linux_get_mtu(&netdev->netdev, &mtu)) {
+        mtu = ETH_PAYLOAD_MAX;
+    }
+    frame_size = 1;
+    while (frame_size < (NETDEV_LINUX_TPACKET2_HDRLEN
+                         + sizeof(struct sockaddr_ll) + 16 + VLAN_HEADER_LEN
+                         + VLAN_ETH_HEADER_LEN + mtu)) {
+        frame_size *= 2;
+    }
+    ring_len = frame_size * NETDEV_LINUX_RING_FRAMES;
+
+    memset(&req, 0, sizeof req);
+    req.tp_block_size = MAX(frame_size, getpagesize());
+    req.tp_block_nr = ring_len / req.tp_block_size;
+    req.tp_frame_size = frame_size;
+    req.tp_frame_nr = NETDEV_LINUX_RING_FRAMES;
+
+    version = NETDEV_LINUX_TPACKET_V2;
+    reserve = VLAN_HEADER_LEN;
+    if (setsockopt(netdev->fd, SOL_PACKET, PACKET_VERSION,
+                   &version, sizeof version)
+        || setsockopt(netdev->fd, SOL_PACKET, PACKET_RESERVE,
+                      &reserve, sizeof reserve)
+        || setsockopt(netdev->fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof req)
+        || setsockopt(netdev->fd, SOL_PACKET, PACKET_TX_RING,
+                      &req, sizeof req)) {
+        error = errno;
+        goto error;
+    }
+
+    /* The kernel maps the receive ring first, then the transmit ring. */
+    mapping = mmap(NULL, 2 * ring_len, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   netdev->fd, 0);
+    if (mapping == MAP_FAILED) {
+        error = errno;
+        goto error;
+    }
+
+    /* Packets that arrived before the receive ring existed are still on the
+     * socket's receive queue, where nothing would ever read them. */
+    drain_rcvbuf(netdev->fd);
+
+    rings = xzalloc(sizeof *rings);
+    rings->mapping = mapping;
+    rings->mapping_len = 2 * ring_len;
+    rings->rx.frames = mapping;
+    rings->rx.frame_size = frame_size;
+    rings->tx.frames = (uint8_t *) mapping + ring_len;
+    rings->tx.frame_size = frame_size;
+    pthread_mutex_init(&rings->tx_mutex, NULL);
+    netdev->rings = rings;
+
+    VLOG_DBG("%s: using PACKET_MMAP rings of %d %zu-byte frames",
+             name, NETDEV_LINUX_RING_FRAMES, frame_size);
+    return;
+
+error:
+    VLOG_WARN("%s: setting up PACKET_MMAP rings failed (%s), falling back to "
+              "read() and write()", name, strerror(error));
+    memset(&req, 0, sizeof req);
+    setsockopt(netdev->fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof req);
+    setsockopt(netdev->fd, SOL_PACKET, PACKET_TX_RING, &req, sizeof req);
+}
+
+/* Hands the receive frames held by buffers returned by the previous call to
+ * netdev_linux_ring_recv() back to the kernel. */
+static void
+netdev_linux_rings_release(struct netdev_linux_rings *rings)
+{
+    int i;
+
+    if (rings->n_held) {
+        __sync_synchronize();
+        for (i = 0; i < rings->n_held; i++) {
+            struct netdev_linux_tpacket2_hdr *hdr = rings->held_frames[i];
+
+            ofpbuf_uninit(&rings->held[i]);
+            hdr->tp_status = NETDEV_LINUX_TP_STATUS_KERNEL;
+        }
+        rings->n_held = 0;
+    }
+}
+
+static void
+netdev_linux_rings_destroy(struct netdev_linux *netdev)
+{
+    struct netdev_linux_rings *rings = netdev->rings;
+
+    if (rings) {
+        netdev_linux_rings_release(rings);
+        munmap(rings->mapping, rings->mapping_len);
+        pthread_mutex_destroy(&rings->tx_mutex);
+        free(rings);
+        netdev->rings = NULL;
+    }
+}
+
+/* Receives up to 'n_buffers' packets from 'netdev''s receive ring, replacing
+ * the pointers in 'buffers' by OFPBUF_RING buffers that refer to the frames
+ * in the ring.  Returns the number of packets received, or -EAGAIN if none
+ * were ready. */
+static int
+netdev_linux_ring_recv(struct netdev_linux *netdev, struct ofpbuf **buffers,
+                       int n_buffers)
+{
+    struct netdev_linux_rings *rings = netdev->rings;
+    struct netdev_linux_ring *rx = &rings->rx;
+    int n;
+
+    netdev_linux_rings_release(rings);
+
+    n = 0;
+    while (rings->n_held < MIN(n_buffers, NETDEV_MAX_BATCH)) {
+        struct netdev_linux_tpacket2_hdr *hdr = netdev_linux_ring_frame(rx);
+        size_t offset = NETDEV_LINUX_TPACKET2_HDRLEN
+                        + sizeof(struct sockaddr_ll);
+        struct ofpbuf *b;
+
+        if (!(hdr->tp_status & NETDEV_LINUX_TP_STATUS_USER)) {
+            break;
+        }
+        __sync_synchronize();
+        netdev_linux_ring_advance(rx);
+
+        rings->held_frames[rings->n_held] = hdr;
+        b = &rings->held[rings->n_held++];
+        ofpbuf_use_ring(b, (uint8_t *) hdr + offset, rx->frame_size - offset);
+
+        if (hdr->tp_snaplen < hdr->tp_len) {
+            COVERAGE_INC(netdev_linux_ring_truncated);
+            VLOG_WARN_RL(&rl, "%s: dropping %"PRIu32"-byte packet truncated "
+                         "to %"PRIu32" bytes by receive ring",
+                         netdev_get_name(&netdev->netdev),
+                         hdr->tp_len, hdr->tp_snaplen);
+            continue;
+        }
+
+        b->data = (uint8_t *) hdr + hdr->tp_mac;
+        b->size = hdr->tp_snaplen;
+        buffers[n++] = b;
+    }
+
+    COVERAGE_ADD(netdev_linux_ring_rx, n);
+    return n ? n : -EAGAIN;
+}
+
+/* Discards all of the packets in 'netdev''s receive ring. */
+static void
+netdev_linux_ring_drain(struct netdev_linux *netdev)
+{
+    struct netdev_linux_ring *rx = &netdev->rings->rx;
+
+    netdev_linux_rings_release(netdev->rings);
+    for (;;) {
+        struct netdev_linux_tpacket2_hdr *hdr = netdev_linux_ring_frame(rx);
+
+        if (!(hdr->tp_status & NETDEV_LINUX_TP_STATUS_USER)) {
+            break;
+        }
+        hdr->tp_status = NETDEV_LINUX_TP_STATUS_KERNEL;
+        netdev_linux_ring_advance(rx);
+    }
+}
+
+/* Queues the 'size' bytes in 'data' on 'netdev''s transmit ring and asks the
+ * kernel to transmit it.  Returns 0 if successful, otherwise a positive errno
+ * value.
+ *
+ * May be called from more than one thread at a time. */
+static int
+netdev_linux_ring_send(struct netdev_linux *netdev, const void *data,
+                       size_t size)
+{
+    struct netdev_linux_rings *rings = netdev->rings;
+    struct netdev_linux_ring *tx = &rings->tx;
+    struct netdev_linux_tpacket2_hdr *hdr;
+    bool rejected;
+    ssize_t retval;
+
+    if (size > tx->frame_size - NETDEV_LINUX_TPACKET2_HDRLEN) {
+        return EMSGSIZE;
+    }
+
+    pthread_mutex_lock(&rings->tx_mutex);
+    hdr = netdev_linux_ring_frame(tx);
+    rejected = hdr->tp_status == NETDEV_LINUX_TP_STATUS_WRONG_FORMAT;
+    if (!rejected && hdr->tp_status != NETDEV_LINUX_TP_STATUS_AVAILABLE) {
+        pthread_mutex_unlock(&rings->tx_mutex);
+
+        /* The ring is full.  Make sure the kernel is working on it. */
+        ignore(send(netdev->fd, NULL, 0, MSG_DONTWAIT));
+        return EAGAIN;
+    }
+    __sync_synchronize();
+
+    memcpy((uint8_t *) hdr + NETDEV_LINUX_TPACKET2_HDRLEN, data, size);
+    hdr->tp_len = size;
+    __sync_synchronize();
+    hdr->tp_status = NETDEV_LINUX_TP_STATUS_SEND_REQUEST;
+    netdev_linux_ring_advance(tx);
+    pthread_mutex_unlock(&rings->tx_mutex);
+
+    if (rejected) {
+        VLOG_WARN_RL(&rl, "%s: kernel rejected packet on transmit ring",
+                     netdev_get_name(&netdev->netdev));
+    }
+    COVERAGE_INC(netdev_linux_ring_tx);
+
+    do {
+        retval = send(netdev->fd, NULL, 0, MSG_DONTWAIT);
+    } while (retval < 0 && errno == EINTR);
+    if (retval < 0 && errno != EAGAIN && errno != ENOBUFS) {
+        VLOG_WARN_RL(&rl, "error sending Ethernet packet on %s: %s",
+                     netdev_get_name(&netdev->netdev), strerror(errno));
+        return errno;
+    }
+    return 0;
+}
+#else  /* !HAVE_PACKET_MMAP */
+static void
+netdev_linux_rings_setup(struct netdev_linux *netdev)
+{
+    VLOG_WARN("%s: PACKET_MMAP rings are not supported, using read() and "
+              "write()", netdev_get_name(&netdev->netdev));
+}
+
+static void
+netdev_linux_rings_destroy(struct netdev_linux *netdev OVS_UNUSED)
+{
+}
+
+static int
+netdev_linux_ring_recv(struct netdev_linux *netdev OVS_UNUSED,
+                       struct ofpbuf **buffers OVS_UNUSED,
+                       int n_buffers OVS_UNUSED)
+{
+    NOT_REACHED();
+}
+
+static void
+netdev_linux_ring_drain(struct netdev_linux *netdev OVS_UNUSED)
+{
+    NOT_REACHED();
+}
+
+static int
+netdev_linux_ring_send(struct netdev_linux *netdev OVS_UNUSED,
+                       const void *data OVS_UNUSED, size_t size OVS_UNUSED)
+{
+    NOT_REACHED();
+}
+#endif /* !HAVE_PACKET_MMAP */
+
+/* Sets whether network devices opened from now on try to use PACKET_MMAP
+ * receive and transmit rings.  Devices that are already open are not
+ * affected. */
+void
+netdev_linux_set_mmap_rings(bool enable)
+{
+    use_mmap_rings = enable;
+}
+
+static void
+netdev_linux_unixctl_set_mmap_rings(struct unixctl_conn *conn,
+                                    const char *args, void *aux OVS_UNUSED)
+{
+    if (!strcmp(args, "on")) {
+        netdev_linux_set_mmap_rings(true);
+    } else if (!strcmp(args, "off")) {
+        netdev_linux_set_mmap_rings(false);
+    } else {
+        unixctl_command_reply(conn, 501, "usage: "
+                              "netdev-linux/set-mmap-rings on|off");
+        return;
+    }
+    unixctl_command_reply(conn, 200, "");
+}
+
 static int
 netdev_linux_recv(struct netdev *netdev_, void *data, size_t size)
 {
@@ -759,6 +1183,15 @@ netdev_linux_recv(struct netdev *netdev_, void *data, size_t size)
     if (netdev->fd < 0) {
         /* Device was opened with NETDEV_ETH_TYPE_NONE. */
         return -EAGAIN;
+    } else if (netdev->rings) {
+        struct ofpbuf *b;
+        int retval = netdev_linux_ring_recv(netdev, &b, 1);
+        if (retval < 0) {
+            return retval;
+        }
+        size = MIN(size, b->size);
+        memcpy(data, b->data, size);
+        return size;
     }
 
     for (;;) {
@@ -775,6 +1208,74 @@ netdev_linux_recv(struct netdev *netdev_, void *data, size_t size)
     }
 }
 
+/* Receives up to 'n_buffers' packets from 'netdev' into 'buffers'.
+ *
+ * For devices opened through an AF_PACKET socket, this receives the whole
+ * batch straight out of the PACKET_MMAP receive ring, if one was set up, or
+ * otherwise with a single recvmmsg() system call, if it is available.  Tap
+ * devices, whose file descriptors are not sockets, fall back to read(). */
+static int
+netdev_linux_recv_batch(struct netdev *netdev_, struct ofpbuf **buffers,
+                        int n_buffers)
+{
+    struct netdev_linux *netdev = netdev_linux_cast(netdev_);
+    int i;
+
+    if (netdev->fd < 0) {
+        /* Device was opened with NETDEV_ETH_TYPE_NONE. */
+        return -EAGAIN;
+    } else if (netdev->rings) {
+        return netdev_linux_ring_recv(netdev, buffers, n_buffers);
+    }
+
+#ifdef HAVE_RECVMMSG
+    if (strcmp(netdev_get_type(netdev_), "tap")) {
+        struct mmsghdr mmsgs[NETDEV_MAX_BATCH];
+        struct iovec iovs[NETDEV_MAX_BATCH];
+        int retval;
+
+        n_buffers = MIN(n_buffers, NETDEV_MAX_BATCH);
+        memset(mmsgs, 0, n_buffers * sizeof *mmsgs);
+        for (i = 0; i < n_buffers; i++) {
+            iovs[i].iov_base = buffers[i]->data;
+            iovs[i].iov_len = ofpbuf_tailroom(buffers[i]);
+            mmsgs[i].msg_hdr.msg_iov = &iovs[i];
+            mmsgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        do {
+            retval = recvmmsg(netdev->fd, mmsgs, n_buffers, MSG_DONTWAIT,
+                              NULL);
+        } while (retval < 0 && errno == EINTR);
+
+        if (retval < 0) {
+            if (errno != EAGAIN) {
+                VLOG_WARN_RL(&rl, "error receiving Ethernet packets on %s: "
+                             "%s", netdev_get_name(netdev_), strerror(errno));
+            }
+            return -errno;
+        } else if (!retval) {
+            return -EAGAIN;
+        }
+
+        for (i = 0; i < retval; i++) {
+            buffers[i]->size += mmsgs[i].msg_len;
+        }
+        return retval;
+    }
+#endif
+
+    for (i = 0; i < n_buffers; i++) {
+        struct ofpbuf *b = buffers[i];
+        int retval = netdev_linux_recv(netdev_, b->data, ofpbuf_tailroom(b));
+        if (retval < 0) {
+            return i ? i : retval;
+        }
+        b->size += retval;
+    }
+    return i;
+}
+
 /* Registers with the poll loop to wake up from the next call to poll_block()
  * when a packet is ready to be received with netdev_recv() on 'netdev'. */
 static void
@@ -802,6 +1303,9 @@ netdev_linux_drain(struct netdev *netdev_)
         }
         drain_fd(netdev->fd, ifr.ifr_qlen);
         return 0;
+    } else if (netdev->rings) {
+        netdev_linux_ring_drain(netdev);
+        return 0;
     } else {
         return drain_rcvbuf(netdev->fd);
     }
@@ -825,6 +1329,8 @@ netdev_linux_send(struct netdev *netdev_, const void *data, size_t size)
      */
     if (netdev->fd < 0) {
         return EPIPE;
+    } else if (netdev->rings) {
+        return netdev_linux_ring_send(netdev, data, size);
     }
 
     for (;;) {
@@ -1120,14 +1626,19 @@ swap_uint64(uint64_t *a, uint64_t *b)
     *a ^= *b;
 }
 
-/* Retrieves current device stats for 'netdev'. */
+/* Retrieves current device stats for 'netdev'.
+ *
+ * If 'link_stats' is nonnull, it is a map from ifindex to "struct link_stats"
+ * obtained from a dump of every network device's stats with
+ * dump_link_stats(), which is used in place of querying the kernel about
+ * 'netdev' alone. */
 static int
-netdev_linux_get_stats(const struct netdev *netdev_,
-                       struct netdev_stats *stats)
+netdev_linux_get_stats__(const struct netdev *netdev_,
+                         struct netdev_stats *stats,
+                         const struct hmap *link_stats)
 {
     struct netdev_dev_linux *netdev_dev =
                                 netdev_dev_linux_cast(netdev_get_dev(netdev_));
-    static int use_netlink_stats = -1;
     int error;
 
     if (netdev_dev->have_vport_stats ||
@@ -1147,7 +1658,14 @@ netdev_linux_get_stats(const struct netdev *netdev_,
 
             error = get_ifindex(netdev_, &ifindex);
             if (!error) {
-                error = get_stats_via_netlink(ifindex, stats);
+                const struct link_stats *ls;
+
+                ls = link_stats ? find_link_stats(link_stats, ifindex) : NULL;
+                if (ls) {
+                    *stats = ls->stats;
+                } else {
+                    error = get_stats_via_netlink(ifindex, stats);
+                }
             }
         } else {
             error = get_stats_via_proc(netdev_get_name(netdev_), stats);
@@ -1183,6 +1701,46 @@ netdev_linux_get_stats(const struct netdev *netdev_,
     return error;
 }
 
+/* Retrieves current device stats for 'netdev'. */
+static int
+netdev_linux_get_stats(const struct netdev *netdev,
+                       struct netdev_stats *stats)
+{
+    return netdev_linux_get_stats__(netdev, stats, NULL);
+}
+
+/* Retrieves current device stats for each of the 'n' devices in 'netdevs'.
+ *
+ * Querying devices one at a time costs a Netlink transaction per device, so
+ * when more than one device needs stats from RTM_GETLINK this instead dumps
+ * the stats for every network device in the system with a single request and
+ * looks each device up in the result. */
+static void
+netdev_linux_get_stats_multiple(const struct netdev *const netdevs[], size_t n,
+                                struct netdev_stats stats[], int errors[])
+{
+    struct hmap link_stats;
+    bool dumped;
+    size_t i;
+
+    hmap_init(&link_stats);
+    dumped = false;
+    for (i = 0; i < n; i++) {
+        struct netdev_dev_linux *netdev_dev =
+            netdev_dev_linux_cast(netdev_get_dev(netdevs[i]));
+
+        if (!dumped && n > 1 && use_netlink_stats > 0
+            && !netdev_dev->have_vport_stats
+            && netdev_dev->cache_valid & VALID_HAVE_VPORT_STATS) {
+            dump_link_stats(&link_stats);
+            dumped = true;
+        }
+        errors[i] = netdev_linux_get_stats__(netdevs[i], &stats[i],
+                                             dumped ? &link_stats : NULL);
+    }
+    free_link_stats(&link_stats);
+}
+
 /* Stores the features supported by 'netdev' into each of '*current',
  * '*advertised', '*supported', and '*peer' that are non-null.  Each value is a
  * bitmap of "enum ofp_port_features" bits, in host byte order.  Returns 0 if
@@ -2210,6 +2768,7 @@ netdev_linux_poll_remove(struct netdev_notifier *notifier_)
     ENUMERATE,                                                  \
                                                                 \
     netdev_linux_recv,                                          \
+    netdev_linux_recv_batch,                                    \
     netdev_linux_recv_wait,                                     \
     netdev_linux_drain,                                         \
                                                                 \
@@ -2223,6 +2782,7 @@ netdev_linux_poll_remove(struct netdev_notifier *notifier_)
     netdev_linux_get_carrier,                                   \
     netdev_linux_get_miimon,                                    \
     netdev_linux_get_stats,                                     \
+    netdev_linux_get_stats_multiple,                            \
     SET_STATS,                                                  \
                                                                 \
     netdev_linux_get_features,                                  \
@@ -3886,8 +4446,11 @@ tc_calc_buffer(unsigned int Bps, int mtu, uint64_t burst_bytes)
 
 /* Utility functions. */
 
+/* Parses 'msg', an RTM_NEWLINK message, storing the network device
+ * statistics that it contains into 'stats'.  Returns 0 if successful,
+ * otherwise a positive errno value. */
 static int
-get_stats_via_netlink(int ifindex, struct netdev_stats *stats)
+parse_link_stats(const struct ofpbuf *msg, struct netdev_stats *stats)
 {
     /* Policy for RTNLGRP_LINK messages.
      *
@@ -3899,34 +4462,17 @@ get_stats_via_netlink(int ifindex, struct netdev_stats *stats)
                          .min_len = sizeof(struct rtnl_link_stats) },
     };
 
-    struct ofpbuf request;
-    struct ofpbuf *reply;
-    struct ifinfomsg *ifi;
     const struct rtnl_link_stats *rtnl_stats;
     struct nlattr *attrs[ARRAY_SIZE(rtnlgrp_link_policy)];
-    int error;
-
-    ofpbuf_init(&request, 0);
-    nl_msg_put_nlmsghdr(&request, sizeof *ifi, RTM_GETLINK, NLM_F_REQUEST);
-    ifi = ofpbuf_put_zeros(&request, sizeof *ifi);
-    ifi->ifi_family = PF_UNSPEC;
-    ifi->ifi_index = ifindex;
-    error = nl_sock_transact(rtnl_sock, &request, &reply);
-    ofpbuf_uninit(&request);
-    if (error) {
-        return error;
-    }
 
-    if (!nl_policy_parse(reply, NLMSG_HDRLEN + sizeof(struct ifinfomsg),
+    if (!nl_policy_parse(msg, NLMSG_HDRLEN + sizeof(struct ifinfomsg),
                          rtnlgrp_link_policy,
                          attrs, ARRAY_SIZE(rtnlgrp_link_policy))) {
-        ofpbuf_delete(reply);
         return EPROTO;
     }
 
     if (!attrs[IFLA_STATS]) {
         VLOG_WARN_RL(&rl, "RTM_GETLINK reply lacks stats");
-        ofpbuf_delete(reply);
         return EPROTO;
     }
 
@@ -3953,9 +4499,108 @@ get_stats_via_netlink(int ifindex, struct netdev_stats *stats)
     stats->tx_heartbeat_errors = rtnl_stats->tx_heartbeat_errors;
     stats->tx_window_errors = rtnl_stats->tx_window_errors;
 
+    return 0;
+}
+
+static int
+get_stats_via_netlink(int ifindex, struct netdev_stats *stats)
+{
+    struct ofpbuf request;
+    struct ofpbuf *reply;
+    struct ifinfomsg *ifi;
+    int error;
+
+    COVERAGE_INC(netdev_linux_stats_query);
+    ofpbuf_init(&request, 0);
+    nl_msg_put_nlmsghdr(&request, sizeof *ifi, RTM_GETLINK, NLM_F_REQUEST);
+    ifi = ofpbuf_put_zeros(&request, sizeof *ifi);
+    ifi->ifi_family = PF_UNSPEC;
+    ifi->ifi_index = ifindex;
+    error = nl_sock_transact(rtnl_sock, &request, &reply);
+    ofpbuf_uninit(&request);
+    if (error) {
+        return error;
+    }
+
+    error = parse_link_stats(reply, stats);
     ofpbuf_delete(reply);
 
-    return 0;
+    return error;
+}
+
+/* Dumps the statistics for every network device in the system with a single
+ * RTM_GETLINK request and adds a "struct link_stats" for each one to
+ * 'link_stats', which the caller must already have initialized.  On error,
+ * logs a warning and leaves out the devices that were not dumped, so that the
+ * caller falls back to querying those devices individually. */
+static void
+dump_link_stats(struct hmap *link_stats)
+{
+    struct ofpbuf request, msg;
+    struct ifinfomsg *ifi;
+    struct nl_dump dump;
+    int error;
+
+    COVERAGE_INC(netdev_linux_stats_dump);
+    ofpbuf_init(&request, 0);
+    nl_msg_put_nlmsghdr(&request, sizeof *ifi, RTM_GETLINK, NLM_F_REQUEST);
+    ifi = ofpbuf_put_zeros(&request, sizeof *ifi);
+    ifi->ifi_family = PF_UNSPEC;
+    nl_dump_start(&dump, rtnl_sock, &request);
+    ofpbuf_uninit(&request);
+
+    while (nl_dump_next(&dump, &msg)) {
+        const struct ifinfomsg *reply_ifi;
+        struct link_stats *ls;
+
+        reply_ifi = ofpbuf_at(&msg, NLMSG_HDRLEN, sizeof *reply_ifi);
+        if (!reply_ifi) {
+            continue;
+        }
+
+        ls = xmalloc(sizeof *ls);
+        if (parse_link_stats(&msg, &ls->stats)) {
+            free(ls);
+            continue;
+        }
+        ls->ifindex = reply_ifi->ifi_index;
+        hmap_insert(link_stats, &ls->hmap_node, hash_int(ls->ifindex, 0));
+    }
+
+    error = nl_dump_done(&dump);
+    if (error) {
+        VLOG_WARN_RL(&rl, "failed to dump network device statistics (%s)",
+                     strerror(error));
+    }
+}
+
+/* Returns the "struct link_stats" for 'ifindex' in 'link_stats', or a null
+ * pointer if there is none. */
+static const struct link_stats *
+find_link_stats(const struct hmap *link_stats, int ifindex)
+{
+    const struct link_stats *ls;
+
+    HMAP_FOR_EACH_IN_BUCKET (ls, hmap_node, hash_int(ifindex, 0), link_stats) {
+        if (ls->ifindex == ifindex) {
+            return ls;
+        }
+    }
+    return NULL;
+}
+
+/* Frees all of the "struct link_stats" in 'link_stats' and then 'link_stats'
+ * itself. */
+static void
+free_link_stats(struct hmap *link_stats)
+{
+    struct link_stats *ls, *next;
+
+    HMAP_FOR_EACH_SAFE (ls, next, hmap_node, link_stats) {
+        hmap_remove(link_stats, &ls->hmap_node);
+        free(ls);
+    }
+    hmap_destroy(link_stats);
 }
 
 static int
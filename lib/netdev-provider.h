@@ -180,6 +180,27 @@ struct netdev_class {
      * datapath".) */
     int (*recv)(struct netdev *netdev, void *buffer, size_t size);
 
+    /* Attempts to receive up to 'n_buffers' packets from 'netdev', one into
+     * the tailroom of each of the ofpbufs in 'buffers', increasing each
+     * buffer's 'size' by the length of the packet received into it.  Each
+     * buffer is initially empty and its tailroom is large enough for any
+     * packet that 'recv' could return.  If successful, returns the number of
+     * packets received, which must be at least 1, otherwise a negative errno
+     * value.  Returns -EAGAIN immediately if no packet is ready to be
+     * received.
+     *
+     * Instead of copying a packet into the caller's buffer, an implementation
+     * may replace the corresponding pointer in 'buffers' by one to an ofpbuf
+     * of its own, e.g. an OFPBUF_RING buffer that refers to a frame shared
+     * with the kernel.  Such a buffer must remain valid until the next call
+     * to 'recv', 'recv_batch', 'drain', or 'close' on 'netdev'.
+     *
+     * This function may be set to null, in which case netdev_recv_batch()
+     * calls 'recv' repeatedly instead.  It is only worthwhile to implement it
+     * if 'netdev' can receive packets in batch faster than individually. */
+    int (*recv_batch)(struct netdev *netdev, struct ofpbuf **buffers,
+                      int n_buffers);
+
     /* Registers with the poll loop to wake up from the next call to
      * poll_block() when a packet is ready to be received with netdev_recv() on
      * 'netdev'.
@@ -277,6 +298,20 @@ struct netdev_class {
      * (UINT64_MAX). */
     int (*get_stats)(const struct netdev *netdev, struct netdev_stats *);
 
+    /* Retrieves current device stats for each of the 'n' devices in
+     * 'netdevs' into the corresponding element of 'stats', and stores 0 or a
+     * positive errno value, as 'get_stats' would return, into the
+     * corresponding element of 'errors'.  Each of 'netdevs' belongs to a class
+     * whose 'get_stats_multiple' is this same function, although not
+     * necessarily to this class.
+     *
+     * This function may be set to null, in which case
+     * netdev_get_stats_multiple() calls 'get_stats' for each device.  It is
+     * only worth implementing if a provider can obtain the stats for many
+     * devices faster than one at a time. */
+    void (*get_stats_multiple)(const struct netdev *const netdevs[], size_t n,
+                               struct netdev_stats stats[], int errors[]);
+
     /* Sets the device stats for 'netdev' to 'stats'.
      *
      * Most network devices won't support this feature and will set this
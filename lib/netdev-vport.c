@@ -933,6 +933,7 @@ unparse_patch_config(const char *name OVS_UNUSED, const char *type OVS_UNUSED,
     NULL,                       /* enumerate */             \
                                                             \
     NULL,                       /* recv */                  \
+    NULL,                       /* recv_batch */            \
     NULL,                       /* recv_wait */             \
     NULL,                       /* drain */                 \
                                                             \
@@ -946,6 +947,7 @@ unparse_patch_config(const char *name OVS_UNUSED, const char *type OVS_UNUSED,
     NULL,                       /* get_carrier */           \
     NULL,                       /* get_miimon */            \
     netdev_vport_get_stats,                                 \
+    NULL,                       /* get_stats_multiple */    \
     netdev_vport_set_stats,                                 \
                                                             \
     NULL,                       /* get_features */          \
@@ -25,6 +25,7 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "bitmap.h"
 #include "coverage.h"
 #include "dynamic-string.h"
 #include "fatal-signal.h"
@@ -426,6 +427,82 @@ netdev_recv(struct netdev *netdev, struct ofpbuf *buffer)
     }
 }
 
+/* Attempts to receive up to 'n_buffers' packets from 'netdev', one into each
+ * of the ofpbufs in 'buffers'.  Each buffer must be empty and otherwise
+ * satisfy the requirements that netdev_recv() places on its 'buffer'.  This
+ * function receives at most NETDEV_MAX_BATCH packets, regardless of
+ * 'n_buffers'.
+ *
+ * If at least one packet is successfully retrieved, returns 0 and stores the
+ * number of packets received into '*n_received'.  The first '*n_received'
+ * buffers then hold a packet apiece, each at least ETH_TOTAL_MIN bytes long.
+ * Otherwise, returns a positive errno value and stores 0 into '*n_received'.
+ * Returns EAGAIN immediately if no packet is ready to be returned.
+ *
+ * Some network devices avoid copying packets by replacing pointers in
+ * 'buffers' with pointers to buffers owned by 'netdev', which refer directly
+ * to memory shared with the kernel.  The caller may modify these buffers (if
+ * they must be reallocated, their data is first copied to malloc()'d memory)
+ * but must not free them.  They remain valid only until the next call to
+ * netdev_recv(), netdev_recv_batch(), netdev_drain(), or netdev_close() on
+ * 'netdev', so the caller should finish processing them, e.g. by executing
+ * their actions, before receiving more packets.
+ *
+ * Some network devices may not implement support for this function.  In such
+ * cases this function will always return EOPNOTSUPP. */
+int
+netdev_recv_batch(struct netdev *netdev, struct ofpbuf **buffers,
+                  int n_buffers, int *n_received)
+{
+    const struct netdev_class *class = netdev_get_dev(netdev)->netdev_class;
+    int retval;
+    int i;
+
+    n_buffers = MIN(n_buffers, NETDEV_MAX_BATCH);
+    for (i = 0; i < n_buffers; i++) {
+        assert(buffers[i]->size == 0);
+        assert(ofpbuf_tailroom(buffers[i]) >= ETH_TOTAL_MIN);
+    }
+
+    if (class->recv_batch) {
+        retval = class->recv_batch(netdev, buffers, n_buffers);
+    } else if (class->recv) {
+        retval = -EAGAIN;
+        for (i = 0; i < n_buffers; i++) {
+            struct ofpbuf *b = buffers[i];
+            int size = class->recv(netdev, b->data, ofpbuf_tailroom(b));
+            if (size < 0) {
+                /* Report the packets already received, if any.  Otherwise,
+                 * report the error, which is -EAGAIN if the device simply
+                 * had nothing more to receive. */
+                retval = size;
+                break;
+            }
+            b->size += size;
+        }
+        if (i) {
+            retval = i;
+        }
+    } else {
+        retval = -EOPNOTSUPP;
+    }
+
+    if (retval > 0) {
+        COVERAGE_ADD(netdev_received, retval);
+        for (i = 0; i < retval; i++) {
+            struct ofpbuf *b = buffers[i];
+            if (b->size < ETH_TOTAL_MIN) {
+                ofpbuf_put_zeros(b, ETH_TOTAL_MIN - b->size);
+            }
+        }
+        *n_received = retval;
+        return 0;
+    } else {
+        *n_received = 0;
+        return -retval;
+    }
+}
+
 /* Registers with the poll loop to wake up from the next call to poll_block()
  * when a packet is ready to be received with netdev_recv() on 'netdev'. */
 void
@@ -930,6 +1007,76 @@ netdev_get_stats(const struct netdev *netdev, struct netdev_stats *stats)
     return error;
 }
 
+/* Retrieves current device stats for each of the 'n' devices in 'netdevs' into
+ * the corresponding element of 'stats', and stores 0 or a positive errno
+ * value into the corresponding element of 'errors', with the same results as
+ * calling netdev_get_stats() on each device in turn.  Some network device
+ * providers can obtain the stats for many devices more cheaply this way. */
+void
+netdev_get_stats_multiple(const struct netdev *const netdevs[], size_t n,
+                          struct netdev_stats stats[], int errors[])
+{
+    struct netdev_stats *batch_stats;
+    const struct netdev **batch;
+    unsigned long *done;
+    size_t *indexes;
+    int *batch_errors;
+    size_t i;
+
+    batch = xmalloc(n * sizeof *batch);
+    batch_stats = xmalloc(n * sizeof *batch_stats);
+    batch_errors = xmalloc(n * sizeof *batch_errors);
+    indexes = xmalloc(n * sizeof *indexes);
+    done = bitmap_allocate(n);
+    for (i = 0; i < n; i++) {
+        const struct netdev_class *class;
+        size_t n_batch, j;
+
+        if (bitmap_is_set(done, i)) {
+            continue;
+        }
+
+        class = netdev_get_dev(netdevs[i])->netdev_class;
+        if (!class->get_stats_multiple) {
+            errors[i] = netdev_get_stats(netdevs[i], &stats[i]);
+            continue;
+        }
+
+        /* Gather every remaining device whose provider shares this
+         * implementation, so that it can query all of them together. */
+        n_batch = 0;
+        for (j = i; j < n; j++) {
+            const struct netdev_class *class_j;
+
+            class_j = netdev_get_dev(netdevs[j])->netdev_class;
+            if (!bitmap_is_set(done, j)
+                && class_j->get_stats_multiple == class->get_stats_multiple) {
+                bitmap_set1(done, j);
+                indexes[n_batch] = j;
+                batch[n_batch++] = netdevs[j];
+            }
+        }
+
+        COVERAGE_ADD(netdev_get_stats, n_batch);
+        class->get_stats_multiple(batch, n_batch, batch_stats, batch_errors);
+        for (j = 0; j < n_batch; j++) {
+            size_t idx = indexes[j];
+
+            errors[idx] = batch_errors[j];
+            if (errors[idx]) {
+                memset(&stats[idx], 0xff, sizeof stats[idx]);
+            } else {
+                stats[idx] = batch_stats[j];
+            }
+        }
+    }
+    bitmap_free(done);
+    free(indexes);
+    free(batch_errors);
+    free(batch_stats);
+    free(batch);
+}
+
 /* Attempts to change the stats for 'netdev' to those provided in 'stats'.
  * Returns 0 if successful, otherwise a positive errno value.
  *
@@ -116,7 +116,10 @@ int netdev_get_mtu(const struct netdev *, int *mtup);
 int netdev_get_ifindex(const struct netdev *);
 
 /* Packet send and receive. */
+enum { NETDEV_MAX_BATCH = 32 }; /* Max packets per netdev_recv_batch(). */
 int netdev_recv(struct netdev *, struct ofpbuf *);
+int netdev_recv_batch(struct netdev *, struct ofpbuf **buffers, int n_buffers,
+                      int *n_received);
 void netdev_recv_wait(struct netdev *);
 int netdev_drain(struct netdev *);
 
@@ -156,6 +159,8 @@ struct netdev *netdev_find_dev_by_in4(const struct in_addr *);
 
 /* Statistics. */
 int netdev_get_stats(const struct netdev *, struct netdev_stats *);
+void netdev_get_stats_multiple(const struct netdev *const netdevs[], size_t n,
+                               struct netdev_stats stats[], int errors[]);
 int netdev_set_stats(struct netdev *, const struct netdev_stats *);
 
 /* Quality of service. */
@@ -496,6 +496,159 @@ recv:
     return 0;
 }
 
+/* Maximum number of requests, and maximum total size of requests, that
+ * nl_sock_transact_multiple() passes to the kernel in a single sendmsg(). */
+#define NL_MAX_BATCH 64
+#define NL_MAX_BATCH_BYTES 65536
+
+static int
+nl_sock_transact_multiple__(struct nl_sock *sock,
+                            struct nl_transaction **transactions, size_t n,
+                            size_t *done)
+{
+    struct iovec iovs[NL_MAX_BATCH];
+    size_t n_bytes;
+    struct msghdr msg;
+    int error;
+    size_t i;
+
+    n_bytes = 0;
+    for (i = 0; i < n && i < NL_MAX_BATCH; i++) {
+        struct nl_transaction *txn = transactions[i];
+        struct nlmsghdr *nlmsg = nl_msg_nlmsghdr(txn->request);
+
+        if (i && n_bytes + txn->request->size > NL_MAX_BATCH_BYTES) {
+            break;
+        }
+        n_bytes += txn->request->size;
+
+        nlmsg->nlmsg_len = txn->request->size;
+        nlmsg->nlmsg_pid = sock->pid;
+        nlmsg->nlmsg_flags |= NLM_F_ACK;
+
+        iovs[i].iov_base = txn->request->data;
+        iovs[i].iov_len = txn->request->size;
+    }
+    n = i;
+
+    memset(&msg, 0, sizeof msg);
+    msg.msg_iov = iovs;
+    msg.msg_iovlen = n;
+    do {
+        int retval = sendmsg(sock->fd, &msg, 0);
+        error = retval < 0 ? errno : 0;
+    } while (error == EINTR);
+    for (i = 0; i < n; i++) {
+        log_nlmsg(__func__, error, iovs[i].iov_base, iovs[i].iov_len,
+                  sock->protocol);
+    }
+    if (error) {
+        return error;
+    }
+    COVERAGE_ADD(netlink_sent, n);
+
+    /* Each request yields zero or more replies followed by an
+     * acknowledgement (or error) carrying the request's sequence number, and
+     * the kernel processes the requests in order. */
+    while (*done < n) {
+        struct nl_transaction *txn;
+        struct ofpbuf *reply;
+        uint32_t seq;
+        int txn_error;
+
+        error = nl_sock_recv__(sock, &reply, true);
+        if (error) {
+            return error;
+        }
+
+        seq = nl_msg_nlmsghdr(reply)->nlmsg_seq;
+        for (i = *done; i < n; i++) {
+            if (nl_msg_nlmsghdr(transactions[i]->request)->nlmsg_seq == seq) {
+                break;
+            }
+        }
+        if (i >= n) {
+            VLOG_DBG_RL(&rl, "ignoring unexpected seq %#"PRIx32, seq);
+            ofpbuf_delete(reply);
+            continue;
+        }
+        *done = i;
+        txn = transactions[i];
+
+        if (nl_msg_nlmsgerr(reply, &txn_error)) {
+            ofpbuf_delete(reply);
+            if (txn_error) {
+                VLOG_DBG_RL(&rl, "received NAK error=%d (%s)",
+                            txn_error, strerror(txn_error));
+                ofpbuf_delete(txn->reply);
+                txn->reply = NULL;
+                txn->error = txn_error != EAGAIN ? txn_error : EPROTO;
+            }
+            (*done)++;
+        } else {
+            ofpbuf_delete(txn->reply);
+            txn->reply = reply;
+        }
+    }
+
+    return 0;
+}
+
+/* Sends the 'request' member of the 'n' transactions in 'transactions' to the
+ * kernel, in order, and waits for responses to all of them.  Fills in the
+ * 'error' member of each transaction with 0 if it was successful, otherwise
+ * with a positive errno value.  If 'reply' is nonnull, then it will be filled
+ * with the reply if the message receives a detailed reply.  In other cases,
+ * i.e. where the request failed or had no reply beyond an indication of
+ * success, 'reply' will be cleared if it is nonnull.
+ *
+ * The caller is responsible for destroying each request and reply, and the
+ * transactions array itself.
+ *
+ * Before sending each message, this function will finalize nlmsg_len in each
+ * 'request' to match the ofpbuf's size, set nlmsg_pid to 'sock''s pid, and
+ * set NLM_F_ACK.
+ *
+ * Many requests are sent to the kernel in a single system call, which is much
+ * cheaper than a nl_sock_transact() per request.  As with nl_sock_transact(),
+ * if the kernel drops a reply, the requests that have not yet been answered
+ * are resent, so they need to be idempotent. */
+void
+nl_sock_transact_multiple(struct nl_sock *sock,
+                          struct nl_transaction **transactions, size_t n)
+{
+    int error;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        transactions[i]->reply = NULL;
+        transactions[i]->error = 0;
+    }
+
+    error = nl_sock_cow__(sock);
+    while (n > 0 && !error) {
+        size_t done = 0;
+
+        error = nl_sock_transact_multiple__(sock, transactions, n, &done);
+        if (error == ENOBUFS) {
+            COVERAGE_INC(netlink_overflow);
+            VLOG_DBG_RL(&rl, "receive buffer overflow, resending requests");
+            error = 0;
+        }
+        transactions += done;
+        n -= done;
+    }
+
+    if (error) {
+        VLOG_ERR_RL(&rl, "transaction error (%s)", strerror(error));
+        for (i = 0; i < n; i++) {
+            ofpbuf_delete(transactions[i]->reply);
+            transactions[i]->reply = NULL;
+            transactions[i]->error = error;
+        }
+    }
+}
+
 /* Drain all the messages currently in 'sock''s receive queue. */
 int
 nl_sock_drain(struct nl_sock *sock)
@@ -573,7 +726,7 @@ nl_dump_start(struct nl_dump *dump,
     struct nlmsghdr *nlmsghdr = nl_msg_nlmsghdr(request);
     nlmsghdr->nlmsg_flags |= NLM_F_DUMP | NLM_F_ACK;
     dump->seq = nlmsghdr->nlmsg_seq;
-    dump->buffer = NULL;
+    dump->buffer = ofpbuf_new(NL_DUMP_BUFSIZE);
     if (sock->any_groups || sock->dump) {
         /* 'sock' might belong to some multicast group, or it already has an
          * onoging dump.  Clone the socket to avoid possibly intermixing
@@ -590,31 +743,68 @@ nl_dump_start(struct nl_dump *dump,
     dump->status = nl_sock_send__(sock, request, true);
 }
 
-/* Helper function for nl_dump_next(). */
+/* Helper function for nl_dump_next().  Receives the next datagram of replies
+ * into 'dump->buffer', replacing its previous contents.
+ *
+ * Unlike nl_sock_recv__(), this reads each datagram with a single system call
+ * into a buffer that is reused for the whole dump.  A dump's replies arrive
+ * packed many to a datagram, and the kernel sizes those datagrams partly by
+ * the size of the buffers that it sees userspace receive into, so this also
+ * tends to reduce the number of datagrams. */
 static int
-nl_dump_recv(struct nl_dump *dump, struct ofpbuf **bufferp)
+nl_dump_recv(struct nl_dump *dump)
 {
+    struct ofpbuf *buffer = dump->buffer;
     struct nlmsghdr *nlmsghdr;
-    struct ofpbuf *buffer;
-    int retval;
+    struct iovec iov;
+    struct msghdr msg;
+    ssize_t retval;
+    int error;
 
-    retval = nl_sock_recv__(dump->sock, bufferp, true);
-    if (retval) {
-        return retval == EINTR ? EAGAIN : retval;
+    ofpbuf_clear(buffer);
+    iov.iov_base = buffer->data;
+    iov.iov_len = buffer->allocated;
+    memset(&msg, 0, sizeof msg);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    do {
+        retval = recvmsg(dump->sock->fd, &msg, 0);
+    } while (retval < 0 && errno == EINTR);
+    if (retval < 0) {
+        error = errno;
+        if (error == ENOBUFS) {
+            COVERAGE_INC(netlink_overflow);
+        }
+        return error;
+    }
+    if (msg.msg_flags & MSG_TRUNC) {
+        VLOG_ERR_RL(&rl, "netlink dump reply truncated to %zu bytes",
+                    buffer->allocated);
+        return EPROTO;
     }
-    buffer = *bufferp;
+    buffer->size = retval;
 
     nlmsghdr = nl_msg_nlmsghdr(buffer);
+    if (retval < sizeof *nlmsghdr
+        || nlmsghdr->nlmsg_len < sizeof *nlmsghdr
+        || nlmsghdr->nlmsg_len > retval) {
+        VLOG_ERR_RL(&rl, "received invalid nlmsg (%zd bytes < %d)",
+                    retval, NLMSG_HDRLEN);
+        return EPROTO;
+    }
+    log_nlmsg(__func__, 0, buffer->data, buffer->size, dump->sock->protocol);
+    COVERAGE_INC(netlink_received);
+
     if (dump->seq != nlmsghdr->nlmsg_seq) {
         VLOG_DBG_RL(&rl, "ignoring seq %#"PRIx32" != expected %#"PRIx32,
                     nlmsghdr->nlmsg_seq, dump->seq);
         return EAGAIN;
     }
 
-    if (nl_msg_nlmsgerr(buffer, &retval)) {
+    if (nl_msg_nlmsgerr(buffer, &error)) {
         VLOG_INFO_RL(&rl, "netlink dump request error (%s)",
-                     strerror(retval));
-        return retval && retval != EAGAIN ? retval : EPROTO;
+                     strerror(error));
+        return error && error != EAGAIN ? error : EPROTO;
     }
 
     return 0;
@@ -643,15 +833,10 @@ nl_dump_next(struct nl_dump *dump, struct ofpbuf *reply)
         return false;
     }
 
-    if (dump->buffer && !dump->buffer->size) {
-        ofpbuf_delete(dump->buffer);
-        dump->buffer = NULL;
-    }
-    while (!dump->buffer) {
-        int retval = nl_dump_recv(dump, &dump->buffer);
+    while (!dump->buffer->size) {
+        int retval = nl_dump_recv(dump);
         if (retval) {
-            ofpbuf_delete(dump->buffer);
-            dump->buffer = NULL;
+            ofpbuf_clear(dump->buffer);
             if (retval != EAGAIN) {
                 dump->status = retval;
                 return false;
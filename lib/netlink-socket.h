@@ -61,13 +61,30 @@ int nl_sock_transact(struct nl_sock *, const struct ofpbuf *request,
 
 int nl_sock_drain(struct nl_sock *);
 
+/* Batching transactions. */
+struct nl_transaction {
+    /* Filled in by client. */
+    struct ofpbuf *request;     /* Request to send. */
+
+    /* Filled in by nl_sock_transact_multiple(). */
+    struct ofpbuf *reply;       /* Reply (NULL if reply was an error code). */
+    int error;                  /* Positive errno value, 0 if no error. */
+};
+
+void nl_sock_transact_multiple(struct nl_sock *,
+                               struct nl_transaction **, size_t n);
+
 void nl_sock_wait(const struct nl_sock *, short int events);
 
 /* Table dumping. */
+
+/* Size of the buffer into which nl_dump_next() receives dump replies. */
+#define NL_DUMP_BUFSIZE 65536
+
 struct nl_dump {
     struct nl_sock *sock;       /* Socket being dumped. */
     uint32_t seq;               /* Expected nlmsg_seq for replies. */
-    struct ofpbuf *buffer;      /* Receive buffer currently being iterated. */
+    struct ofpbuf *buffer;      /* Replies received but not yet iterated. */
     int status;                 /* 0=OK, EOF=done, or positive errno value. */
 };
 
@@ -55,7 +55,6 @@ enum nxm_field_index {
 };
 
 struct nxm_field {
-    struct hmap_node hmap_node;
     enum nxm_field_index index;       /* NFI_* value. */
     uint32_t header;                  /* NXM_* value. */
     flow_wildcards_t wildcard;        /* FWW_* bit, if exactly one. */
@@ -67,17 +66,14 @@ struct nxm_field {
 
 
 /* All the known fields. */
-static struct nxm_field nxm_fields[N_NXM_FIELDS] = {
+static const struct nxm_field nxm_fields[N_NXM_FIELDS] = {
 #define DEFINE_FIELD(HEADER, WILDCARD, DL_TYPES, NW_PROTO, WRITABLE)     \
-    { HMAP_NODE_NULL_INITIALIZER, NFI_NXM_##HEADER, NXM_##HEADER, WILDCARD, \
-        DL_CONVERT DL_TYPES, NW_PROTO, "NXM_" #HEADER, WRITABLE },
+    { NFI_NXM_##HEADER, NXM_##HEADER, WILDCARD, DL_CONVERT DL_TYPES,    \
+      NW_PROTO, "NXM_" #HEADER, WRITABLE },
 #define DL_CONVERT(T1, T2) { CONSTANT_HTONS(T1), CONSTANT_HTONS(T2) }
 #include "nx-match.def"
 };
 
-/* Hash table of 'nxm_fields'. */
-static struct hmap all_nxm_fields = HMAP_INITIALIZER(&all_nxm_fields);
-
 /* Possible masks for NXM_OF_ETH_DST_W. */
 static const uint8_t eth_all_0s[ETH_ADDR_LEN]
     = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
@@ -88,43 +84,23 @@ static const uint8_t eth_mcast_1[ETH_ADDR_LEN]
 static const uint8_t eth_mcast_0[ETH_ADDR_LEN]
     = {0xfe, 0xff, 0xff, 0xff, 0xff, 0xff};
 
-static void
-nxm_init(void)
-{
-    if (hmap_is_empty(&all_nxm_fields)) {
-        int i;
-
-        for (i = 0; i < N_NXM_FIELDS; i++) {
-            struct nxm_field *f = &nxm_fields[i];
-            hmap_insert(&all_nxm_fields, &f->hmap_node,
-                        hash_int(f->header, 0));
-        }
-
-        /* Verify that the header values are unique (duplicate "case" values
-         * cause a compile error). */
-        switch (0) {
-#define DEFINE_FIELD(HEADER, WILDCARD, DL_TYPE, NW_PROTO, WRITABLE)  \
-        case NXM_##HEADER: break;
-#include "nx-match.def"
-        }
-    }
-}
-
+/* Returns the field whose NXM_* value is 'header', or a null pointer if there
+ * is no such field.
+ *
+ * This is on the path of every nxm_entry that nx_pull_match() decodes, so it
+ * is a switch that the compiler can turn into a jump table or a binary search
+ * instead of a hash table lookup.  Duplicate header values also cause a compile
+ * error. */
 static const struct nxm_field *
 nxm_field_lookup(uint32_t header)
 {
-    struct nxm_field *f;
-
-    nxm_init();
-
-    HMAP_FOR_EACH_WITH_HASH (f, hmap_node, hash_int(header, 0),
-                             &all_nxm_fields) {
-        if (f->header == header) {
-            return f;
-        }
+    switch (header) {
+#define DEFINE_FIELD(HEADER, WILDCARD, DL_TYPES, NW_PROTO, WRITABLE)     \
+    case NXM_##HEADER: return &nxm_fields[NFI_NXM_##HEADER];
+#include "nx-match.def"
+    default:
+        return NULL;
     }
-
-    return NULL;
 }
 
 /* Returns the width of the data for a field with the given 'header', in
@@ -155,23 +131,73 @@ parse_nx_reg(const struct nxm_field *f,
     if (wc->reg_masks[idx]) {
         return NXM_DUP_TYPE;
     } else {
-        flow_wildcards_set_reg_mask(wc, idx,
-                                    (NXM_HASMASK(f->header)
-                                     ? ntohl(get_unaligned_be32(maskp))
-                                     : UINT32_MAX));
+        wc->reg_masks[idx] = (maskp
+                              ? ntohl(get_unaligned_be32(maskp))
+                              : UINT32_MAX);
         flow->regs[idx] = ntohl(get_unaligned_be32(value));
         flow->regs[idx] &= wc->reg_masks[idx];
         return 0;
     }
 }
 
+/* Decodes an IPv6 address 'value' with optional CIDR 'mask' into '*addrp' and
+ * '*maskp'. */
 static int
-parse_nxm_entry(struct cls_rule *rule, const struct nxm_field *f,
-                const void *value, const void *mask)
+parse_nx_ipv6(struct in6_addr *addrp, struct in6_addr *maskp,
+              const void *value, const void *mask)
 {
-    struct flow_wildcards *wc = &rule->wc;
-    struct flow *flow = &rule->flow;
+    struct in6_addr addr, netmask;
+
+    if (!ipv6_mask_is_any(maskp)) {
+        return NXM_DUP_TYPE;
+    }
 
+    if (mask) {
+        memcpy(&netmask, mask, sizeof netmask);
+        if (!ipv6_is_cidr(&netmask)) {
+            return NXM_BAD_MASK;
+        }
+    } else {
+        netmask = in6addr_exact;
+    }
+    memcpy(&addr, value, sizeof addr);
+    *addrp = ipv6_addr_bitand(&addr, &netmask);
+    *maskp = netmask;
+    return 0;
+}
+
+/* Decodes an IPv4 address 'value' with optional CIDR 'mask' into '*addrp' and
+ * '*maskp'. */
+static int
+parse_nx_ip(ovs_be32 *addrp, ovs_be32 *maskp,
+            const void *value, const void *mask)
+{
+    ovs_be32 netmask;
+
+    if (*maskp) {
+        return NXM_DUP_TYPE;
+    }
+
+    netmask = mask ? get_unaligned_be32(mask) : htonl(UINT32_MAX);
+    if (!ip_is_cidr(netmask)) {
+        return NXM_BAD_MASK;
+    }
+    *maskp = netmask;
+    *addrp = get_unaligned_be32(value) & netmask;
+    return 0;
+}
+
+/* Decodes the nxm_entry for field 'f' with the given 'value' and 'mask' (which
+ * is a null pointer if 'f' is not a masked field) into 'flow' and 'wc'.
+ *
+ * The caller has already checked 'f''s prerequisites and cleared its FWW_*
+ * bit, if any.  Everything else is stored directly into 'flow' and 'wc'
+ * instead of through the cls_rule_set_*() functions. */
+static int
+parse_nxm_entry(struct flow *flow, struct flow_wildcards *wc,
+                const struct nxm_field *f,
+                const void *value, const void *mask)
+{
     switch (f->index) {
         /* Metadata. */
     case NFI_NXM_OF_IN_PORT:
@@ -222,18 +248,13 @@ parse_nxm_entry(struct cls_rule *rule, const struct nxm_field *f,
 
         /* 802.1Q header. */
     case NFI_NXM_OF_VLAN_TCI:
-        if (wc->vlan_tci_mask) {
-            return NXM_DUP_TYPE;
-        } else {
-            cls_rule_set_dl_tci(rule, get_unaligned_be16(value));
-            return 0;
-        }
     case NFI_NXM_OF_VLAN_TCI_W:
         if (wc->vlan_tci_mask) {
             return NXM_DUP_TYPE;
         } else {
-            cls_rule_set_dl_tci_masked(rule, get_unaligned_be16(value),
-                                       get_unaligned_be16(mask));
+            wc->vlan_tci_mask = mask ? get_unaligned_be16(mask)
+                                     : htons(UINT16_MAX);
+            flow->vlan_tci = get_unaligned_be16(value) & wc->vlan_tci_mask;
             return 0;
         }
 
@@ -251,89 +272,25 @@ parse_nxm_entry(struct cls_rule *rule, const struct nxm_field *f,
 
         /* IP addresses in IP and ARP headers. */
     case NFI_NXM_OF_IP_SRC:
-    case NFI_NXM_OF_ARP_SPA:
-        if (wc->nw_src_mask) {
-            return NXM_DUP_TYPE;
-        } else {
-            cls_rule_set_nw_src(rule, get_unaligned_be32(value));
-            return 0;
-        }
     case NFI_NXM_OF_IP_SRC_W:
+    case NFI_NXM_OF_ARP_SPA:
     case NFI_NXM_OF_ARP_SPA_W:
-        if (wc->nw_src_mask) {
-            return NXM_DUP_TYPE;
-        } else {
-            ovs_be32 ip = get_unaligned_be32(value);
-            ovs_be32 netmask = get_unaligned_be32(mask);
-            if (!cls_rule_set_nw_src_masked(rule, ip, netmask)) {
-                return NXM_BAD_MASK;
-            }
-            return 0;
-        }
+        return parse_nx_ip(&flow->nw_src, &wc->nw_src_mask, value, mask);
     case NFI_NXM_OF_IP_DST:
-    case NFI_NXM_OF_ARP_TPA:
-        if (wc->nw_dst_mask) {
-            return NXM_DUP_TYPE;
-        } else {
-            cls_rule_set_nw_dst(rule, get_unaligned_be32(value));
-            return 0;
-        }
     case NFI_NXM_OF_IP_DST_W:
+    case NFI_NXM_OF_ARP_TPA:
     case NFI_NXM_OF_ARP_TPA_W:
-        if (wc->nw_dst_mask) {
-            return NXM_DUP_TYPE;
-        } else {
-            ovs_be32 ip = get_unaligned_be32(value);
-            ovs_be32 netmask = get_unaligned_be32(mask);
-            if (!cls_rule_set_nw_dst_masked(rule, ip, netmask)) {
-                return NXM_BAD_MASK;
-            }
-            return 0;
-        }
+        return parse_nx_ip(&flow->nw_dst, &wc->nw_dst_mask, value, mask);
 
         /* IPv6 addresses. */
     case NFI_NXM_NX_IPV6_SRC:
-        if (!ipv6_mask_is_any(&wc->ipv6_src_mask)) {
-            return NXM_DUP_TYPE;
-        } else {
-            struct in6_addr ipv6;
-            memcpy(&ipv6, value, sizeof ipv6);
-            cls_rule_set_ipv6_src(rule, &ipv6);
-            return 0;
-        }
     case NFI_NXM_NX_IPV6_SRC_W:
-        if (!ipv6_mask_is_any(&wc->ipv6_src_mask)) {
-            return NXM_DUP_TYPE;
-        } else {
-            struct in6_addr ipv6, netmask;
-            memcpy(&ipv6, value, sizeof ipv6);
-            memcpy(&netmask, mask, sizeof netmask);
-            if (!cls_rule_set_ipv6_src_masked(rule, &ipv6, &netmask)) {
-                return NXM_BAD_MASK;
-            }
-            return 0;
-        }
+        return parse_nx_ipv6(&flow->ipv6_src, &wc->ipv6_src_mask,
+                             value, mask);
     case NFI_NXM_NX_IPV6_DST:
-        if (!ipv6_mask_is_any(&wc->ipv6_dst_mask)) {
-            return NXM_DUP_TYPE;
-        } else {
-            struct in6_addr ipv6;
-            memcpy(&ipv6, value, sizeof ipv6);
-            cls_rule_set_ipv6_dst(rule, &ipv6);
-            return 0;
-        }
     case NFI_NXM_NX_IPV6_DST_W:
-        if (!ipv6_mask_is_any(&wc->ipv6_dst_mask)) {
-            return NXM_DUP_TYPE;
-        } else {
-            struct in6_addr ipv6, netmask;
-            memcpy(&ipv6, value, sizeof ipv6);
-            memcpy(&netmask, mask, sizeof netmask);
-            if (!cls_rule_set_ipv6_dst_masked(rule, &ipv6, &netmask)) {
-                return NXM_BAD_MASK;
-            }
-            return 0;
-        }
+        return parse_nx_ipv6(&flow->ipv6_dst, &wc->ipv6_dst_mask,
+                             value, mask);
 
         /* TCP header. */
     case NFI_NXM_OF_TCP_SRC:
@@ -409,19 +366,13 @@ parse_nxm_entry(struct cls_rule *rule, const struct nxm_field *f,
 
         /* Tunnel ID. */
     case NFI_NXM_NX_TUN_ID:
-        if (wc->tun_id_mask) {
-            return NXM_DUP_TYPE;
-        } else {
-            cls_rule_set_tun_id(rule, get_unaligned_be64(value));
-            return 0;
-        }
     case NFI_NXM_NX_TUN_ID_W:
         if (wc->tun_id_mask) {
             return NXM_DUP_TYPE;
         } else {
-            ovs_be64 tun_id = get_unaligned_be64(value);
-            ovs_be64 tun_mask = get_unaligned_be64(mask);
-            cls_rule_set_tun_id_masked(rule, tun_id, tun_mask);
+            wc->tun_id_mask = mask ? get_unaligned_be64(mask)
+                                   : htonll(UINT64_MAX);
+            flow->tun_id = get_unaligned_be64(value) & wc->tun_id_mask;
             return 0;
         }
 
@@ -519,6 +470,7 @@ nx_pull_match(struct ofpbuf *b, unsigned int match_len, uint16_t priority,
     while ((header = nx_entry_ok(p, match_len)) != 0) {
         unsigned length = NXM_LENGTH(header);
         const struct nxm_field *f;
+        const uint8_t *mask;
         int error;
 
         f = nxm_field_lookup(header);
@@ -533,7 +485,8 @@ nx_pull_match(struct ofpbuf *b, unsigned int match_len, uint16_t priority,
              * because they are included in 'header' and nxm_field_lookup()
              * checked them already. */
             rule->wc.wildcards &= ~f->wildcard;
-            error = parse_nxm_entry(rule, f, p + 4, p + 4 + length / 2);
+            mask = NXM_HASMASK(header) ? p + 4 + length / 2 : NULL;
+            error = parse_nxm_entry(&rule->flow, &rule->wc, f, p + 4, mask);
         }
         if (error) {
             VLOG_DBG_RL(&rl, "bad nxm_entry with vendor=%"PRIu32", "
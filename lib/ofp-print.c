@@ -1359,6 +1359,24 @@ ofp_print_nxt_set_flow_format(struct ds *string,
     }
 }
 
+static void
+ofp_print_nxt_flow_mod_batch(struct ds *string,
+                             const struct nxt_flow_mod_batch *nfmb)
+{
+    uint32_t command = ntohl(nfmb->command);
+
+    ds_put_cstr(string, " command=");
+    if (command == NXFMB_OPEN) {
+        ds_put_cstr(string, "open");
+    } else if (command == NXFMB_COMMIT) {
+        ds_put_cstr(string, "commit");
+    } else if (command == NXFMB_DISCARD) {
+        ds_put_cstr(string, "discard");
+    } else {
+        ds_put_format(string, "%"PRIu32, command);
+    }
+}
+
 static void
 ofp_to_string__(const struct ofp_header *oh,
                 const struct ofputil_msg_type *type, struct ds *string,
@@ -1513,6 +1531,10 @@ ofp_to_string__(const struct ofp_header *oh,
         ofp_print_flow_mod(string, msg, code, verbosity);
         break;
 
+    case OFPUTIL_NXT_FLOW_MOD_BATCH:
+        ofp_print_nxt_flow_mod_batch(string, msg);
+        break;
+
     case OFPUTIL_NXST_AGGREGATE_REPLY:
         ofp_print_stats_reply(string, oh);
         ofp_print_nxst_aggregate_reply(string, msg);
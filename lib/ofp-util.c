@@ -422,6 +422,10 @@ ofputil_decode_vendor(const struct ofp_header *oh,
         { OFPUTIL_NXT_FLOW_REMOVED,
           NXT_FLOW_REMOVED, "NXT_FLOW_REMOVED",
           sizeof(struct nx_flow_removed), 8 },
+
+        { OFPUTIL_NXT_FLOW_MOD_BATCH,
+          NXT_FLOW_MOD_BATCH, "NXT_FLOW_MOD_BATCH",
+          sizeof(struct nxt_flow_mod_batch), 0 },
     };
 
     static const struct ofputil_msg_category nxt_category = {
@@ -963,6 +967,19 @@ ofputil_make_set_flow_format(enum nx_flow_format flow_format)
     return msg;
 }
 
+/* Returns an NXT_FLOW_MOD_BATCH message that carries 'command'. */
+struct ofpbuf *
+ofputil_make_flow_mod_batch(enum nx_flow_mod_batch_command command)
+{
+    struct nxt_flow_mod_batch *nfmb;
+    struct ofpbuf *msg;
+
+    nfmb = make_nxmsg(sizeof *nfmb, NXT_FLOW_MOD_BATCH, &msg);
+    nfmb->command = htonl(command);
+
+    return msg;
+}
+
 /* Converts an OFPT_FLOW_MOD or NXT_FLOW_MOD message 'oh' into an abstract
  * flow_mod in 'fm'.  Returns 0 if successful, otherwise an OpenFlow error
  * code.
@@ -971,18 +988,20 @@ ofputil_make_set_flow_format(enum nx_flow_format flow_format)
  * at the time when the message was received.  Otherwise 'flow_format' is
  * ignored.
  *
+ * The caller must already have checked 'oh' with ofputil_decode_msg_type().
+ *
  * Does not validate the flow_mod actions. */
 int
 ofputil_decode_flow_mod(struct flow_mod *fm, const struct ofp_header *oh,
                         enum nx_flow_format flow_format)
 {
-    const struct ofputil_msg_type *type;
     struct ofpbuf b;
 
     ofpbuf_use_const(&b, oh, ntohs(oh->length));
 
-    ofputil_decode_msg_type(oh, &type);
-    if (ofputil_msg_type_code(type) == OFPUTIL_OFPT_FLOW_MOD) {
+    /* The caller has already checked the message type and length with
+     * ofputil_decode_msg_type(), so a vendor message must be NXT_FLOW_MOD. */
+    if (oh->type == OFPT_FLOW_MOD) {
         /* Standard OpenFlow flow_mod. */
         struct ofp_match match, orig_match;
         const struct ofp_flow_mod *ofm;
@@ -1023,7 +1042,7 @@ ofputil_decode_flow_mod(struct flow_mod *fm, const struct ofp_header *oh,
         fm->buffer_id = ntohl(ofm->buffer_id);
         fm->out_port = ntohs(ofm->out_port);
         fm->flags = ntohs(ofm->flags);
-    } else if (ofputil_msg_type_code(type) == OFPUTIL_NXT_FLOW_MOD) {
+    } else if (oh->type == OFPT_VENDOR) {
         /* Nicira extended flow_mod. */
         const struct nx_flow_mod *nfm;
         int error;
@@ -77,6 +77,7 @@ enum ofputil_msg_code {
     OFPUTIL_NXT_SET_FLOW_FORMAT,
     OFPUTIL_NXT_FLOW_MOD,
     OFPUTIL_NXT_FLOW_REMOVED,
+    OFPUTIL_NXT_FLOW_MOD_BATCH,
 
     /* NXST_* stat requests. */
     OFPUTIL_NXST_FLOW_REQUEST,
@@ -121,6 +122,7 @@ enum nx_flow_format ofputil_min_flow_format(const struct cls_rule *,
                                             ovs_be64 cookie);
 
 struct ofpbuf *ofputil_make_set_flow_format(enum nx_flow_format);
+struct ofpbuf *ofputil_make_flow_mod_batch(enum nx_flow_mod_batch_command);
 
 /* Flow format independent flow_mod. */
 struct flow_mod {
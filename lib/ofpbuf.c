@@ -78,6 +78,21 @@ ofpbuf_use_const(struct ofpbuf *b, const void *data, size_t size)
     b->size = size;
 }
 
+/* Initializes 'b' as an empty ofpbuf that contains the 'allocated' bytes of
+ * memory starting at 'base', which must be a frame in a ring buffer shared
+ * with the kernel, such as a PACKET_MMAP receive ring.  The ring's owner is
+ * responsible for handing the frame back to the kernel.
+ *
+ * An ofpbuf operation that requires reallocating data copies the data into
+ * memory obtained from malloc(), after which 'b' no longer refers to the ring
+ * frame and must eventually be freed with ofpbuf_uninit().  ofpbuf_uninit() is
+ * harmless on a buffer that still refers to its ring frame. */
+void
+ofpbuf_use_ring(struct ofpbuf *b, void *base, size_t allocated)
+{
+    ofpbuf_use__(b, base, allocated, OFPBUF_RING);
+}
+
 /* Initializes 'b' as an empty ofpbuf with an initial capacity of 'size'
  * bytes. */
 void
@@ -227,6 +242,12 @@ ofpbuf_resize__(struct ofpbuf *b, size_t new_headroom, size_t new_tailroom)
     case OFPBUF_STACK:
         NOT_REACHED();
 
+    case OFPBUF_RING:
+        new_base = xmalloc(new_allocated);
+        ofpbuf_copy__(b, new_base, new_headroom, new_tailroom);
+        b->source = OFPBUF_MALLOC;
+        break;
+
     default:
         NOT_REACHED();
     }
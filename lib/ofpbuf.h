@@ -28,7 +28,8 @@ extern "C" {
 
 enum ofpbuf_source {
     OFPBUF_MALLOC,              /* Obtained via malloc(). */
-    OFPBUF_STACK                /* Stack space or static buffer. */
+    OFPBUF_STACK,               /* Stack space or static buffer. */
+    OFPBUF_RING                 /* Frame in a memory-mapped receive ring. */
 };
 
 /* Buffer for holding arbitrary data.  An ofpbuf is automatically reallocated
@@ -57,6 +58,7 @@ struct ofpbuf {
 void ofpbuf_use(struct ofpbuf *, void *, size_t);
 void ofpbuf_use_stack(struct ofpbuf *, void *, size_t);
 void ofpbuf_use_const(struct ofpbuf *, const void *, size_t);
+void ofpbuf_use_ring(struct ofpbuf *, void *, size_t);
 
 void ofpbuf_init(struct ofpbuf *, size_t);
 void ofpbuf_uninit(struct ofpbuf *);
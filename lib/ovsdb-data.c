@@ -466,6 +466,44 @@ ovsdb_atom_to_json(const union ovsdb_atom *atom, enum ovsdb_atomic_type type)
     }
 }
 
+/* Appends 'atom', of the specified 'type', to 'ds' in JSON format.  The
+ * output is the same as serializing the return value of ovsdb_atom_to_json()
+ * with json_to_ds(), but no "struct json" is constructed along the way. */
+void
+ovsdb_atom_to_json_ds(const union ovsdb_atom *atom,
+                      enum ovsdb_atomic_type type, struct ds *ds)
+{
+    switch (type) {
+    case OVSDB_TYPE_VOID:
+        NOT_REACHED();
+
+    case OVSDB_TYPE_INTEGER:
+        ds_put_format(ds, "%lld", (long long int) atom->integer);
+        break;
+
+    case OVSDB_TYPE_REAL:
+        ds_put_format(ds, "%.*g", DBL_DIG, atom->real);
+        break;
+
+    case OVSDB_TYPE_BOOLEAN:
+        ds_put_cstr(ds, atom->boolean ? "true" : "false");
+        break;
+
+    case OVSDB_TYPE_STRING:
+        json_string_escape(atom->string, ds);
+        break;
+
+    case OVSDB_TYPE_UUID:
+        ds_put_format(ds, "[\"uuid\",\""UUID_FMT"\"]",
+                      UUID_ARGS(&atom->uuid));
+        break;
+
+    case OVSDB_N_TYPES:
+    default:
+        NOT_REACHED();
+    }
+}
+
 static char *
 ovsdb_atom_from_string__(union ovsdb_atom *atom,
                          const struct ovsdb_base_type *base, const char *s,
@@ -1305,6 +1343,46 @@ ovsdb_datum_to_json(const struct ovsdb_datum *datum,
     }
 }
 
+/* Appends 'datum', of the specified 'type', to 'ds' in JSON format.  The
+ * output is the same as serializing the return value of ovsdb_datum_to_json()
+ * with json_to_ds(), but without the cost of constructing and destroying a
+ * "struct json" for every atom, so it suits serializing large numbers of
+ * datums directly into an output buffer.
+ *
+ * 'type' constraints on datum->n are ignored. */
+void
+ovsdb_datum_to_json_ds(const struct ovsdb_datum *datum,
+                       const struct ovsdb_type *type, struct ds *ds)
+{
+    size_t i;
+
+    if (datum->n == 1 && !ovsdb_type_is_map(type)) {
+        ovsdb_atom_to_json_ds(&datum->keys[0], type->key.type, ds);
+    } else if (type->value.type == OVSDB_TYPE_VOID) {
+        ds_put_cstr(ds, "[\"set\",[");
+        for (i = 0; i < datum->n; i++) {
+            if (i) {
+                ds_put_char(ds, ',');
+            }
+            ovsdb_atom_to_json_ds(&datum->keys[i], type->key.type, ds);
+        }
+        ds_put_cstr(ds, "]]");
+    } else {
+        ds_put_cstr(ds, "[\"map\",[");
+        for (i = 0; i < datum->n; i++) {
+            if (i) {
+                ds_put_char(ds, ',');
+            }
+            ds_put_char(ds, '[');
+            ovsdb_atom_to_json_ds(&datum->keys[i], type->key.type, ds);
+            ds_put_char(ds, ',');
+            ovsdb_atom_to_json_ds(&datum->values[i], type->value.type, ds);
+            ds_put_char(ds, ']');
+        }
+        ds_put_cstr(ds, "]]");
+    }
+}
+
 static const char *
 skip_spaces(const char *p)
 {
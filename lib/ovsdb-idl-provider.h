@@ -36,6 +36,10 @@ struct ovsdb_idl_row {
     unsigned long int *prereqs; /* Bitmap of columns to verify in "old". */
     unsigned long int *written; /* Bitmap of columns from "new" to write. */
     struct hmap_node txn_node;  /* Node in ovsdb_idl_txn's list. */
+
+    /* Change tracking (see ovsdb_idl_row_changed()). */
+    unsigned int change_seqno;  /* Seqno of last insertion or change. */
+    unsigned int *column_seqnos; /* Seqno of last change, for each column. */
 };
 
 struct ovsdb_idl_column {
@@ -60,6 +64,10 @@ struct ovsdb_idl_table {
     struct shash columns;    /* Contains "const struct ovsdb_idl_column *"s. */
     struct hmap rows;        /* Contains "struct ovsdb_idl_row"s. */
     struct ovsdb_idl *idl;   /* Containing idl. */
+
+    /* Change tracking (see ovsdb_idl_table_changed()). */
+    unsigned int change_seqno;  /* Seqno of last change to any row. */
+    unsigned int rows_seqno;    /* Seqno of last insertion or deletion. */
 };
 
 struct ovsdb_idl_class {
@@ -126,6 +126,7 @@ static struct ovsdb_idl_row *ovsdb_idl_row_create__(
 static struct ovsdb_idl_row *ovsdb_idl_row_create(struct ovsdb_idl_table *,
                                                   const struct uuid *);
 static void ovsdb_idl_row_destroy(struct ovsdb_idl_row *);
+static unsigned int ovsdb_idl_next_seqno(const struct ovsdb_idl_table *);
 
 static void ovsdb_idl_row_parse(struct ovsdb_idl_row *);
 static void ovsdb_idl_row_unparse(struct ovsdb_idl_row *);
@@ -186,6 +187,7 @@ ovsdb_idl_create(const char *remote, const struct ovsdb_idl_class *class,
         }
         hmap_init(&table->rows);
         table->idl = idl;
+        table->change_seqno = table->rows_seqno = 0;
     }
     idl->last_monitor_request_seqno = UINT_MAX;
     hmap_init(&idl->outstanding_txns);
@@ -232,6 +234,7 @@ ovsdb_idl_clear(struct ovsdb_idl *idl)
         }
 
         changed = true;
+        table->change_seqno = table->rows_seqno = idl->change_seqno + 1;
         HMAP_FOR_EACH_SAFE (row, next_row, hmap_node, &table->rows) {
             struct ovsdb_idl_arc *arc, *next_arc;
 
@@ -686,6 +689,7 @@ static bool
 ovsdb_idl_row_update(struct ovsdb_idl_row *row, const struct json *row_json)
 {
     struct ovsdb_idl_table *table = row->table;
+    unsigned int seqno = ovsdb_idl_next_seqno(table);
     struct shash_node *node;
     bool changed = false;
 
@@ -710,6 +714,7 @@ ovsdb_idl_row_update(struct ovsdb_idl_row *row, const struct json *row_json)
             if (!ovsdb_datum_equals(old, &datum, &column->type)) {
                 ovsdb_datum_swap(old, &datum);
                 if (table->modes[column_idx] & OVSDB_IDL_ALERT) {
+                    row->column_seqnos[column_idx] = seqno;
                     changed = true;
                 }
             } else {
@@ -872,6 +877,16 @@ ovsdb_idl_row_reparse_backrefs(struct ovsdb_idl_row *row)
     }
 }
 
+/* Returns the value that ovsdb_idl_get_seqno() will return for 'table''s idl
+ * once the change currently being processed has been applied.  Row, column,
+ * and table changes are stamped with this value, so that a client that saved
+ * ovsdb_idl_get_seqno() can later tell which of them changed after it. */
+static unsigned int
+ovsdb_idl_next_seqno(const struct ovsdb_idl_table *table)
+{
+    return table->idl->change_seqno + 1;
+}
+
 static struct ovsdb_idl_row *
 ovsdb_idl_row_create__(const struct ovsdb_idl_table_class *class)
 {
@@ -898,6 +913,7 @@ ovsdb_idl_row_destroy(struct ovsdb_idl_row *row)
     if (row) {
         ovsdb_idl_row_clear_old(row);
         hmap_remove(&row->table->rows, &row->hmap_node);
+        free(row->column_seqnos);
         free(row);
     }
 }
@@ -906,22 +922,34 @@ static void
 ovsdb_idl_insert_row(struct ovsdb_idl_row *row, const struct json *row_json)
 {
     const struct ovsdb_idl_table_class *class = row->table->class;
+    unsigned int seqno = ovsdb_idl_next_seqno(row->table);
     size_t i;
 
     assert(!row->old && !row->new);
     row->old = row->new = xmalloc(class->n_columns * sizeof *row->old);
+    if (!row->column_seqnos) {
+        row->column_seqnos = xmalloc(class->n_columns
+                                     * sizeof *row->column_seqnos);
+    }
     for (i = 0; i < class->n_columns; i++) {
         ovsdb_datum_init_default(&row->old[i], &class->columns[i].type);
+        row->column_seqnos[i] = seqno;
     }
     ovsdb_idl_row_update(row, row_json);
     ovsdb_idl_row_parse(row);
 
+    row->change_seqno = seqno;
+    row->table->change_seqno = row->table->rows_seqno = seqno;
+
     ovsdb_idl_row_reparse_backrefs(row);
 }
 
 static void
 ovsdb_idl_delete_row(struct ovsdb_idl_row *row)
 {
+    struct ovsdb_idl_table *table = row->table;
+
+    table->change_seqno = table->rows_seqno = ovsdb_idl_next_seqno(table);
     ovsdb_idl_row_unparse(row);
     ovsdb_idl_row_clear_arcs(row, true);
     ovsdb_idl_row_clear_old(row);
@@ -943,6 +971,10 @@ ovsdb_idl_modify_row(struct ovsdb_idl_row *row, const struct json *row_json)
     ovsdb_idl_row_clear_arcs(row, true);
     changed = ovsdb_idl_row_update(row, row_json);
     ovsdb_idl_row_parse(row);
+    if (changed) {
+        row->change_seqno = row->table->change_seqno
+            = ovsdb_idl_next_seqno(row->table);
+    }
 
     return changed;
 }
@@ -1117,6 +1149,70 @@ ovsdb_idl_row_is_synthetic(const struct ovsdb_idl_row *row)
 {
     return row->table == NULL;
 }
+
+/* Change tracking.
+ *
+ * Each of these functions takes a 'seqno' previously obtained from
+ * ovsdb_idl_get_seqno() and reports whether something changed in a later call
+ * to ovsdb_idl_run().  Only changes to columns whose mode includes
+ * OVSDB_IDL_ALERT are tracked.  Reconnecting to the database server clears
+ * and reloads the whole replica, which appears as every row being deleted and
+ * then inserted again. */
+
+static bool
+seqno_is_after(unsigned int a, unsigned int b)
+{
+    return (int) (a - b) > 0;
+}
+
+/* Returns true if any row in 'table_class' was inserted, deleted, or changed
+ * after 'seqno'. */
+bool
+ovsdb_idl_table_changed(const struct ovsdb_idl *idl,
+                        const struct ovsdb_idl_table_class *table_class,
+                        unsigned int seqno)
+{
+    const struct ovsdb_idl_table *table
+        = ovsdb_idl_table_from_class(idl, table_class);
+    return seqno_is_after(table->change_seqno, seqno);
+}
+
+/* Returns true if any row was inserted into or deleted from 'table_class'
+ * after 'seqno'. */
+bool
+ovsdb_idl_table_rows_changed(const struct ovsdb_idl *idl,
+                             const struct ovsdb_idl_table_class *table_class,
+                             unsigned int seqno)
+{
+    const struct ovsdb_idl_table *table
+        = ovsdb_idl_table_from_class(idl, table_class);
+    return seqno_is_after(table->rows_seqno, seqno);
+}
+
+/* Returns true if 'row' was inserted or any of its columns changed after
+ * 'seqno'.  Always returns false for a synthetic row. */
+bool
+ovsdb_idl_row_changed(const struct ovsdb_idl_row *row, unsigned int seqno)
+{
+    return row->table && seqno_is_after(row->change_seqno, seqno);
+}
+
+/* Returns true if 'row' was inserted or the value of 'column' within 'row'
+ * changed after 'seqno'.  Always returns false for a synthetic row. */
+bool
+ovsdb_idl_column_changed(const struct ovsdb_idl_row *row,
+                         const struct ovsdb_idl_column *column,
+                         unsigned int seqno)
+{
+    if (row->table && row->column_seqnos) {
+        size_t column_idx = column - row->table->class->columns;
+
+        assert(column_idx < row->table->class->n_columns);
+        return seqno_is_after(row->column_seqnos[column_idx], seqno);
+    } else {
+        return false;
+    }
+}
 
 /* Transactions. */
 
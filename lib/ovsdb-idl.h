@@ -107,6 +107,19 @@ const struct ovsdb_datum *ovsdb_idl_get(const struct ovsdb_idl_row *,
                                         enum ovsdb_atomic_type value_type);
 
 bool ovsdb_idl_row_is_synthetic(const struct ovsdb_idl_row *);
+
+/* Tracking changes since an earlier ovsdb_idl_get_seqno(). */
+
+bool ovsdb_idl_table_changed(const struct ovsdb_idl *,
+                             const struct ovsdb_idl_table_class *,
+                             unsigned int seqno);
+bool ovsdb_idl_table_rows_changed(const struct ovsdb_idl *,
+                                  const struct ovsdb_idl_table_class *,
+                                  unsigned int seqno);
+bool ovsdb_idl_row_changed(const struct ovsdb_idl_row *, unsigned int seqno);
+bool ovsdb_idl_column_changed(const struct ovsdb_idl_row *,
+                              const struct ovsdb_idl_column *,
+                              unsigned int seqno);
 
 /* Transactions. */
 
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2011 Nicira Networks.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <config.h>
+#include "pool.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "coverage.h"
+#include "dynamic-string.h"
+#include "unixctl.h"
+#include "util.h"
+
+COVERAGE_DEFINE(pool_alloc);
+COVERAGE_DEFINE(pool_slab_alloc);
+
+/* Alignment of every object in a pool. */
+#define POOL_ALIGN 8
+
+/* Approximate number of bytes in each slab. */
+#define POOL_SLAB_SIZE 16384
+
+/* A free object. */
+struct pool_obj {
+    struct pool_obj *next;
+};
+
+/* A slab, followed by 'objs_per_slab' objects. */
+struct pool_slab {
+    struct pool_slab *next;
+};
+
+#define POOL_SLAB_HEADER ROUND_UP(sizeof(struct pool_slab), POOL_ALIGN)
+
+static struct list all_pools = LIST_INITIALIZER(&all_pools);
+
+static void pool_unixctl_show(struct unixctl_conn *, const char *args,
+                              void *aux);
+
+/* Initializes 'pool' to hand out objects of 'obj_size' bytes.  'name' is used
+ * only for reporting statistics. */
+void
+pool_init(struct pool *pool, const char *name, size_t obj_size)
+{
+    static bool registered;
+
+    if (!registered) {
+        registered = true;
+        unixctl_command_register("pool/show", pool_unixctl_show, NULL);
+    }
+
+    pool->name = xstrdup(name);
+    pool->obj_size = ROUND_UP(MAX(obj_size, sizeof(struct pool_obj)),
+                              POOL_ALIGN);
+    pool->objs_per_slab = MAX(1, ((POOL_SLAB_SIZE - POOL_SLAB_HEADER)
+                                  / pool->obj_size));
+    pool->free_objs = NULL;
+    pool->slabs = NULL;
+    pool->n_slabs = 0;
+    pool->n_in_use = 0;
+    pool->n_allocs = 0;
+    list_push_back(&all_pools, &pool->list_node);
+}
+
+/* Frees all of the memory in 'pool', including any objects that are still
+ * allocated from it. */
+void
+pool_destroy(struct pool *pool)
+{
+    if (pool) {
+        struct pool_slab *slab, *next;
+
+        for (slab = pool->slabs; slab; slab = next) {
+            next = slab->next;
+            free(slab);
+        }
+        list_remove(&pool->list_node);
+        free(pool->name);
+    }
+}
+
+/* Adds a new slab to 'pool' and puts all of its objects on the free list. */
+static void
+pool_grow(struct pool *pool)
+{
+    struct pool_slab *slab;
+    char *objs;
+    size_t i;
+
+    COVERAGE_INC(pool_slab_alloc);
+    slab = xmalloc(POOL_SLAB_HEADER + pool->objs_per_slab * pool->obj_size);
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->n_slabs++;
+
+    objs = (char *) slab + POOL_SLAB_HEADER;
+    for (i = pool->objs_per_slab; i-- > 0; ) {
+        struct pool_obj *obj = (struct pool_obj *) (objs + i * pool->obj_size);
+        obj->next = pool->free_objs;
+        pool->free_objs = obj;
+    }
+}
+
+/* Allocates and returns an object from 'pool'.  Its contents are
+ * indeterminate. */
+void *
+pool_alloc(struct pool *pool)
+{
+    struct pool_obj *obj;
+
+    if (!pool->free_objs) {
+        pool_grow(pool);
+    }
+    obj = pool->free_objs;
+    pool->free_objs = obj->next;
+
+    COVERAGE_INC(pool_alloc);
+    pool->n_in_use++;
+    pool->n_allocs++;
+    return obj;
+}
+
+/* Allocates and returns an object from 'pool', initialized to all-zero
+ * bytes. */
+void *
+pool_zalloc(struct pool *pool)
+{
+    void *obj = pool_alloc(pool);
+    memset(obj, 0, pool->obj_size);
+    return obj;
+}
+
+/* Returns 'obj_', which must have been allocated from 'pool', to 'pool'.  Does
+ * nothing if 'obj_' is null. */
+void
+pool_free(struct pool *pool, void *obj_)
+{
+    if (obj_) {
+        struct pool_obj *obj = obj_;
+
+        assert(pool->n_in_use > 0);
+        obj->next = pool->free_objs;
+        pool->free_objs = obj;
+        pool->n_in_use--;
+    }
+}
+
+/* Initializes 'set'.  'name' is used only for reporting statistics. */
+void
+pool_set_init(struct pool_set *set, const char *name)
+{
+    int i;
+
+    for (i = 0; i < POOL_SET_N_CLASSES; i++) {
+        size_t size = POOL_SET_MIN_SIZE << i;
+        char *class_name = xasprintf("%s-%zu", name, size);
+
+        pool_init(&set->classes[i], class_name, size);
+        free(class_name);
+    }
+}
+
+/* Frees all of the memory in 'set', except for any buffers larger than
+ * POOL_SET_MAX_SIZE that are still allocated from it. */
+void
+pool_set_destroy(struct pool_set *set)
+{
+    if (set) {
+        int i;
+
+        for (i = 0; i < POOL_SET_N_CLASSES; i++) {
+            pool_destroy(&set->classes[i]);
+        }
+    }
+}
+
+/* Returns the pool in 'set' for buffers of 'size' bytes, or a null pointer if
+ * such buffers are too large for any of its pools. */
+static struct pool *
+pool_set_find(struct pool_set *set, size_t size)
+{
+    int i;
+
+    for (i = 0; i < POOL_SET_N_CLASSES; i++) {
+        if (size <= POOL_SET_MIN_SIZE << i) {
+            return &set->classes[i];
+        }
+    }
+    return NULL;
+}
+
+/* Allocates and returns a buffer of at least 'size' bytes from 'set'. */
+void *
+pool_set_alloc(struct pool_set *set, size_t size)
+{
+    struct pool *pool = pool_set_find(set, size);
+    return pool ? pool_alloc(pool) : xmalloc(size);
+}
+
+/* Allocates a buffer of 'size' bytes from 'set', copies the 'size' bytes in
+ * 'data' into it, and returns it. */
+void *
+pool_set_memdup(struct pool_set *set, const void *data, size_t size)
+{
+    void *p = pool_set_alloc(set, size);
+    memcpy(p, data, size);
+    return p;
+}
+
+/* Returns 'p', which must have been allocated from 'set' with the given
+ * 'size', to 'set'.  Does nothing if 'p' is null. */
+void
+pool_set_free(struct pool_set *set, void *p, size_t size)
+{
+    struct pool *pool = pool_set_find(set, size);
+    if (pool) {
+        pool_free(pool, p);
+    } else {
+        free(p);
+    }
+}
+
+static void
+pool_unixctl_show(struct unixctl_conn *conn, const char *args OVS_UNUSED,
+                  void *aux OVS_UNUSED)
+{
+    const struct pool *pool;
+    struct ds ds;
+
+    ds_init(&ds);
+    LIST_FOR_EACH (pool, list_node, &all_pools) {
+        size_t n_objs = pool->n_slabs * pool->objs_per_slab;
+
+        ds_put_format(&ds, "%s: %zu-byte objects, %zu in use, %zu free, "
+                      "%zu slabs (%zu kB), %llu allocations\n",
+                      pool->name, pool->obj_size, pool->n_in_use,
+                      n_objs - pool->n_in_use, pool->n_slabs,
+                      (pool->n_slabs * (POOL_SLAB_HEADER
+                                        + pool->objs_per_slab * pool->obj_size)
+                       + 1023) / 1024,
+                      pool->n_allocs);
+    }
+    unixctl_command_reply(conn, 200, ds_cstr(&ds));
+    ds_destroy(&ds);
+}
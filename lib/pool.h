@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2011 Nicira Networks.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef POOL_H
+#define POOL_H 1
+
+#include <stddef.h>
+#include "list.h"
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+/* Fixed-size object pool.
+ *
+ * A pool hands out objects of a single size, carved out of larger "slabs"
+ * obtained from malloc().  Freed objects go onto a free list, from which later
+ * allocations are satisfied first.  Memory is returned to the system only when
+ * the pool is destroyed, so a pool is best suited to objects that are
+ * allocated and freed frequently but whose number stays roughly steady.
+ *
+ * Pools are not thread-safe.
+ *
+ * The "pool/show" ovs-appctl command reports statistics for every pool. */
+struct pool {
+    struct list list_node;      /* In list of all pools. */
+    char *name;                 /* Name, for pool/show. */
+    size_t obj_size;            /* Size of each object, after rounding up. */
+    size_t objs_per_slab;       /* Number of objects carved from each slab. */
+    struct pool_obj *free_objs; /* Singly linked list of free objects. */
+    struct pool_slab *slabs;    /* Singly linked list of all slabs. */
+
+    /* Statistics. */
+    size_t n_slabs;             /* Number of slabs in 'slabs'. */
+    size_t n_in_use;            /* Objects allocated and not yet freed. */
+    unsigned long long int n_allocs; /* Total allocations. */
+};
+
+void pool_init(struct pool *, const char *name, size_t obj_size);
+void pool_destroy(struct pool *);
+
+void *pool_alloc(struct pool *);
+void *pool_zalloc(struct pool *);
+void pool_free(struct pool *, void *);
+
+/* A set of pools for variable-size buffers.
+ *
+ * Requests are rounded up to the nearest of POOL_SET_N_CLASSES size classes,
+ * which run from POOL_SET_MIN_SIZE bytes upward by powers of 2, and served
+ * from that class's pool.  Larger requests fall back to malloc().  Because the
+ * size class is not recorded with each buffer, the caller must pass the
+ * buffer's original size back to pool_set_free(). */
+#define POOL_SET_MIN_SIZE 16
+#define POOL_SET_N_CLASSES 5
+#define POOL_SET_MAX_SIZE (POOL_SET_MIN_SIZE << (POOL_SET_N_CLASSES - 1))
+
+struct pool_set {
+    struct pool classes[POOL_SET_N_CLASSES];
+};
+
+void pool_set_init(struct pool_set *, const char *name);
+void pool_set_destroy(struct pool_set *);
+
+void *pool_set_alloc(struct pool_set *, size_t size);
+void *pool_set_memdup(struct pool_set *, const void *, size_t size);
+void pool_set_free(struct pool_set *, void *, size_t size);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* pool.h */
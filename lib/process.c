@@ -32,6 +32,7 @@
 #include "poll-loop.h"
 #include "signals.h"
 #include "socket-util.h"
+#include "timeval.h"
 #include "util.h"
 #include "vlog.h"
 
@@ -40,6 +41,7 @@ VLOG_DEFINE_THIS_MODULE(process);
 COVERAGE_DEFINE(process_run);
 COVERAGE_DEFINE(process_run_capture);
 COVERAGE_DEFINE(process_sigchld);
+COVERAGE_DEFINE(process_fork);
 COVERAGE_DEFINE(process_start);
 
 struct process {
@@ -250,6 +252,48 @@ process_start(char **argv,
     }
 }
 
+/* Forks a child process that continues to run the caller's code, instead of
+ * executing a new program as process_start() does.  'name' is used as the
+ * name of the process.
+ *
+ * Returns 0 if successful, otherwise a positive errno value indicating the
+ * error.  If successful, then in the parent '*pp' is assigned a new struct
+ * process that may be used to query the child's status, and in the child
+ * '*pp' is set to NULL.  The child must terminate with _exit(), not exit(), so
+ * that it does not run the parent's exit handlers or flush stdio buffers that
+ * it shares with the parent.  On failure, '*pp' is set to NULL. */
+int
+process_fork(const char *name, struct process **pp)
+{
+    sigset_t oldsigs;
+    pid_t pid;
+
+    *pp = NULL;
+    COVERAGE_INC(process_fork);
+    process_init();
+
+    block_sigchld(&oldsigs);
+    pid = fork();
+    if (pid < 0) {
+        int error = errno;
+
+        unblock_sigchld(&oldsigs);
+        VLOG_WARN("fork failed: %s", strerror(error));
+        return error;
+    } else if (pid) {
+        /* Running in parent process. */
+        *pp = process_register(name, pid);
+        unblock_sigchld(&oldsigs);
+        return 0;
+    } else {
+        /* Running in child process. */
+        fatal_signal_fork();
+        time_postfork();
+        unblock_sigchld(&oldsigs);
+        return 0;
+    }
+}
+
 /* Destroys process 'p'. */
 void
 process_destroy(struct process *p)
@@ -27,6 +27,7 @@ int process_start(char **argv,
                   const int *keep_fds, size_t n_keep_fds,
                   const int *null_fds, size_t n_null_fds,
                   struct process **);
+int process_fork(const char *name, struct process **);
 void process_destroy(struct process *);
 int process_kill(const struct process *, int signr);
 
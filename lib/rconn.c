@@ -893,35 +893,49 @@ rconn_set_target__(struct rconn *rc, const char *target, const char *name)
     rc->remote_port = 0;
 }
 
-/* Tries to send a packet from 'rc''s send buffer.  Returns 0 if successful,
- * otherwise a positive errno value. */
+/* Maximum number of packets that try_send() hands to the vconn at once. */
+#define RCONN_TX_BATCH 64
+
+/* Tries to send packets from 'rc''s send buffer, as many as RCONN_TX_BATCH at
+ * a time.  Returns 0 if all of them were sent, otherwise a positive errno
+ * value. */
 static int
 try_send(struct rconn *rc)
 {
-    struct ofpbuf *msg = ofpbuf_from_list(rc->txq.next);
-    struct rconn_packet_counter *counter = msg->private_p;
+    struct rconn_packet_counter *counters[RCONN_TX_BATCH];
+    struct ofpbuf *msgs[RCONN_TX_BATCH];
+    size_t n_msgs, n_sent, i;
     int retval;
 
-    /* Eagerly remove 'msg' from the txq.  We can't remove it from the list
-     * after sending, if sending is successful, because it is then owned by the
-     * vconn, which might have freed it already. */
-    list_remove(&msg->list_node);
+    /* Eagerly remove the packets from the txq.  We can't remove them from the
+     * list after sending, if sending is successful, because they are then
+     * owned by the vconn, which might have freed them already.  For the same
+     * reason, we have to save their counters beforehand. */
+    n_msgs = 0;
+    while (n_msgs < RCONN_TX_BATCH && !list_is_empty(&rc->txq)) {
+        struct ofpbuf *msg = ofpbuf_from_list(list_pop_front(&rc->txq));
+        counters[n_msgs] = msg->private_p;
+        msgs[n_msgs++] = msg;
+    }
 
-    retval = vconn_send(rc->vconn, msg);
-    if (retval) {
-        list_push_front(&rc->txq, &msg->list_node);
-        if (retval != EAGAIN) {
-            report_error(rc, retval);
-            disconnect(rc, retval);
+    retval = vconn_send_batch(rc->vconn, msgs, n_msgs, &n_sent);
+    for (i = n_msgs; i > n_sent; i--) {
+        list_push_front(&rc->txq, &msgs[i - 1]->list_node);
+    }
+
+    COVERAGE_ADD(rconn_sent, n_sent);
+    rc->packets_sent += n_sent;
+    for (i = 0; i < n_sent; i++) {
+        if (counters[i]) {
+            rconn_packet_counter_dec(counters[i]);
         }
-        return retval;
     }
-    COVERAGE_INC(rconn_sent);
-    rc->packets_sent++;
-    if (counter) {
-        rconn_packet_counter_dec(counter);
+
+    if (retval && retval != EAGAIN) {
+        report_error(rc, retval);
+        disconnect(rc, retval);
     }
-    return 0;
+    return retval;
 }
 
 /* Reports that 'error' caused 'rc' to disconnect.  'error' may be a positive
@@ -18,11 +18,13 @@
 #include "stream-fd.h"
 #include <assert.h>
 #include <errno.h>
+#include <limits.h>
 #include <poll.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include "fatal-signal.h"
 #include "leak-checker.h"
@@ -135,6 +137,26 @@ fd_send(struct stream *stream, const void *buffer, size_t n)
             : -errno);
 }
 
+#ifndef IOV_MAX
+#define IOV_MAX 16              /* Minimum value allowed by POSIX. */
+#endif
+
+static ssize_t
+fd_sendv(struct stream *stream, const struct iovec *iov, size_t n_iov)
+{
+    struct stream_fd *s = stream_fd_cast(stream);
+    ssize_t retval;
+
+    if (STRESS(stream_flaky_send)) {
+        return -EIO;
+    }
+
+    retval = writev(s->fd, iov, MIN(n_iov, IOV_MAX));
+    return (retval > 0 ? retval
+            : retval == 0 ? -EAGAIN
+            : -errno);
+}
+
 static void
 fd_wait(struct stream *stream, enum stream_wait_type wait)
 {
@@ -161,6 +183,7 @@ static struct stream_class stream_fd_class = {
     fd_connect,                 /* connect */
     fd_recv,                    /* recv */
     fd_send,                    /* send */
+    fd_sendv,                   /* sendv */
     NULL,                       /* run */
     NULL,                       /* run_wait */
     fd_wait,                    /* wait */
@@ -19,6 +19,7 @@
 
 #include <assert.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include "stream.h"
 
 /* Active stream connection. */
@@ -109,6 +110,16 @@ struct stream_class {
      * accepted for transmission, it should return -EAGAIN immediately. */
     ssize_t (*send)(struct stream *stream, const void *buffer, size_t n);
 
+    /* Tries to send the 'n_iov' buffers in 'iov', in order, on 'stream' as if
+     * they were concatenated into a single buffer, with the same return value
+     * conventions as the send function.  The total length of the buffers will
+     * not be zero.
+     *
+     * May be null, in which case stream_sendv() sends only the first nonempty
+     * buffer with the send function. */
+    ssize_t (*sendv)(struct stream *stream, const struct iovec *iov,
+                     size_t n_iov);
+
     /* Allows 'stream' to perform maintenance activities, such as flushing
      * output buffers.
      *
@@ -774,6 +774,42 @@ ssl_send(struct stream *stream, const void *buffer, size_t n)
     }
 }
 
+/* Coalesces the buffers in 'iov' into a single SSL_write() call, so that many
+ * small messages go out in a few full-sized TLS records instead of one record
+ * (and one system call) apiece. */
+static ssize_t
+ssl_sendv(struct stream *stream, const struct iovec *iov, size_t n_iov)
+{
+    struct ssl_stream *sslv = ssl_stream_cast(stream);
+    size_t n, i;
+    int error;
+
+    if (sslv->txbuf) {
+        return -EAGAIN;
+    }
+
+    n = 0;
+    for (i = 0; i < n_iov; i++) {
+        n += iov[i].iov_len;
+    }
+    sslv->txbuf = ofpbuf_new(n);
+    for (i = 0; i < n_iov; i++) {
+        ofpbuf_put(sslv->txbuf, iov[i].iov_base, iov[i].iov_len);
+    }
+
+    error = ssl_do_tx(stream);
+    switch (error) {
+    case 0:
+        ssl_clear_txbuf(sslv);
+        return n;
+    case EAGAIN:
+        return n;
+    default:
+        ssl_clear_txbuf(sslv);
+        return -error;
+    }
+}
+
 static void
 ssl_run(struct stream *stream)
 {
@@ -852,6 +888,7 @@ struct stream_class ssl_stream_class = {
     ssl_connect,                /* connect */
     ssl_recv,                   /* recv */
     ssl_send,                   /* send */
+    ssl_sendv,                  /* sendv */
     ssl_run,                    /* run */
     ssl_run_wait,               /* run_wait */
     ssl_wait,                   /* wait */
@@ -70,6 +70,7 @@ struct stream_class unix_stream_class = {
     NULL,                       /* connect */
     NULL,                       /* recv */
     NULL,                       /* send */
+    NULL,                       /* sendv */
     NULL,                       /* run */
     NULL,                       /* run_wait */
     NULL,                       /* wait */
@@ -394,6 +394,32 @@ stream_send(struct stream *stream, const void *buffer, size_t n)
             : (stream->class->send)(stream, buffer, n));
 }
 
+/* Tries to send the 'n_iov' buffers in 'iov' on 'stream', in order, as if they
+ * were a single buffer.  Return values are the same as for stream_send(), in
+ * terms of the total length of the buffers.
+ *
+ * Streams that support it send all of the buffers with a single system call,
+ * which is cheaper than calling stream_send() on each one in turn. */
+int
+stream_sendv(struct stream *stream, const struct iovec *iov, size_t n_iov)
+{
+    int retval = stream_connect(stream);
+    if (retval) {
+        return -retval;
+    }
+
+    for (; n_iov > 0 && !iov->iov_len; iov++, n_iov--) {
+        continue;
+    }
+    if (!n_iov) {
+        return 0;
+    } else if (stream->class->sendv && n_iov > 1) {
+        return (stream->class->sendv)(stream, iov, n_iov);
+    } else {
+        return (stream->class->send)(stream, iov->iov_base, iov->iov_len);
+    }
+}
+
 /* Allows 'stream' to perform maintenance activities, such as flushing
  * output buffers. */
 void
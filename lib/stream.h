@@ -42,6 +42,8 @@ ovs_be16 stream_get_local_port(const struct stream *);
 int stream_connect(struct stream *);
 int stream_recv(struct stream *, void *buffer, size_t n);
 int stream_send(struct stream *, const void *buffer, size_t n);
+struct iovec;
+int stream_sendv(struct stream *, const struct iovec *, size_t n_iov);
 
 void stream_run(struct stream *);
 void stream_run_wait(struct stream *);
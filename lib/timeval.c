@@ -19,6 +19,7 @@
 #include <assert.h>
 #include <errno.h>
 #include <poll.h>
+#include <pthread.h>
 #include <signal.h>
 #include <string.h>
 #include <sys/time.h>
@@ -44,9 +45,12 @@ static clockid_t monotonic_clock;
 static volatile sig_atomic_t wall_tick = true;
 static volatile sig_atomic_t monotonic_tick = true;
 
-/* The current time, as of the last refresh. */
+/* The current time, as of the last refresh.  Only the main thread, the one
+ * that initialized this module, uses and refreshes these.  Other threads read
+ * the clock instead. */
 static struct timespec wall_time;
 static struct timespec monotonic_time;
+static pthread_t main_thread;
 
 /* Time at which to die with SIGALRM (if not TIME_MIN). */
 static time_t deadline = TIME_MIN;
@@ -56,6 +60,8 @@ static void set_up_signal(int flags);
 static void sigalrm_handler(int);
 static void refresh_wall_if_ticked(void);
 static void refresh_monotonic_if_ticked(void);
+static bool in_main_thread(void);
+static void time_timespec_sig(struct timespec *);
 static time_t time_add(time_t, time_t);
 static void block_sigalrm(sigset_t *);
 static void unblock_sigalrm(const sigset_t *);
@@ -74,6 +80,7 @@ time_init(void)
         return;
     }
     inited = true;
+    main_thread = pthread_self();
 
     coverage_init();
 
@@ -157,6 +164,7 @@ void
 time_postfork(void)
 {
     time_init();
+    main_thread = pthread_self();
     set_up_timer();
 }
 
@@ -196,52 +204,65 @@ time_refresh(void)
 time_t
 time_now(void)
 {
-    refresh_monotonic_if_ticked();
-    return monotonic_time.tv_sec;
+    struct timespec ts;
+
+    time_timespec(&ts);
+    return ts.tv_sec;
 }
 
-/* Same as time_now() except does not write to static variables, for use in
- * signal handlers.  */
-static time_t
-time_now_sig(void)
+/* Same as time_timespec() except does not write to static variables, for use
+ * in signal handlers and in threads other than the main thread. */
+static void
+time_timespec_sig(struct timespec *ts)
 {
-    struct timespec cur_time;
-
-    clock_gettime(monotonic_clock, &cur_time);
-    return cur_time.tv_sec;
+    clock_gettime(monotonic_clock, ts);
 }
 
 /* Returns the current time, in seconds. */
 time_t
 time_wall(void)
 {
-    refresh_wall_if_ticked();
-    return wall_time.tv_sec;
+    struct timespec ts;
+
+    time_wall_timespec(&ts);
+    return ts.tv_sec;
 }
 
 /* Returns a monotonic timer, in ms (within TIME_UPDATE_INTERVAL ms). */
 long long int
 time_msec(void)
 {
-    refresh_monotonic_if_ticked();
-    return timespec_to_msec(&monotonic_time);
+    struct timespec ts;
+
+    time_timespec(&ts);
+    return timespec_to_msec(&ts);
 }
 
 /* Returns the current time, in ms (within TIME_UPDATE_INTERVAL ms). */
 long long int
 time_wall_msec(void)
 {
-    refresh_wall_if_ticked();
-    return timespec_to_msec(&wall_time);
+    struct timespec ts;
+
+    time_wall_timespec(&ts);
+    return timespec_to_msec(&ts);
 }
 
 /* Stores a monotonic timer, accurate within TIME_UPDATE_INTERVAL ms, into
- * '*ts'. */
+ * '*ts'.
+ *
+ * Threads other than the main thread may call this function and the others
+ * above that return the current time.  They get the exact time, because only
+ * the main thread may refresh the time that it caches. */
 void
 time_timespec(struct timespec *ts)
 {
-    refresh_monotonic_if_ticked();
-    *ts = monotonic_time;
+    if (in_main_thread()) {
+        refresh_monotonic_if_ticked();
+        *ts = monotonic_time;
+    } else {
+        time_timespec_sig(ts);
+    }
 }
 
 /* Stores the current time, accurate within TIME_UPDATE_INTERVAL ms, into
@@ -249,8 +270,12 @@ time_timespec(struct timespec *ts)
 void
 time_wall_timespec(struct timespec *ts)
 {
-    refresh_wall_if_ticked();
-    *ts = wall_time;
+    if (in_main_thread()) {
+        refresh_wall_if_ticked();
+        *ts = wall_time;
+    } else {
+        clock_gettime(CLOCK_REALTIME, ts);
+    }
 }
 
 /* Configures the program to die with SIGALRM 'secs' seconds from now, if
@@ -336,8 +361,13 @@ sigalrm_handler(int sig_nr)
 {
     wall_tick = true;
     monotonic_tick = true;
-    if (deadline != TIME_MIN && time_now_sig() > deadline) {
-        fatal_signal_handler(sig_nr);
+    if (deadline != TIME_MIN) {
+        struct timespec now;
+
+        time_timespec_sig(&now);
+        if (now.tv_sec > deadline) {
+            fatal_signal_handler(sig_nr);
+        }
     }
 }
 
@@ -357,6 +387,15 @@ refresh_monotonic_if_ticked(void)
     }
 }
 
+/* Returns true if the caller is running in the main thread, which is the only
+ * one that may use the cached times. */
+static bool
+in_main_thread(void)
+{
+    time_init();
+    return pthread_equal(pthread_self(), main_thread);
+}
+
 static void
 block_sigalrm(sigset_t *oldsigs)
 {
@@ -76,6 +76,30 @@ xrealloc(void *p, size_t size)
     return p;
 }
 
+/* Allocates and returns 'size' bytes of memory aligned on a CACHE_LINE_SIZE
+ * boundary.  The memory may be freed with free(). */
+void *
+xmalloc_cacheline(size_t size)
+{
+    void *p;
+
+    COVERAGE_INC(util_xalloc);
+    if (posix_memalign(&p, CACHE_LINE_SIZE, size ? size : 1)) {
+        out_of_memory();
+    }
+    return p;
+}
+
+/* Like xmalloc_cacheline() but clears the allocated memory to all zero
+ * bytes. */
+void *
+xzalloc_cacheline(size_t size)
+{
+    void *p = xmalloc_cacheline(size);
+    memset(p, 0, size);
+    return p;
+}
+
 void *
 xmemdup(const void *p_, size_t size)
 {
@@ -108,6 +108,21 @@ struct vconn_class {
      * accepted for transmission, it should return EAGAIN. */
     int (*send)(struct vconn *vconn, struct ofpbuf *msg);
 
+    /* Tries to queue the 'n' messages in 'msgs' for transmission on 'vconn',
+     * in order.  Stores the number of messages accepted into '*n_sentp'.
+     * Ownership of the accepted messages, which are always a prefix of
+     * 'msgs', is transferred to the vconn; the caller retains the rest.
+     *
+     * Returns 0 if every message was accepted, otherwise a positive errno
+     * value.  Like the send function, this function must not block: if it
+     * cannot accept all of the messages immediately, it should return
+     * EAGAIN.
+     *
+     * May be null, in which case vconn_send_batch() calls the send function
+     * on each message in turn. */
+    int (*send_batch)(struct vconn *vconn, struct ofpbuf *msgs[], size_t n,
+                      size_t *n_sentp);
+
     /* Allows 'vconn' to perform maintenance activities, such as flushing
      * output buffers.
      *
@@ -21,6 +21,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include "fatal-signal.h"
 #include "leak-checker.h"
@@ -38,11 +39,21 @@ VLOG_DEFINE_THIS_MODULE(vconn_stream);
 
 /* Active stream socket vconn. */
 
+/* Size of the receive buffer.  Each call to stream_recv() reads as much as
+ * will fit, so that a burst of small messages costs one system call instead
+ * of two per message.  It must be big enough for the largest possible
+ * OpenFlow message. */
+#define VCONN_STREAM_RX_SIZE 65536
+
+/* Maximum number of messages that vconn_stream_send_batch() passes to a
+ * single stream_sendv() call. */
+#define VCONN_STREAM_MAX_BATCH 64
+
 struct vconn_stream
 {
     struct vconn vconn;
     struct stream *stream;
-    struct ofpbuf *rxbuf;
+    struct ofpbuf *rxbuf;       /* Received bytes not yet returned. */
     struct ofpbuf *txbuf;
     int n_packets;
 };
@@ -126,18 +137,46 @@ vconn_stream_connect(struct vconn *vconn)
     return stream_connect(s->stream);
 }
 
+/* Returns the number of bytes in 's''s receive buffer needed to complete the
+ * message at its head: the length of that message, if at least its header has
+ * been received, otherwise the length of a header.  Returns 0 if the message's
+ * header specifies a bad length. */
+static size_t
+vconn_stream_rx_len(const struct vconn_stream *s)
+{
+    const struct ofp_header *oh = s->rxbuf->data;
+    size_t rx_len;
+
+    if (s->rxbuf->size < sizeof *oh) {
+        return sizeof *oh;
+    }
+
+    rx_len = ntohs(oh->length);
+    if (rx_len < sizeof *oh) {
+        VLOG_ERR_RL(&rl, "received too-short ofp_header (%zu bytes)", rx_len);
+        return 0;
+    }
+    return rx_len;
+}
+
+/* Reads as many bytes as possible from 's''s stream into its receive buffer,
+ * first moving any partial message to the front of the buffer.  Returns 0 if
+ * some data was read, otherwise a positive errno value or EOF. */
 static int
-vconn_stream_recv__(struct vconn_stream *s, int rx_len)
+vconn_stream_recv__(struct vconn_stream *s)
 {
     struct ofpbuf *rx = s->rxbuf;
-    int want_bytes, retval;
+    int retval;
+
+    if (rx->data != rx->base) {
+        memmove(rx->base, rx->data, rx->size);
+        rx->data = rx->base;
+    }
 
-    want_bytes = rx_len - rx->size;
-    ofpbuf_prealloc_tailroom(rx, want_bytes);
-    retval = stream_recv(s->stream, ofpbuf_tail(rx), want_bytes);
+    retval = stream_recv(s->stream, ofpbuf_tail(rx), ofpbuf_tailroom(rx));
     if (retval > 0) {
         rx->size += retval;
-        return retval == want_bytes ? 0 : EAGAIN;
+        return 0;
     } else if (retval == 0) {
         if (rx->size) {
             VLOG_ERR_RL(&rl, "connection dropped mid-packet");
@@ -153,41 +192,60 @@ static int
 vconn_stream_recv(struct vconn *vconn, struct ofpbuf **bufferp)
 {
     struct vconn_stream *s = vconn_stream_cast(vconn);
-    const struct ofp_header *oh;
-    int rx_len;
+    size_t rx_len;
 
-    /* Allocate new receive buffer if we don't have one. */
+    /* Allocate the receive buffer if we don't have one. */
     if (s->rxbuf == NULL) {
-        s->rxbuf = ofpbuf_new(1564);
+        s->rxbuf = ofpbuf_new(VCONN_STREAM_RX_SIZE);
     }
 
-    /* Read ofp_header. */
-    if (s->rxbuf->size < sizeof(struct ofp_header)) {
-        int retval = vconn_stream_recv__(s, sizeof(struct ofp_header));
-        if (retval) {
-            return retval;
-        }
-    }
-
-    /* Read payload. */
-    oh = s->rxbuf->data;
-    rx_len = ntohs(oh->length);
-    if (rx_len < sizeof(struct ofp_header)) {
-        VLOG_ERR_RL(&rl, "received too-short ofp_header (%d bytes)", rx_len);
+    rx_len = vconn_stream_rx_len(s);
+    if (!rx_len) {
         return EPROTO;
     } else if (s->rxbuf->size < rx_len) {
-        int retval = vconn_stream_recv__(s, rx_len);
+        /* Read once.  If that does not complete a message then the stream is
+         * (at least momentarily) out of data. */
+        int retval = vconn_stream_recv__(s);
         if (retval) {
             return retval;
         }
+
+        rx_len = vconn_stream_rx_len(s);
+        if (!rx_len) {
+            return EPROTO;
+        } else if (s->rxbuf->size < rx_len) {
+            return EAGAIN;
+        }
     }
 
     s->n_packets++;
-    *bufferp = s->rxbuf;
-    s->rxbuf = NULL;
+    if (s->rxbuf->size == rx_len && rx_len >= s->rxbuf->allocated / 2) {
+        /* The buffer holds just this message and is not much bigger than it,
+         * so hand it over as is.  A smaller message gets copied instead, so
+         * that the caller does not pin a mostly empty buffer. */
+        *bufferp = s->rxbuf;
+        s->rxbuf = NULL;
+    } else {
+        *bufferp = ofpbuf_clone_data(s->rxbuf->data, rx_len);
+        ofpbuf_pull(s->rxbuf, rx_len);
+    }
     return 0;
 }
 
+/* Returns true if 's''s receive buffer holds at least one complete message
+ * (or a bad header), so that vconn_stream_recv() will return without reading
+ * from the stream. */
+static bool
+vconn_stream_rx_ready(const struct vconn_stream *s)
+{
+    if (s->rxbuf && s->rxbuf->size >= sizeof(struct ofp_header)) {
+        const struct ofp_header *oh = s->rxbuf->data;
+        size_t rx_len = ntohs(oh->length);
+        return rx_len < sizeof *oh || s->rxbuf->size >= rx_len;
+    }
+    return false;
+}
+
 static void
 vconn_stream_clear_txbuf(struct vconn_stream *s)
 {
@@ -221,6 +279,54 @@ vconn_stream_send(struct vconn *vconn, struct ofpbuf *buffer)
     }
 }
 
+static int
+vconn_stream_send_batch(struct vconn *vconn, struct ofpbuf *msgs[], size_t n,
+                        size_t *n_sentp)
+{
+    struct vconn_stream *s = vconn_stream_cast(vconn);
+    struct iovec iov[VCONN_STREAM_MAX_BATCH];
+    size_t n_iov, n_sent, n_bytes, i;
+    ssize_t retval;
+
+    assert(n > 0);
+    if (s->txbuf) {
+        *n_sentp = 0;
+        return EAGAIN;
+    }
+
+    n_iov = MIN(n, VCONN_STREAM_MAX_BATCH);
+    for (i = 0; i < n_iov; i++) {
+        iov[i].iov_base = msgs[i]->data;
+        iov[i].iov_len = msgs[i]->size;
+    }
+    retval = stream_sendv(s->stream, iov, n_iov);
+    if (retval < 0 && retval != -EAGAIN) {
+        *n_sentp = 0;
+        return -retval;
+    }
+
+    /* Free the messages that were sent completely.  As vconn_stream_send()
+     * does, keep the first message that was not sent completely in txbuf,
+     * minus whatever part of it was sent, so that we always accept at least
+     * one message. */
+    n_sent = 0;
+    n_bytes = MAX(retval, 0);
+    while (n_sent < n_iov && n_bytes >= msgs[n_sent]->size) {
+        n_bytes -= msgs[n_sent]->size;
+        ofpbuf_delete(msgs[n_sent++]);
+    }
+    if (n_sent < n_iov) {
+        struct ofpbuf *msg = msgs[n_sent++];
+
+        leak_checker_claim(msg);
+        s->txbuf = msg;
+        ofpbuf_pull(msg, n_bytes);
+    }
+
+    *n_sentp = n_sent;
+    return n_sent < n ? EAGAIN : 0;
+}
+
 static void
 vconn_stream_run(struct vconn *vconn)
 {
@@ -280,7 +386,11 @@ vconn_stream_wait(struct vconn *vconn, enum vconn_wait_type wait)
         break;
 
     case WAIT_RECV:
-        stream_recv_wait(s->stream);
+        if (vconn_stream_rx_ready(s)) {
+            poll_immediate_wake();
+        } else {
+            stream_recv_wait(s->stream);
+        }
         break;
 
     default:
@@ -375,6 +485,7 @@ pvconn_pstream_wait(struct pvconn *pvconn)
             vconn_stream_connect,                   \
             vconn_stream_recv,                      \
             vconn_stream_send,                      \
+            vconn_stream_send_batch,                \
             vconn_stream_run,                       \
             vconn_stream_run_wait,                  \
             vconn_stream_wait,                      \
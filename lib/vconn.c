@@ -611,6 +611,49 @@ do_send(struct vconn *vconn, struct ofpbuf *msg)
     return retval;
 }
 
+/* Tries to queue the 'n' messages in 'msgs' for transmission on 'vconn', in
+ * order, and stores the number of messages accepted into '*n_sentp'.  As with
+ * vconn_send(), ownership of each accepted message is transferred to the
+ * vconn.  The accepted messages are always a prefix of 'msgs', so the caller
+ * retains ownership of 'msgs[*n_sentp]' through 'msgs[n - 1]'.
+ *
+ * Returns 0 if every message was accepted, otherwise a positive errno value.
+ * vconn_send_batch() will not block: if some of the messages cannot be
+ * accepted immediately, it returns EAGAIN.
+ *
+ * This has the same effect as calling vconn_send() on each message in turn,
+ * but stream-based vconns write the whole batch with a single system call. */
+int
+vconn_send_batch(struct vconn *vconn, struct ofpbuf *msgs[], size_t n,
+                 size_t *n_sentp)
+{
+    size_t n_sent = 0;
+    int retval;
+
+    retval = vconn_connect(vconn);
+    if (!retval && vconn->class->send_batch && n > 1
+        && !VLOG_IS_DBG_ENABLED()) {
+        size_t i;
+
+        for (i = 0; i < n; i++) {
+            const struct ofpbuf *msg = msgs[i];
+
+            assert(msg->size >= sizeof(struct ofp_header));
+            assert(((struct ofp_header *) msg->data)->length
+                   == htons(msg->size));
+        }
+        retval = (vconn->class->send_batch)(vconn, msgs, n, &n_sent);
+        COVERAGE_ADD(vconn_sent, n_sent);
+    } else if (!retval) {
+        /* do_send() logs each message at debug level. */
+        while (n_sent < n && !(retval = do_send(vconn, msgs[n_sent]))) {
+            n_sent++;
+        }
+    }
+    *n_sentp = n_sent;
+    return retval;
+}
+
 /* Same as vconn_send, except that it waits until 'msg' can be transmitted. */
 int
 vconn_send_block(struct vconn *vconn, struct ofpbuf *msg)
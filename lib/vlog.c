@@ -19,6 +19,7 @@
 #include <assert.h>
 #include <ctype.h>
 #include <errno.h>
+#include <pthread.h>
 #include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
@@ -90,6 +91,12 @@ static FILE *log_file;
 /* vlog initialized? */
 static bool vlog_inited;
 
+/* Serializes writing log messages, updating rate limiters, and replacing
+ * 'log_file', so that threads other than the main thread (such as the
+ * dpif-netdev forwarding threads) may log.  Configuring log levels and
+ * patterns is still only allowed from the main thread. */
+static pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 static void format_log_message(const struct vlog_module *, enum vlog_level,
                                enum vlog_facility, unsigned int msg_num,
                                const char *message, va_list, struct ds *)
@@ -282,8 +289,10 @@ vlog_set_log_file(const char *file_name)
     /* Close old log file. */
     if (log_file) {
         VLOG_INFO("closing log file");
+        pthread_mutex_lock(&log_mutex);
         fclose(log_file);
         log_file = NULL;
+        pthread_mutex_unlock(&log_mutex);
     }
 
     /* Update log file name and free old name.  The ordering is important
@@ -297,7 +306,9 @@ vlog_set_log_file(const char *file_name)
 
     /* Open new log file and update min_levels[] to reflect whether we actually
      * have a log_file. */
+    pthread_mutex_lock(&log_mutex);
     log_file = fopen(log_file_name, "a");
+    pthread_mutex_unlock(&log_mutex);
     for (mp = vlog_modules; mp < &vlog_modules[n_vlog_modules]; mp++) {
         update_min_level(*mp);
     }
@@ -634,6 +645,7 @@ vlog_valist(const struct vlog_module *module, enum vlog_level level,
 
         ds_init(&s);
         ds_reserve(&s, 1024);
+        pthread_mutex_lock(&log_mutex);
         msg_num++;
 
         if (log_to_console) {
@@ -656,13 +668,14 @@ vlog_valist(const struct vlog_module *module, enum vlog_level level,
             }
         }
 
-        if (log_to_file) {
+        if (log_to_file && log_file) {
             format_log_message(module, level, VLF_FILE, msg_num,
                                message, args, &s);
             ds_put_char(&s, '\n');
             fputs(ds_cstr(&s), log_file);
             fflush(log_file);
         }
+        pthread_mutex_unlock(&log_mutex);
 
         ds_destroy(&s);
         errno = save_errno;
@@ -709,10 +722,14 @@ bool
 vlog_should_drop(const struct vlog_module *module, enum vlog_level level,
                  struct vlog_rate_limit *rl)
 {
+    unsigned int n_dropped;
+    time_t first_dropped;
+
     if (!vlog_is_enabled(module, level)) {
         return true;
     }
 
+    pthread_mutex_lock(&log_mutex);
     if (rl->tokens < VLOG_MSG_TOKENS) {
         time_t now = time_now();
         if (rl->last_fill > now) {
@@ -730,17 +747,21 @@ vlog_should_drop(const struct vlog_module *module, enum vlog_level level,
                 rl->first_dropped = now;
             }
             rl->n_dropped++;
+            pthread_mutex_unlock(&log_mutex);
             return true;
         }
     }
     rl->tokens -= VLOG_MSG_TOKENS;
+    n_dropped = rl->n_dropped;
+    first_dropped = rl->first_dropped;
+    rl->n_dropped = 0;
+    pthread_mutex_unlock(&log_mutex);
 
-    if (rl->n_dropped) {
+    if (n_dropped) {
         vlog(module, level,
              "Dropped %u log messages in last %u seconds "
              "due to excessive rate",
-             rl->n_dropped, (unsigned int) (time_now() - rl->first_dropped));
-        rl->n_dropped = 0;
+             n_dropped, (unsigned int) (time_now() - first_dropped));
     }
     return false;
 }
@@ -18,11 +18,13 @@
 
 #include "connmgr.h"
 
+#include <assert.h>
 #include <errno.h>
 #include <stdlib.h>
 
 #include "coverage.h"
 #include "dpif.h"
+#include "dynamic-string.h"
 #include "fail-open.h"
 #include "in-band.h"
 #include "odp-util.h"
@@ -52,8 +54,7 @@ struct ofconn {
 
     /* OFPT_PACKET_IN related data. */
     struct rconn_packet_counter *packet_in_counter; /* # queued on 'rconn'. */
-#define N_SCHEDULERS 2
-    struct pinsched *schedulers[N_SCHEDULERS];
+    struct pinsched *pinsched;     /* Rate limiter, if any. */
     struct pktbuf *pktbuf;         /* OpenFlow packet buffers. */
     int miss_send_len;             /* Bytes to send of buffered packets. */
 
@@ -63,6 +64,10 @@ struct ofconn {
 #define OFCONN_REPLY_MAX 100
     struct rconn_packet_counter *reply_counter;
 
+    /* Number of replies queued on 'rconn' at which long-running requests, such
+     * as big flow statistics dumps, pause until some of them drain. */
+#define OFCONN_REPLY_BACKLOG 10
+
     /* type == OFCONN_PRIMARY only. */
     enum nx_role role;           /* Role. */
     struct hmap_node hmap_node;  /* In struct connmgr's "controllers" map. */
@@ -380,6 +385,45 @@ connmgr_get_controller_info(struct connmgr *mgr, struct shash *info)
             cinfo->pairs.values[cinfo->pairs.n++]
                 = xasprintf("%ld", (long int) (now - last_disconnect));
         }
+
+        if (ofconn->pinsched) {
+            struct pinsched_stats stats;
+
+            pinsched_get_stats(ofconn->pinsched, &stats);
+
+            cinfo->pairs.keys[cinfo->pairs.n] = "packet_in_queued";
+            cinfo->pairs.values[cinfo->pairs.n++]
+                = xasprintf("%d", stats.n_queued);
+
+            cinfo->pairs.keys[cinfo->pairs.n] = "packet_in_dropped";
+            cinfo->pairs.values[cinfo->pairs.n++]
+                = xasprintf("%llu", stats.n_dropped);
+
+            cinfo->pairs.keys[cinfo->pairs.n] = "packet_in_avg_latency";
+            cinfo->pairs.values[cinfo->pairs.n++]
+                = xasprintf("%lld", stats.avg_latency);
+
+            cinfo->pairs.keys[cinfo->pairs.n] = "packet_in_max_latency";
+            cinfo->pairs.values[cinfo->pairs.n++]
+                = xasprintf("%lld", stats.max_latency);
+        }
+        assert(cinfo->pairs.n <= ARRAY_SIZE(cinfo->pairs.keys));
+    }
+}
+
+/* Appends a description of the packet-in rate limiter of each of 'mgr''s
+ * OpenFlow connections that has one, including each of its queues, to 'ds'.
+ * This is for use by the "ofproto/packet-in-status" unixctl command. */
+void
+connmgr_format_packet_in_status(const struct connmgr *mgr, struct ds *ds)
+{
+    const struct ofconn *ofconn;
+
+    LIST_FOR_EACH (ofconn, node, &mgr->all_conns) {
+        if (ofconn->pinsched) {
+            ds_put_format(ds, "\t%s:\n", ofconn_get_target(ofconn));
+            pinsched_format(ofconn->pinsched, ds);
+        }
     }
 }
 
@@ -744,6 +788,16 @@ ofconn_send_reply(const struct ofconn *ofconn, struct ofpbuf *msg)
     ofconn_send(ofconn, msg, ofconn->reply_counter);
 }
 
+/* Returns true if 'ofconn' has enough replies queued that a long-running
+ * request should stop producing output for now.  The ofconn wakes up the poll
+ * loop as the queue drains. */
+bool
+ofconn_is_backlogged(const struct ofconn *ofconn)
+{
+    return (rconn_packet_counter_read(ofconn->reply_counter)
+            >= OFCONN_REPLY_BACKLOG);
+}
+
 /* Same as pktbuf_retrieve(), using the pktbuf owned by 'ofconn'. */
 int
 ofconn_pktbuf_retrieve(struct ofconn *ofconn, uint32_t id,
@@ -780,6 +834,8 @@ ofconn_create(struct connmgr *mgr, struct rconn *rconn, enum ofconn_type type)
 static void
 ofconn_destroy(struct ofconn *ofconn)
 {
+    ofproto_ofconn_destroyed(ofconn->connmgr->ofproto, ofconn);
+
     if (ofconn->type == OFCONN_PRIMARY) {
         hmap_remove(&ofconn->connmgr->controllers, &ofconn->hmap_node);
     }
@@ -789,6 +845,7 @@ ofconn_destroy(struct ofconn *ofconn)
     rconn_packet_counter_destroy(ofconn->packet_in_counter);
     rconn_packet_counter_destroy(ofconn->reply_counter);
     pktbuf_destroy(ofconn->pktbuf);
+    pinsched_destroy(ofconn->pinsched);
     free(ofconn);
 }
 
@@ -815,11 +872,8 @@ ofconn_run(struct ofconn *ofconn,
 {
     struct connmgr *mgr = ofconn->connmgr;
     int iteration;
-    size_t i;
 
-    for (i = 0; i < N_SCHEDULERS; i++) {
-        pinsched_run(ofconn->schedulers[i], do_send_packet_in, ofconn);
-    }
+    pinsched_run(ofconn->pinsched, do_send_packet_in, ofconn);
 
     rconn_run(ofconn->rconn);
 
@@ -847,11 +901,7 @@ ofconn_run(struct ofconn *ofconn,
 static void
 ofconn_wait(struct ofconn *ofconn)
 {
-    int i;
-
-    for (i = 0; i < N_SCHEDULERS; i++) {
-        pinsched_wait(ofconn->schedulers[i]);
-    }
+    pinsched_wait(ofconn->pinsched);
     rconn_run_wait(ofconn->rconn);
     if (rconn_packet_counter_read (ofconn->reply_counter) < OFCONN_REPLY_MAX) {
         rconn_recv_wait(ofconn->rconn);
@@ -891,21 +941,15 @@ ofconn_make_name(const struct connmgr *mgr, const char *target)
 static void
 ofconn_set_rate_limit(struct ofconn *ofconn, int rate, int burst)
 {
-    int i;
-
-    for (i = 0; i < N_SCHEDULERS; i++) {
-        struct pinsched **s = &ofconn->schedulers[i];
-
-        if (rate > 0) {
-            if (!*s) {
-                *s = pinsched_create(rate, burst);
-            } else {
-                pinsched_set_limits(*s, rate, burst);
-            }
+    if (rate > 0) {
+        if (!ofconn->pinsched) {
+            ofconn->pinsched = pinsched_create(rate, burst);
         } else {
-            pinsched_destroy(*s);
-            *s = NULL;
+            pinsched_set_limits(ofconn->pinsched, rate, burst);
         }
+    } else {
+        pinsched_destroy(ofconn->pinsched);
+        ofconn->pinsched = NULL;
     }
 }
 
@@ -1061,8 +1105,8 @@ schedule_packet_in(struct ofconn *ofconn, const struct dpif_upcall *upcall,
     /* Make OFPT_PACKET_IN and hand over to packet scheduler.  It might
      * immediately call into do_send_packet_in() or it might buffer it for a
      * while (until a later call to pinsched_run()). */
-    pinsched_send(ofconn->schedulers[upcall->type == DPIF_UC_MISS ? 0 : 1],
-                  flow->in_port, ofputil_encode_packet_in(&pin, rw_packet),
+    pinsched_send(ofconn->pinsched, pin.in_port, pin.reason,
+                  ofputil_encode_packet_in(&pin, rw_packet),
                   do_send_packet_in, ofconn);
 }
 
@@ -24,6 +24,7 @@
 #include "openvswitch/types.h"
 
 struct dpif_upcall;
+struct ds;
 struct ofconn;
 struct ofputil_flow_removed;
 struct sset;
@@ -63,6 +64,7 @@ struct ofproto *ofconn_get_ofproto(const struct ofconn *);
 /* OpenFlow configuration. */
 bool connmgr_has_controllers(const struct connmgr *);
 void connmgr_get_controller_info(struct connmgr *, struct shash *);
+void connmgr_format_packet_in_status(const struct connmgr *, struct ds *);
 void connmgr_set_controllers(struct connmgr *,
                              const struct ofproto_controller[], size_t n);
 void connmgr_reconnect(const struct connmgr *);
@@ -84,6 +86,7 @@ int ofconn_get_miss_send_len(const struct ofconn *);
 void ofconn_set_miss_send_len(struct ofconn *, int miss_send_len);
 
 void ofconn_send_reply(const struct ofconn *, struct ofpbuf *);
+bool ofconn_is_backlogged(const struct ofconn *);
 
 int ofconn_pktbuf_retrieve(struct ofconn *, uint32_t id,
                            struct ofpbuf **bufferp, uint16_t *in_port);
@@ -53,6 +53,7 @@
 #include "pinsched.h"
 #include "pktbuf.h"
 #include "poll-loop.h"
+#include "pool.h"
 #include "rconn.h"
 #include "shash.h"
 #include "sset.h"
@@ -68,6 +69,7 @@
 VLOG_DEFINE_THIS_MODULE(ofproto);
 
 COVERAGE_DEFINE(facet_changed_rule);
+COVERAGE_DEFINE(facet_evicted);
 COVERAGE_DEFINE(facet_revalidate);
 COVERAGE_DEFINE(odp_overflow);
 COVERAGE_DEFINE(ofproto_agg_request);
@@ -77,6 +79,9 @@ COVERAGE_DEFINE(ofproto_del_rule);
 COVERAGE_DEFINE(ofproto_error);
 COVERAGE_DEFINE(ofproto_expiration);
 COVERAGE_DEFINE(ofproto_expired);
+COVERAGE_DEFINE(ofproto_flow_dump_deferred);
+COVERAGE_DEFINE(ofproto_flow_dump_paused);
+COVERAGE_DEFINE(ofproto_flow_mod_batched);
 COVERAGE_DEFINE(ofproto_flows_req);
 COVERAGE_DEFINE(ofproto_flush);
 COVERAGE_DEFINE(ofproto_invalidated);
@@ -139,6 +144,7 @@ struct action_xlate_ctx {
 
     struct ofpbuf *odp_actions; /* Datapath actions. */
     tag_type tags;              /* Tags associated with OFPP_NORMAL actions. */
+    tag_type table_tags;        /* Tags for resubmit lookups. */
     bool may_set_up_flow;       /* True ordinarily; false if the actions must
                                  * be reassessed for every packet. */
     uint16_t nf_output_iface;   /* Output interface index for NetFlow. */
@@ -199,7 +205,9 @@ static struct rule *rule_create(const struct cls_rule *,
 static void rule_destroy(struct ofproto *, struct rule *);
 static void rule_free(struct rule *);
 
-static struct rule *rule_lookup(struct ofproto *, const struct flow *);
+static struct rule *rule_lookup(struct ofproto *, const struct flow *,
+                                tag_type *table_tags);
+static tag_type rule_calculate_tag(const struct rule *);
 static void rule_insert(struct ofproto *, struct rule *);
 static void rule_remove(struct ofproto *, struct rule *);
 
@@ -210,6 +218,7 @@ static void rule_get_stats(const struct rule *, uint64_t *packets,
 /* An exact-match instantiation of an OpenFlow flow. */
 struct facet {
     long long int used;         /* Time last used; time created if not used. */
+    long long int created;      /* Time created. */
 
     /* These statistics:
      *
@@ -240,30 +249,38 @@ struct facet {
     uint64_t accounted_bytes;
 
     struct hmap_node hmap_node;  /* In owning ofproto's 'facets' hmap. */
+    struct hmap_node key_node;   /* In owning ofproto's 'facets_by_key'. */
     struct list list_node;       /* In owning rule's 'facets' list. */
     struct rule *rule;           /* Owning rule. */
     struct flow flow;            /* Exact-match flow. */
+    struct nlattr *key;          /* 'flow' as a datapath flow key. */
+    size_t key_len;              /* Number of bytes in 'key'. */
     bool installed;              /* Installed in datapath? */
     bool may_install;            /* True ordinarily; false if actions must
                                   * be reassessed for every packet. */
     size_t actions_len;          /* Number of bytes in actions[]. */
     struct nlattr *actions;      /* Datapath actions. */
     tag_type tags;               /* Tags (set only by hooks). */
+    tag_type table_tags;         /* Tags for lookups in the flow table. */
+    unsigned int reval_seq;      /* 'reval_seq' when last revalidated. */
     struct netflow_flow nf_flow; /* Per-flow NetFlow tracking data. */
 };
 
 static struct facet *facet_create(struct ofproto *, struct rule *,
-                                  const struct flow *,
+                                  const struct flow *, tag_type table_tags,
                                   const struct ofpbuf *packet);
 static void facet_remove(struct ofproto *, struct facet *);
 static void facet_free(struct facet *);
+static size_t facet_memory_size(const struct facet *);
 
 static struct facet *facet_lookup_valid(struct ofproto *, const struct flow *);
 static bool facet_revalidate(struct ofproto *, struct facet *);
+static bool facet_is_stale(const struct ofproto *, const struct facet *);
 
 static void facet_install(struct ofproto *, struct facet *, bool zero_stats);
 static void facet_uninstall(struct ofproto *, struct facet *);
 static void facet_flush_stats(struct ofproto *, struct facet *);
+static void ofproto_evict_facets(struct ofproto *);
 
 static void facet_make_actions(struct ofproto *, struct facet *,
                                const struct ofpbuf *packet);
@@ -301,11 +318,46 @@ struct ofproto {
 
     /* Facets. */
     struct hmap facets;
-    bool need_revalidate;
-    struct tag_set revalidate_set;
+    struct hmap facets_by_key;  /* Indexed by hash of datapath flow key. */
+    size_t facet_bytes;         /* Memory used by facets, in bytes. */
+    size_t facet_budget;        /* Max 'facet_bytes' or 0 for no limit. */
+    unsigned long long int facet_n_evictions; /* Evicted for the budget. */
+    bool need_revalidate;       /* Revalidate every facet. */
+    struct tag_set revalidate_set; /* Revalidate facets with these tags. */
+
+    /* Revalidation pass in progress, if 'reval_active'.  ofproto_run2() starts
+     * a pass for the revalidation requested in 'need_revalidate' and
+     * 'revalidate_set' and then carries it out a slice at a time.  Each facet
+     * that the pass has already visited has 'reval_seq' as its own
+     * 'reval_seq'. */
+    bool reval_active;
+    bool reval_all;             /* Revalidate every facet? */
+    struct tag_set reval_set;   /* If not, revalidate facets with these tags. */
+    unsigned int reval_seq;     /* Incremented at the start of each pass. */
+    uint32_t reval_bucket;      /* Position in 'facets' for next slice. */
+    uint32_t reval_offset;
+    size_t reval_mask;          /* 'facets.mask' when position was saved. */
+    unsigned int reval_n_visited; /* Facets visited in the current sweep. */
+    long long int reval_started;  /* Time at which the pass started. */
+
+    /* Revalidation statistics, for ofproto/revalidation-status. */
+    unsigned long long int reval_n_passes;
+    unsigned long long int reval_n_checked;
+    unsigned long long int reval_n_revalidated;
+    long long int reval_last_msec; /* Duration of last completed pass. */
+
+    /* Flow statistics dump statistics, for ofproto/flow-stats-status. */
+    unsigned long long int stats_n_dumps;
+    unsigned long long int stats_n_strays; /* Unknown datapath flows deleted. */
+    size_t stats_last_flows;    /* Datapath flows seen in last dump. */
+    long long int stats_last_msec; /* Duration of last dump. */
 
     /* OpenFlow connections. */
     struct connmgr *connmgr;
+    struct list flow_dumps;     /* Contains "struct flow_dump"s. */
+
+    /* Flow table modification batches. */
+    struct list flow_mod_batches; /* Contains "struct flow_mod_batch"es. */
 
     /* Hooks for ovs-vswitchd. */
     const struct ofhooks *ofhooks;
@@ -318,6 +370,12 @@ struct ofproto {
 /* Map from dpif name to struct ofproto, for use by unixctl commands. */
 static struct shash all_ofprotos = SHASH_INITIALIZER(&all_ofprotos);
 
+/* Memory for facets and rules and for their actions and datapath flow keys,
+ * which are allocated and freed at a high rate.  Shared by all ofprotos. */
+static struct pool facet_pool;
+static struct pool rule_pool;
+static struct pool_set actions_pool;
+
 static struct vlog_rate_limit rl = VLOG_RATE_LIMIT_INIT(1, 5);
 
 static const struct ofhooks default_ofhooks;
@@ -326,12 +384,17 @@ static uint64_t pick_datapath_id(const struct ofproto *);
 static uint64_t pick_fallback_dpid(void);
 
 static void ofproto_flush_flows__(struct ofproto *);
+static void flow_dumps_run(struct ofproto *);
+static void flow_dumps_wait(struct ofproto *);
+static void flow_dumps_rule_changed(struct ofproto *, struct rule *);
+static void flow_dumps_destroy(struct ofproto *);
 static int ofproto_expire(struct ofproto *);
 static void flow_push_stats(struct ofproto *, const struct rule *,
                             struct flow *, uint64_t packets, uint64_t bytes,
                             long long int used);
 
-static void handle_upcall(struct ofproto *, struct dpif_upcall *);
+#define FLOW_MISS_MAX_BATCH 50
+static void handle_upcalls(struct ofproto *, struct dpif_upcall *, size_t n);
 
 static void handle_openflow(struct ofconn *, struct ofpbuf *);
 
@@ -341,6 +404,7 @@ static int init_ports(struct ofproto *);
 static void reinit_ports(struct ofproto *);
 
 static void ofproto_unixctl_init(void);
+static void ofproto_pools_init(void);
 
 int
 ofproto_create(const char *datapath, const char *datapath_type,
@@ -355,6 +419,7 @@ ofproto_create(const char *datapath, const char *datapath_type,
     *ofprotop = NULL;
 
     ofproto_unixctl_init();
+    ofproto_pools_init();
 
     /* Connect to datapath and start listening for messages. */
     error = dpif_open(datapath, datapath_type, &dpif);
@@ -407,11 +472,19 @@ ofproto_create(const char *datapath, const char *datapath_type,
     /* Initialize flow table. */
     classifier_init(&p->cls);
     timer_set_duration(&p->next_expiration, 1000);
+    list_init(&p->flow_dumps);
+    list_init(&p->flow_mod_batches);
 
     /* Initialize facet table. */
     hmap_init(&p->facets);
+    hmap_init(&p->facets_by_key);
+    p->facet_bytes = 0;
+    p->facet_budget = 0;
+    p->facet_n_evictions = 0;
     p->need_revalidate = false;
     tag_set_init(&p->revalidate_set);
+    p->reval_active = false;
+    p->reval_seq = 0;
 
     /* Initialize hooks. */
     if (ofhooks) {
@@ -492,6 +565,16 @@ ofproto_set_in_band_queue(struct ofproto *ofproto, int queue_id)
     connmgr_set_in_band_queue(ofproto->connmgr, queue_id);
 }
 
+/* Sets the maximum amount of memory, in bytes, that 'ofproto' may use for
+ * facets to 'budget'.  When its facets use more than that, whether because new
+ * facets were created or because the budget was lowered, 'ofproto' evicts the
+ * least valuable ones.  A 'budget' of 0 means that there is no limit. */
+void
+ofproto_set_facet_budget(struct ofproto *ofproto, size_t budget)
+{
+    ofproto->facet_budget = budget;
+}
+
 void
 ofproto_set_desc(struct ofproto *p,
                  const char *mfr_desc, const char *hw_desc,
@@ -656,6 +739,19 @@ ofproto_get_datapath_id(const struct ofproto *ofproto)
     return ofproto->datapath_id;
 }
 
+/* Stores in '*n_facets' the number of facets in 'ofproto', in '*n_bytes' the
+ * amount of memory that they use, in bytes, and in '*n_evictions' the number
+ * of facets that have been evicted to keep within 'ofproto''s facet memory
+ * budget. */
+void
+ofproto_get_facet_usage(const struct ofproto *ofproto, size_t *n_facets,
+                        size_t *n_bytes, unsigned long long int *n_evictions)
+{
+    *n_facets = hmap_count(&ofproto->facets);
+    *n_bytes = ofproto->facet_bytes;
+    *n_evictions = ofproto->facet_n_evictions;
+}
+
 bool
 ofproto_has_primary_controller(const struct ofproto *ofproto)
 {
@@ -691,10 +787,12 @@ ofproto_destroy(struct ofproto *p)
 
     shash_find_and_delete(&all_ofprotos, dpif_name(p->dpif));
 
+    flow_dumps_destroy(p);
     ofproto_flush_flows__(p);
     connmgr_destroy(p->connmgr);
     classifier_destroy(&p->cls);
     hmap_destroy(&p->facets);
+    hmap_destroy(&p->facets_by_key);
 
     dpif_close(p->dpif);
     netdev_monitor_destroy(p->netdev_monitor);
@@ -744,19 +842,18 @@ process_port_change(struct ofproto *ofproto, int error, char *devname)
 int
 ofproto_run1(struct ofproto *p)
 {
+    struct dpif_upcall upcalls[FLOW_MISS_MAX_BATCH];
     struct ofport *ofport;
+    size_t n_upcalls;
     char *devname;
     int error;
-    int i;
 
     if (shash_is_empty(&p->port_by_name)) {
         init_ports(p);
     }
 
-    for (i = 0; i < 50; i++) {
-        struct dpif_upcall packet;
-
-        error = dpif_recv(p->dpif, &packet);
+    for (n_upcalls = 0; n_upcalls < FLOW_MISS_MAX_BATCH; n_upcalls++) {
+        error = dpif_recv(p->dpif, &upcalls[n_upcalls]);
         if (error) {
             if (error == ENODEV) {
                 /* Someone destroyed the datapath behind our back.  The caller
@@ -765,13 +862,13 @@ ofproto_run1(struct ofproto *p)
                 static struct vlog_rate_limit rl2 = VLOG_RATE_LIMIT_INIT(1, 5);
                 VLOG_ERR_RL(&rl2, "%s: datapath was destroyed externally",
                             dpif_name(p->dpif));
+                handle_upcalls(p, upcalls, n_upcalls);
                 return ENODEV;
             }
             break;
         }
-
-        handle_upcall(p, &packet);
     }
+    handle_upcalls(p, upcalls, n_upcalls);
 
     while ((error = dpif_port_poll(p->dpif, &devname)) != EAGAIN) {
         process_port_change(p, error, devname);
@@ -786,6 +883,7 @@ ofproto_run1(struct ofproto *p)
     }
 
     connmgr_run(p->connmgr, handle_openflow);
+    flow_dumps_run(p);
 
     if (timer_expired(&p->next_expiration)) {
         int delay = ofproto_expire(p);
@@ -803,31 +901,111 @@ ofproto_run1(struct ofproto *p)
     return 0;
 }
 
-int
-ofproto_run2(struct ofproto *p, bool revalidate_all)
+/* Maximum amount of time that ofproto_run2() spends revalidating facets, in
+ * milliseconds.  Revalidation that takes longer than this continues on the
+ * next trip through the main loop. */
+#define REVALIDATE_MAX_MSEC 10
+
+/* Starts a revalidation pass for the revalidation requested in 'p' so far. */
+static void
+revalidate_start(struct ofproto *p)
 {
-    /* Figure out what we need to revalidate now, if anything. */
-    struct tag_set revalidate_set = p->revalidate_set;
-    if (p->need_revalidate) {
-        revalidate_all = true;
-    }
+    p->reval_active = true;
+    p->reval_all = p->need_revalidate;
+    p->reval_set = p->revalidate_set;
+    p->reval_seq++;
+    p->reval_bucket = p->reval_offset = 0;
+    p->reval_mask = p->facets.mask;
+    p->reval_n_visited = 0;
+    p->reval_started = time_msec();
 
-    /* Clear the revalidation flags. */
-    tag_set_init(&p->revalidate_set);
     p->need_revalidate = false;
+    tag_set_init(&p->revalidate_set);
+}
+
+/* Continues the revalidation pass in progress in 'p' for up to
+ * REVALIDATE_MAX_MSEC ms.
+ *
+ * Facets may be added to and removed from 'p->facets' between slices, which
+ * can cause a sweep through the hash table to miss some of them.  Therefore,
+ * the pass only ends after a sweep that finds every facet already visited. */
+static void
+revalidate_run(struct ofproto *p)
+{
+    long long int deadline;
+    unsigned int n;
+
+    time_refresh();
+    deadline = time_msec() + REVALIDATE_MAX_MSEC;
+    for (n = 1; ; n++) {
+        struct hmap_node *node;
+        struct facet *facet;
+
+        if (!(n % 64)) {
+            time_refresh();
+            if (time_msec() >= deadline) {
+                return;
+            }
+        }
+
+        if (p->facets.mask != p->reval_mask) {
+            /* 'p->facets' was resized, so our position in it no longer means
+             * anything.  Start a new sweep. */
+            p->reval_bucket = p->reval_offset = 0;
+            p->reval_mask = p->facets.mask;
+            p->reval_n_visited = 0;
+        }
 
-    /* Now revalidate if there's anything to do. */
-    if (revalidate_all || !tag_set_is_empty(&revalidate_set)) {
-        struct facet *facet, *next;
+        node = hmap_at_position(&p->facets,
+                                &p->reval_bucket, &p->reval_offset);
+        if (!node) {
+            if (p->reval_n_visited) {
+                p->reval_n_visited = 0;
+                continue;
+            }
+            break;
+        }
 
-        HMAP_FOR_EACH_SAFE (facet, next, hmap_node, &p->facets) {
-            if (revalidate_all
-                || tag_set_intersects(&revalidate_set, facet->tags)) {
-                facet_revalidate(p, facet);
+        facet = CONTAINER_OF(node, struct facet, hmap_node);
+        if (facet->reval_seq == p->reval_seq) {
+            continue;
+        }
+        facet->reval_seq = p->reval_seq;
+        p->reval_n_visited++;
+        p->reval_n_checked++;
+
+        if (p->reval_all
+            || tag_set_intersects(&p->reval_set,
+                                  facet->tags | facet->table_tags)) {
+            p->reval_n_revalidated++;
+            if (!facet_revalidate(p, facet) && p->reval_offset) {
+                /* The next facet in the bucket moved into the position of the
+                 * one that was destroyed. */
+                p->reval_offset--;
             }
         }
     }
 
+    p->reval_active = false;
+    p->reval_n_passes++;
+    p->reval_last_msec = time_msec() - p->reval_started;
+}
+
+int
+ofproto_run2(struct ofproto *p, bool revalidate_all)
+{
+    if (revalidate_all) {
+        p->need_revalidate = true;
+    }
+
+    if (!p->reval_active
+        && (p->need_revalidate || !tag_set_is_empty(&p->revalidate_set))) {
+        revalidate_start(p);
+    }
+    if (p->reval_active) {
+        revalidate_run(p);
+    }
+
     return 0;
 }
 
@@ -842,15 +1020,12 @@ ofproto_wait(struct ofproto *p)
     dpif_recv_wait(p->dpif);
     dpif_port_poll_wait(p->dpif);
     netdev_monitor_poll_wait(p->netdev_monitor);
+    flow_dumps_wait(p);
     if (p->sflow) {
         ofproto_sflow_wait(p->sflow);
     }
-    if (!tag_set_is_empty(&p->revalidate_set)) {
-        poll_immediate_wake();
-    }
-    if (p->need_revalidate) {
-        /* Shouldn't happen, but if it does just go around again. */
-        VLOG_DBG_RL(&rl, "need revalidate in ofproto_wait_cb()");
+    if (p->reval_active || p->need_revalidate
+        || !tag_set_is_empty(&p->revalidate_set)) {
         poll_immediate_wake();
     } else {
         timer_wait(&p->next_expiration);
@@ -1345,7 +1520,7 @@ rule_create(const struct cls_rule *cls_rule,
             uint16_t idle_timeout, uint16_t hard_timeout,
             ovs_be64 flow_cookie, bool send_flow_removed)
 {
-    struct rule *rule = xzalloc(sizeof *rule);
+    struct rule *rule = pool_zalloc(&rule_pool);
     rule->cr = *cls_rule;
     rule->idle_timeout = idle_timeout;
     rule->hard_timeout = hard_timeout;
@@ -1355,7 +1530,8 @@ rule_create(const struct cls_rule *cls_rule,
     list_init(&rule->facets);
     if (n_actions > 0) {
         rule->n_actions = n_actions;
-        rule->actions = xmemdup(actions, n_actions * sizeof *actions);
+        rule->actions = pool_set_memdup(&actions_pool, actions,
+                                        n_actions * sizeof *actions);
     }
 
     return rule;
@@ -1370,8 +1546,9 @@ rule_from_cls_rule(const struct cls_rule *cls_rule)
 static void
 rule_free(struct rule *rule)
 {
-    free(rule->actions);
-    free(rule);
+    pool_set_free(&actions_pool, rule->actions,
+                  rule->n_actions * sizeof *rule->actions);
+    pool_free(&rule_pool, rule);
 }
 
 /* Destroys 'rule' and iterates through all of its facets and revalidates them,
@@ -1382,6 +1559,8 @@ static void
 rule_destroy(struct ofproto *ofproto, struct rule *rule)
 {
     struct facet *facet, *next_facet;
+
+    flow_dumps_rule_changed(ofproto, rule);
     LIST_FOR_EACH_SAFE (facet, next_facet, list_node, &rule->facets) {
         facet_revalidate(ofproto, facet);
     }
@@ -1409,6 +1588,15 @@ rule_has_out_port(const struct rule *rule, ovs_be16 out_port)
     return false;
 }
 
+/* Returns true if 'odp_actions' consists solely of a single action that sends
+ * the packet to the controller. */
+static bool
+is_controller_only(const struct nlattr *odp_actions, size_t actions_len)
+{
+    return (actions_len == NLA_ALIGN(NLA_HDRLEN + sizeof(uint64_t))
+            && odp_actions->nla_type == ODP_ACTION_ATTR_CONTROLLER);
+}
+
 /* Executes, within 'ofproto', the 'n_actions' actions in 'actions' on
  * 'packet', which arrived on 'in_port'.
  *
@@ -1418,8 +1606,7 @@ execute_odp_actions(struct ofproto *ofproto, const struct flow *flow,
                     const struct nlattr *odp_actions, size_t actions_len,
                     struct ofpbuf *packet)
 {
-    if (actions_len == NLA_ALIGN(NLA_HDRLEN + sizeof(uint64_t))
-        && odp_actions->nla_type == ODP_ACTION_ATTR_CONTROLLER) {
+    if (is_controller_only(odp_actions, actions_len)) {
         /* As an optimization, avoid a round-trip from userspace to kernel to
          * userspace.  This also avoids possibly filling up kernel packet
          * buffers along the way. */
@@ -1488,6 +1675,7 @@ rule_execute(struct ofproto *ofproto, struct rule *rule, uint16_t in_port,
 {
     struct action_xlate_ctx ctx;
     struct ofpbuf *odp_actions;
+    tag_type table_tags;
     struct facet *facet;
     struct flow flow;
     size_t size;
@@ -1505,10 +1693,12 @@ rule_execute(struct ofproto *ofproto, struct rule *rule, uint16_t in_port,
 
     /* Otherwise, if 'rule' is in fact the correct rule for 'packet', then
      * create a new facet for it and use that. */
-    if (rule_lookup(ofproto, &flow) == rule) {
-        facet = facet_create(ofproto, rule, &flow, packet);
+    table_tags = 0;
+    if (rule_lookup(ofproto, &flow, &table_tags) == rule) {
+        facet = facet_create(ofproto, rule, &flow, table_tags, packet);
         facet_execute(ofproto, facet, packet);
         facet_install(ofproto, facet, true);
+        ofproto_evict_facets(ofproto);
         return;
     }
 
@@ -1531,33 +1721,56 @@ rule_execute(struct ofproto *ofproto, struct rule *rule, uint16_t in_port,
 static void
 rule_insert(struct ofproto *p, struct rule *rule)
 {
+    bool reachable = classifier_rule_is_reachable(&p->cls, &rule->cr);
     struct rule *displaced_rule;
 
     displaced_rule = rule_from_cls_rule(classifier_insert(&p->cls, &rule->cr));
     if (displaced_rule) {
         rule_destroy(p, displaced_rule);
     }
-    p->need_revalidate = true;
+
+    if (!reachable) {
+        /* Lookups that stopped before reaching 'rule''s classifier table, or
+         * that predate the table, did not tag their facets with anything that
+         * 'rule' could match. */
+        p->need_revalidate = true;
+    } else {
+        ofproto_revalidate(p, rule_calculate_tag(rule));
+    }
 }
 
 /* Creates and returns a new facet within 'ofproto' owned by 'rule', given a
- * 'flow' and an example 'packet' within that flow.
+ * 'flow' and an example 'packet' within that flow.  'table_tags' must be the
+ * tags from the rule_lookup() that found 'rule'.
  *
  * The caller must already have determined that no facet with an identical
  * 'flow' exists in 'ofproto' and that 'flow' is the best match for 'rule' in
  * 'ofproto''s classifier table. */
 static struct facet *
 facet_create(struct ofproto *ofproto, struct rule *rule,
-             const struct flow *flow, const struct ofpbuf *packet)
+             const struct flow *flow, tag_type table_tags,
+             const struct ofpbuf *packet)
 {
+    struct odputil_keybuf keybuf;
     struct facet *facet;
+    struct ofpbuf key;
 
-    facet = xzalloc(sizeof *facet);
-    facet->used = time_msec();
+    facet = pool_zalloc(&facet_pool);
+    facet->used = facet->created = time_msec();
     hmap_insert(&ofproto->facets, &facet->hmap_node, flow_hash(flow, 0));
     list_push_back(&rule->facets, &facet->list_node);
     facet->rule = rule;
     facet->flow = *flow;
+    facet->table_tags = table_tags;
+
+    ofpbuf_use_stack(&key, &keybuf, sizeof keybuf);
+    odp_flow_key_from_flow(&key, flow);
+    facet->key = pool_set_memdup(&actions_pool, key.data, key.size);
+    facet->key_len = key.size;
+    hmap_insert(&ofproto->facets_by_key, &facet->key_node,
+                hash_bytes(facet->key, facet->key_len, 0));
+    ofproto->facet_bytes += facet_memory_size(facet);
+
     netflow_flow_init(&facet->nf_flow);
     netflow_flow_update_time(ofproto->netflow, &facet->nf_flow, facet->used);
 
@@ -1569,8 +1782,17 @@ facet_create(struct ofproto *ofproto, struct rule *rule,
 static void
 facet_free(struct facet *facet)
 {
-    free(facet->actions);
-    free(facet);
+    pool_set_free(&actions_pool, facet->actions, facet->actions_len);
+    pool_set_free(&actions_pool, facet->key, facet->key_len);
+    pool_free(&facet_pool, facet);
+}
+
+/* Returns the number of bytes of memory that 'facet' occupies, for the
+ * purpose of its ofproto's facet memory budget. */
+static size_t
+facet_memory_size(const struct facet *facet)
+{
+    return sizeof *facet + facet->key_len + facet->actions_len;
 }
 
 /* Remove 'rule' from 'ofproto' and free up the associated memory:
@@ -1584,7 +1806,7 @@ static void
 rule_remove(struct ofproto *ofproto, struct rule *rule)
 {
     COVERAGE_INC(ofproto_del_rule);
-    ofproto->need_revalidate = true;
+    ofproto_revalidate(ofproto, rule_calculate_tag(rule));
     classifier_remove(&ofproto->cls, &rule->cr);
     rule_destroy(ofproto, rule);
 }
@@ -1594,7 +1816,8 @@ rule_remove(struct ofproto *ofproto, struct rule *rule)
  *   - If 'facet' was installed in the datapath, uninstalls it and updates its
  *     rule's statistics, via facet_uninstall().
  *
- *   - Removes 'facet' from its rule and from ofproto->facets.
+ *   - Removes 'facet' from its rule and from ofproto->facets and
+ *     ofproto->facets_by_key.
  */
 static void
 facet_remove(struct ofproto *ofproto, struct facet *facet)
@@ -1602,7 +1825,9 @@ facet_remove(struct ofproto *ofproto, struct facet *facet)
     facet_uninstall(ofproto, facet);
     facet_flush_stats(ofproto, facet);
     hmap_remove(&ofproto->facets, &facet->hmap_node);
+    hmap_remove(&ofproto->facets_by_key, &facet->key_node);
     list_remove(&facet->list_node);
+    ofproto->facet_bytes -= facet_memory_size(facet);
     facet_free(facet);
 }
 
@@ -1618,14 +1843,19 @@ facet_make_actions(struct ofproto *p, struct facet *facet,
     action_xlate_ctx_init(&ctx, p, &facet->flow, packet);
     odp_actions = xlate_actions(&ctx, rule->actions, rule->n_actions);
     facet->tags = ctx.tags;
+    facet->table_tags |= ctx.table_tags;
+    facet->reval_seq = p->reval_seq;
     facet->may_install = ctx.may_set_up_flow;
     facet->nf_flow.output_iface = ctx.nf_output_iface;
 
     if (facet->actions_len != odp_actions->size
         || memcmp(facet->actions, odp_actions->data, odp_actions->size)) {
-        free(facet->actions);
+        pool_set_free(&actions_pool, facet->actions, facet->actions_len);
+        p->facet_bytes -= facet->actions_len;
         facet->actions_len = odp_actions->size;
-        facet->actions = xmemdup(odp_actions->data, odp_actions->size);
+        facet->actions = pool_set_memdup(&actions_pool, odp_actions->data,
+                                         odp_actions->size);
+        p->facet_bytes += facet->actions_len;
     }
 
     ofpbuf_delete(odp_actions);
@@ -1636,9 +1866,7 @@ facet_put__(struct ofproto *ofproto, struct facet *facet,
             const struct nlattr *actions, size_t actions_len,
             struct dpif_flow_stats *stats)
 {
-    struct odputil_keybuf keybuf;
     enum dpif_flow_put_flags flags;
-    struct ofpbuf key;
 
     flags = DPIF_FP_CREATE | DPIF_FP_MODIFY;
     if (stats) {
@@ -1647,10 +1875,7 @@ facet_put__(struct ofproto *ofproto, struct facet *facet,
         facet->dp_byte_count = 0;
     }
 
-    ofpbuf_use_stack(&key, &keybuf, sizeof keybuf);
-    odp_flow_key_from_flow(&key, &facet->flow);
-
-    return dpif_flow_put(ofproto->dpif, flags, key.data, key.size,
+    return dpif_flow_put(ofproto->dpif, flags, facet->key, facet->key_len,
                          actions, actions_len, stats);
 }
 
@@ -1692,14 +1917,9 @@ static void
 facet_uninstall(struct ofproto *p, struct facet *facet)
 {
     if (facet->installed) {
-        struct odputil_keybuf keybuf;
         struct dpif_flow_stats stats;
-        struct ofpbuf key;
-
-        ofpbuf_use_stack(&key, &keybuf, sizeof keybuf);
-        odp_flow_key_from_flow(&key, &facet->flow);
 
-        if (!dpif_flow_del(p->dpif, key.data, key.size, &stats)) {
+        if (!dpif_flow_del(p->dpif, facet->key, facet->key_len, &stats)) {
             facet_update_stats(p, facet, &stats);
         }
         facet->installed = false;
@@ -1759,6 +1979,25 @@ facet_flush_stats(struct ofproto *ofproto, struct facet *facet)
     netflow_flow_clear(&facet->nf_flow);
 }
 
+/* Searches 'ofproto''s table of facets for one whose datapath flow key is
+ * exactly the 'key_len' bytes in 'key'.  Returns it if found, otherwise a null
+ * pointer. */
+static struct facet *
+facet_find_by_key(struct ofproto *ofproto,
+                  const struct nlattr *key, size_t key_len)
+{
+    struct facet *facet;
+
+    HMAP_FOR_EACH_WITH_HASH (facet, key_node, hash_bytes(key, key_len, 0),
+                             &ofproto->facets_by_key) {
+        if (facet->key_len == key_len && !memcmp(facet->key, key, key_len)) {
+            return facet;
+        }
+    }
+
+    return NULL;
+}
+
 /* Searches 'ofproto''s table of facets for one exactly equal to 'flow'.
  * Returns it if found, otherwise a null pointer.
  *
@@ -1791,7 +2030,7 @@ facet_lookup_valid(struct ofproto *ofproto, const struct flow *flow)
     /* The facet we found might not be valid, since we could be in need of
      * revalidation.  If it is not valid, don't return it. */
     if (facet
-        && ofproto->need_revalidate
+        && facet_is_stale(ofproto, facet)
         && !facet_revalidate(ofproto, facet)) {
         COVERAGE_INC(ofproto_invalidated);
         return NULL;
@@ -1800,6 +2039,22 @@ facet_lookup_valid(struct ofproto *ofproto, const struct flow *flow)
     return facet;
 }
 
+/* Returns true if 'facet' might need to be revalidated because of a change
+ * that has not yet been fully processed, false if it is known to be up to
+ * date. */
+static bool
+facet_is_stale(const struct ofproto *ofproto, const struct facet *facet)
+{
+    tag_type tags = facet->tags | facet->table_tags;
+
+    return (ofproto->need_revalidate
+            || tag_set_intersects(&ofproto->revalidate_set, tags)
+            || (ofproto->reval_active
+                && facet->reval_seq != ofproto->reval_seq
+                && (ofproto->reval_all
+                    || tag_set_intersects(&ofproto->reval_set, tags))));
+}
+
 /* Re-searches 'ofproto''s classifier for a rule matching 'facet':
  *
  *   - If the rule found is different from 'facet''s current rule, moves
@@ -1818,11 +2073,13 @@ facet_revalidate(struct ofproto *ofproto, struct facet *facet)
     struct ofpbuf *odp_actions;
     struct rule *new_rule;
     bool actions_changed;
+    tag_type table_tags;
 
     COVERAGE_INC(facet_revalidate);
 
     /* Determine the new rule. */
-    new_rule = rule_lookup(ofproto, &facet->flow);
+    table_tags = 0;
+    new_rule = rule_lookup(ofproto, &facet->flow, &table_tags);
     if (!new_rule) {
         /* No new rule, so delete the facet. */
         facet_remove(ofproto, facet);
@@ -1860,12 +2117,17 @@ facet_revalidate(struct ofproto *ofproto, struct facet *facet)
 
     /* Update 'facet' now that we've taken care of all the old state. */
     facet->tags = ctx.tags;
+    facet->table_tags = table_tags | ctx.table_tags;
+    facet->reval_seq = ofproto->reval_seq;
     facet->nf_flow.output_iface = ctx.nf_output_iface;
     facet->may_install = ctx.may_set_up_flow;
     if (actions_changed) {
-        free(facet->actions);
+        pool_set_free(&actions_pool, facet->actions, facet->actions_len);
+        ofproto->facet_bytes -= facet->actions_len;
         facet->actions_len = odp_actions->size;
-        facet->actions = xmemdup(odp_actions->data, odp_actions->size);
+        facet->actions = pool_set_memdup(&actions_pool, odp_actions->data,
+                                         odp_actions->size);
+        ofproto->facet_bytes += facet->actions_len;
     }
     if (facet->rule != new_rule) {
         COVERAGE_INC(facet_changed_rule);
@@ -2008,10 +2270,28 @@ add_output_action(struct action_xlate_ctx *ctx, uint16_t port)
     ctx->nf_output_iface = port;
 }
 
+/* Looks up 'flow' in 'ofproto''s classifier and returns the best matching
+ * rule, if any.  If 'table_tags' is nonnull, adds to it tags for the lookup
+ * (see classifier_lookup_tags()), for a facet's 'table_tags'. */
 static struct rule *
-rule_lookup(struct ofproto *ofproto, const struct flow *flow)
+rule_lookup(struct ofproto *ofproto, const struct flow *flow,
+            tag_type *table_tags)
 {
-    return rule_from_cls_rule(classifier_lookup(&ofproto->cls, flow));
+    return rule_from_cls_rule(
+        table_tags
+        ? classifier_lookup_tags(&ofproto->cls, flow, table_tags)
+        : classifier_lookup(&ofproto->cls, flow));
+}
+
+/* Returns the tag that represents the flows that 'rule', which must be in its
+ * ofproto's classifier, matches.  A facet whose lookups included a flow that
+ * 'rule' matches has this tag among its 'table_tags', so modifying or removing
+ * 'rule', or adding it when classifier_rule_is_reachable() says so, need only
+ * revalidate facets with this tag. */
+static tag_type
+rule_calculate_tag(const struct rule *rule)
+{
+    return cls_rule_tag(&rule->cr);
 }
 
 static void
@@ -2026,7 +2306,7 @@ xlate_table_action(struct action_xlate_ctx *ctx, uint16_t in_port)
          * have surprising behavior). */
         old_in_port = ctx->flow.in_port;
         ctx->flow.in_port = in_port;
-        rule = rule_lookup(ctx->ofproto, &ctx->flow);
+        rule = rule_lookup(ctx->ofproto, &ctx->flow, &ctx->table_tags);
         ctx->flow.in_port = old_in_port;
 
         if (ctx->resubmit_hook) {
@@ -2457,6 +2737,7 @@ xlate_actions(struct action_xlate_ctx *ctx,
 
     ctx->odp_actions = ofpbuf_new(512);
     ctx->tags = 0;
+    ctx->table_tags = 0;
     ctx->may_set_up_flow = true;
     ctx->nf_output_iface = NF_OUT_DROP;
     ctx->recurse = 0;
@@ -2818,7 +3099,8 @@ calc_flow_duration(long long int start, ovs_be32 *sec_be, ovs_be32 *nsec_be)
 
 static void
 put_ofp_flow_stats(struct ofconn *ofconn, struct rule *rule,
-                   ovs_be16 out_port, struct ofpbuf **replyp)
+                   ovs_be16 out_port, enum nx_flow_format flow_format,
+                   struct ofpbuf **replyp)
 {
     struct ofp_flow_stats *ofs;
     uint64_t packet_count, byte_count;
@@ -2838,7 +3120,7 @@ put_ofp_flow_stats(struct ofconn *ofconn, struct rule *rule,
     ofs->length = htons(len);
     ofs->table_id = 0;
     ofs->pad = 0;
-    ofputil_cls_rule_to_match(&rule->cr, ofconn_get_flow_format(ofconn),
+    ofputil_cls_rule_to_match(&rule->cr, flow_format,
                               &ofs->match, rule->flow_cookie, &cookie);
     put_32aligned_be64(&ofs->cookie, cookie);
     calc_flow_duration(rule->created, &ofs->duration_sec, &ofs->duration_nsec);
@@ -2868,32 +3150,6 @@ is_valid_table(uint8_t table_id)
     }
 }
 
-static int
-handle_flow_stats_request(struct ofconn *ofconn, const struct ofp_header *oh)
-{
-    const struct ofp_flow_stats_request *fsr = ofputil_stats_body(oh);
-    struct ofproto *ofproto = ofconn_get_ofproto(ofconn);
-    struct ofpbuf *reply;
-
-    COVERAGE_INC(ofproto_flows_req);
-    reply = start_ofp_stats_reply(oh, 1024);
-    if (is_valid_table(fsr->table_id)) {
-        struct cls_cursor cursor;
-        struct cls_rule target;
-        struct rule *rule;
-
-        ofputil_cls_rule_from_match(&fsr->match, 0, NXFF_OPENFLOW10, 0,
-                                    &target);
-        cls_cursor_init(&cursor, &ofproto->cls, &target);
-        CLS_CURSOR_FOR_EACH (rule, cr, &cursor) {
-            put_ofp_flow_stats(ofconn, rule, fsr->out_port, &reply);
-        }
-    }
-    ofconn_send_reply(ofconn, reply);
-
-    return 0;
-}
-
 static void
 put_nx_flow_stats(struct ofconn *ofconn, struct rule *rule,
                   ovs_be16 out_port, struct ofpbuf **replyp)
@@ -2933,13 +3189,347 @@ put_nx_flow_stats(struct ofconn *ofconn, struct rule *rule,
     nfs->length = htons(reply->size - start_len);
 }
 
+/* Flow statistics dumps.
+ *
+ * A flow or aggregate statistics request can cover hundreds of thousands of
+ * rules, too many to answer all at once without stalling the main loop and
+ * piling up replies on the requesting connection.  Instead, the request takes
+ * a snapshot of the rules that it covers, then works through them up to
+ * FLOW_DUMP_BATCH rules at a time on each trip through the main loop.  It
+ * pauses whenever the requesting connection has a backlog of replies.
+ *
+ * The reply reflects the flow table as it was when the request arrived.  Rules
+ * added later are not in the snapshot.  A rule in the snapshot that is about
+ * to be modified or deleted before the dump reaches it is reported right away,
+ * in its old form. */
+
+/* Maximum number of rules that a dump reports per trip through the main
+ * loop. */
+#define FLOW_DUMP_BATCH 1024
+
+enum flow_dump_type {
+    FLOW_DUMP_OFPST_FLOW,       /* OFPST_FLOW reply. */
+    FLOW_DUMP_NXST_FLOW,        /* NXST_FLOW reply. */
+    FLOW_DUMP_AGGREGATE         /* OFPST_AGGREGATE or NXST_AGGREGATE reply. */
+};
+
+struct flow_dump_entry {
+    struct hmap_node hmap_node; /* In struct flow_dump's 'index'. */
+    struct rule *rule;          /* Null if already reported. */
+};
+
+struct flow_dump {
+    struct list list_node;      /* In struct ofproto's 'flow_dumps' list. */
+    struct ofproto *ofproto;
+    struct ofconn *ofconn;      /* Connection that sent the request. */
+    enum flow_dump_type type;
+    ovs_be16 out_port;          /* Report only rules that output here. */
+    enum nx_flow_format flow_format; /* Flow format, for OFPST_FLOW. */
+
+    /* The snapshot.  Entries before 'next' have been reported.
+     *
+     * 'index' contains the unreported entries, hashed on their rules'
+     * addresses.  It is only built, by flow_dump_index(), once a rule that
+     * might be in the snapshot changes. */
+    struct flow_dump_entry *entries;
+    size_t n_entries, next;
+    struct hmap index;
+    bool indexed;
+
+    /* The reply under construction.  For FLOW_DUMP_AGGREGATE, 'reply' is the
+     * whole reply, whose body at offset 'body_ofs' is filled in from the
+     * totals when the dump finishes. */
+    struct ofpbuf *reply;
+    size_t body_ofs;
+    uint64_t total_packets;
+    uint64_t total_bytes;
+    uint32_t n_flows;
+};
+
+/* Creates and returns a new dump, of the given 'type', for the rules in
+ * 'ofconn''s ofproto that match 'target' and output to 'out_port'.  The
+ * caller must supply the initial 'reply' and then start the dump with
+ * flow_dump_start(). */
+static struct flow_dump *
+flow_dump_create(struct ofconn *ofconn, enum flow_dump_type type,
+                 const struct cls_rule *target, uint8_t table_id,
+                 ovs_be16 out_port, struct ofpbuf *reply)
+{
+    struct ofproto *ofproto = ofconn_get_ofproto(ofconn);
+    struct flow_dump *dump;
+    size_t allocated;
+
+    dump = xzalloc(sizeof *dump);
+    dump->ofproto = ofproto;
+    dump->ofconn = ofconn;
+    dump->type = type;
+    dump->out_port = out_port;
+    dump->flow_format = ofconn_get_flow_format(ofconn);
+    hmap_init(&dump->index);
+    dump->reply = reply;
+
+    allocated = 0;
+    if (is_valid_table(table_id)) {
+        struct cls_cursor cursor;
+        struct rule *rule;
+
+        cls_cursor_init(&cursor, &ofproto->cls, target);
+        CLS_CURSOR_FOR_EACH (rule, cr, &cursor) {
+            if (!rule_is_hidden(rule)) {
+                if (dump->n_entries >= allocated) {
+                    dump->entries = x2nrealloc(dump->entries, &allocated,
+                                               sizeof *dump->entries);
+                }
+                dump->entries[dump->n_entries++].rule = rule;
+            }
+        }
+    }
+
+    return dump;
+}
+
+static void
+flow_dump_destroy(struct flow_dump *dump)
+{
+    if (dump) {
+        hmap_destroy(&dump->index);
+        free(dump->entries);
+        ofpbuf_delete(dump->reply);
+        free(dump);
+    }
+}
+
+/* Adds 'rule' to 'dump''s reply, if it outputs to the requested port. */
+static void
+flow_dump_put_rule(struct flow_dump *dump, struct rule *rule)
+{
+    uint64_t packet_count, byte_count;
+
+    switch (dump->type) {
+    case FLOW_DUMP_OFPST_FLOW:
+        put_ofp_flow_stats(dump->ofconn, rule, dump->out_port,
+                           dump->flow_format, &dump->reply);
+        break;
+
+    case FLOW_DUMP_NXST_FLOW:
+        put_nx_flow_stats(dump->ofconn, rule, dump->out_port, &dump->reply);
+        break;
+
+    case FLOW_DUMP_AGGREGATE:
+        if (rule_has_out_port(rule, dump->out_port)) {
+            rule_get_stats(rule, &packet_count, &byte_count);
+            dump->total_packets += packet_count;
+            dump->total_bytes += byte_count;
+            dump->n_flows++;
+        }
+        break;
+    }
+}
+
+/* Reports up to 'max' more rules in 'dump'.  Returns true if that reported
+ * every rule in the snapshot, false if some remain. */
+static bool
+flow_dump_run(struct flow_dump *dump, size_t max)
+{
+    size_t end = dump->next + MIN(max, dump->n_entries - dump->next);
+
+    for (; dump->next < end; dump->next++) {
+        struct flow_dump_entry *entry = &dump->entries[dump->next];
+
+        if (entry->rule) {
+            if (dump->indexed) {
+                hmap_remove(&dump->index, &entry->hmap_node);
+            }
+            flow_dump_put_rule(dump, entry->rule);
+        }
+    }
+    return dump->next >= dump->n_entries;
+}
+
+/* Sends the final part of 'dump''s reply and destroys 'dump'. */
+static void
+flow_dump_finish(struct flow_dump *dump)
+{
+    if (dump->type == FLOW_DUMP_AGGREGATE) {
+        struct ofp_aggregate_stats_reply *oasr;
+
+        oasr = (struct ofp_aggregate_stats_reply *)
+            ((char *) dump->reply->data + dump->body_ofs);
+        oasr->flow_count = htonl(dump->n_flows);
+        put_32aligned_be64(&oasr->packet_count, htonll(dump->total_packets));
+        put_32aligned_be64(&oasr->byte_count, htonll(dump->total_bytes));
+        memset(oasr->pad, 0, sizeof oasr->pad);
+    }
+    ofconn_send_reply(dump->ofconn, dump->reply);
+    dump->reply = NULL;
+    flow_dump_destroy(dump);
+}
+
+/* Answers as much of 'dump' as a single batch allows.  If that is all of it,
+ * sends the reply and destroys 'dump', otherwise adds 'dump' to its ofproto's
+ * dumps in progress to be finished later by flow_dumps_run(). */
+static void
+flow_dump_start(struct flow_dump *dump)
+{
+    if (flow_dump_run(dump, FLOW_DUMP_BATCH)) {
+        flow_dump_finish(dump);
+    } else {
+        COVERAGE_INC(ofproto_flow_dump_deferred);
+        list_push_back(&dump->ofproto->flow_dumps, &dump->list_node);
+    }
+}
+
+/* Indexes the unreported entries in 'dump', so that flow_dumps_rule_changed()
+ * can find them. */
+static void
+flow_dump_index(struct flow_dump *dump)
+{
+    size_t i;
+
+    for (i = dump->next; i < dump->n_entries; i++) {
+        struct flow_dump_entry *entry = &dump->entries[i];
+        if (entry->rule) {
+            hmap_insert(&dump->index, &entry->hmap_node,
+                        hash_pointer(entry->rule, 0));
+        }
+    }
+    dump->indexed = true;
+}
+
+/* Advances each of 'ofproto''s dumps in progress by one batch, unless its
+ * connection already has a backlog of replies. */
+static void
+flow_dumps_run(struct ofproto *ofproto)
+{
+    struct flow_dump *dump, *next;
+
+    LIST_FOR_EACH_SAFE (dump, next, list_node, &ofproto->flow_dumps) {
+        if (!ofconn_is_backlogged(dump->ofconn)) {
+            if (flow_dump_run(dump, FLOW_DUMP_BATCH)) {
+                list_remove(&dump->list_node);
+                flow_dump_finish(dump);
+            }
+        } else {
+            COVERAGE_INC(ofproto_flow_dump_paused);
+        }
+    }
+}
+
+static void
+flow_dumps_wait(struct ofproto *ofproto)
+{
+    struct flow_dump *dump;
+
+    /* A dump whose connection is backlogged resumes when the connection
+     * drains, which the connection itself wakes us up for. */
+    LIST_FOR_EACH (dump, list_node, &ofproto->flow_dumps) {
+        if (!ofconn_is_backlogged(dump->ofconn)) {
+            poll_immediate_wake();
+            return;
+        }
+    }
+}
+
+/* Must be called just before 'rule' in 'ofproto' is modified or destroyed.
+ * Reports 'rule' in its current form to every dump in progress that has yet
+ * to report it. */
+static void
+flow_dumps_rule_changed(struct ofproto *ofproto, struct rule *rule)
+{
+    struct flow_dump *dump;
+
+    LIST_FOR_EACH (dump, list_node, &ofproto->flow_dumps) {
+        struct flow_dump_entry *entry;
+
+        if (!dump->indexed) {
+            flow_dump_index(dump);
+        }
+        HMAP_FOR_EACH_WITH_HASH (entry, hmap_node, hash_pointer(rule, 0),
+                                 &dump->index) {
+            if (entry->rule == rule) {
+                hmap_remove(&dump->index, &entry->hmap_node);
+                entry->rule = NULL;
+                flow_dump_put_rule(dump, rule);
+                break;
+            }
+        }
+    }
+}
+
+/* Finishes all of the dumps in progress that 'ofconn' requested, regardless of
+ * any backlog on 'ofconn'. */
+static void
+flow_dumps_finish_ofconn(struct ofproto *ofproto, const struct ofconn *ofconn)
+{
+    struct flow_dump *dump, *next;
+
+    LIST_FOR_EACH_SAFE (dump, next, list_node, &ofproto->flow_dumps) {
+        if (dump->ofconn == ofconn) {
+            flow_dump_run(dump, SIZE_MAX);
+            list_remove(&dump->list_node);
+            flow_dump_finish(dump);
+        }
+    }
+}
+
+/* Destroys all of 'ofproto''s dumps in progress without sending any more of
+ * their replies. */
+static void
+flow_dumps_destroy(struct ofproto *ofproto)
+{
+    struct flow_dump *dump, *next;
+
+    LIST_FOR_EACH_SAFE (dump, next, list_node, &ofproto->flow_dumps) {
+        list_remove(&dump->list_node);
+        flow_dump_destroy(dump);
+    }
+}
+
+static struct flow_mod_batch *flow_mod_batch_find(const struct ofproto *,
+                                                  const struct ofconn *);
+static void flow_mod_batch_destroy(struct flow_mod_batch *);
+
+/* Called by the connection manager when it destroys 'ofconn', to discard the
+ * dumps in progress that 'ofconn' requested and the flow_mod batch, if any,
+ * that it left open. */
+void
+ofproto_ofconn_destroyed(struct ofproto *ofproto, const struct ofconn *ofconn)
+{
+    struct flow_mod_batch *batch;
+    struct flow_dump *dump, *next;
+
+    LIST_FOR_EACH_SAFE (dump, next, list_node, &ofproto->flow_dumps) {
+        if (dump->ofconn == ofconn) {
+            list_remove(&dump->list_node);
+            flow_dump_destroy(dump);
+        }
+    }
+
+    batch = flow_mod_batch_find(ofproto, ofconn);
+    if (batch) {
+        flow_mod_batch_destroy(batch);
+    }
+}
+
+static int
+handle_flow_stats_request(struct ofconn *ofconn, const struct ofp_header *oh)
+{
+    const struct ofp_flow_stats_request *fsr = ofputil_stats_body(oh);
+    struct cls_rule target;
+
+    COVERAGE_INC(ofproto_flows_req);
+    ofputil_cls_rule_from_match(&fsr->match, 0, NXFF_OPENFLOW10, 0, &target);
+    flow_dump_start(flow_dump_create(ofconn, FLOW_DUMP_OFPST_FLOW, &target,
+                                     fsr->table_id, fsr->out_port,
+                                     start_ofp_stats_reply(oh, 1024)));
+    return 0;
+}
+
 static int
 handle_nxst_flow(struct ofconn *ofconn, const struct ofp_header *oh)
 {
-    struct ofproto *ofproto = ofconn_get_ofproto(ofconn);
     struct nx_flow_stats_request *nfsr;
     struct cls_rule target;
-    struct ofpbuf *reply;
     struct ofpbuf b;
     int error;
 
@@ -2956,18 +3546,9 @@ handle_nxst_flow(struct ofconn *ofconn, const struct ofp_header *oh)
     }
 
     COVERAGE_INC(ofproto_flows_req);
-    reply = start_nxstats_reply(&nfsr->nsm, 1024);
-    if (is_valid_table(nfsr->table_id)) {
-        struct cls_cursor cursor;
-        struct rule *rule;
-
-        cls_cursor_init(&cursor, &ofproto->cls, &target);
-        CLS_CURSOR_FOR_EACH (rule, cr, &cursor) {
-            put_nx_flow_stats(ofconn, rule, nfsr->out_port, &reply);
-        }
-    }
-    ofconn_send_reply(ofconn, reply);
-
+    flow_dump_start(flow_dump_create(ofconn, FLOW_DUMP_NXST_FLOW, &target,
+                                     nfsr->table_id, nfsr->out_port,
+                                     start_nxstats_reply(&nfsr->nsm, 1024)));
     return 0;
 }
 
@@ -3009,69 +3590,44 @@ ofproto_get_all_flows(struct ofproto *p, struct ds *results)
     }
 }
 
+/* Starts a dump for an OFPST_AGGREGATE or NXST_AGGREGATE request whose reply
+ * so far is 'reply', with the body (still to be filled in) at its end. */
 static void
-query_aggregate_stats(struct ofproto *ofproto, struct cls_rule *target,
-                      ovs_be16 out_port, uint8_t table_id,
-                      struct ofp_aggregate_stats_reply *oasr)
+start_aggregate_dump(struct ofconn *ofconn, const struct cls_rule *target,
+                     uint8_t table_id, ovs_be16 out_port, struct ofpbuf *reply)
 {
-    uint64_t total_packets = 0;
-    uint64_t total_bytes = 0;
-    int n_flows = 0;
+    struct flow_dump *dump;
 
     COVERAGE_INC(ofproto_agg_request);
-
-    if (is_valid_table(table_id)) {
-        struct cls_cursor cursor;
-        struct rule *rule;
-
-        cls_cursor_init(&cursor, &ofproto->cls, target);
-        CLS_CURSOR_FOR_EACH (rule, cr, &cursor) {
-            if (!rule_is_hidden(rule) && rule_has_out_port(rule, out_port)) {
-                uint64_t packet_count;
-                uint64_t byte_count;
-
-                rule_get_stats(rule, &packet_count, &byte_count);
-
-                total_packets += packet_count;
-                total_bytes += byte_count;
-                n_flows++;
-            }
-        }
-    }
-
-    oasr->flow_count = htonl(n_flows);
-    put_32aligned_be64(&oasr->packet_count, htonll(total_packets));
-    put_32aligned_be64(&oasr->byte_count, htonll(total_bytes));
-    memset(oasr->pad, 0, sizeof oasr->pad);
-}
+    dump = flow_dump_create(ofconn, FLOW_DUMP_AGGREGATE, target, table_id,
+                            out_port, reply);
+    dump->body_ofs = reply->size - sizeof(struct ofp_aggregate_stats_reply);
+    flow_dump_start(dump);
+}
 
 static int
 handle_aggregate_stats_request(struct ofconn *ofconn,
                                const struct ofp_header *oh)
 {
     const struct ofp_aggregate_stats_request *request = ofputil_stats_body(oh);
-    struct ofproto *ofproto = ofconn_get_ofproto(ofconn);
-    struct ofp_aggregate_stats_reply *reply;
     struct cls_rule target;
     struct ofpbuf *msg;
 
     ofputil_cls_rule_from_match(&request->match, 0, NXFF_OPENFLOW10, 0,
                                 &target);
 
-    msg = start_ofp_stats_reply(oh, sizeof *reply);
-    reply = append_ofp_stats_reply(sizeof *reply, ofconn, &msg);
-    query_aggregate_stats(ofproto, &target, request->out_port,
-                          request->table_id, reply);
-    ofconn_send_reply(ofconn, msg);
+    msg = start_ofp_stats_reply(oh, sizeof(struct ofp_aggregate_stats_reply));
+    append_ofp_stats_reply(sizeof(struct ofp_aggregate_stats_reply), ofconn,
+                           &msg);
+    start_aggregate_dump(ofconn, &target, request->table_id,
+                         request->out_port, msg);
     return 0;
 }
 
 static int
 handle_nxst_aggregate(struct ofconn *ofconn, const struct ofp_header *oh)
 {
-    struct ofproto *ofproto = ofconn_get_ofproto(ofconn);
     struct nx_aggregate_stats_request *request;
-    struct ofp_aggregate_stats_reply *reply;
     struct cls_rule target;
     struct ofpbuf b;
     struct ofpbuf *buf;
@@ -3091,12 +3647,11 @@ handle_nxst_aggregate(struct ofconn *ofconn, const struct ofp_header *oh)
 
     /* Reply. */
     COVERAGE_INC(ofproto_flows_req);
-    buf = start_nxstats_reply(&request->nsm, sizeof *reply);
-    reply = ofpbuf_put_uninit(buf, sizeof *reply);
-    query_aggregate_stats(ofproto, &target, request->out_port,
-                          request->table_id, reply);
-    ofconn_send_reply(ofconn, buf);
-
+    buf = start_nxstats_reply(&request->nsm,
+                              sizeof(struct ofp_aggregate_stats_reply));
+    ofpbuf_put_uninit(buf, sizeof(struct ofp_aggregate_stats_reply));
+    start_aggregate_dump(ofconn, &target, request->table_id,
+                         request->out_port, buf);
     return 0;
 }
 
@@ -3422,6 +3977,7 @@ modify_flow(struct ofproto *p, const struct flow_mod *fm, struct rule *rule)
 {
     size_t actions_len = fm->n_actions * sizeof *rule->actions;
 
+    flow_dumps_rule_changed(p, rule);
     rule->flow_cookie = fm->cookie;
 
     /* If the actions are the same, do nothing. */
@@ -3432,11 +3988,14 @@ modify_flow(struct ofproto *p, const struct flow_mod *fm, struct rule *rule)
     }
 
     /* Replace actions. */
-    free(rule->actions);
-    rule->actions = fm->n_actions ? xmemdup(fm->actions, actions_len) : NULL;
+    pool_set_free(&actions_pool, rule->actions,
+                  rule->n_actions * sizeof *rule->actions);
+    rule->actions = (fm->n_actions
+                     ? pool_set_memdup(&actions_pool, fm->actions, actions_len)
+                     : NULL);
     rule->n_actions = fm->n_actions;
 
-    p->need_revalidate = true;
+    ofproto_revalidate(p, rule_calculate_tag(rule));
 
     return 0;
 }
@@ -3491,58 +4050,253 @@ delete_flow(struct ofproto *p, struct rule *rule, ovs_be16 out_port)
     rule_remove(p, rule);
 }
 
+/* Decodes the OFPT_FLOW_MOD or NXT_FLOW_MOD in 'oh' into 'fm' according to
+ * 'flow_format' and checks that 'p' can carry it out.  Returns 0 if
+ * successful, otherwise an OpenFlow error code as encoded by ofp_mkerr(). */
 static int
-handle_flow_mod(struct ofconn *ofconn, const struct ofp_header *oh)
+decode_flow_mod(struct ofproto *p, struct flow_mod *fm,
+                const struct ofp_header *oh, enum nx_flow_format flow_format)
 {
-    struct ofproto *p = ofconn_get_ofproto(ofconn);
-    struct flow_mod fm;
     int error;
 
-    error = reject_slave_controller(ofconn, "flow_mod");
-    if (error) {
-        return error;
-    }
-
-    error = ofputil_decode_flow_mod(&fm, oh, ofconn_get_flow_format(ofconn));
+    error = ofputil_decode_flow_mod(fm, oh, flow_format);
     if (error) {
         return error;
     }
 
     /* We do not support the emergency flow cache.  It will hopefully get
      * dropped from OpenFlow in the near future. */
-    if (fm.flags & OFPFF_EMERG) {
+    if (fm->flags & OFPFF_EMERG) {
         /* There isn't a good fit for an error code, so just state that the
          * flow table is full. */
         return ofp_mkerr(OFPET_FLOW_MOD_FAILED, OFPFMFC_ALL_TABLES_FULL);
     }
 
-    error = validate_actions(fm.actions, fm.n_actions,
-                             &fm.cr.flow, p->max_ports);
-    if (error) {
-        return error;
+    switch (fm->command) {
+    case OFPFC_ADD:
+    case OFPFC_MODIFY:
+    case OFPFC_MODIFY_STRICT:
+    case OFPFC_DELETE:
+    case OFPFC_DELETE_STRICT:
+        break;
+
+    default:
+        return ofp_mkerr(OFPET_FLOW_MOD_FAILED, OFPFMFC_BAD_COMMAND);
     }
 
-    switch (fm.command) {
+    return validate_actions(fm->actions, fm->n_actions,
+                            &fm->cr.flow, p->max_ports);
+}
+
+/* Carries out 'fm', which decode_flow_mod() has already checked, on the flow
+ * table of 'ofconn''s ofproto.  Returns 0 if successful, otherwise an
+ * OpenFlow error code as encoded by ofp_mkerr(). */
+static int
+execute_flow_mod(struct ofconn *ofconn, struct flow_mod *fm)
+{
+    struct ofproto *p = ofconn_get_ofproto(ofconn);
+
+    switch (fm->command) {
     case OFPFC_ADD:
-        return add_flow(ofconn, &fm);
+        return add_flow(ofconn, fm);
 
     case OFPFC_MODIFY:
-        return modify_flows_loose(ofconn, &fm);
+        return modify_flows_loose(ofconn, fm);
 
     case OFPFC_MODIFY_STRICT:
-        return modify_flow_strict(ofconn, &fm);
+        return modify_flow_strict(ofconn, fm);
 
     case OFPFC_DELETE:
-        delete_flows_loose(p, &fm);
+        delete_flows_loose(p, fm);
         return 0;
 
     case OFPFC_DELETE_STRICT:
-        delete_flow_strict(p, &fm);
+        delete_flow_strict(p, fm);
         return 0;
 
     default:
-        return ofp_mkerr(OFPET_FLOW_MOD_FAILED, OFPFMFC_BAD_COMMAND);
+        NOT_REACHED();
+    }
+}
+
+/* Flow table modification batches (NXT_FLOW_MOD_BATCH).
+ *
+ * A batch holds the flow_mods that its connection sends between NXFMB_OPEN
+ * and NXFMB_COMMIT.  Committing applies all of them within a single call,
+ * so the facets that they affect are revalidated once, by the next
+ * ofproto_run2(), instead of once for every trip through the main loop that
+ * the flow_mods would otherwise take to arrive. */
+
+/* Maximum number of flow_mods that a single batch may hold. */
+#define FLOW_MOD_BATCH_MAX 1000000
+
+/* A flow_mod held in a batch. */
+struct flow_mod_batch_entry {
+    struct list list_node;      /* In struct flow_mod_batch's 'entries'. */
+    struct ofpbuf *msg;         /* Copy of the flow_mod message. */
+    struct flow_mod fm;         /* Decoded from 'msg'. */
+};
+
+struct flow_mod_batch {
+    struct list list_node;      /* In struct ofproto's 'flow_mod_batches'. */
+    struct ofconn *ofconn;      /* Connection that opened the batch. */
+    struct list entries;        /* Contains "struct flow_mod_batch_entry"s. */
+    size_t n_entries;
+    bool failed;                /* Was some flow_mod in the batch rejected? */
+};
+
+/* Returns the batch that 'ofconn' has open on 'p', or a null pointer if there
+ * is none. */
+static struct flow_mod_batch *
+flow_mod_batch_find(const struct ofproto *p, const struct ofconn *ofconn)
+{
+    struct flow_mod_batch *batch;
+
+    LIST_FOR_EACH (batch, list_node, &p->flow_mod_batches) {
+        if (batch->ofconn == ofconn) {
+            return batch;
+        }
+    }
+    return NULL;
+}
+
+static void
+flow_mod_batch_destroy(struct flow_mod_batch *batch)
+{
+    struct flow_mod_batch_entry *entry, *next;
+
+    list_remove(&batch->list_node);
+    LIST_FOR_EACH_SAFE (entry, next, list_node, &batch->entries) {
+        ofpbuf_delete(entry->msg);
+        free(entry);
+    }
+    free(batch);
+}
+
+/* Adds a copy of the flow_mod in 'oh' to 'batch'.  Returns 0 if successful.
+ * Otherwise, marks 'batch' as failed and returns an OpenFlow error code as
+ * encoded by ofp_mkerr(). */
+static int
+flow_mod_batch_put(struct ofproto *p, struct flow_mod_batch *batch,
+                   const struct ofp_header *oh)
+{
+    struct flow_mod_batch_entry *entry;
+    int error;
+
+    if (batch->n_entries >= FLOW_MOD_BATCH_MAX) {
+        batch->failed = true;
+        return ofp_mkerr(OFPET_FLOW_MOD_FAILED, OFPFMFC_ALL_TABLES_FULL);
+    }
+
+    entry = xmalloc(sizeof *entry);
+    entry->msg = ofpbuf_clone_data(oh, ntohs(oh->length));
+    error = decode_flow_mod(p, &entry->fm, entry->msg->data,
+                            ofconn_get_flow_format(batch->ofconn));
+    if (error) {
+        ofpbuf_delete(entry->msg);
+        free(entry);
+        batch->failed = true;
+        return error;
+    }
+
+    COVERAGE_INC(ofproto_flow_mod_batched);
+    list_push_back(&batch->entries, &entry->list_node);
+    batch->n_entries++;
+    return 0;
+}
+
+/* Applies the flow_mods in 'batch', in order, then destroys 'batch'.  A
+ * flow_mod that fails gets its own error reply, just as it would outside a
+ * batch. */
+static void
+flow_mod_batch_commit(struct flow_mod_batch *batch)
+{
+    struct flow_mod_batch_entry *entry;
+
+    LIST_FOR_EACH (entry, list_node, &batch->entries) {
+        int error = execute_flow_mod(batch->ofconn, &entry->fm);
+        if (error) {
+            send_error_oh(batch->ofconn, entry->msg->data, error);
+        }
+    }
+    flow_mod_batch_destroy(batch);
+}
+
+static int
+handle_flow_mod(struct ofconn *ofconn, const struct ofp_header *oh)
+{
+    struct ofproto *p = ofconn_get_ofproto(ofconn);
+    struct flow_mod_batch *batch;
+    struct flow_mod fm;
+    int error;
+
+    error = reject_slave_controller(ofconn, "flow_mod");
+    if (error) {
+        return error;
+    }
+
+    batch = flow_mod_batch_find(p, ofconn);
+    if (batch) {
+        return flow_mod_batch_put(p, batch, oh);
+    }
+
+    error = decode_flow_mod(p, &fm, oh, ofconn_get_flow_format(ofconn));
+    if (error) {
+        return error;
     }
+    return execute_flow_mod(ofconn, &fm);
+}
+
+static int
+handle_flow_mod_batch(struct ofconn *ofconn, const struct ofp_header *oh)
+{
+    const struct nxt_flow_mod_batch *nfmb
+        = (const struct nxt_flow_mod_batch *) oh;
+    struct ofproto *p = ofconn_get_ofproto(ofconn);
+    struct flow_mod_batch *batch;
+    int error;
+
+    error = reject_slave_controller(ofconn, "flow_mod batch");
+    if (error) {
+        return error;
+    }
+
+    batch = flow_mod_batch_find(p, ofconn);
+    switch (ntohl(nfmb->command)) {
+    case NXFMB_OPEN:
+        if (batch) {
+            break;
+        }
+        batch = xmalloc(sizeof *batch);
+        list_push_back(&p->flow_mod_batches, &batch->list_node);
+        batch->ofconn = ofconn;
+        list_init(&batch->entries);
+        batch->n_entries = 0;
+        batch->failed = false;
+        return 0;
+
+    case NXFMB_COMMIT:
+        if (!batch) {
+            break;
+        } else if (batch->failed) {
+            flow_mod_batch_destroy(batch);
+            return ofp_mkerr_nicira(OFPET_BAD_REQUEST, NXBRC_BATCH_FAILED);
+        }
+        flow_mod_batch_commit(batch);
+        return 0;
+
+    case NXFMB_DISCARD:
+        if (!batch) {
+            break;
+        }
+        flow_mod_batch_destroy(batch);
+        return 0;
+
+    default:
+        return ofp_mkerr(OFPET_BAD_REQUEST, OFPBRC_EPERM);
+    }
+
+    return ofp_mkerr_nicira(OFPET_BAD_REQUEST, NXBRC_BATCH_BAD_STATE);
 }
 
 static int
@@ -3613,8 +4367,10 @@ handle_barrier_request(struct ofconn *ofconn, const struct ofp_header *oh)
     struct ofp_header *ob;
     struct ofpbuf *buf;
 
-    /* Currently, everything executes synchronously, so we can just
-     * immediately send the barrier reply. */
+    /* Everything executes synchronously except for flow statistics dumps, so
+     * finish any of those that 'ofconn' started and then send the barrier
+     * reply. */
+    flow_dumps_finish_ofconn(ofconn_get_ofproto(ofconn), ofconn);
     ob = make_openflow_xid(sizeof *ob, OFPT_BARRIER_REPLY, oh->xid, &buf);
     ofconn_send_reply(ofconn, buf);
     return 0;
@@ -3675,6 +4431,9 @@ handle_openflow__(struct ofconn *ofconn, const struct ofpbuf *msg)
     case OFPUTIL_NXT_FLOW_MOD:
         return handle_flow_mod(ofconn, oh);
 
+    case OFPUTIL_NXT_FLOW_MOD_BATCH:
+        return handle_flow_mod_batch(ofconn, oh);
+
         /* OpenFlow statistics requests. */
     case OFPUTIL_OFPST_DESC_REQUEST:
         return handle_desc_stats_request(ofconn, oh);
@@ -3746,113 +4505,313 @@ handle_openflow(struct ofconn *ofconn, struct ofpbuf *ofp_msg)
     COVERAGE_INC(ofproto_recv_openflow);
 }
 
-static void
-handle_miss_upcall(struct ofproto *p, struct dpif_upcall *upcall)
-{
-    struct facet *facet;
+/* A packet that missed in the datapath, with one or more others that share its
+ * flow, awaiting processing by handle_miss_upcalls(). */
+struct flow_miss {
+    struct hmap_node hmap_node;
     struct flow flow;
+    struct list packets;        /* Contains "struct ofpbuf"s. */
+};
 
-    /* Obtain in_port and tun_id, at least. */
-    odp_flow_key_to_flow(upcall->key, upcall->key_len, &flow);
+/* A datapath operation queued by handle_flow_miss(), along with what
+ * handle_miss_upcalls() needs to account for it once it completes. */
+struct flow_miss_op {
+    union dpif_op dpif_op;
+    struct facet *facet;
+    struct dpif_flow_stats stats; /* For DPIF_OP_EXECUTE. */
+};
 
-    /* Set header pointers in 'flow'. */
-    flow_extract(upcall->packet, flow.tun_id, flow.in_port, &flow);
+static struct flow_miss *
+flow_miss_find(struct hmap *todo, const struct flow *flow, uint32_t hash)
+{
+    struct flow_miss *miss;
 
-    if (cfm_should_process_flow(&flow)) {
-        ofproto_process_cfm(p, &flow, upcall->packet);
-        ofpbuf_delete(upcall->packet);
-        return;
-    } else if (p->ofhooks->special_cb
-               && !p->ofhooks->special_cb(&flow, upcall->packet, p->aux)) {
-        ofpbuf_delete(upcall->packet);
-        return;
+    HMAP_FOR_EACH_WITH_HASH (miss, hmap_node, hash, todo) {
+        if (flow_equal(&miss->flow, flow)) {
+            return miss;
+        }
     }
 
-    /* Check with in-band control to see if this packet should be sent
-     * to the local port regardless of the flow table. */
-    if (connmgr_msg_in_hook(p->connmgr, &flow, upcall->packet)) {
-        ofproto_send_packet(p, ODPP_LOCAL, 0, upcall->packet);
+    return NULL;
+}
+
+/* Sends each of the packets in 'miss', none of which matched any rule, to the
+ * controller, unless their in_port has OFPPC_NO_PACKET_IN set. */
+static void
+flow_miss_send_to_controller(struct ofproto *p, struct flow_miss *miss)
+{
+    struct ofpbuf *packet, *next_packet;
+    struct ofport *port;
+
+    port = get_port(p, miss->flow.in_port);
+    if (!port) {
+        VLOG_WARN_RL(&rl, "packet-in on unknown port %"PRIu16,
+                     miss->flow.in_port);
     }
 
-    facet = facet_lookup_valid(p, &flow);
-    if (!facet) {
-        struct rule *rule = rule_lookup(p, &flow);
-        if (!rule) {
-            /* Don't send a packet-in if OFPPC_NO_PACKET_IN asserted. */
-            struct ofport *port = get_port(p, flow.in_port);
-            if (port) {
-                if (port->opp.config & OFPPC_NO_PACKET_IN) {
-                    COVERAGE_INC(ofproto_no_packet_in);
-                    /* XXX install 'drop' flow entry */
-                    ofpbuf_delete(upcall->packet);
-                    return;
-                }
-            } else {
-                VLOG_WARN_RL(&rl, "packet-in on unknown port %"PRIu16,
-                             flow.in_port);
-            }
+    LIST_FOR_EACH_SAFE (packet, next_packet, list_node, &miss->packets) {
+        struct dpif_upcall *upcall = packet->private_p;
 
+        list_remove(&packet->list_node);
+        if (port && port->opp.config & OFPPC_NO_PACKET_IN) {
+            COVERAGE_INC(ofproto_no_packet_in);
+            /* XXX install 'drop' flow entry */
+            ofpbuf_delete(packet);
+        } else {
             COVERAGE_INC(ofproto_packet_in);
-            send_packet_in(p, upcall, &flow, false);
+            send_packet_in(p, upcall, &miss->flow, false);
+        }
+    }
+}
+
+/* Processes all of the packets in 'miss'.  Packets whose actions can be
+ * executed by the datapath, and the datapath flow for 'miss''s facet, are
+ * appended to 'ops' (incrementing '*n_ops') rather than executed directly, so
+ * that the caller may pass them to the datapath in a single batch. */
+static void
+handle_flow_miss(struct ofproto *p, struct flow_miss *miss,
+                 struct flow_miss_op *ops, size_t *n_ops)
+{
+    struct ofpbuf *packet, *next_packet;
+    const struct ofpbuf *created_from;
+    struct facet *facet;
+
+    created_from = NULL;
+    facet = facet_lookup_valid(p, &miss->flow);
+    if (!facet) {
+        tag_type table_tags = 0;
+        struct rule *rule = rule_lookup(p, &miss->flow, &table_tags);
+        if (!rule) {
+            flow_miss_send_to_controller(p, miss);
             return;
         }
 
-        facet = facet_create(p, rule, &flow, upcall->packet);
-    } else if (!facet->may_install) {
-        /* The facet is not installable, that is, we need to process every
-         * packet, so process the current packet's actions into 'facet'. */
-        facet_make_actions(p, facet, upcall->packet);
+        packet = CONTAINER_OF(list_front(&miss->packets),
+                              struct ofpbuf, list_node);
+        facet = facet_create(p, rule, &miss->flow, table_tags, packet);
+        created_from = packet;
     }
 
-    if (facet->rule->cr.priority == FAIL_OPEN_PRIORITY) {
-        /*
-         * Extra-special case for fail-open mode.
-         *
-         * We are in fail-open mode and the packet matched the fail-open rule,
-         * but we are connected to a controller too.  We should send the packet
-         * up to the controller in the hope that it will try to set up a flow
-         * and thereby allow us to exit fail-open.
-         *
-         * See the top-level comment in fail-open.c for more information.
-         */
-        send_packet_in(p, upcall, &flow, true);
+    LIST_FOR_EACH_SAFE (packet, next_packet, list_node, &miss->packets) {
+        struct dpif_upcall *upcall = packet->private_p;
+        struct flow_miss_op *op;
+        struct dpif_execute *execute;
+
+        list_remove(&packet->list_node);
+
+        if (!facet->may_install && packet != created_from) {
+            /* The facet is not installable, that is, we need to process every
+             * packet, so process the current packet's actions into 'facet'. */
+            facet_make_actions(p, facet, packet);
+        }
+
+        if (facet->rule->cr.priority == FAIL_OPEN_PRIORITY) {
+            /*
+             * Extra-special case for fail-open mode.
+             *
+             * We are in fail-open mode and the packet matched the fail-open
+             * rule, but we are connected to a controller too.  We should send
+             * the packet up to the controller in the hope that it will try to
+             * set up a flow and thereby allow us to exit fail-open.
+             *
+             * See the top-level comment in fail-open.c for more information.
+             */
+            send_packet_in(p, upcall, &miss->flow, true);
+        }
+
+        if (!facet->may_install || !facet->actions_len
+            || is_controller_only(facet->actions, facet->actions_len)) {
+            /* Nothing to gain from batching these. */
+            facet_execute(p, facet, packet);
+            continue;
+        }
+
+        assert(ofpbuf_headroom(packet) >= sizeof(struct ofp_packet_in));
+
+        op = &ops[(*n_ops)++];
+        op->facet = facet;
+        flow_extract_stats(&facet->flow, packet, &op->stats);
+        op->stats.used = time_msec();
+
+        execute = &op->dpif_op.execute;
+        execute->type = DPIF_OP_EXECUTE;
+        execute->actions = facet->actions;
+        execute->actions_len = facet->actions_len;
+        execute->packet = packet;
     }
 
-    facet_execute(p, facet, upcall->packet);
-    facet_install(p, facet, false);
+    if (facet->may_install) {
+        struct flow_miss_op *op = &ops[(*n_ops)++];
+        struct dpif_flow_put *put = &op->dpif_op.flow_put;
+
+        op->facet = facet;
+        put->type = DPIF_OP_FLOW_PUT;
+        put->flags = DPIF_FP_CREATE | DPIF_FP_MODIFY;
+        put->key = facet->key;
+        put->key_len = facet->key_len;
+        put->actions = facet->actions;
+        put->actions_len = facet->actions_len;
+        put->stats = NULL;
+    }
 }
 
+/* Handles the 'n_upcalls' DPIF_UC_MISS upcalls in 'upcalls'.
+ *
+ * Packets are first grouped by flow, so that the flow table is consulted and
+ * actions are composed only once per flow.  Then the packets' actions are
+ * executed and the new datapath flows are installed with a single call to
+ * dpif_operate(), which saves many system calls for datapaths that support
+ * batching. */
 static void
-handle_upcall(struct ofproto *p, struct dpif_upcall *upcall)
+handle_miss_upcalls(struct ofproto *p, struct dpif_upcall *upcalls,
+                    size_t n_upcalls)
 {
-    struct flow flow;
+    struct flow_miss misses[FLOW_MISS_MAX_BATCH];
+    struct flow_miss_op flow_miss_ops[FLOW_MISS_MAX_BATCH * 2];
+    union dpif_op *dpif_ops[FLOW_MISS_MAX_BATCH * 2];
+    struct flow_miss *miss;
+    struct dpif_upcall *upcall;
+    size_t n_misses, n_ops, i;
+    struct hmap todo;
+
+    assert(n_upcalls <= FLOW_MISS_MAX_BATCH);
+
+    /* Construct the to-do list.
+     *
+     * This just amounts to extracting the flow from each packet and sticking
+     * the packets that have the same flow in the same "flow_miss" structure so
+     * that we can process them together. */
+    hmap_init(&todo);
+    n_misses = 0;
+    for (upcall = upcalls; upcall < &upcalls[n_upcalls]; upcall++) {
+        struct flow flow;
+        uint32_t hash;
 
-    switch (upcall->type) {
-    case DPIF_UC_ACTION:
-        COVERAGE_INC(ofproto_ctlr_action);
+        /* Obtain in_port and tun_id, at least. */
         odp_flow_key_to_flow(upcall->key, upcall->key_len, &flow);
-        send_packet_in(p, upcall, &flow, false);
-        break;
 
-    case DPIF_UC_SAMPLE:
-        if (p->sflow) {
-            odp_flow_key_to_flow(upcall->key, upcall->key_len, &flow);
-            ofproto_sflow_received(p->sflow, upcall, &flow);
+        /* Set header pointers in 'flow'. */
+        flow_extract(upcall->packet, flow.tun_id, flow.in_port, &flow);
+
+        if (cfm_should_process_flow(&flow)) {
+            ofproto_process_cfm(p, &flow, upcall->packet);
+            ofpbuf_delete(upcall->packet);
+            continue;
+        } else if (p->ofhooks->special_cb
+                   && !p->ofhooks->special_cb(&flow, upcall->packet,
+                                              p->aux)) {
+            ofpbuf_delete(upcall->packet);
+            continue;
         }
-        ofpbuf_delete(upcall->packet);
-        break;
 
-    case DPIF_UC_MISS:
-        handle_miss_upcall(p, upcall);
-        break;
+        /* Check with in-band control to see if this packet should be sent
+         * to the local port regardless of the flow table. */
+        if (connmgr_msg_in_hook(p->connmgr, &flow, upcall->packet)) {
+            ofproto_send_packet(p, ODPP_LOCAL, 0, upcall->packet);
+        }
 
-    case DPIF_N_UC_TYPES:
-    default:
-        VLOG_WARN_RL(&rl, "upcall has unexpected type %"PRIu32, upcall->type);
-        break;
+        /* Add other packets to a to-do list. */
+        hash = flow_hash(&flow, 0);
+        miss = flow_miss_find(&todo, &flow, hash);
+        if (!miss) {
+            miss = &misses[n_misses++];
+            hmap_insert(&todo, &miss->hmap_node, hash);
+            miss->flow = flow;
+            list_init(&miss->packets);
+        }
+        upcall->packet->private_p = upcall;
+        list_push_back(&miss->packets, &upcall->packet->list_node);
+    }
+
+    /* Process each element in the to-do list, constructing the set of
+     * operations to batch. */
+    n_ops = 0;
+    HMAP_FOR_EACH (miss, hmap_node, &todo) {
+        handle_flow_miss(p, miss, flow_miss_ops, &n_ops);
+    }
+    assert(n_ops <= ARRAY_SIZE(flow_miss_ops));
+    hmap_destroy(&todo);
+
+    /* Execute batch. */
+    for (i = 0; i < n_ops; i++) {
+        dpif_ops[i] = &flow_miss_ops[i].dpif_op;
     }
+    dpif_operate(p->dpif, dpif_ops, n_ops);
+
+    /* Free memory and update facets. */
+    for (i = 0; i < n_ops; i++) {
+        struct flow_miss_op *op = &flow_miss_ops[i];
+        struct dpif_execute *execute;
+
+        switch (op->dpif_op.type) {
+        case DPIF_OP_EXECUTE:
+            execute = &op->dpif_op.execute;
+            if (!execute->error) {
+                facet_update_stats(p, op->facet, &op->stats);
+            }
+            ofpbuf_delete((struct ofpbuf *) execute->packet);
+            break;
+
+        case DPIF_OP_FLOW_PUT:
+            if (!op->dpif_op.flow_put.error) {
+                op->facet->installed = true;
+            }
+            break;
+
+        case DPIF_OP_FLOW_DEL:
+        default:
+            NOT_REACHED();
+        }
+    }
+
+    /* Keep the new facets within the memory budget now, instead of letting
+     * them pile up until the next expiration run. */
+    ofproto_evict_facets(p);
 }
-
+
+static void
+handle_upcalls(struct ofproto *p, struct dpif_upcall *upcalls,
+               size_t n_upcalls)
+{
+    struct dpif_upcall misses[FLOW_MISS_MAX_BATCH];
+    struct dpif_upcall *upcall;
+    size_t n_misses = 0;
+    struct flow flow;
+
+    assert(n_upcalls <= FLOW_MISS_MAX_BATCH);
+
+    for (upcall = upcalls; upcall < &upcalls[n_upcalls]; upcall++) {
+        switch (upcall->type) {
+        case DPIF_UC_ACTION:
+            COVERAGE_INC(ofproto_ctlr_action);
+            odp_flow_key_to_flow(upcall->key, upcall->key_len, &flow);
+            send_packet_in(p, upcall, &flow, false);
+            break;
+
+        case DPIF_UC_SAMPLE:
+            if (p->sflow) {
+                odp_flow_key_to_flow(upcall->key, upcall->key_len, &flow);
+                ofproto_sflow_received(p->sflow, upcall, &flow);
+            }
+            ofpbuf_delete(upcall->packet);
+            break;
+
+        case DPIF_UC_MISS:
+            /* Handle misses in a batch below. */
+            misses[n_misses++] = *upcall;
+            break;
+
+        case DPIF_N_UC_TYPES:
+        default:
+            VLOG_WARN_RL(&rl, "upcall has unexpected type %"PRIu32,
+                         upcall->type);
+            break;
+        }
+    }
+
+    handle_miss_upcalls(p, misses, n_misses);
+}
+
 /* Flow expiration. */
 
 static int ofproto_dp_max_idle(const struct ofproto *);
@@ -3880,6 +4839,9 @@ ofproto_expire(struct ofproto *ofproto)
     dp_max_idle = ofproto_dp_max_idle(ofproto);
     ofproto_expire_facets(ofproto, dp_max_idle);
 
+    /* Evict facets if they use more memory than their budget allows. */
+    ofproto_evict_facets(ofproto);
+
     /* Expire OpenFlow flows whose idle_timeout or hard_timeout has passed. */
     cls_cursor_init(&cursor, &ofproto->cls, NULL);
     CLS_CURSOR_FOR_EACH_SAFE (rule, next_rule, cr, &cursor) {
@@ -3897,6 +4859,40 @@ ofproto_expire(struct ofproto *ofproto)
     return MIN(dp_max_idle, 1000);
 }
 
+/* Maximum number of unknown datapath flows to delete with a single call to
+ * dpif_operate(). */
+#define STRAY_MAX_BATCH 50
+
+/* Deletes the 'n' datapath flows whose keys are in 'strays' from 'p''s
+ * datapath, then uninitializes 'strays'. */
+static void
+delete_strays(struct ofproto *p, struct ofpbuf strays[], size_t n)
+{
+    union dpif_op dels[STRAY_MAX_BATCH];
+    union dpif_op *ops[STRAY_MAX_BATCH];
+    size_t i;
+
+    if (!n) {
+        return;
+    }
+
+    for (i = 0; i < n; i++) {
+        struct dpif_flow_del *del = &dels[i].flow_del;
+
+        del->type = DPIF_OP_FLOW_DEL;
+        del->key = strays[i].data;
+        del->key_len = strays[i].size;
+        del->stats = NULL;
+        ops[i] = &dels[i];
+    }
+    dpif_operate(p->dpif, ops, n);
+
+    for (i = 0; i < n; i++) {
+        ofpbuf_uninit(&strays[i]);
+    }
+    p->stats_n_strays += n;
+}
+
 /* Update 'packet_count', 'byte_count', and 'used' members of installed facets.
  *
  * This function also pushes statistics updates to rules which each facet
@@ -3911,28 +4907,44 @@ ofproto_expire(struct ofproto *ofproto)
 static void
 ofproto_update_stats(struct ofproto *p)
 {
+    struct ofpbuf strays[STRAY_MAX_BATCH];
     const struct dpif_flow_stats *stats;
     struct dpif_flow_dump dump;
     const struct nlattr *key;
+    long long int start;
+    size_t n_strays;
+    size_t n_flows;
     size_t key_len;
 
+    time_refresh();
+    start = time_msec();
+    n_strays = 0;
+    n_flows = 0;
+
     dpif_flow_dump_start(&dump, p->dpif);
     while (dpif_flow_dump_next(&dump, &key, &key_len, NULL, NULL, &stats)) {
         struct facet *facet;
-        struct flow flow;
 
-        if (odp_flow_key_to_flow(key, key_len, &flow)) {
-            struct ds s;
+        n_flows++;
+        facet = facet_find_by_key(p, key, key_len);
+        if (!facet) {
+            struct flow flow;
 
-            ds_init(&s);
-            odp_flow_key_format(key, key_len, &s);
-            VLOG_WARN_RL(&rl, "failed to convert ODP flow key to flow: %s",
-                         ds_cstr(&s));
-            ds_destroy(&s);
+            /* The datapath might encode a key differently from us, so fall
+             * back to a lookup on the decoded flow. */
+            if (odp_flow_key_to_flow(key, key_len, &flow)) {
+                struct ds s;
 
-            continue;
+                ds_init(&s);
+                odp_flow_key_format(key, key_len, &s);
+                VLOG_WARN_RL(&rl, "failed to convert ODP flow key to flow: %s",
+                             ds_cstr(&s));
+                ds_destroy(&s);
+
+                continue;
+            }
+            facet = facet_find(p, &flow);
         }
-        facet = facet_find(p, &flow);
 
         if (facet && facet->installed) {
 
@@ -3956,12 +4968,24 @@ ofproto_update_stats(struct ofproto *p)
             facet_push_stats(p, facet);
         } else {
             /* There's a flow in the datapath that we know nothing about.
-             * Delete it. */
+             * Delete it, along with others like it, without waiting for the
+             * dump to finish. */
             COVERAGE_INC(ofproto_unexpected_rule);
-            dpif_flow_del(p->dpif, key, key_len, NULL);
+            ofpbuf_init(&strays[n_strays], key_len);
+            ofpbuf_put(&strays[n_strays], key, key_len);
+            if (++n_strays >= STRAY_MAX_BATCH) {
+                delete_strays(p, strays, n_strays);
+                n_strays = 0;
+            }
         }
     }
     dpif_flow_dump_done(&dump);
+    delete_strays(p, strays, n_strays);
+
+    time_refresh();
+    p->stats_n_dumps++;
+    p->stats_last_flows = n_flows;
+    p->stats_last_msec = time_msec() - start;
 }
 
 /* Calculates and returns the number of milliseconds of idle time after which
@@ -4091,6 +5115,129 @@ ofproto_expire_facets(struct ofproto *ofproto, int dp_max_idle)
     }
 }
 
+/* A facet that ofproto_evict_facets() might evict. */
+struct facet_eviction {
+    long long int value;        /* Lower values are evicted first. */
+    struct facet *facet;
+};
+
+static int
+compare_facet_evictions(const void *a_, const void *b_)
+{
+    const struct facet_eviction *a = a_;
+    const struct facet_eviction *b = b_;
+
+    return a->value < b->value ? -1 : a->value > b->value;
+}
+
+/* Uninstalls the 'n' facets in 'evictions' from 'ofproto''s datapath with a
+ * single call to dpif_operate(), then removes them from 'ofproto'. */
+static void
+evict_facets(struct ofproto *ofproto, struct facet_eviction *evictions,
+             size_t n)
+{
+    struct dpif_flow_stats *stats;
+    union dpif_op **ops;
+    union dpif_op *dels;
+    size_t n_ops;
+    size_t i;
+
+    stats = xmalloc(n * sizeof *stats);
+    dels = xmalloc(n * sizeof *dels);
+    ops = xmalloc(n * sizeof *ops);
+    n_ops = 0;
+    for (i = 0; i < n; i++) {
+        struct facet *facet = evictions[i].facet;
+
+        if (facet->installed) {
+            struct dpif_flow_del *del = &dels[n_ops].flow_del;
+
+            del->type = DPIF_OP_FLOW_DEL;
+            del->key = facet->key;
+            del->key_len = facet->key_len;
+            del->stats = &stats[n_ops];
+            ops[n_ops] = &dels[n_ops];
+            n_ops++;
+        }
+    }
+    dpif_operate(ofproto->dpif, ops, n_ops);
+
+    /* This is the same as facet_uninstall(), for each facet, except that it
+     * takes the results from 'dels'. */
+    n_ops = 0;
+    for (i = 0; i < n; i++) {
+        struct facet *facet = evictions[i].facet;
+
+        if (facet->installed) {
+            const struct dpif_flow_del *del = &dels[n_ops++].flow_del;
+
+            if (!del->error) {
+                facet_update_stats(ofproto, facet, del->stats);
+            }
+            facet->installed = false;
+            facet->dp_packet_count = 0;
+            facet->dp_byte_count = 0;
+        }
+        facet_remove(ofproto, facet);
+    }
+
+    free(ops);
+    free(dels);
+    free(stats);
+}
+
+/* Removes facets from 'ofproto' until the memory that they use fits within
+ * 'ofproto''s facet memory budget.  Removing a facet folds its statistics
+ * into its rule.  Called after facets are created as well as periodically.
+ *
+ * Facets are evicted least valuable first.  A facet's value is its average
+ * byte rate over its lifetime, discounted by the time since it was last used,
+ * so that idle facets and facets that carry little traffic go first.
+ *
+ * Eviction goes down to 7/8 of the budget, so that while new facets keep
+ * arriving, not every batch of them has to sort all of the facets. */
+static void
+ofproto_evict_facets(struct ofproto *ofproto)
+{
+    struct facet_eviction *evictions;
+    struct facet *facet;
+    size_t bytes, target;
+    long long int now;
+    size_t n, i;
+
+    if (!ofproto->facet_budget
+        || ofproto->facet_bytes <= ofproto->facet_budget) {
+        return;
+    }
+    target = ofproto->facet_budget - ofproto->facet_budget / 8;
+
+    now = time_msec();
+    evictions = xmalloc(hmap_count(&ofproto->facets) * sizeof *evictions);
+    n = 0;
+    HMAP_FOR_EACH (facet, hmap_node, &ofproto->facets) {
+        long long int age = MAX(now - facet->created, 1);
+        long long int idle = MAX(now - facet->used, 0);
+        long long int rate = facet->byte_count * 1000 / age;
+
+        evictions[n].value = rate * 1000 / (idle + 1000);
+        evictions[n].facet = facet;
+        n++;
+    }
+    qsort(evictions, n, sizeof *evictions, compare_facet_evictions);
+
+    bytes = ofproto->facet_bytes;
+    for (i = 0; i < n && bytes > target; i++) {
+        bytes -= facet_memory_size(evictions[i].facet);
+    }
+    evict_facets(ofproto, evictions, i);
+    free(evictions);
+
+    COVERAGE_ADD(facet_evicted, i);
+    ofproto->facet_n_evictions += i;
+    VLOG_DBG_RL(&rl, "%s: evicted %zu facets to fit within %zu-byte budget",
+                dpif_name(ofproto->dpif), i, ofproto->facet_budget);
+}
+
 /* If 'rule' is an OpenFlow rule, that has expired according to OpenFlow rules,
  * then delete it entirely. */
 static void
@@ -4348,7 +5495,7 @@ ofproto_unixctl_trace(struct unixctl_conn *conn, const char *args_,
     flow_format(&result, &flow);
     ds_put_char(&result, '\n');
 
-    rule = rule_lookup(ofproto, &flow);
+    rule = rule_lookup(ofproto, &flow, NULL);
     trace_format_rule(&result, 0, rule);
     if (rule) {
         struct ofproto_trace trace;
@@ -4376,6 +5523,138 @@ exit:
     free(args);
 }
 
+static void
+ofproto_unixctl_revalidation_status(struct unixctl_conn *conn,
+                                    const char *args,
+                                    void *aux OVS_UNUSED)
+{
+    const struct ofproto *ofproto;
+    struct ds ds;
+
+    ofproto = shash_find_data(&all_ofprotos, args);
+    if (!ofproto) {
+        unixctl_command_reply(conn, 501, "Unknown ofproto (use ofproto/list "
+                              "for help)");
+        return;
+    }
+
+    ds_init(&ds);
+    ds_put_format(&ds, "%s:\n", args);
+    ds_put_format(&ds, "\tfacets: %zu\n", hmap_count(&ofproto->facets));
+    ds_put_format(&ds, "\tpending: %s\n",
+                  (ofproto->need_revalidate ? "all facets"
+                   : !tag_set_is_empty(&ofproto->revalidate_set)
+                   ? "tagged facets"
+                   : "none"));
+    if (ofproto->reval_active) {
+        ds_put_format(&ds, "\tin progress: %s, started %lld ms ago\n",
+                      ofproto->reval_all ? "all facets" : "tagged facets",
+                      time_msec() - ofproto->reval_started);
+    } else {
+        ds_put_cstr(&ds, "\tin progress: none\n");
+    }
+    ds_put_format(&ds, "\tcompleted passes: %llu, last took %lld ms\n",
+                  ofproto->reval_n_passes, ofproto->reval_last_msec);
+    ds_put_format(&ds, "\tfacets checked: %llu revalidated: %llu\n",
+                  ofproto->reval_n_checked, ofproto->reval_n_revalidated);
+    unixctl_command_reply(conn, 200, ds_cstr(&ds));
+    ds_destroy(&ds);
+}
+
+static void
+ofproto_unixctl_flow_stats_status(struct unixctl_conn *conn, const char *args,
+                                  void *aux OVS_UNUSED)
+{
+    const struct ofproto *ofproto;
+    struct ds ds;
+
+    ofproto = shash_find_data(&all_ofprotos, args);
+    if (!ofproto) {
+        unixctl_command_reply(conn, 501, "Unknown ofproto (use ofproto/list "
+                              "for help)");
+        return;
+    }
+
+    ds_init(&ds);
+    ds_put_format(&ds, "%s:\n", args);
+    ds_put_format(&ds, "\tdumps: %llu\n", ofproto->stats_n_dumps);
+    ds_put_format(&ds, "\tlast dump: %zu flows in %lld ms",
+                  ofproto->stats_last_flows, ofproto->stats_last_msec);
+    if (ofproto->stats_last_msec > 0) {
+        ds_put_format(&ds, " (%lld flows/s)",
+                      ofproto->stats_last_flows * 1000LL
+                      / ofproto->stats_last_msec);
+    }
+    ds_put_char(&ds, '\n');
+    ds_put_format(&ds, "\tunexpected flows deleted: %llu\n",
+                  ofproto->stats_n_strays);
+    unixctl_command_reply(conn, 200, ds_cstr(&ds));
+    ds_destroy(&ds);
+}
+
+static void
+ofproto_unixctl_packet_in_status(struct unixctl_conn *conn, const char *args,
+                                 void *aux OVS_UNUSED)
+{
+    const struct ofproto *ofproto;
+    struct ds ds;
+
+    ofproto = shash_find_data(&all_ofprotos, args);
+    if (!ofproto) {
+        unixctl_command_reply(conn, 501, "Unknown ofproto (use ofproto/list "
+                              "for help)");
+        return;
+    }
+
+    ds_init(&ds);
+    ds_put_format(&ds, "%s:\n", args);
+    connmgr_format_packet_in_status(ofproto->connmgr, &ds);
+    unixctl_command_reply(conn, 200, ds_cstr(&ds));
+    ds_destroy(&ds);
+}
+
+static void
+ofproto_unixctl_facet_status(struct unixctl_conn *conn, const char *args,
+                             void *aux OVS_UNUSED)
+{
+    const struct ofproto *ofproto;
+    struct ds ds;
+
+    ofproto = shash_find_data(&all_ofprotos, args);
+    if (!ofproto) {
+        unixctl_command_reply(conn, 501, "Unknown ofproto (use ofproto/list "
+                              "for help)");
+        return;
+    }
+
+    ds_init(&ds);
+    ds_put_format(&ds, "%s:\n", args);
+    ds_put_format(&ds, "\tfacets: %zu\n", hmap_count(&ofproto->facets));
+    ds_put_format(&ds, "\tmemory: %zu bytes\n", ofproto->facet_bytes);
+    if (ofproto->facet_budget) {
+        ds_put_format(&ds, "\tbudget: %zu bytes\n", ofproto->facet_budget);
+    } else {
+        ds_put_cstr(&ds, "\tbudget: none\n");
+    }
+    ds_put_format(&ds, "\tevictions: %llu\n", ofproto->facet_n_evictions);
+    unixctl_command_reply(conn, 200, ds_cstr(&ds));
+    ds_destroy(&ds);
+}
+
+static void
+ofproto_pools_init(void)
+{
+    static bool inited;
+    if (inited) {
+        return;
+    }
+    inited = true;
+
+    pool_init(&facet_pool, "ofproto-facets", sizeof(struct facet));
+    pool_init(&rule_pool, "ofproto-rules", sizeof(struct rule));
+    pool_set_init(&actions_pool, "ofproto-actions");
+}
+
 static void
 ofproto_unixctl_init(void)
 {
@@ -4387,6 +5666,14 @@ ofproto_unixctl_init(void)
 
     unixctl_command_register("ofproto/list", ofproto_unixctl_list, NULL);
     unixctl_command_register("ofproto/trace", ofproto_unixctl_trace, NULL);
+    unixctl_command_register("ofproto/revalidation-status",
+                             ofproto_unixctl_revalidation_status, NULL);
+    unixctl_command_register("ofproto/flow-stats-status",
+                             ofproto_unixctl_flow_stats_status, NULL);
+    unixctl_command_register("ofproto/packet-in-status",
+                             ofproto_unixctl_packet_in_status, NULL);
+    unixctl_command_register("ofproto/facet-status",
+                             ofproto_unixctl_facet_status, NULL);
 }
 
 static bool
@@ -33,6 +33,7 @@ extern "C" {
 
 struct cls_rule;
 struct nlattr;
+struct ofconn;
 struct ofhooks;
 struct ofproto;
 struct shash;
@@ -41,8 +42,8 @@ struct ofproto_controller_info {
     bool is_connected;
     enum nx_role role;
     struct {
-        const char *keys[4];
-        const char *values[4];
+        const char *keys[8];
+        const char *values[8];
         size_t n;
     } pairs;
 };
@@ -114,6 +115,7 @@ void ofproto_reconnect_controllers(struct ofproto *);
 void ofproto_set_extra_in_band_remotes(struct ofproto *,
                                        const struct sockaddr_in *, size_t n);
 void ofproto_set_in_band_queue(struct ofproto *, int queue_id);
+void ofproto_set_facet_budget(struct ofproto *, size_t budget);
 void ofproto_set_desc(struct ofproto *,
                       const char *mfr_desc, const char *hw_desc,
                       const char *sw_desc, const char *serial_desc,
@@ -135,6 +137,9 @@ const struct cfm *ofproto_iface_get_cfm(struct ofproto *, uint32_t port_no);
 /* Configuration querying. */
 uint64_t ofproto_get_datapath_id(const struct ofproto *);
 bool ofproto_has_primary_controller(const struct ofproto *);
+void ofproto_get_facet_usage(const struct ofproto *, size_t *n_facets,
+                             size_t *n_bytes,
+                             unsigned long long int *n_evictions);
 enum ofproto_fail_mode ofproto_get_fail_mode(const struct ofproto *);
 void ofproto_get_listeners(const struct ofproto *, struct sset *);
 bool ofproto_has_snoops(const struct ofproto *);
@@ -148,6 +153,7 @@ void ofproto_add_flow(struct ofproto *, const struct cls_rule *,
                       const union ofp_action *, size_t n_actions);
 void ofproto_delete_flow(struct ofproto *, const struct cls_rule *);
 void ofproto_flush_flows(struct ofproto *);
+void ofproto_ofconn_destroyed(struct ofproto *, const struct ofconn *);
 
 /* Hooks for ovs-vswitchd. */
 struct ofhooks {
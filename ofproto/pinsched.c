@@ -19,9 +19,14 @@
 #include <sys/types.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <inttypes.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include "dynamic-string.h"
+#include "hash.h"
 #include "hmap.h"
+#include "list.h"
 #include "ofpbuf.h"
 #include "openflow/openflow.h"
 #include "poll-loop.h"
@@ -30,11 +35,57 @@
 #include "timeval.h"
 #include "vconn.h"
 
+/* A packet-in scheduler has a token bucket, which limits the rate at which it
+ * passes packet-ins to its callback, and a queue for each combination of input
+ * port and reason (table miss or controller action).  When the bucket runs
+ * dry, packet-ins wait in their queues, which are drained with self-clocked
+ * weighted fair queuing: each packet in a queue has a virtual finish time
+ * PINSCHED_VTIME_UNIT / weight later than the packet ahead of it, and the
+ * head packet with the earliest virtual finish time goes next.  A
+ * port that floods the scheduler with packets therefore mostly delays its own
+ * packets, not those of other ports.
+ *
+ * When the queues together hold 'burst_limit' packets, each new packet causes
+ * the oldest packet in the queue with the largest backlog, relative to its
+ * weight, to be dropped. */
+
+/* Queue weights.  Packets sent to the controller by an explicit action are
+ * usually control traffic that the controller asked to see, so they get a
+ * larger share of the rate limit than table misses. */
+#define PINSCHED_MISS_WEIGHT 1
+#define PINSCHED_ACTION_WEIGHT 4
+
+/* Virtual time that it takes to send one packet from a queue with weight 1.
+ * Must be a multiple of each of the weights above. */
+#define PINSCHED_VTIME_UNIT 1024
+
+/* A queued packet-in. */
+struct pinpacket {
+    struct list list_node;      /* In struct pinqueue's 'packets' list. */
+    struct ofpbuf *packet;      /* The OFPT_PACKET_IN message. */
+    long long int queued;       /* Time at which it was queued, in ms. */
+};
+
 struct pinqueue {
     struct hmap_node node;      /* In struct pinsched's 'queues' hmap. */
+    struct list active_node;    /* In struct pinsched's 'active' if n > 0. */
     uint16_t port_no;           /* Port number. */
-    struct list packets;        /* Contains "struct ofpbuf"s. */
+    enum ofp_packet_in_reason reason; /* OFPR_NO_MATCH or OFPR_ACTION. */
+    int weight;                 /* PINSCHED_*_WEIGHT. */
+    struct list packets;        /* Contains "struct pinpacket"s. */
     int n;                      /* Number of packets in 'packets'. */
+
+    /* Virtual finish times of the first packet in 'packets' (if n > 0) and of
+     * the last packet sent from this queue. */
+    long long int head_vtime;
+    long long int last_vtime;
+
+    /* Statistics reporting. */
+    unsigned long long int n_limited;  /* # queued for rate limiting. */
+    unsigned long long int n_sent;     /* # txed after queuing. */
+    unsigned long long int n_dropped;  /* # dropped due to queue overflow. */
+    long long int total_latency;       /* Sum of time queued, in ms. */
+    long long int max_latency;         /* Max time queued, in ms. */
 };
 
 struct pinsched {
@@ -42,10 +93,12 @@ struct pinsched {
     int rate_limit;           /* Packets added to bucket per second. */
     int burst_limit;          /* Maximum token bucket size, in packets. */
 
-    /* One queue per physical port. */
+    /* One queue per port and reason.  Queues are kept even when they are
+     * empty, so that their statistics can be reported. */
     struct hmap queues;         /* Contains "struct pinqueue"s. */
+    struct list active;         /* Nonempty queues, in activation order. */
     int n_queued;               /* Sum over queues[*].n. */
-    struct pinqueue *next_txq;  /* Next pinqueue check in round-robin. */
+    long long int vtime;        /* Virtual finish time of last packet sent. */
 
     /* Token bucket.
      *
@@ -56,80 +109,100 @@ struct pinsched {
     long long int last_fill;    /* Time at which we last added tokens. */
     int tokens;                 /* Current number of tokens. */
 
-    /* Transmission queue. */
-    int n_txq;                  /* No. of packets waiting in rconn for tx. */
-
     /* Statistics reporting. */
     unsigned long long n_normal;        /* # txed w/o rate limit queuing. */
-    unsigned long long n_limited;       /* # queued for rate limiting. */
-    unsigned long long n_queue_dropped; /* # dropped due to queue overflow. */
 };
 
-static void
-advance_txq(struct pinsched *ps)
-{
-    struct hmap_node *next;
-
-    next = (ps->next_txq
-            ? hmap_next(&ps->queues, &ps->next_txq->node)
-            : hmap_first(&ps->queues));
-    ps->next_txq = next ? CONTAINER_OF(next, struct pinqueue, node) : NULL;
-}
-
-static struct ofpbuf *
-dequeue_packet(struct pinsched *ps, struct pinqueue *q)
-{
-    struct ofpbuf *packet = ofpbuf_from_list(list_pop_front(&q->packets));
-    q->n--;
-    ps->n_queued--;
-    return packet;
-}
-
-/* Destroys 'q' and removes it from 'ps''s set of queues.
- * (The caller must ensure that 'q' is empty.) */
-static void
-pinqueue_destroy(struct pinsched *ps, struct pinqueue *q)
+static int
+pinqueue_cost(const struct pinqueue *q)
 {
-    hmap_remove(&ps->queues, &q->node);
-    free(q);
+    return PINSCHED_VTIME_UNIT / q->weight;
 }
 
 static struct pinqueue *
-pinqueue_get(struct pinsched *ps, uint16_t port_no)
+pinqueue_get(struct pinsched *ps, uint16_t port_no,
+             enum ofp_packet_in_reason reason)
 {
-    uint32_t hash = hash_int(port_no, 0);
+    uint32_t hash = hash_int(port_no, reason);
     struct pinqueue *q;
 
     HMAP_FOR_EACH_IN_BUCKET (q, node, hash, &ps->queues) {
-        if (port_no == q->port_no) {
+        if (port_no == q->port_no && reason == q->reason) {
             return q;
         }
     }
 
-    q = xmalloc(sizeof *q);
+    q = xzalloc(sizeof *q);
     hmap_insert(&ps->queues, &q->node, hash);
     q->port_no = port_no;
+    q->reason = reason;
+    q->weight = (reason == OFPR_ACTION
+                 ? PINSCHED_ACTION_WEIGHT
+                 : PINSCHED_MISS_WEIGHT);
     list_init(&q->packets);
-    q->n = 0;
     return q;
 }
 
-/* Drop a packet from the longest queue in 'ps'. */
+/* Appends 'packet' to 'q'. */
+static void
+enqueue_packet(struct pinsched *ps, struct pinqueue *q, struct ofpbuf *packet)
+{
+    struct pinpacket *pp;
+
+    if (!q->n) {
+        q->head_vtime = MAX(ps->vtime, q->last_vtime) + pinqueue_cost(q);
+        list_push_back(&ps->active, &q->active_node);
+    }
+
+    pp = xmalloc(sizeof *pp);
+    pp->packet = packet;
+    pp->queued = time_msec();
+    list_push_back(&q->packets, &pp->list_node);
+    q->n++;
+    q->n_limited++;
+    ps->n_queued++;
+}
+
+/* Removes the oldest packet from 'q' and returns it.  The caller must free the
+ * returned pinpacket. */
+static struct pinpacket *
+dequeue_packet(struct pinsched *ps, struct pinqueue *q)
+{
+    struct pinpacket *pp;
+
+    pp = CONTAINER_OF(list_pop_front(&q->packets), struct pinpacket,
+                      list_node);
+    q->n--;
+    ps->n_queued--;
+    if (!q->n) {
+        list_remove(&q->active_node);
+    }
+    return pp;
+}
+
+/* Drops the oldest packet from the queue in 'ps' with the longest backlog
+ * relative to its weight.
+ *
+ * The rest of the queue keeps its place in line: the next packet inherits the
+ * dropped packet's virtual finish time. */
 static void
 drop_packet(struct pinsched *ps)
 {
     struct pinqueue *longest;   /* Queue currently selected as longest. */
     int n_longest = 0;          /* # of queues of same length as 'longest'. */
+    struct pinpacket *pp;
     struct pinqueue *q;
 
-    ps->n_queue_dropped++;
-
     longest = NULL;
-    HMAP_FOR_EACH (q, node, &ps->queues) {
-        if (!longest || longest->n < q->n) {
+    LIST_FOR_EACH (q, active_node, &ps->active) {
+        long long int cmp = (longest
+                             ? (long long int) q->n * longest->weight
+                               - (long long int) longest->n * q->weight
+                             : 1);
+        if (cmp > 0) {
             longest = q;
             n_longest = 1;
-        } else if (longest->n == q->n) {
+        } else if (!cmp) {
             n_longest++;
 
             /* Randomly select one of the longest queues, with a uniform
@@ -140,31 +213,41 @@ drop_packet(struct pinsched *ps)
         }
     }
 
-    /* FIXME: do we want to pop the tail instead? */
-    ofpbuf_delete(dequeue_packet(ps, longest));
-    if (longest->n == 0) {
-        pinqueue_destroy(ps, longest);
-    }
+    pp = dequeue_packet(ps, longest);
+    longest->n_dropped++;
+    ofpbuf_delete(pp->packet);
+    free(pp);
 }
 
-/* Remove and return the next packet to transmit (in round-robin order). */
+/* Remove and return the next packet to transmit (in weighted fair queuing
+ * order). */
 static struct ofpbuf *
 get_tx_packet(struct pinsched *ps)
 {
+    struct pinqueue *next, *q;
     struct ofpbuf *packet;
-    struct pinqueue *q;
-
-    if (!ps->next_txq) {
-        advance_txq(ps);
+    struct pinpacket *pp;
+    long long int latency;
+
+    /* Ties go to the queue that became active first. */
+    next = NULL;
+    LIST_FOR_EACH (q, active_node, &ps->active) {
+        if (!next || q->head_vtime < next->head_vtime) {
+            next = q;
+        }
     }
 
-    q = ps->next_txq;
-    packet = dequeue_packet(ps, q);
-    advance_txq(ps);
-    if (q->n == 0) {
-        pinqueue_destroy(ps, q);
-    }
+    pp = dequeue_packet(ps, next);
+    ps->vtime = next->last_vtime = next->head_vtime;
+    next->head_vtime += pinqueue_cost(next);
+
+    latency = time_msec() - pp->queued;
+    next->n_sent++;
+    next->total_latency += latency;
+    next->max_latency = MAX(next->max_latency, latency);
 
+    packet = pp->packet;
+    free(pp);
     return packet;
 }
 
@@ -194,8 +277,15 @@ get_token(struct pinsched *ps)
     }
 }
 
+/* Passes 'packet', a packet-in for a packet received on 'port_no' and sent to
+ * the controller for the given 'reason', to 'cb' along with 'aux', either
+ * immediately or later from pinsched_run() if 'ps' needs to rate limit it.
+ * 'packet' might instead be dropped if 'ps''s queues are full.
+ *
+ * If 'ps' is null, passes 'packet' to 'cb' immediately. */
 void
 pinsched_send(struct pinsched *ps, uint16_t port_no,
+              enum ofp_packet_in_reason reason,
               struct ofpbuf *packet, pinsched_tx_cb *cb, void *aux)
 {
     if (!ps) {
@@ -207,7 +297,6 @@ pinsched_send(struct pinsched *ps, uint16_t port_no,
         cb(packet, aux);
     } else {
         /* Otherwise queue it up for the periodic callback to drain out. */
-        struct pinqueue *q;
 
         /* We are called with a buffer obtained from dpif_recv() that has much
          * more allocated space than actual content most of the time.  Since
@@ -218,11 +307,7 @@ pinsched_send(struct pinsched *ps, uint16_t port_no,
         if (ps->n_queued >= ps->burst_limit) {
             drop_packet(ps);
         }
-        q = pinqueue_get(ps, port_no);
-        list_push_back(&q->packets, &packet->list_node);
-        q->n++;
-        ps->n_queued++;
-        ps->n_limited++;
+        enqueue_packet(ps, pinqueue_get(ps, port_no, reason), packet);
     }
 }
 
@@ -264,14 +349,12 @@ pinsched_create(int rate_limit, int burst_limit)
 
     ps = xzalloc(sizeof *ps);
     hmap_init(&ps->queues);
+    list_init(&ps->active);
     ps->n_queued = 0;
-    ps->next_txq = NULL;
+    ps->vtime = 0;
     ps->last_fill = time_msec();
     ps->tokens = rate_limit * 100;
-    ps->n_txq = 0;
     ps->n_normal = 0;
-    ps->n_limited = 0;
-    ps->n_queue_dropped = 0;
     pinsched_set_limits(ps, rate_limit, burst_limit);
 
     return ps;
@@ -284,8 +367,13 @@ pinsched_destroy(struct pinsched *ps)
         struct pinqueue *q, *next;
 
         HMAP_FOR_EACH_SAFE (q, next, node, &ps->queues) {
+            struct pinpacket *pp, *next_pp;
+
+            LIST_FOR_EACH_SAFE (pp, next_pp, list_node, &q->packets) {
+                ofpbuf_delete(pp->packet);
+                free(pp);
+            }
             hmap_remove(&ps->queues, &q->node);
-            ofpbuf_list_delete(&q->packets);
             free(q);
         }
         hmap_destroy(&ps->queues);
@@ -319,3 +407,75 @@ pinsched_set_limits(struct pinsched *ps, int rate_limit, int burst_limit)
         drop_packet(ps);
     }
 }
+
+/* Stores statistics for 'ps', summed over all of its queues, in '*stats'. */
+void
+pinsched_get_stats(const struct pinsched *ps, struct pinsched_stats *stats)
+{
+    const struct pinqueue *q;
+    long long int total_latency;
+
+    memset(stats, 0, sizeof *stats);
+    stats->n_normal = ps->n_normal;
+    stats->n_queued = ps->n_queued;
+
+    total_latency = 0;
+    HMAP_FOR_EACH (q, node, &ps->queues) {
+        stats->n_limited += q->n_limited;
+        stats->n_sent += q->n_sent;
+        stats->n_dropped += q->n_dropped;
+        total_latency += q->total_latency;
+        stats->max_latency = MAX(stats->max_latency, q->max_latency);
+    }
+    stats->avg_latency = stats->n_sent ? total_latency / stats->n_sent : 0;
+}
+
+static int
+compare_pinqueues(const void *a_, const void *b_)
+{
+    const struct pinqueue *const *a = a_;
+    const struct pinqueue *const *b = b_;
+
+    return ((*a)->port_no != (*b)->port_no
+            ? ((*a)->port_no < (*b)->port_no ? -1 : 1)
+            : (int) (*a)->reason - (int) (*b)->reason);
+}
+
+/* Appends a human-readable description of 'ps', with its limits, its totals,
+ * and a line for each of its queues in order of port number, to 'ds'.  Each
+ * line is indented by two tabs. */
+void
+pinsched_format(const struct pinsched *ps, struct ds *ds)
+{
+    struct pinsched_stats stats;
+    const struct pinqueue **queues;
+    const struct pinqueue *q;
+    size_t i, n;
+
+    pinsched_get_stats(ps, &stats);
+    ds_put_format(ds, "\t\trate limit: %d packets/s, burst limit: %d packets\n",
+                  ps->rate_limit, ps->burst_limit);
+    ds_put_format(ds, "\t\tsent without queuing: %llu, queued: %llu, "
+                  "sent: %llu, dropped: %llu, queue length: %d\n",
+                  stats.n_normal, stats.n_limited, stats.n_sent,
+                  stats.n_dropped, stats.n_queued);
+
+    n = 0;
+    queues = xmalloc(hmap_count(&ps->queues) * sizeof *queues);
+    HMAP_FOR_EACH (q, node, &ps->queues) {
+        queues[n++] = q;
+    }
+    qsort(queues, n, sizeof *queues, compare_pinqueues);
+
+    for (i = 0; i < n; i++) {
+        q = queues[i];
+        ds_put_format(ds, "\t\tport %"PRIu16" %s (weight %d): queued: %llu, "
+                      "sent: %llu, dropped: %llu, queue length: %d, "
+                      "latency: avg %lld ms, max %lld ms\n",
+                      q->port_no, q->reason == OFPR_ACTION ? "action" : "miss",
+                      q->weight, q->n_limited, q->n_sent, q->n_dropped, q->n,
+                      q->n_sent ? q->total_latency / (long long int) q->n_sent
+                      : 0, q->max_latency);
+    }
+    free(queues);
+}
@@ -18,18 +18,37 @@
 #define PINSCHED_H_H 1
 
 #include <stdint.h>
+#include "openflow/openflow.h"
 
+struct ds;
 struct ofpbuf;
 
+/* Statistics for a packet-in scheduler, summed over all of its queues. */
+struct pinsched_stats {
+    unsigned long long int n_normal;   /* Sent without queuing. */
+    unsigned long long int n_limited;  /* Queued for rate limiting. */
+    unsigned long long int n_sent;     /* Sent after queuing. */
+    unsigned long long int n_dropped;  /* Dropped from a full queue. */
+    int n_queued;                      /* Currently queued. */
+
+    /* Time that packets sent after queuing spent in their queues, in ms. */
+    long long int avg_latency;
+    long long int max_latency;
+};
+
 typedef void pinsched_tx_cb(struct ofpbuf *, void *aux);
 struct pinsched *pinsched_create(int rate_limit, int burst_limit);
 void pinsched_get_limits(const struct pinsched *,
                          int *rate_limit, int *burst_limit);
 void pinsched_set_limits(struct pinsched *, int rate_limit, int burst_limit);
 void pinsched_destroy(struct pinsched *);
-void pinsched_send(struct pinsched *, uint16_t port_no, struct ofpbuf *,
+void pinsched_send(struct pinsched *, uint16_t port_no,
+                   enum ofp_packet_in_reason, struct ofpbuf *,
                    pinsched_tx_cb *, void *aux);
 void pinsched_run(struct pinsched *, pinsched_tx_cb *, void *aux);
 void pinsched_wait(struct pinsched *);
 
+void pinsched_get_stats(const struct pinsched *, struct pinsched_stats *);
+void pinsched_format(const struct pinsched *, struct ds *);
+
 #endif /* pinsched.h */
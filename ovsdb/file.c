@@ -20,28 +20,37 @@
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
 #include <unistd.h>
 
 #include "bitmap.h"
 #include "column.h"
+#include "dynamic-string.h"
 #include "log.h"
 #include "json.h"
 #include "lockfile.h"
 #include "ovsdb.h"
 #include "ovsdb-error.h"
+#include "poll-loop.h"
+#include "process.h"
 #include "row.h"
 #include "socket-util.h"
 #include "table.h"
 #include "timeval.h"
 #include "transaction.h"
+#include "trigger.h"
 #include "uuid.h"
 #include "util.h"
 #include "vlog.h"
 
 VLOG_DEFINE_THIS_MODULE(ovsdb_file);
 
-/* Minimum number of milliseconds between database compactions. */
-#define COMPACT_MIN_MSEC        (10 * 60 * 1000) /* 10 minutes. */
+/* Default thresholds for automatic compaction: the log must be at least this
+ * many times as large as the snapshot that it started from, and at least this
+ * many bytes long. */
+#define COMPACT_DEFAULT_RATIO    2.0
+#define COMPACT_DEFAULT_MIN_SIZE (10 * 1024 * 1024) /* 10 MB. */
 
 /* Minimum number of milliseconds between trying to compact the database if
  * compacting fails. */
@@ -436,7 +445,7 @@ error:
 static struct ovsdb_error *
 ovsdb_file_save_copy__(const char *file_name, int locking,
                        const char *comment, const struct ovsdb *db,
-                       struct ovsdb_log **logp)
+                       enum ovsdb_log_format format, struct ovsdb_log **logp)
 {
     const struct shash_node *node;
     struct ovsdb_file_txn ftxn;
@@ -448,6 +457,10 @@ ovsdb_file_save_copy__(const char *file_name, int locking,
     if (error) {
         return error;
     }
+    error = ovsdb_log_set_format(log, format);
+    if (error) {
+        goto exit;
+    }
 
     /* Write schema. */
     json = ovsdb_schema_to_json(db->schema);
@@ -467,7 +480,11 @@ ovsdb_file_save_copy__(const char *file_name, int locking,
             ovsdb_file_txn_add_row(&ftxn, NULL, row, NULL);
         }
     }
+    if (!ftxn.json) {
+        ftxn.json = json_object_create();
+    }
     error = ovsdb_file_txn_commit(ftxn.json, comment, true, log);
+    json_destroy(ftxn.json);
 
 exit:
     if (logp) {
@@ -485,16 +502,18 @@ exit:
     return error;
 }
 
-/* Saves a snapshot of 'db''s current contents as 'file_name'.  If 'comment' is
- * nonnull, then it is added along with the data contents and can be viewed
- * with "ovsdb-tool show-log".
+/* Saves a snapshot of 'db''s current contents as 'file_name', in the given
+ * log 'format'.  If 'comment' is nonnull, then it is added along with the data
+ * contents and can be viewed with "ovsdb-tool show-log".
  *
  * 'locking' is passed along to ovsdb_log_open() untouched. */
 struct ovsdb_error *
 ovsdb_file_save_copy(const char *file_name, int locking,
-                     const char *comment, const struct ovsdb *db)
+                     const char *comment, const struct ovsdb *db,
+                     enum ovsdb_log_format format)
 {
-    return ovsdb_file_save_copy__(file_name, locking, comment, db, NULL);
+    return ovsdb_file_save_copy__(file_name, locking, comment, db, format,
+                                  NULL);
 }
 
 /* Opens database 'file_name', reads its schema, and closes it.  On success,
@@ -510,6 +529,12 @@ ovsdb_file_read_schema(const char *file_name, struct ovsdb_schema **schemap)
 
 /* Replica implementation. */
 
+/* Buckets in the group commit histograms.  Bucket i counts fsync() calls that
+ * took less than 2**i milliseconds, or that committed fewer than 2**i
+ * transactions, but were not counted in a lower bucket.  The last bucket
+ * counts all the rest. */
+#define GROUP_COMMIT_N_BUCKETS 12
+
 struct ovsdb_file {
     struct ovsdb_replica replica;
     struct ovsdb *db;
@@ -518,10 +543,47 @@ struct ovsdb_file {
     long long int oldest_commit;
     long long int next_compact;
     unsigned int n_transactions;
+
+    /* Compaction (see ovsdb_file_set_compaction()). */
+    double compact_ratio;       /* Compact when log is this many times... */
+    off_t compact_min_size;     /* ...and this many bytes larger than... */
+    off_t snapshot_size;        /* ...the snapshot that begins the log. */
+    struct ovsdb_file_compactor *compactor; /* Background compaction. */
+
+    /* Group commit (see ovsdb_file_set_group_commit()). */
+    int group_commit_msec;      /* Window, or -1 if group commit disabled. */
+    unsigned long long int log_seqno_base; /* 'db->commit_seqno' that
+                                            * corresponds to 'log''s ticket
+                                            * 0. */
+    unsigned long long int n_syncs;        /* fsync() calls completed. */
+    unsigned long long int n_synced;       /* Transactions they committed. */
+    unsigned long long int compacted_seqno; /* Made durable by compaction. */
+    unsigned long long int fsync_hist[GROUP_COMMIT_N_BUCKETS];
+    unsigned long long int batch_hist[GROUP_COMMIT_N_BUCKETS];
+};
+
+/* A compaction in progress in a child process.
+ *
+ * The child writes a snapshot of the database, as it was at the time of the
+ * fork(), to 'tmp_name'.  Meanwhile, the parent keeps committing transactions
+ * to the old log as usual and also saves them in 'txns'.  When the child
+ * exits, the parent appends 'txns' to 'tmp_name' and renames it over the
+ * original file. */
+struct ovsdb_file_compactor {
+    struct process *process;    /* Child process writing the snapshot. */
+    char *tmp_name;             /* Name of the file the child writes. */
+    struct lockfile *tmp_lock;  /* Lock on 'tmp_name'. */
+
+    struct json **txns;         /* Transactions committed since the fork(). */
+    size_t n_txns, allocated_txns;
 };
 
 static const struct ovsdb_replica_class ovsdb_file_class;
 
+static void ovsdb_file_start_compaction(struct ovsdb_file *);
+static void ovsdb_file_finish_compaction(struct ovsdb_file *);
+static void ovsdb_file_abort_compaction(struct ovsdb_file *);
+
 static struct ovsdb_error *
 ovsdb_file_create(struct ovsdb *db, struct ovsdb_log *log,
                   const char *file_name,
@@ -548,8 +610,19 @@ ovsdb_file_create(struct ovsdb *db, struct ovsdb_log *log,
     file->log = log;
     file->file_name = abs_name;
     file->oldest_commit = MIN(oldest_commit, now);
-    file->next_compact = file->oldest_commit + COMPACT_MIN_MSEC;
+    file->next_compact = now;
     file->n_transactions = n_transactions;
+    file->compact_ratio = COMPACT_DEFAULT_RATIO;
+    file->compact_min_size = COMPACT_DEFAULT_MIN_SIZE;
+    file->snapshot_size = ovsdb_log_get_offset(log);
+    file->compactor = NULL;
+    file->group_commit_msec = -1;
+    file->log_seqno_base = 0;
+    file->n_syncs = 0;
+    file->n_synced = 0;
+    file->compacted_seqno = 0;
+    memset(file->fsync_hist, 0, sizeof file->fsync_hist);
+    memset(file->batch_hist, 0, sizeof file->batch_hist);
     ovsdb_add_replica(db, &file->replica);
 
     *filep = file;
@@ -590,35 +663,103 @@ ovsdb_file_commit(struct ovsdb_replica *replica,
     }
 
     error = ovsdb_file_txn_commit(ftxn.json, ovsdb_txn_get_comment(txn),
-                                  durable, file->log);
+                                  durable && file->group_commit_msec < 0,
+                                  file->log);
+    if (file->compactor && !error) {
+        /* Save the transaction to append to the compacted log later. */
+        struct ovsdb_file_compactor *c = file->compactor;
+
+        if (c->n_txns >= c->allocated_txns) {
+            c->txns = x2nrealloc(c->txns, &c->allocated_txns,
+                                 sizeof *c->txns);
+        }
+        c->txns[c->n_txns++] = ftxn.json;
+    } else {
+        json_destroy(ftxn.json);
+    }
     if (error) {
         return error;
     }
     file->n_transactions++;
 
-    /* If it has been at least COMPACT_MIN_MSEC millseconds since the last time
-     * we compacted (or at least COMPACT_RETRY_MSEC since the last time we
-     * tried), and if there are at least 100 transactions in the database, and
-     * if the database is at least 1 MB, then compact the database. */
-    if (time_msec() >= file->next_compact
-        && file->n_transactions >= 100
-        && ovsdb_log_get_offset(file->log) >= 10 * 1024 * 1024)
-    {
-        error = ovsdb_file_compact(file);
-        if (error) {
-            char *s = ovsdb_error_to_string(error);
-            ovsdb_error_destroy(error);
-            VLOG_WARN("%s: compacting database failed (%s), retrying in "
-                      "60 seconds", file->file_name, s);
-            free(s);
+    if (durable && file->group_commit_msec >= 0) {
+        /* Let the log's helper thread commit the transaction to disk.
+         * ovsdb_file_run() reports when it is done. */
+        file->db->commit_seqno = (file->log_seqno_base
+                                  + ovsdb_log_commit_async(file->log));
+    }
 
-            file->next_compact = time_msec() + COMPACT_RETRY_MSEC;
+    /* Compact the database in the background if the log has grown to at least
+     * 'compact_ratio' times the size of the snapshot that it started from and
+     * to at least 'compact_min_size' bytes, unless a compaction is already in
+     * progress or one failed less than COMPACT_RETRY_MSEC ago. */
+    if (!file->compactor && time_msec() >= file->next_compact) {
+        off_t size = ovsdb_log_get_offset(file->log);
+
+        if (size >= file->compact_min_size
+            && size >= file->compact_ratio * file->snapshot_size) {
+            ovsdb_file_start_compaction(file);
         }
     }
 
     return NULL;
 }
 
+/* Returns the comment to record in the snapshot that compacts 'file'.  The
+ * caller must free the string. */
+static char *
+ovsdb_file_compaction_comment(const struct ovsdb_file *file)
+{
+    return xasprintf("compacting database online "
+                     "(%.3f seconds old, %u transactions, %llu bytes)",
+                     (time_msec() - file->oldest_commit) / 1000.0,
+                     file->n_transactions,
+                     (unsigned long long) ovsdb_log_get_offset(file->log));
+}
+
+/* Locks the temporary file used to compact 'file', which is named 'tmp_name',
+ * and removes it if it exists.  On success, stores the lock in '*tmp_lockp'
+ * and returns NULL. */
+static struct ovsdb_error *
+ovsdb_file_prepare_tmp(const char *tmp_name, struct lockfile **tmp_lockp)
+{
+    int retval;
+
+    /* Lock temporary file. */
+    retval = lockfile_lock(tmp_name, 0, tmp_lockp);
+    if (retval) {
+        return ovsdb_io_error(retval, "could not get lock on %s", tmp_name);
+    }
+
+    /* Remove temporary file.  (It might not exist.) */
+    if (unlink(tmp_name) < 0 && errno != ENOENT) {
+        return ovsdb_io_error(errno, "failed to remove %s", tmp_name);
+    }
+
+    return NULL;
+}
+
+/* Replaces 'file''s log by 'new_log', a compacted version of it whose initial
+ * snapshot is 'snapshot_size' bytes long. */
+static void
+ovsdb_file_replace_log(struct ovsdb_file *file, struct ovsdb_log *new_log,
+                       off_t snapshot_size)
+{
+    ovsdb_log_close(file->log);
+    file->log = new_log;
+    if (file->group_commit_msec >= 0) {
+        ovsdb_log_enable_async_commit(new_log, file->group_commit_msec);
+        file->log_seqno_base = file->db->commit_seqno;
+    }
+    file->oldest_commit = time_msec();
+    file->next_compact = file->oldest_commit;
+    file->n_transactions = 1;
+    file->snapshot_size = snapshot_size;
+}
+
+/* Compacts 'file' synchronously: that is, writes a snapshot of its database to
+ * a new file and replaces the original by it before returning.  Abandons any
+ * compaction in progress in the background. */
 struct ovsdb_error *
 ovsdb_file_compact(struct ovsdb_file *file)
 {
@@ -627,13 +768,10 @@ ovsdb_file_compact(struct ovsdb_file *file)
     struct ovsdb_error *error;
     char *tmp_name = NULL;
     char *comment = NULL;
-    int retval;
 
-    comment = xasprintf("compacting database online "
-                        "(%.3f seconds old, %u transactions, %llu bytes)",
-                        (time_msec() - file->oldest_commit) / 1000.0,
-                        file->n_transactions,
-                        (unsigned long long) ovsdb_log_get_offset(file->log));
+    ovsdb_file_abort_compaction(file);
+
+    comment = ovsdb_file_compaction_comment(file);
     VLOG_INFO("%s: %s", file->file_name, comment);
 
     /* Commit the old version, so that we can be assured that we'll eventually
@@ -642,23 +780,22 @@ ovsdb_file_compact(struct ovsdb_file *file)
     if (error) {
         goto exit;
     }
-
-    /* Lock temporary file. */
-    tmp_name = xasprintf("%s.tmp", file->file_name);
-    retval = lockfile_lock(tmp_name, 0, &tmp_lock);
-    if (retval) {
-        error = ovsdb_io_error(retval, "could not get lock on %s", tmp_name);
-        goto exit;
+    if (file->group_commit_msec >= 0) {
+        /* Every transaction written to the old log is durable now.  Let
+         * ovsdb_file_run() report it, as it does for other durable
+         * commits. */
+        file->compacted_seqno = file->db->commit_seqno;
     }
 
-    /* Remove temporary file.  (It might not exist.) */
-    if (unlink(tmp_name) < 0 && errno != ENOENT) {
-        error = ovsdb_io_error(errno, "failed to remove %s", tmp_name);
+    tmp_name = xasprintf("%s.tmp", file->file_name);
+    error = ovsdb_file_prepare_tmp(tmp_name, &tmp_lock);
+    if (error) {
         goto exit;
     }
 
     /* Save a copy. */
     error = ovsdb_file_save_copy__(tmp_name, false, comment, file->db,
+                                   ovsdb_log_get_format(file->log),
                                    &new_log);
     if (error) {
         goto exit;
@@ -674,11 +811,7 @@ ovsdb_file_compact(struct ovsdb_file *file)
 
 exit:
     if (!error) {
-        ovsdb_log_close(file->log);
-        file->log = new_log;
-        file->oldest_commit = time_msec();
-        file->next_compact = file->oldest_commit + COMPACT_MIN_MSEC;
-        file->n_transactions = 1;
+        ovsdb_file_replace_log(file, new_log, ovsdb_log_get_offset(new_log));
     } else {
         ovsdb_log_close(new_log);
         if (tmp_lock) {
@@ -693,11 +826,312 @@ exit:
     return error;
 }
 
+/* Logs 'error', which occurred compacting 'file', and destroys it.  Arranges
+ * not to try again for a while. */
+static void
+ovsdb_file_compaction_failed(struct ovsdb_file *file,
+                             struct ovsdb_error *error)
+{
+    char *s = ovsdb_error_to_string(error);
+    ovsdb_error_destroy(error);
+    VLOG_WARN("%s: compacting database failed (%s), retrying in "
+              "%d seconds", file->file_name, s, COMPACT_RETRY_MSEC / 1000);
+    free(s);
+
+    file->next_compact = time_msec() + COMPACT_RETRY_MSEC;
+}
+
+/* Starts compacting 'file' in a child process, which writes a snapshot of the
+ * database to a temporary file while the parent continues to commit
+ * transactions.  ovsdb_file_run() finishes the job when the child exits. */
+static void
+ovsdb_file_start_compaction(struct ovsdb_file *file)
+{
+    struct ovsdb_file_compactor *c;
+    struct ovsdb_error *error;
+    struct process *process;
+    char *comment;
+    int retval;
+
+    c = xzalloc(sizeof *c);
+    c->tmp_name = xasprintf("%s.tmp", file->file_name);
+    error = ovsdb_file_prepare_tmp(c->tmp_name, &c->tmp_lock);
+    if (error) {
+        goto error;
+    }
+
+    comment = ovsdb_file_compaction_comment(file);
+    VLOG_INFO("%s: %s in the background", file->file_name, comment);
+
+    retval = process_fork("ovsdb-compact", &process);
+    if (retval) {
+        free(comment);
+        error = ovsdb_io_error(retval, "could not fork compaction process");
+        goto error;
+    } else if (!process) {
+        /* Running in child process.  The fork() gave it a copy-on-write
+         * snapshot of the database to save. */
+        error = ovsdb_file_save_copy(c->tmp_name, false, comment, file->db,
+                                     ovsdb_log_get_format(file->log));
+        if (error) {
+            char *s = ovsdb_error_to_string(error);
+            VLOG_ERR("%s", s);
+            free(s);
+            _exit(EXIT_FAILURE);
+        }
+        _exit(EXIT_SUCCESS);
+    }
+
+    /* Running in parent process. */
+    free(comment);
+    c->process = process;
+    file->compactor = c;
+    return;
+
+error:
+    lockfile_unlock(c->tmp_lock);
+    free(c->tmp_name);
+    free(c);
+    ovsdb_file_compaction_failed(file, error);
+}
+
+static void
+ovsdb_file_compactor_destroy(struct ovsdb_file *file)
+{
+    struct ovsdb_file_compactor *c = file->compactor;
+    size_t i;
+
+    lockfile_unlock(c->tmp_lock);
+    free(c->tmp_name);
+    for (i = 0; i < c->n_txns; i++) {
+        json_destroy(c->txns[i]);
+    }
+    free(c->txns);
+    process_destroy(c->process);
+    free(c);
+
+    file->compactor = NULL;
+}
+
+/* Appends the transactions committed since the background compaction of
+ * 'file' started to the snapshot that the child process wrote, then replaces
+ * the original file by the result. */
+static void
+ovsdb_file_finish_compaction(struct ovsdb_file *file)
+{
+    struct ovsdb_file_compactor *c = file->compactor;
+    struct ovsdb_log *new_log = NULL;
+    struct ovsdb_error *error;
+    off_t snapshot_size = 0;
+    int status;
+    size_t i;
+
+    status = process_status(c->process);
+    if (!WIFEXITED(status) || WEXITSTATUS(status)) {
+        char *msg = process_status_msg(status);
+        error = ovsdb_error(NULL, "compaction process %s", msg);
+        free(msg);
+        goto exit;
+    }
+
+    error = ovsdb_log_open(c->tmp_name, OVSDB_LOG_READ_WRITE, false,
+                           &new_log);
+    if (!error) {
+        error = ovsdb_log_seek_end(new_log);
+    }
+    if (error) {
+        goto exit;
+    }
+    snapshot_size = ovsdb_log_get_offset(new_log);
+
+    for (i = 0; i < c->n_txns; i++) {
+        error = ovsdb_log_write(new_log, c->txns[i]);
+        if (error) {
+            goto exit;
+        }
+    }
+    error = ovsdb_log_commit(new_log);
+    if (error) {
+        goto exit;
+    }
+
+    /* Replace original by temporary. */
+    if (rename(c->tmp_name, file->file_name)) {
+        error = ovsdb_io_error(errno, "failed to rename \"%s\" to \"%s\"",
+                               c->tmp_name, file->file_name);
+        goto exit;
+    }
+    fsync_parent_dir(file->file_name);
+
+exit:
+    if (!error) {
+        VLOG_INFO("%s: compacted database in the background (%zu "
+                  "transactions committed meanwhile)",
+                  file->file_name, c->n_txns);
+        if (file->group_commit_msec >= 0) {
+            /* Every transaction is in the new log, which is durable now. */
+            ovsdb_trigger_commit_done(file->db, file->db->commit_seqno, NULL);
+        }
+        ovsdb_file_replace_log(file, new_log, snapshot_size);
+        file->n_transactions += c->n_txns;
+    } else {
+        ovsdb_log_close(new_log);
+        unlink(c->tmp_name);
+        ovsdb_file_compaction_failed(file, error);
+    }
+    ovsdb_file_compactor_destroy(file);
+}
+
+/* Kills the child process compacting 'file' in the background, if any, and
+ * discards its work. */
+static void
+ovsdb_file_abort_compaction(struct ovsdb_file *file)
+{
+    struct ovsdb_file_compactor *c = file->compactor;
+
+    if (c) {
+        process_kill(c->process, SIGKILL);
+        while (!process_exited(c->process)) {
+            process_wait(c->process);
+            poll_block();
+        }
+        unlink(c->tmp_name);
+        ovsdb_file_compactor_destroy(file);
+    }
+}
+
+/* Configures when 'file' is compacted automatically: once its log is at least
+ * 'ratio' times as large as the snapshot of the database that it started
+ * with, and at least 'min_size' bytes long.  A negative 'ratio' or 'min_size'
+ * leaves that threshold unchanged.  Automatic compaction runs in a child
+ * process, so that it does not delay other work. */
+void
+ovsdb_file_set_compaction(struct ovsdb_file *file, double ratio,
+                          off_t min_size)
+{
+    if (ratio >= 0) {
+        file->compact_ratio = ratio;
+    }
+    if (min_size >= 0) {
+        file->compact_min_size = min_size;
+    }
+}
+
+/* Enables group commit for 'file': instead of fsync()ing the log for each
+ * durable transaction before replying to it, a helper thread fsync()s on
+ * behalf of every durable transaction that commits while an fsync() is in
+ * progress or within 'window_msec' milliseconds of the first one, and the
+ * replies to those transactions are held until ovsdb_file_run() sees that
+ * fsync() complete.
+ *
+ * Group commit cannot be disabled once it has been enabled. */
+void
+ovsdb_file_set_group_commit(struct ovsdb_file *file, int window_msec)
+{
+    if (file->group_commit_msec < 0) {
+        file->group_commit_msec = MAX(window_msec, 0);
+        file->log_seqno_base = file->db->commit_seqno;
+        ovsdb_log_enable_async_commit(file->log, file->group_commit_msec);
+    }
+}
+
+static int
+group_commit_bucket(unsigned long long int value)
+{
+    int bucket = 0;
+
+    while (value && bucket < GROUP_COMMIT_N_BUCKETS - 1) {
+        value >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+/* Completes transactions that group commit has made durable in 'file' and
+ * finishes background compaction of 'file' once its child process exits. */
+void
+ovsdb_file_run(struct ovsdb_file *file)
+{
+    struct ovsdb_log_sync sync;
+
+    if (file->compactor && process_exited(file->compactor->process)) {
+        ovsdb_file_finish_compaction(file);
+    }
+    if (file->compacted_seqno > file->db->durable_seqno) {
+        ovsdb_trigger_commit_done(file->db, file->compacted_seqno, NULL);
+    }
+
+    while (ovsdb_log_poll_async_commit(file->log, &sync)) {
+        file->n_syncs++;
+        file->n_synced += sync.n_commits;
+        file->fsync_hist[group_commit_bucket(sync.fsync_usec / 1000)]++;
+        file->batch_hist[group_commit_bucket(sync.n_commits)]++;
+
+        if (sync.error) {
+            char *s = ovsdb_error_to_string(sync.error);
+            VLOG_ERR("%s: committing %u transaction(s) failed (%s)",
+                     file->file_name, sync.n_commits, s);
+            free(s);
+        }
+        ovsdb_trigger_commit_done(file->db, file->log_seqno_base + sync.ticket,
+                                  sync.error);
+        ovsdb_error_destroy(sync.error);
+    }
+}
+
+void
+ovsdb_file_wait(struct ovsdb_file *file)
+{
+    ovsdb_log_wait_async_commit(file->log);
+    if (file->compactor) {
+        process_wait(file->compactor->process);
+    }
+    if (file->compacted_seqno > file->db->durable_seqno) {
+        poll_immediate_wake();
+    }
+}
+
+static void
+put_group_commit_hist(struct ds *s, const char *title, const char *unit,
+                      const unsigned long long int hist[])
+{
+    int i;
+
+    ds_put_format(s, "%s:\n", title);
+    for (i = 0; i < GROUP_COMMIT_N_BUCKETS; i++) {
+        if (hist[i]) {
+            bool last = i == GROUP_COMMIT_N_BUCKETS - 1;
+
+            ds_put_format(s, "  %s %4u%s: %llu\n",
+                          last ? ">=" : "< ", 1u << (last ? i - 1 : i),
+                          unit, hist[i]);
+        }
+    }
+}
+
+/* Appends a description of 'file''s group commit statistics to 's'. */
+void
+ovsdb_file_get_commit_stats(const struct ovsdb_file *file, struct ds *s)
+{
+    if (file->group_commit_msec < 0) {
+        ds_put_cstr(s, "group commit disabled\n");
+        return;
+    }
+
+    ds_put_format(s, "group commit window: %d ms\n", file->group_commit_msec);
+    ds_put_format(s, "durable commits: %llu requested, %llu completed in "
+                  "%llu fsyncs\n",
+                  file->db->commit_seqno, file->n_synced, file->n_syncs);
+    put_group_commit_hist(s, "fsync latency", " ms", file->fsync_hist);
+    put_group_commit_hist(s, "commits per fsync", "", file->batch_hist);
+}
+
 static void
 ovsdb_file_destroy(struct ovsdb_replica *replica)
 {
     struct ovsdb_file *file = ovsdb_file_cast(replica);
 
+    ovsdb_file_abort_compaction(file);
     ovsdb_log_close(file->log);
     free(file->file_name);
     free(file);
@@ -772,22 +1206,22 @@ ovsdb_file_txn_add_row(struct ovsdb_file_txn *ftxn,
     }
 }
 
+/* Adds 'comment' and the current date to 'json', which must be a JSON object
+ * that represents a transaction, and writes it to 'log'.  If 'durable' is
+ * true, also commits 'log' to disk.  The caller retains ownership of
+ * 'json'. */
 static struct ovsdb_error *
 ovsdb_file_txn_commit(struct json *json, const char *comment,
                       bool durable, struct ovsdb_log *log)
 {
     struct ovsdb_error *error;
 
-    if (!json) {
-        json = json_object_create();
-    }
     if (comment) {
         json_object_put_string(json, "_comment", comment);
     }
     json_object_put(json, "_date", json_integer_create(time_wall()));
 
     error = ovsdb_log_write(log, json);
-    json_destroy(json);
     if (error) {
         return ovsdb_wrap_error(error, "writing transaction failed");
     }
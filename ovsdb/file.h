@@ -20,6 +20,7 @@
 #include "compiler.h"
 #include "log.h"
 
+struct ds;
 struct ovsdb;
 struct ovsdb_file;
 struct ovsdb_schema;
@@ -35,10 +36,18 @@ struct ovsdb_error *ovsdb_file_open_as_schema(const char *file_name,
 
 struct ovsdb_error *ovsdb_file_save_copy(const char *file_name, int locking,
                                          const char *comment,
-                                         const struct ovsdb *)
+                                         const struct ovsdb *,
+                                         enum ovsdb_log_format)
     WARN_UNUSED_RESULT;
 
 struct ovsdb_error *ovsdb_file_compact(struct ovsdb_file *);
+void ovsdb_file_set_compaction(struct ovsdb_file *, double ratio,
+                               off_t min_size);
+
+void ovsdb_file_set_group_commit(struct ovsdb_file *, int window_msec);
+void ovsdb_file_run(struct ovsdb_file *);
+void ovsdb_file_wait(struct ovsdb_file *);
+void ovsdb_file_get_commit_stats(const struct ovsdb_file *, struct ds *);
 
 struct ovsdb_error *ovsdb_file_read_schema(const char *file_name,
                                            struct ovsdb_schema **)
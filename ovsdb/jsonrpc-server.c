@@ -22,11 +22,14 @@
 
 #include "bitmap.h"
 #include "column.h"
+#include "dynamic-string.h"
+#include "hash.h"
 #include "json.h"
 #include "jsonrpc.h"
 #include "ovsdb-error.h"
 #include "ovsdb-parser.h"
 #include "ovsdb.h"
+#include "poll-loop.h"
 #include "reconnect.h"
 #include "row.h"
 #include "stream.h"
@@ -63,13 +66,14 @@ static void ovsdb_jsonrpc_trigger_create(struct ovsdb_jsonrpc_session *,
 static struct ovsdb_jsonrpc_trigger *ovsdb_jsonrpc_trigger_find(
     struct ovsdb_jsonrpc_session *, const struct json *id, size_t hash);
 static void ovsdb_jsonrpc_trigger_complete(struct ovsdb_jsonrpc_trigger *);
+static void ovsdb_jsonrpc_trigger_cancel(struct ovsdb_jsonrpc_trigger *);
 static void ovsdb_jsonrpc_trigger_complete_all(struct ovsdb_jsonrpc_session *);
 static void ovsdb_jsonrpc_trigger_complete_done(
     struct ovsdb_jsonrpc_session *);
 
 /* Monitors. */
-static struct json *ovsdb_jsonrpc_monitor_create(
-    struct ovsdb_jsonrpc_session *, struct json *params);
+static struct jsonrpc_msg *ovsdb_jsonrpc_monitor_create(
+    struct ovsdb_jsonrpc_session *, struct jsonrpc_msg *request);
 static struct jsonrpc_msg *ovsdb_jsonrpc_monitor_cancel(
     struct ovsdb_jsonrpc_session *,
     struct json_array *params,
@@ -82,6 +86,9 @@ struct ovsdb_jsonrpc_server {
     struct ovsdb *db;
     unsigned int n_sessions, max_sessions;
     struct shash remotes;      /* Contains "struct ovsdb_jsonrpc_remote *"s. */
+
+    /* Contains "struct ovsdb_jsonrpc_shared_monitor"s. */
+    struct hmap shared_monitors;
 };
 
 /* A configured remote.  This is either a passive stream listener plus a list
@@ -104,6 +111,7 @@ ovsdb_jsonrpc_server_create(struct ovsdb *db)
     server->db = db;
     server->max_sessions = 64;
     shash_init(&server->remotes);
+    hmap_init(&server->shared_monitors);
     return server;
 }
 
@@ -116,6 +124,7 @@ ovsdb_jsonrpc_server_destroy(struct ovsdb_jsonrpc_server *svr)
         ovsdb_jsonrpc_server_del_remote(node);
     }
     shash_destroy(&svr->remotes);
+    hmap_destroy(&svr->shared_monitors);
     free(svr);
 }
 
@@ -387,6 +396,11 @@ ovsdb_jsonrpc_session_wait(struct ovsdb_jsonrpc_session *s)
     if (!jsonrpc_session_get_backlog(s->js)) {
         jsonrpc_session_recv_wait(s->js);
     }
+    if (!list_is_empty(&s->completions)) {
+        /* Triggers completed after ovsdb_jsonrpc_session_run(), e.g. by
+         * ovsdb_trigger_commit_done().  Send their replies promptly. */
+        poll_immediate_wake();
+    }
 }
 
 static void
@@ -545,8 +559,7 @@ ovsdb_jsonrpc_session_got_request(struct ovsdb_jsonrpc_session *s,
     } else if (!strcmp(request->method, "monitor")) {
         reply = ovsdb_jsonrpc_check_db_name(s, request);
         if (!reply) {
-            reply = jsonrpc_create_reply(
-                ovsdb_jsonrpc_monitor_create(s, request->params), request->id);
+            reply = ovsdb_jsonrpc_monitor_create(s, request);
         }
     } else if (!strcmp(request->method, "monitor_cancel")) {
         reply = ovsdb_jsonrpc_monitor_cancel(s, json_array(request->params),
@@ -585,7 +598,7 @@ execute_cancel(struct ovsdb_jsonrpc_session *s, struct jsonrpc_msg *request)
         id = request->params->u.array.elems[0];
         t = ovsdb_jsonrpc_trigger_find(s, id, json_hash(id, 0));
         if (t) {
-            ovsdb_jsonrpc_trigger_complete(t);
+            ovsdb_jsonrpc_trigger_cancel(t);
         }
     }
 }
@@ -688,6 +701,16 @@ ovsdb_jsonrpc_trigger_complete(struct ovsdb_jsonrpc_trigger *t)
     free(t);
 }
 
+static void
+ovsdb_jsonrpc_trigger_cancel(struct ovsdb_jsonrpc_trigger *t)
+{
+    /* A transaction that has committed cannot be canceled.  Its reply will be
+     * sent when the commit becomes durable. */
+    if (!ovsdb_trigger_is_committing(&t->trigger)) {
+        ovsdb_jsonrpc_trigger_complete(t);
+    }
+}
+
 static void
 ovsdb_jsonrpc_trigger_complete_all(struct ovsdb_jsonrpc_session *s)
 {
@@ -736,23 +759,93 @@ struct ovsdb_jsonrpc_monitor_table {
     size_t n_columns;
 };
 
-/* A collection of tables being monitored. */
-struct ovsdb_jsonrpc_monitor {
+/* A collection of tables being monitored.
+ *
+ * Monitors on any number of sessions that request exactly the same tables,
+ * columns, and selections share one of these.  It is the replica that the
+ * database notifies of each transaction, so each transaction is converted to
+ * JSON and serialized only once for all of those monitors. */
+struct ovsdb_jsonrpc_shared_monitor {
     struct ovsdb_replica replica;
+    struct ovsdb_jsonrpc_server *server;
+    struct hmap_node node;      /* In server's "shared_monitors". */
+    char *spec;                 /* Canonical form of 'tables', for matching. */
+
+    struct shash tables;     /* Holds "struct ovsdb_jsonrpc_monitor_table"s. */
+    struct list monitors;    /* Holds "struct ovsdb_jsonrpc_monitor"s. */
+
+    /* Statistics. */
+    unsigned long long int n_commits;  /* Transactions examined. */
+    unsigned long long int n_updates;  /* Transactions that yielded updates. */
+    unsigned long long int n_sends;    /* Updates sent to sessions. */
+    unsigned long long int n_bytes;    /* Bytes serialized for updates. */
+    unsigned long long int usec;       /* Time spent on transactions. */
+};
+
+/* A monitor on a particular session. */
+struct ovsdb_jsonrpc_monitor {
     struct ovsdb_jsonrpc_session *session;
     struct hmap_node node;      /* In ovsdb_jsonrpc_session's "monitors". */
-
     struct json *monitor_id;
-    struct shash tables;     /* Holds "struct ovsdb_jsonrpc_monitor_table"s. */
+
+    struct ovsdb_jsonrpc_shared_monitor *shared;
+    struct list shared_node;    /* In 'shared''s "monitors". */
+
+    /* Initial contents still being sent, if any. */
+    struct ovsdb_jsonrpc_monitor_dump *dump;
+};
+
+/* The initial contents of a monitor's tables, which are sent as the result of
+ * the "monitor" request that created it.  Instead of converting the whole
+ * result to JSON up front, which for a large database can take several times
+ * the database's size in memory, this records the UUIDs of the rows to send
+ * and then serializes the rows a piece at a time as the session's connection
+ * drains (see jsonrpc_send_reply_generated()).
+ *
+ * The result must reflect the database as it was when the monitor was created,
+ * since "update" notifications for later transactions follow it.  Thus, when a
+ * transaction modifies or deletes a row that has not been sent yet,
+ * ovsdb_jsonrpc_monitor_commit() serializes the row's old contents right
+ * away, into the table's 'early' buffer. */
+struct ovsdb_jsonrpc_monitor_dump {
+    struct jsonrpc_generator up;
+    struct ovsdb_jsonrpc_monitor *monitor; /* Null if monitor destroyed. */
+
+    struct ovsdb_jsonrpc_dump_table *tables;
+    size_t n_tables;
+    size_t cur_table;           /* Index in 'tables' of table being sent. */
+    size_t n_opened;            /* Number of tables output so far. */
+    bool started;               /* Output the initial "{"? */
+};
+
+/* A table in an ovsdb_jsonrpc_monitor_dump. */
+struct ovsdb_jsonrpc_dump_table {
+    const struct ovsdb_jsonrpc_monitor_table *mt;
+    struct ovsdb_jsonrpc_dump_row *rows; /* Rows to send, in order. */
+    size_t n_rows;
+    size_t next_row;            /* Index in 'rows' of next row to send. */
+    struct hmap unsent;         /* Rows not yet sent, hashed on UUID. */
+    struct ds early;            /* Rows serialized early, separated by ",". */
+    bool opened;                /* Output the table's name? */
+};
+
+/* A row in an ovsdb_jsonrpc_dump_table. */
+struct ovsdb_jsonrpc_dump_row {
+    struct hmap_node hmap_node; /* In ovsdb_jsonrpc_dump_table's 'unsent'. */
+    struct uuid uuid;
+    bool sent;
 };
 
 static const struct ovsdb_replica_class ovsdb_jsonrpc_replica_class;
+static const struct jsonrpc_generator_class ovsdb_jsonrpc_monitor_dump_class;
 
 struct ovsdb_jsonrpc_monitor *ovsdb_jsonrpc_monitor_find(
     struct ovsdb_jsonrpc_session *, const struct json *monitor_id);
-static void ovsdb_jsonrpc_monitor_destroy(struct ovsdb_replica *);
-static struct json *ovsdb_jsonrpc_monitor_get_initial(
-    const struct ovsdb_jsonrpc_monitor *);
+static void ovsdb_jsonrpc_monitor_destroy(struct ovsdb_jsonrpc_monitor *);
+static struct ovsdb_jsonrpc_monitor_dump *ovsdb_jsonrpc_monitor_dump_create(
+    struct ovsdb_jsonrpc_monitor *);
+static void ovsdb_jsonrpc_monitor_dump_note_txn(
+    struct ovsdb_jsonrpc_monitor_dump *, const struct ovsdb_txn *);
 
 static bool
 parse_bool(struct ovsdb_parser *parser, const char *name, bool default_value)
@@ -890,16 +983,95 @@ ovsdb_jsonrpc_parse_monitor_request(struct ovsdb_jsonrpc_monitor_table *mt,
     return NULL;
 }
 
-static struct json *
+static void
+ovsdb_jsonrpc_monitor_tables_destroy(struct shash *tables)
+{
+    struct shash_node *node;
+
+    SHASH_FOR_EACH (node, tables) {
+        struct ovsdb_jsonrpc_monitor_table *mt = node->data;
+        free(mt->columns);
+        free(mt);
+    }
+    shash_destroy(tables);
+}
+
+/* Returns a string that describes exactly what 'tables' monitors, so that two
+ * sets of tables that monitor the same things yield the same string.  The
+ * caller must free the string. */
+static char *
+ovsdb_jsonrpc_monitor_tables_to_spec(const struct shash *tables)
+{
+    const struct shash_node **nodes;
+    struct ds ds;
+    size_t i, j;
+
+    ds_init(&ds);
+    nodes = shash_sort(tables);
+    for (i = 0; i < shash_count(tables); i++) {
+        const struct ovsdb_jsonrpc_monitor_table *mt = nodes[i]->data;
+
+        ds_put_format(&ds, "%s:%x[", nodes[i]->name, mt->select);
+        for (j = 0; j < mt->n_columns; j++) {
+            const struct ovsdb_jsonrpc_monitor_column *c = &mt->columns[j];
+            ds_put_format(&ds, "%s:%x,", c->column->name, c->select);
+        }
+        ds_put_char(&ds, ']');
+    }
+    free(nodes);
+
+    return ds_steal_cstr(&ds);
+}
+
+/* Returns the shared monitor in 'server' for 'tables', creating it if
+ * necessary.  Takes ownership of the contents of 'tables'. */
+static struct ovsdb_jsonrpc_shared_monitor *
+ovsdb_jsonrpc_shared_monitor_get(struct ovsdb_jsonrpc_server *server,
+                                 struct shash *tables)
+{
+    struct ovsdb_jsonrpc_shared_monitor *shared;
+    char *spec;
+    size_t hash;
+
+    spec = ovsdb_jsonrpc_monitor_tables_to_spec(tables);
+    hash = hash_string(spec, 0);
+    HMAP_FOR_EACH_WITH_HASH (shared, node, hash, &server->shared_monitors) {
+        if (!strcmp(shared->spec, spec)) {
+            free(spec);
+            ovsdb_jsonrpc_monitor_tables_destroy(tables);
+            return shared;
+        }
+    }
+
+    shared = xzalloc(sizeof *shared);
+    ovsdb_replica_init(&shared->replica, &ovsdb_jsonrpc_replica_class);
+    ovsdb_add_replica(server->db, &shared->replica);
+    shared->server = server;
+    hmap_insert(&server->shared_monitors, &shared->node, hash);
+    shared->spec = spec;
+    shash_swap(&shared->tables, tables);
+    shash_destroy(tables);
+    list_init(&shared->monitors);
+    return shared;
+}
+
+/* Creates the monitor that 'request' describes and starts sending its initial
+ * contents as the reply to 'request'.  Returns a null pointer if successful,
+ * taking ownership of 'request', or an error reply to send otherwise. */
+static struct jsonrpc_msg *
 ovsdb_jsonrpc_monitor_create(struct ovsdb_jsonrpc_session *s,
-                             struct json *params)
+                             struct jsonrpc_msg *request)
 {
-    struct ovsdb_jsonrpc_monitor *m = NULL;
+    struct ovsdb_jsonrpc_shared_monitor *shared;
+    struct ovsdb_jsonrpc_monitor *m;
     struct json *monitor_id, *monitor_requests;
     struct ovsdb_error *error = NULL;
+    struct json *params = request->params;
     struct shash_node *node;
+    struct shash tables;
     struct json *json;
 
+    shash_init(&tables);
     if (json_array(params)->n != 3) {
         error = ovsdb_syntax_error(params, NULL, "invalid parameters");
         goto error;
@@ -917,14 +1089,6 @@ ovsdb_jsonrpc_monitor_create(struct ovsdb_jsonrpc_session *s,
         goto error;
     }
 
-    m = xzalloc(sizeof *m);
-    ovsdb_replica_init(&m->replica, &ovsdb_jsonrpc_replica_class);
-    ovsdb_add_replica(s->remote->server->db, &m->replica);
-    m->session = s;
-    hmap_insert(&s->monitors, &m->node, json_hash(monitor_id, 0));
-    m->monitor_id = json_clone(monitor_id);
-    shash_init(&m->tables);
-
     SHASH_FOR_EACH (node, json_object(monitor_requests)) {
         const struct ovsdb_table *table;
         struct ovsdb_jsonrpc_monitor_table *mt;
@@ -941,7 +1105,7 @@ ovsdb_jsonrpc_monitor_create(struct ovsdb_jsonrpc_session *s,
 
         mt = xzalloc(sizeof *mt);
         mt->table = table;
-        shash_add(&m->tables, table->schema->name, mt);
+        shash_add(&tables, table->schema->name, mt);
 
         /* Parse columns. */
         mr_value = node->data;
@@ -977,16 +1141,26 @@ ovsdb_jsonrpc_monitor_create(struct ovsdb_jsonrpc_session *s,
         }
     }
 
-    return ovsdb_jsonrpc_monitor_get_initial(m);
+    shared = ovsdb_jsonrpc_shared_monitor_get(s->remote->server, &tables);
+
+    m = xzalloc(sizeof *m);
+    m->session = s;
+    hmap_insert(&s->monitors, &m->node, json_hash(monitor_id, 0));
+    m->monitor_id = json_clone(monitor_id);
+    m->shared = shared;
+    list_push_back(&shared->monitors, &m->shared_node);
+
+    m->dump = ovsdb_jsonrpc_monitor_dump_create(m);
+    jsonrpc_session_send_reply_generated(s->js, request->id, &m->dump->up);
+    jsonrpc_msg_destroy(request);
+    return NULL;
 
 error:
-    if (m) {
-        ovsdb_remove_replica(s->remote->server->db, &m->replica);
-    }
+    ovsdb_jsonrpc_monitor_tables_destroy(&tables);
 
     json = ovsdb_error_to_json(error);
     ovsdb_error_destroy(error);
-    return json;
+    return jsonrpc_create_reply(json, request->id);
 }
 
 static struct jsonrpc_msg *
@@ -1005,7 +1179,7 @@ ovsdb_jsonrpc_monitor_cancel(struct ovsdb_jsonrpc_session *s,
             return jsonrpc_create_error(json_string_create("unknown monitor"),
                                         request_id);
         } else {
-            ovsdb_remove_replica(s->remote->server->db, &m->replica);
+            ovsdb_jsonrpc_monitor_destroy(m);
             return jsonrpc_create_reply(json_object_create(), request_id);
         }
     }
@@ -1017,20 +1191,19 @@ ovsdb_jsonrpc_monitor_remove_all(struct ovsdb_jsonrpc_session *s)
     struct ovsdb_jsonrpc_monitor *m, *next;
 
     HMAP_FOR_EACH_SAFE (m, next, node, &s->monitors) {
-        ovsdb_remove_replica(s->remote->server->db, &m->replica);
+        ovsdb_jsonrpc_monitor_destroy(m);
     }
 }
 
-static struct ovsdb_jsonrpc_monitor *
-ovsdb_jsonrpc_monitor_cast(struct ovsdb_replica *replica)
+static struct ovsdb_jsonrpc_shared_monitor *
+ovsdb_jsonrpc_shared_monitor_cast(struct ovsdb_replica *replica)
 {
     assert(replica->class == &ovsdb_jsonrpc_replica_class);
-    return CONTAINER_OF(replica, struct ovsdb_jsonrpc_monitor, replica);
+    return CONTAINER_OF(replica, struct ovsdb_jsonrpc_shared_monitor, replica);
 }
 
 struct ovsdb_jsonrpc_monitor_aux {
-    bool initial;               /* Sending initial contents of table? */
-    const struct ovsdb_jsonrpc_monitor *monitor;
+    const struct ovsdb_jsonrpc_shared_monitor *monitor;
     struct json *json;          /* JSON for the whole transaction. */
 
     /* Current table.  */
@@ -1063,7 +1236,7 @@ ovsdb_jsonrpc_monitor_change_cb(const struct ovsdb_row *old,
                                 void *aux_)
 {
     struct ovsdb_jsonrpc_monitor_aux *aux = aux_;
-    const struct ovsdb_jsonrpc_monitor *m = aux->monitor;
+    const struct ovsdb_jsonrpc_shared_monitor *m = aux->monitor;
     struct ovsdb_table *table = new ? new->table : old->table;
     enum ovsdb_jsonrpc_monitor_selection type;
     struct json *old_json, *new_json;
@@ -1081,8 +1254,7 @@ ovsdb_jsonrpc_monitor_change_cb(const struct ovsdb_row *old,
         }
     }
 
-    type = (aux->initial ? OJMS_INITIAL
-            : !old ? OJMS_INSERT
+    type = (!old ? OJMS_INSERT
             : !new ? OJMS_DELETE
             : OJMS_MODIFY);
     if (!(aux->mt->select & type)) {
@@ -1100,7 +1272,7 @@ ovsdb_jsonrpc_monitor_change_cb(const struct ovsdb_row *old,
     if (type & (OJMS_DELETE | OJMS_MODIFY)) {
         old_json = json_object_create();
     }
-    if (type & (OJMS_INITIAL | OJMS_INSERT | OJMS_MODIFY)) {
+    if (type & (OJMS_INSERT | OJMS_MODIFY)) {
         new_json = json_object_create();
     }
     for (i = 0; i < aux->mt->n_columns; i++) {
@@ -1120,7 +1292,7 @@ ovsdb_jsonrpc_monitor_change_cb(const struct ovsdb_row *old,
                             ovsdb_datum_to_json(&old->fields[idx],
                                                 &column->type));
         }
-        if (type & (OJMS_INITIAL | OJMS_INSERT | OJMS_MODIFY)) {
+        if (type & (OJMS_INSERT | OJMS_MODIFY)) {
             json_object_put(new_json, column->name,
                             ovsdb_datum_to_json(&new->fields[idx],
                                                 &column->type));
@@ -1158,78 +1330,392 @@ ovsdb_jsonrpc_monitor_change_cb(const struct ovsdb_row *old,
 
 static void
 ovsdb_jsonrpc_monitor_init_aux(struct ovsdb_jsonrpc_monitor_aux *aux,
-                               const struct ovsdb_jsonrpc_monitor *m,
-                               bool initial)
+                               const struct ovsdb_jsonrpc_shared_monitor *m)
 {
-    aux->initial = initial;
     aux->monitor = m;
     aux->json = NULL;
     aux->mt = NULL;
     aux->table_json = NULL;
 }
 
+/* Converts the changes in 'txn' that concern 'replica' to JSON once, then
+ * sends the serialized result as an "update" notification to every monitor
+ * that shares 'replica'. */
 static struct ovsdb_error *
 ovsdb_jsonrpc_monitor_commit(struct ovsdb_replica *replica,
                              const struct ovsdb_txn *txn,
                              bool durable OVS_UNUSED)
 {
-    struct ovsdb_jsonrpc_monitor *m = ovsdb_jsonrpc_monitor_cast(replica);
+    struct ovsdb_jsonrpc_shared_monitor *shared;
     struct ovsdb_jsonrpc_monitor_aux aux;
+    struct ovsdb_jsonrpc_monitor *m;
+    struct timeval start, end;
 
-    ovsdb_jsonrpc_monitor_init_aux(&aux, m, false);
+    shared = ovsdb_jsonrpc_shared_monitor_cast(replica);
+    xgettimeofday(&start);
+
+    ovsdb_jsonrpc_monitor_init_aux(&aux, shared);
     ovsdb_txn_for_each_change(txn, ovsdb_jsonrpc_monitor_change_cb, &aux);
     if (aux.json) {
-        struct jsonrpc_msg *msg;
-        struct json *params;
+        struct jsonrpc_shared *update;
+
+        update = jsonrpc_shared_create(aux.json);
+        json_destroy(aux.json);
 
-        params = json_array_create_2(json_clone(aux.monitor->monitor_id),
-                                     aux.json);
-        msg = jsonrpc_create_notify("update", params);
-        jsonrpc_session_send(aux.monitor->session->js, msg);
+        LIST_FOR_EACH (m, shared_node, &shared->monitors) {
+            jsonrpc_session_send_notify_shared(
+                m->session->js, "update",
+                json_array_create_1(json_clone(m->monitor_id)), update);
+            shared->n_sends++;
+        }
+        shared->n_updates++;
+        shared->n_bytes += jsonrpc_shared_size(update);
+        jsonrpc_shared_unref(update);
+    }
+
+    /* A monitor whose initial contents are still being sent must send the old
+     * versions of the rows that 'txn' changes, since any "update" for 'txn'
+     * follows the initial contents. */
+    LIST_FOR_EACH (m, shared_node, &shared->monitors) {
+        if (m->dump) {
+            ovsdb_jsonrpc_monitor_dump_note_txn(m->dump, txn);
+        }
     }
 
+    xgettimeofday(&end);
+    shared->n_commits++;
+    shared->usec += ((end.tv_sec - start.tv_sec) * 1000000LL
+                     + (end.tv_usec - start.tv_usec));
+
     return NULL;
 }
 
-static struct json *
-ovsdb_jsonrpc_monitor_get_initial(const struct ovsdb_jsonrpc_monitor *m)
+static struct ovsdb_jsonrpc_monitor_dump *
+ovsdb_jsonrpc_monitor_dump_cast(struct jsonrpc_generator *generator)
 {
-    struct ovsdb_jsonrpc_monitor_aux aux;
+    assert(generator->class == &ovsdb_jsonrpc_monitor_dump_class);
+    return CONTAINER_OF(generator, struct ovsdb_jsonrpc_monitor_dump, up);
+}
+
+/* Creates and returns a dump of the rows currently in the tables that 'm'
+ * monitors for their initial contents. */
+static struct ovsdb_jsonrpc_monitor_dump *
+ovsdb_jsonrpc_monitor_dump_create(struct ovsdb_jsonrpc_monitor *m)
+{
+    struct ovsdb_jsonrpc_monitor_dump *dump;
     struct shash_node *node;
 
-    ovsdb_jsonrpc_monitor_init_aux(&aux, m, true);
-    SHASH_FOR_EACH (node, &m->tables) {
-        struct ovsdb_jsonrpc_monitor_table *mt = node->data;
+    dump = xzalloc(sizeof *dump);
+    dump->up.class = &ovsdb_jsonrpc_monitor_dump_class;
+    dump->monitor = m;
+    dump->tables = xmalloc(shash_count(&m->shared->tables)
+                           * sizeof *dump->tables);
+    SHASH_FOR_EACH (node, &m->shared->tables) {
+        const struct ovsdb_jsonrpc_monitor_table *mt = node->data;
+        size_t n_rows = hmap_count(&mt->table->rows);
+        struct ovsdb_jsonrpc_dump_table *dt;
+        const struct ovsdb_row *row;
+
+        if (!(mt->select & OJMS_INITIAL) || !n_rows) {
+            continue;
+        }
+
+        dt = &dump->tables[dump->n_tables++];
+        dt->mt = mt;
+        dt->rows = xmalloc(n_rows * sizeof *dt->rows);
+        dt->n_rows = 0;
+        dt->next_row = 0;
+        hmap_init(&dt->unsent);
+        hmap_reserve(&dt->unsent, n_rows);
+        ds_init(&dt->early);
+        dt->opened = false;
+
+        HMAP_FOR_EACH (row, hmap_node, &mt->table->rows) {
+            struct ovsdb_jsonrpc_dump_row *dr = &dt->rows[dt->n_rows++];
+
+            dr->uuid = *ovsdb_row_get_uuid(row);
+            dr->sent = false;
+            hmap_insert(&dt->unsent, &dr->hmap_node, uuid_hash(&dr->uuid));
+        }
+    }
+    return dump;
+}
+
+/* Appends 'row' to 'ds' in the form used in the initial contents of a
+ * monitor's table. */
+static void
+ovsdb_jsonrpc_monitor_row_to_ds(const struct ovsdb_jsonrpc_monitor_table *mt,
+                                const struct ovsdb_row *row, struct ds *ds)
+{
+    bool first = true;
+    size_t i;
+
+    ds_put_format(ds, "\""UUID_FMT"\":{\"new\":{",
+                  UUID_ARGS(ovsdb_row_get_uuid(row)));
+    for (i = 0; i < mt->n_columns; i++) {
+        const struct ovsdb_jsonrpc_monitor_column *c = &mt->columns[i];
+        const struct ovsdb_column *column = c->column;
+
+        if (c->select & OJMS_INITIAL) {
+            if (!first) {
+                ds_put_char(ds, ',');
+            }
+            first = false;
+
+            json_string_escape(column->name, ds);
+            ds_put_char(ds, ':');
+            ovsdb_datum_to_json_ds(&row->fields[column->index],
+                                   &column->type, ds);
+        }
+    }
+    ds_put_cstr(ds, "}}");
+}
+
+/* Marks 'dr', in 'dt', as sent. */
+static void
+ovsdb_jsonrpc_dump_row_sent(struct ovsdb_jsonrpc_dump_table *dt,
+                            struct ovsdb_jsonrpc_dump_row *dr)
+{
+    hmap_remove(&dt->unsent, &dr->hmap_node);
+    dr->sent = true;
+}
+
+/* Appends to 'ds' whatever has to precede another row of 'dt'. */
+static void
+ovsdb_jsonrpc_dump_table_next(struct ovsdb_jsonrpc_monitor_dump *dump,
+                              struct ovsdb_jsonrpc_dump_table *dt,
+                              struct ds *ds)
+{
+    if (!dt->opened) {
+        if (dump->n_opened++) {
+            ds_put_char(ds, ',');
+        }
+        json_string_escape(dt->mt->table->schema->name, ds);
+        ds_put_cstr(ds, ":{");
+        dt->opened = true;
+    } else {
+        ds_put_char(ds, ',');
+    }
+}
+
+static bool
+ovsdb_jsonrpc_monitor_dump_generate(struct jsonrpc_generator *generator,
+                                    struct ds *ds, size_t max)
+{
+    struct ovsdb_jsonrpc_monitor_dump *dump;
+
+    dump = ovsdb_jsonrpc_monitor_dump_cast(generator);
+    if (!dump->started) {
+        ds_put_char(ds, '{');
+        dump->started = true;
+    }
+
+    for (; dump->cur_table < dump->n_tables; dump->cur_table++) {
+        struct ovsdb_jsonrpc_dump_table *dt = &dump->tables[dump->cur_table];
 
-        if (mt->select & OJMS_INITIAL) {
-            struct ovsdb_row *row;
+        /* If the monitor has been destroyed, its tables are gone too, so
+         * just finish off the JSON.  The session is going away anyhow. */
+        if (dump->monitor) {
+            const struct ovsdb_table *table = dt->mt->table;
 
-            HMAP_FOR_EACH (row, hmap_node, &mt->table->rows) {
-                ovsdb_jsonrpc_monitor_change_cb(NULL, row, NULL, &aux);
+            if (dt->early.length) {
+                ovsdb_jsonrpc_dump_table_next(dump, dt, ds);
+                ds_put_buffer(ds, dt->early.string, dt->early.length);
+                ds_clear(&dt->early);
+            }
+
+            while (dt->next_row < dt->n_rows) {
+                struct ovsdb_jsonrpc_dump_row *dr = &dt->rows[dt->next_row++];
+
+                if (!dr->sent) {
+                    const struct ovsdb_row *row;
+
+                    /* A row deleted since the dump began would have been
+                     * sent early, so the row must still exist. */
+                    row = ovsdb_table_get_row(table, &dr->uuid);
+                    assert(row != NULL);
+                    ovsdb_jsonrpc_dump_row_sent(dt, dr);
+
+                    ovsdb_jsonrpc_dump_table_next(dump, dt, ds);
+                    ovsdb_jsonrpc_monitor_row_to_ds(dt->mt, row, ds);
+                    if (ds->length >= max) {
+                        return true;
+                    }
+                }
             }
         }
+
+        if (dt->opened) {
+            ds_put_char(ds, '}');
+        }
     }
-    return aux.json ? aux.json : json_object_create();
+
+    ds_put_char(ds, '}');
+    return false;
 }
 
+static bool
+ovsdb_jsonrpc_monitor_dump_change_cb(const struct ovsdb_row *old,
+                                     const struct ovsdb_row *new,
+                                     const unsigned long int *changed
+                                     OVS_UNUSED,
+                                     void *dump_)
+{
+    struct ovsdb_jsonrpc_monitor_dump *dump = dump_;
+    const struct ovsdb_table *table = new ? new->table : old->table;
+    size_t i;
+
+    for (i = dump->cur_table; i < dump->n_tables; i++) {
+        struct ovsdb_jsonrpc_dump_table *dt = &dump->tables[i];
+
+        if (dt->mt->table == table) {
+            struct ovsdb_jsonrpc_dump_row *dr;
+            const struct uuid *uuid;
+
+            if (hmap_is_empty(&dt->unsent)) {
+                break;
+            } else if (!old) {
+                /* Inserted rows are not part of the dump. */
+                return true;
+            }
+
+            uuid = ovsdb_row_get_uuid(old);
+            HMAP_FOR_EACH_WITH_HASH (dr, hmap_node, uuid_hash(uuid),
+                                     &dt->unsent) {
+                if (uuid_equals(&dr->uuid, uuid)) {
+                    ovsdb_jsonrpc_dump_row_sent(dt, dr);
+                    if (dt->early.length) {
+                        ds_put_char(&dt->early, ',');
+                    }
+                    ovsdb_jsonrpc_monitor_row_to_ds(dt->mt, old, &dt->early);
+                    break;
+                }
+            }
+            return true;
+        }
+    }
+
+    /* Nothing left to send for this table.  Tell the caller to skip it. */
+    return false;
+}
+
+/* Serializes the old versions of the rows in 'dump' that 'txn' modifies or
+ * deletes and that have not yet been sent, so that the dump does not reflect
+ * 'txn'. */
 static void
-ovsdb_jsonrpc_monitor_destroy(struct ovsdb_replica *replica)
+ovsdb_jsonrpc_monitor_dump_note_txn(struct ovsdb_jsonrpc_monitor_dump *dump,
+                                    const struct ovsdb_txn *txn)
 {
-    struct ovsdb_jsonrpc_monitor *m = ovsdb_jsonrpc_monitor_cast(replica);
-    struct shash_node *node;
+    ovsdb_txn_for_each_change(txn, ovsdb_jsonrpc_monitor_dump_change_cb, dump);
+}
 
-    json_destroy(m->monitor_id);
-    SHASH_FOR_EACH (node, &m->tables) {
-        struct ovsdb_jsonrpc_monitor_table *mt = node->data;
-        free(mt->columns);
-        free(mt);
+static void
+ovsdb_jsonrpc_monitor_dump_destroy(struct jsonrpc_generator *generator)
+{
+    struct ovsdb_jsonrpc_monitor_dump *dump;
+    size_t i;
+
+    dump = ovsdb_jsonrpc_monitor_dump_cast(generator);
+    if (dump->monitor) {
+        dump->monitor->dump = NULL;
+    }
+    for (i = 0; i < dump->n_tables; i++) {
+        struct ovsdb_jsonrpc_dump_table *dt = &dump->tables[i];
+
+        free(dt->rows);
+        hmap_destroy(&dt->unsent);
+        ds_destroy(&dt->early);
+    }
+    free(dump->tables);
+    free(dump);
+}
+
+static const struct jsonrpc_generator_class ovsdb_jsonrpc_monitor_dump_class = {
+    ovsdb_jsonrpc_monitor_dump_generate,
+    ovsdb_jsonrpc_monitor_dump_destroy
+};
+
+/* Destroys 'm', and the shared monitor that it belonged to if no other monitor
+ * still uses it. */
+static void
+ovsdb_jsonrpc_monitor_destroy(struct ovsdb_jsonrpc_monitor *m)
+{
+    struct ovsdb_jsonrpc_shared_monitor *shared = m->shared;
+
+    if (m->dump) {
+        m->dump->monitor = NULL;
     }
-    shash_destroy(&m->tables);
+    json_destroy(m->monitor_id);
     hmap_remove(&m->session->monitors, &m->node);
+    list_remove(&m->shared_node);
     free(m);
+
+    if (list_is_empty(&shared->monitors)) {
+        ovsdb_remove_replica(shared->server->db, &shared->replica);
+    }
+}
+
+static void
+ovsdb_jsonrpc_shared_monitor_destroy(struct ovsdb_replica *replica)
+{
+    struct ovsdb_jsonrpc_shared_monitor *shared;
+    struct ovsdb_jsonrpc_monitor *m, *next;
+
+    shared = ovsdb_jsonrpc_shared_monitor_cast(replica);
+    LIST_FOR_EACH_SAFE (m, next, shared_node, &shared->monitors) {
+        if (m->dump) {
+            m->dump->monitor = NULL;
+        }
+        json_destroy(m->monitor_id);
+        hmap_remove(&m->session->monitors, &m->node);
+        free(m);
+    }
+    ovsdb_jsonrpc_monitor_tables_destroy(&shared->tables);
+    hmap_remove(&shared->server->shared_monitors, &shared->node);
+    free(shared->spec);
+    free(shared);
 }
 
 static const struct ovsdb_replica_class ovsdb_jsonrpc_replica_class = {
     ovsdb_jsonrpc_monitor_commit,
-    ovsdb_jsonrpc_monitor_destroy
+    ovsdb_jsonrpc_shared_monitor_destroy
 };
+
+/* Appends to 'ds' a description of the monitors in 'svr', including how often
+ * monitors share serialized updates and how much output is queued up for the
+ * sessions that receive them. */
+void
+ovsdb_jsonrpc_server_get_monitor_stats(const struct ovsdb_jsonrpc_server *svr,
+                                       struct ds *ds)
+{
+    const struct ovsdb_jsonrpc_shared_monitor *shared;
+    size_t n_sessions, n_monitors, backlog;
+    struct shash_node *node;
+
+    n_sessions = n_monitors = backlog = 0;
+    SHASH_FOR_EACH (node, &svr->remotes) {
+        struct ovsdb_jsonrpc_remote *remote = node->data;
+        struct ovsdb_jsonrpc_session *s;
+
+        LIST_FOR_EACH (s, node, &remote->sessions) {
+            n_sessions++;
+            n_monitors += hmap_count(&s->monitors);
+            backlog += jsonrpc_session_get_backlog(s->js);
+        }
+    }
+
+    ds_put_format(ds, "sessions: %zu, monitors: %zu, monitor groups: %zu\n",
+                  n_sessions, n_monitors, hmap_count(&svr->shared_monitors));
+    ds_put_format(ds, "backlog: %zu bytes total, %zu bytes per session\n",
+                  backlog, n_sessions ? backlog / n_sessions : 0);
+
+    HMAP_FOR_EACH (shared, node, &svr->shared_monitors) {
+        ds_put_format(ds, "group with %zu monitors: %llu commits, "
+                      "%llu updates, %llu sends, %llu bytes, "
+                      "%llu us/commit\n",
+                      list_size(&shared->monitors),
+                      shared->n_commits, shared->n_updates, shared->n_sends,
+                      shared->n_bytes,
+                      shared->n_commits ? shared->usec / shared->n_commits : 0);
+    }
+}
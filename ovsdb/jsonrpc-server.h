@@ -18,6 +18,7 @@
 
 #include <stdbool.h>
 
+struct ds;
 struct ovsdb;
 struct shash;
 
@@ -47,6 +48,8 @@ void ovsdb_jsonrpc_server_get_remote_status(
     struct shash * /* of 'struct ovsdb_jsonrpc_remote_status' */ );
 
 void ovsdb_jsonrpc_server_reconnect(struct ovsdb_jsonrpc_server *);
+void ovsdb_jsonrpc_server_get_monitor_stats(
+    const struct ovsdb_jsonrpc_server *, struct ds *);
 
 void ovsdb_jsonrpc_server_run(struct ovsdb_jsonrpc_server *);
 void ovsdb_jsonrpc_server_wait(struct ovsdb_jsonrpc_server *);
@@ -20,19 +20,31 @@
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <time.h>
 #include <unistd.h>
 
+#include "byte-order.h"
+#include "crc32c.h"
 #include "json.h"
+#include "list.h"
 #include "lockfile.h"
+#include "ofpbuf.h"
 #include "ovsdb.h"
 #include "ovsdb-error.h"
+#include "poll-loop.h"
 #include "sha1.h"
+#include "shash.h"
 #include "socket-util.h"
 #include "transaction.h"
+#include "unaligned.h"
 #include "util.h"
+#include "uuid.h"
 #include "vlog.h"
 
 VLOG_DEFINE_THIS_MODULE(ovsdb_log);
@@ -51,12 +63,62 @@ struct ovsdb_log {
     struct ovsdb_error *read_error;
     struct ovsdb_error *write_error;
     enum ovsdb_log_mode mode;
+    enum ovsdb_log_format format;
+    struct ovsdb_log_syncer *syncer; /* Null unless async commits enabled. */
+
+    /* OVSDB_LOG_BINARY only: the JSON object member names that the log
+     * refers to by index, in the order that they were defined. */
+    char **names;
+    size_t n_names, allocated_names;
+    size_t prev_n_names;        /* 'n_names' before the last record read. */
+    struct shash name_index;    /* Maps from a name to its index plus 1. */
+};
+
+/* Asynchronous commits.
+ *
+ * A helper thread fsync()s the log on behalf of ovsdb_log_commit_async(), so
+ * that the main thread does not block.  Every request that arrives while an
+ * fsync() is in progress, or within 'window_msec' of the first request in a
+ * group, shares the next fsync().
+ *
+ * The helper thread only ever calls fsync() on the log's file descriptor.
+ * Everything else, including all use of the log's stdio stream, stays in the
+ * main thread. */
+struct ovsdb_log_syncer {
+    pthread_t thread;
+    int fd;                     /* File descriptor to fsync(). */
+    int window_msec;            /* Time to wait for more requests to join. */
+    int wakeup_fds[2];          /* Wakes the main thread on completion. */
+    unsigned long long int n_requested; /* Main thread only: last ticket. */
+    unsigned long long int n_polled;    /* Main thread only: last reported. */
+
+    /* Protected by 'mutex'. */
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;        /* Signaled on new request or 'exiting'. */
+    unsigned long long int requested; /* Last ticket handed out. */
+    unsigned long long int synced;    /* Last ticket fsync()'d or failed. */
+    struct list completions;    /* Contains "struct ovsdb_log_completion"s. */
+    bool exiting;
 };
 
+/* A group of requests completed by one fsync(). */
+struct ovsdb_log_completion {
+    struct list node;           /* In ovsdb_log_syncer's 'completions'. */
+    struct ovsdb_log_sync sync;
+    int error;                  /* 0 or positive errno value from fsync(). */
+};
+
+static void ovsdb_log_stop_async_commit(struct ovsdb_log *);
+static bool ovsdb_log_detect_format(struct ovsdb_log *);
+static void ovsdb_log_truncate_names(struct ovsdb_log *, size_t n);
+
 /* Attempts to open 'name' with the specified 'open_mode'.  On success, stores
  * the new log into '*filep' and returns NULL; otherwise returns NULL and
  * stores NULL into '*filep'.
  *
+ * The format of an existing log is detected automatically.  A newly created
+ * log uses OVSDB_LOG_JSON format unless ovsdb_log_set_format() changes it.
+ *
  * Whether the file will be locked using lockfile_lock() depends on 'locking':
  * use true to lock it, false not to lock it, or -1 to lock it only if
  * 'open_mode' is a mode that allows writing.
@@ -127,6 +189,17 @@ ovsdb_log_open(const char *name, enum ovsdb_log_open_mode open_mode,
     file->read_error = NULL;
     file->write_error = NULL;
     file->mode = OVSDB_LOG_READ;
+    file->format = OVSDB_LOG_JSON;
+    file->syncer = NULL;
+    file->names = NULL;
+    file->n_names = file->allocated_names = 0;
+    file->prev_n_names = 0;
+    shash_init(&file->name_index);
+    if (open_mode != OVSDB_LOG_CREATE && !ovsdb_log_detect_format(file)) {
+        error = ovsdb_io_error(errno, "%s: read failed", name);
+        ovsdb_log_close(file);
+        return error;
+    }
     *filep = file;
     return NULL;
 
@@ -142,17 +215,99 @@ void
 ovsdb_log_close(struct ovsdb_log *file)
 {
     if (file) {
+        ovsdb_log_stop_async_commit(file);
         free(file->name);
         fclose(file->stream);
         lockfile_unlock(file->lockfile);
         ovsdb_error_destroy(file->read_error);
         ovsdb_error_destroy(file->write_error);
+        ovsdb_log_truncate_names(file, 0);
+        free(file->names);
+        shash_destroy(&file->name_index);
         free(file);
     }
 }
 
+/* Returns a string that names 'format'. */
+const char *
+ovsdb_log_format_to_string(enum ovsdb_log_format format)
+{
+    return format == OVSDB_LOG_BINARY ? "binary" : "json";
+}
+
+/* Parses 's' as the name of a log format.  On success, stores the format in
+ * '*formatp' and returns true, otherwise returns false. */
+bool
+ovsdb_log_format_from_string(const char *s, enum ovsdb_log_format *formatp)
+{
+    if (!strcmp(s, "json")) {
+        *formatp = OVSDB_LOG_JSON;
+    } else if (!strcmp(s, "binary")) {
+        *formatp = OVSDB_LOG_BINARY;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/* Returns the format of the records in 'file'. */
+enum ovsdb_log_format
+ovsdb_log_get_format(const struct ovsdb_log *file)
+{
+    return file->format;
+}
+
 static const char magic[] = "OVSDB JSON ";
 
+/* A log in OVSDB_LOG_BINARY format begins with this string.  Each record
+ * follows as a 4-byte length and a 4-byte CRC-32C of the data that follows,
+ * both in network byte order, followed by the data, which is a JSON value
+ * encoded as described under "Binary JSON" below. */
+static const char binary_magic[] = "OVSDB BINARY 1\n";
+
+/* Checks whether 'file', which has just been opened, begins with
+ * 'binary_magic' and, if so, switches it to OVSDB_LOG_BINARY format and skips
+ * past the magic string.  Returns false if reading fails. */
+static bool
+ovsdb_log_detect_format(struct ovsdb_log *file)
+{
+    char buf[sizeof binary_magic - 1];
+    size_t n;
+
+    n = fread(buf, 1, sizeof buf, file->stream);
+    if (n == sizeof buf && !memcmp(buf, binary_magic, sizeof buf)) {
+        file->format = OVSDB_LOG_BINARY;
+        file->prev_offset = file->offset = sizeof buf;
+        return true;
+    }
+    return !ferror(file->stream) && !fseeko(file->stream, 0, SEEK_SET);
+}
+
+/* Sets the format in which records will be written to 'file', which must be
+ * newly created and not yet written. */
+struct ovsdb_error *
+ovsdb_log_set_format(struct ovsdb_log *file, enum ovsdb_log_format format)
+{
+    assert(file->mode == OVSDB_LOG_READ && !file->offset);
+
+    file->format = format;
+    if (format == OVSDB_LOG_BINARY) {
+        size_t n = strlen(binary_magic);
+
+        file->mode = OVSDB_LOG_WRITE;
+        if (fwrite(binary_magic, n, 1, file->stream) != 1
+            || fflush(file->stream)) {
+            struct ovsdb_error *error;
+
+            error = ovsdb_io_error(errno, "%s: write failed", file->name);
+            file->write_error = ovsdb_error_clone(error);
+            return error;
+        }
+        file->prev_offset = file->offset = n;
+    }
+    return NULL;
+}
+
 static bool
 parse_header(char *header, unsigned long int *length,
              uint8_t sha1[SHA1_DIGEST_SIZE])
@@ -224,8 +379,12 @@ parse_body(struct ovsdb_log *file, off_t offset, unsigned long int length,
     return NULL;
 }
 
-struct ovsdb_error *
-ovsdb_log_read(struct ovsdb_log *file, struct json **jsonp)
+/* Reads a record in OVSDB_LOG_JSON format from 'file'.  On success, stores
+ * the record in '*jsonp' (or NULL at end of file) and the offset just past
+ * the record in '*next_offsetp'. */
+static struct ovsdb_error *
+ovsdb_log_read_json(struct ovsdb_log *file, struct json **jsonp,
+                    off_t *next_offsetp)
 {
     uint8_t expected_sha1[SHA1_DIGEST_SIZE];
     uint8_t actual_sha1[SHA1_DIGEST_SIZE];
@@ -235,35 +394,25 @@ ovsdb_log_read(struct ovsdb_log *file, struct json **jsonp)
     struct json *json;
     char header[128];
 
-    *jsonp = json = NULL;
-
-    if (file->read_error) {
-        return ovsdb_error_clone(file->read_error);
-    } else if (file->mode == OVSDB_LOG_WRITE) {
-        return OVSDB_BUG("reading file in write mode");
-    }
-
     if (!fgets(header, sizeof header, file->stream)) {
         if (feof(file->stream)) {
-            error = NULL;
+            return NULL;
         } else {
-            error = ovsdb_io_error(errno, "%s: read failed", file->name);
+            return ovsdb_io_error(errno, "%s: read failed", file->name);
         }
-        goto error;
     }
 
     if (!parse_header(header, &data_length, expected_sha1)) {
-        error = ovsdb_syntax_error(NULL, NULL, "%s: parse error at offset "
-                                   "%lld in header line \"%.*s\"",
-                                   file->name, (long long int) file->offset,
-                                   (int) strcspn(header, "\n"), header);
-        goto error;
+        return ovsdb_syntax_error(NULL, NULL, "%s: parse error at offset "
+                                  "%lld in header line \"%.*s\"",
+                                  file->name, (long long int) file->offset,
+                                  (int) strcspn(header, "\n"), header);
     }
 
     data_offset = file->offset + strlen(header);
     error = parse_body(file, data_offset, data_length, actual_sha1, &json);
     if (error) {
-        goto error;
+        return error;
     }
 
     if (memcmp(expected_sha1, actual_sha1, SHA1_DIGEST_SIZE)) {
@@ -274,7 +423,8 @@ ovsdb_log_read(struct ovsdb_log *file, struct json **jsonp)
                                    (long long int) data_offset,
                                    SHA1_ARGS(actual_sha1),
                                    SHA1_ARGS(expected_sha1));
-        goto error;
+        json_destroy(json);
+        return error;
     }
 
     if (json->type == JSON_STRING) {
@@ -283,18 +433,48 @@ ovsdb_log_read(struct ovsdb_log *file, struct json **jsonp)
                                    file->name, data_length,
                                    (long long int) data_offset,
                                    json->u.string);
-        goto error;
+        json_destroy(json);
+        return error;
     }
 
-    file->prev_offset = file->offset;
-    file->offset = data_offset + data_length;
     *jsonp = json;
-    return 0;
+    *next_offsetp = data_offset + data_length;
+    return NULL;
+}
 
-error:
-    file->read_error = ovsdb_error_clone(error);
-    json_destroy(json);
-    return error;
+static struct ovsdb_error *ovsdb_log_read_binary(struct ovsdb_log *,
+                                                 struct json **,
+                                                 off_t *next_offsetp);
+
+struct ovsdb_error *
+ovsdb_log_read(struct ovsdb_log *file, struct json **jsonp)
+{
+    struct ovsdb_error *error;
+    struct json *json = NULL;
+    off_t next_offset;
+
+    *jsonp = NULL;
+
+    if (file->read_error) {
+        return ovsdb_error_clone(file->read_error);
+    } else if (file->mode == OVSDB_LOG_WRITE) {
+        return OVSDB_BUG("reading file in write mode");
+    }
+
+    error = (file->format == OVSDB_LOG_BINARY
+             ? ovsdb_log_read_binary(file, &json, &next_offset)
+             : ovsdb_log_read_json(file, &json, &next_offset));
+    if (error) {
+        file->read_error = ovsdb_error_clone(error);
+        return error;
+    }
+
+    if (json) {
+        file->prev_offset = file->offset;
+        file->offset = next_offset;
+    }
+    *jsonp = json;
+    return NULL;
 }
 
 /* Causes the log record read by the previous call to ovsdb_log_read() to be
@@ -311,18 +491,24 @@ ovsdb_log_unread(struct ovsdb_log *file)
 {
     assert(file->mode == OVSDB_LOG_READ);
     file->offset = file->prev_offset;
+    ovsdb_log_truncate_names(file, file->prev_n_names);
 }
 
+static void ovsdb_log_encode_binary(struct ovsdb_log *, const struct json *,
+                                    struct ofpbuf *);
+
 struct ovsdb_error *
 ovsdb_log_write(struct ovsdb_log *file, struct json *json)
 {
-    uint8_t sha1[SHA1_DIGEST_SIZE];
     struct ovsdb_error *error;
     char *json_string;
+    struct ofpbuf buf;
     char header[128];
+    size_t header_len;
     size_t length;
 
     json_string = NULL;
+    ofpbuf_init(&buf, 0);
 
     if (file->write_error) {
         return ovsdb_error_clone(file->write_error);
@@ -345,19 +531,35 @@ ovsdb_log_write(struct ovsdb_log *file, struct json *json)
         goto error;
     }
 
-    /* Compose content.  Add a new-line (replacing the null terminator) to make
-     * the file easier to read, even though it has no semantic value.  */
-    json_string = json_to_string(json, 0);
-    length = strlen(json_string) + 1;
-    json_string[length - 1] = '\n';
+    if (file->format == OVSDB_LOG_BINARY) {
+        ovs_be32 *be_header = (ovs_be32 *) header;
 
-    /* Compose header. */
-    sha1_bytes(json_string, length, sha1);
-    snprintf(header, sizeof header, "%s%zu "SHA1_FMT"\n",
-             magic, length, SHA1_ARGS(sha1));
+        /* Compose content and header. */
+        ovsdb_log_encode_binary(file, json, &buf);
+        json_string = buf.data;
+        length = buf.size;
+        put_unaligned_be32(&be_header[0], htonl(length));
+        put_unaligned_be32(&be_header[1], htonl(crc32c(buf.data, length)));
+        header_len = 8;
+    } else {
+        uint8_t sha1[SHA1_DIGEST_SIZE];
+
+        /* Compose content.  Add a new-line (replacing the null terminator) to
+         * make the file easier to read, even though it has no semantic
+         * value.  */
+        json_string = json_to_string(json, 0);
+        length = strlen(json_string) + 1;
+        json_string[length - 1] = '\n';
+
+        /* Compose header. */
+        sha1_bytes(json_string, length, sha1);
+        snprintf(header, sizeof header, "%s%zu "SHA1_FMT"\n",
+                 magic, length, SHA1_ARGS(sha1));
+        header_len = strlen(header);
+    }
 
     /* Write. */
-    if (fwrite(header, strlen(header), 1, file->stream) != 1
+    if (fwrite(header, header_len, 1, file->stream) != 1
         || fwrite(json_string, length, 1, file->stream) != 1
         || fflush(file->stream))
     {
@@ -370,13 +572,19 @@ ovsdb_log_write(struct ovsdb_log *file, struct json *json)
         goto error;
     }
 
-    file->offset += strlen(header) + length;
-    free(json_string);
+    file->offset += header_len + length;
+    if (json_string != buf.data) {
+        free(json_string);
+    }
+    ofpbuf_uninit(&buf);
     return 0;
 
 error:
     file->write_error = ovsdb_error_clone(error);
-    free(json_string);
+    if (json_string != buf.data) {
+        free(json_string);
+    }
+    ofpbuf_uninit(&buf);
     return error;
 }
 
@@ -389,6 +597,240 @@ ovsdb_log_commit(struct ovsdb_log *file)
     return 0;
 }
 
+static long long int
+monotonic_usec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+static void *
+ovsdb_log_syncer_main(void *syncer_)
+{
+    struct ovsdb_log_syncer *syncer = syncer_;
+    sigset_t sigs;
+
+    /* Leave signal handling to the main thread. */
+    sigfillset(&sigs);
+    pthread_sigmask(SIG_BLOCK, &sigs, NULL);
+
+    pthread_mutex_lock(&syncer->mutex);
+    for (;;) {
+        struct ovsdb_log_completion *c;
+        unsigned long long int target;
+        long long int start;
+        int error;
+
+        while (syncer->synced == syncer->requested && !syncer->exiting) {
+            pthread_cond_wait(&syncer->cond, &syncer->mutex);
+        }
+        if (syncer->synced == syncer->requested) {
+            break;
+        }
+
+        if (syncer->window_msec > 0 && !syncer->exiting) {
+            /* Give other requests a chance to join this group. */
+            pthread_mutex_unlock(&syncer->mutex);
+            poll(NULL, 0, syncer->window_msec);
+            pthread_mutex_lock(&syncer->mutex);
+        }
+        target = syncer->requested;
+        pthread_mutex_unlock(&syncer->mutex);
+
+        start = monotonic_usec();
+        error = fsync(syncer->fd) ? errno : 0;
+
+        c = xmalloc(sizeof *c);
+        c->sync.ticket = target;
+        c->sync.n_commits = target - syncer->synced;
+        c->sync.fsync_usec = monotonic_usec() - start;
+        c->sync.error = NULL;
+        c->error = error;
+
+        pthread_mutex_lock(&syncer->mutex);
+        syncer->synced = target;
+        list_push_back(&syncer->completions, &c->node);
+        ignore(write(syncer->wakeup_fds[1], "", 1));
+    }
+    pthread_mutex_unlock(&syncer->mutex);
+
+    return NULL;
+}
+
+/* Starts a helper thread that performs asynchronous commits for 'file' with
+ * ovsdb_log_commit_async().  The helper thread waits up to 'window_msec'
+ * milliseconds after the first request in a group for more requests to join
+ * it, so that a single fsync() can commit all of them.  Does nothing if
+ * asynchronous commits are already enabled for 'file'. */
+void
+ovsdb_log_enable_async_commit(struct ovsdb_log *file, int window_msec)
+{
+    struct ovsdb_log_syncer *syncer;
+    int error;
+
+    if (file->syncer) {
+        return;
+    }
+
+    syncer = xzalloc(sizeof *syncer);
+    syncer->fd = fileno(file->stream);
+    syncer->window_msec = window_msec;
+    xpipe(syncer->wakeup_fds);
+    set_nonblocking(syncer->wakeup_fds[0]);
+    set_nonblocking(syncer->wakeup_fds[1]);
+    pthread_mutex_init(&syncer->mutex, NULL);
+    pthread_cond_init(&syncer->cond, NULL);
+    list_init(&syncer->completions);
+
+    error = pthread_create(&syncer->thread, NULL, ovsdb_log_syncer_main,
+                           syncer);
+    if (error) {
+        ovs_fatal(error, "%s: failed to create fsync thread", file->name);
+    }
+    file->syncer = syncer;
+}
+
+/* Stops 'file''s helper thread, if any, after it finishes committing all of
+ * the requests that have been made of it.  Completions that have not yet been
+ * retrieved with ovsdb_log_poll_async_commit() are discarded. */
+static void
+ovsdb_log_stop_async_commit(struct ovsdb_log *file)
+{
+    struct ovsdb_log_syncer *syncer = file->syncer;
+    struct ovsdb_log_completion *c, *next;
+
+    if (!syncer) {
+        return;
+    }
+
+    pthread_mutex_lock(&syncer->mutex);
+    syncer->exiting = true;
+    pthread_cond_signal(&syncer->cond);
+    pthread_mutex_unlock(&syncer->mutex);
+    pthread_join(syncer->thread, NULL);
+
+    LIST_FOR_EACH_SAFE (c, next, node, &syncer->completions) {
+        list_remove(&c->node);
+        free(c);
+    }
+    pthread_mutex_destroy(&syncer->mutex);
+    pthread_cond_destroy(&syncer->cond);
+    close(syncer->wakeup_fds[0]);
+    close(syncer->wakeup_fds[1]);
+    free(syncer);
+    file->syncer = NULL;
+}
+
+/* Asks 'file''s helper thread, which must have been started with
+ * ovsdb_log_enable_async_commit(), to commit everything written to 'file' so
+ * far to disk, and returns a "ticket" that identifies the request.  Tickets
+ * start from 1 and increase by 1 with each request.
+ *
+ * Use ovsdb_log_poll_async_commit() to find out when the request completes. */
+unsigned long long int
+ovsdb_log_commit_async(struct ovsdb_log *file)
+{
+    struct ovsdb_log_syncer *syncer = file->syncer;
+
+    assert(syncer != NULL);
+    pthread_mutex_lock(&syncer->mutex);
+    syncer->requested = ++syncer->n_requested;
+    pthread_cond_signal(&syncer->cond);
+    pthread_mutex_unlock(&syncer->mutex);
+
+    return syncer->n_requested;
+}
+
+/* Checks whether 'file''s helper thread has completed any more requests made
+ * with ovsdb_log_commit_async().  If so, fills in 'sync' with information
+ * about the oldest completed group of requests that has not yet been reported
+ * and returns true.  Otherwise, returns false.
+ *
+ * On success, the caller owns 'sync->error' and must eventually free it with
+ * ovsdb_error_destroy(). */
+bool
+ovsdb_log_poll_async_commit(struct ovsdb_log *file, struct ovsdb_log_sync *sync)
+{
+    struct ovsdb_log_syncer *syncer = file->syncer;
+    struct ovsdb_log_completion *c;
+    char buf[128];
+
+    if (!syncer || syncer->n_polled == syncer->n_requested) {
+        return false;
+    }
+
+    /* Drain the wakeup pipe before checking for completions, so that a
+     * completion that arrives afterward still wakes us up. */
+    ignore(read(syncer->wakeup_fds[0], buf, sizeof buf));
+
+    pthread_mutex_lock(&syncer->mutex);
+    c = (list_is_empty(&syncer->completions) ? NULL
+         : CONTAINER_OF(list_pop_front(&syncer->completions),
+                        struct ovsdb_log_completion, node));
+    pthread_mutex_unlock(&syncer->mutex);
+
+    if (!c) {
+        return false;
+    }
+
+    *sync = c->sync;
+    if (c->error) {
+        sync->error = ovsdb_io_error(c->error, "%s: fsync failed", file->name);
+    }
+    syncer->n_polled = sync->ticket;
+    free(c);
+    return true;
+}
+
+/* Arranges for poll_block() to wake up when ovsdb_log_poll_async_commit() has
+ * something to report for 'file'. */
+void
+ovsdb_log_wait_async_commit(struct ovsdb_log *file)
+{
+    struct ovsdb_log_syncer *syncer = file->syncer;
+
+    if (syncer && syncer->n_polled != syncer->n_requested) {
+        poll_fd_wait(syncer->wakeup_fds[0], POLLIN);
+    }
+}
+
+/* Prepares 'file', which must have been opened for writing and not yet read
+ * from, to append records after the ones that it already contains, without
+ * reading or verifying them.  This is only appropriate for a file whose
+ * contents are known to be good, e.g. one that another process has just
+ * written and committed.
+ *
+ * A log in OVSDB_LOG_BINARY format still has to be read, because its records
+ * refer to member names defined by earlier records, but that is cheap. */
+struct ovsdb_error *
+ovsdb_log_seek_end(struct ovsdb_log *file)
+{
+    off_t offset;
+
+    if (file->format == OVSDB_LOG_BINARY) {
+        for (;;) {
+            struct ovsdb_error *error;
+            struct json *json;
+
+            error = ovsdb_log_read(file, &json);
+            if (error || !json) {
+                return error;
+            }
+            json_destroy(json);
+        }
+    }
+
+    if (fseeko(file->stream, 0, SEEK_END)
+        || (offset = ftello(file->stream)) < 0) {
+        return ovsdb_io_error(errno, "%s: cannot seek to end of file",
+                              file->name);
+    }
+    file->prev_offset = file->offset = offset;
+    return NULL;
+}
+
 /* Returns the current offset into the file backing 'log', in bytes.  This
  * reflects the number of bytes that have been read or written in the file.  If
  * the whole file has been read, this is the file size. */
@@ -397,3 +839,512 @@ ovsdb_log_get_offset(const struct ovsdb_log *log)
 {
     return log->offset;
 }
+
+/* Binary JSON.
+ *
+ * In OVSDB_LOG_BINARY format, each record is a JSON value encoded as a
+ * one-byte tag (one of the BJSON_* values below) followed by data that
+ * depends on the tag.  Lengths, counts, and integers are encoded as unsigned
+ * LEB128 "varints", with signed integers first zigzag-encoded so that small
+ * negative numbers stay short.
+ *
+ * Strings that are UUIDs in canonical form, which are common in OVSDB logs,
+ * take 16 bytes instead of 36.  Object member names are mostly table and
+ * column names, which repeat in every record, so the first record to use a
+ * name defines it and later records refer to it by index, as do later uses
+ * within the same record.  Row UUIDs, which are also member names, are not
+ * worth defining since each one is mostly used only a few times. */
+enum {
+    BJSON_NULL,                 /* No data. */
+    BJSON_FALSE,                /* No data. */
+    BJSON_TRUE,                 /* No data. */
+    BJSON_INTEGER,              /* Zigzag varint. */
+    BJSON_REAL,                 /* 8-byte IEEE 754 double, big-endian. */
+    BJSON_STRING,               /* Varint length, then bytes. */
+    BJSON_UUID,                 /* 16-byte UUID, big-endian. */
+    BJSON_ARRAY,                /* Varint count, then values. */
+    BJSON_OBJECT                /* Varint count, then (name, value) pairs. */
+};
+
+/* Encoding of an object member name, as a varint. */
+enum {
+    BJSON_NAME_LITERAL,         /* Varint length, then bytes. */
+    BJSON_NAME_DEFINE,          /* Same, and add to the log's names. */
+    BJSON_NAME_UUID,            /* 16-byte UUID, big-endian. */
+    BJSON_NAME_INDEX            /* Values from here up: index into names. */
+};
+
+/* Maximum number of member names to define in a single log.  Should only be
+ * reached if a schema has thousands of columns. */
+#define BJSON_MAX_NAMES 65536
+
+/* Maximum nesting depth of a binary JSON value.  The deepest values in an
+ * OVSDB log are only about 6 levels deep. */
+#define BJSON_MAX_DEPTH 64
+
+static void
+ovsdb_log_add_name(struct ovsdb_log *file, char *name)
+{
+    if (file->n_names >= file->allocated_names) {
+        file->names = x2nrealloc(file->names, &file->allocated_names,
+                                 sizeof *file->names);
+    }
+    file->names[file->n_names++] = name;
+    shash_add(&file->name_index, name, (void *) (uintptr_t) file->n_names);
+}
+
+/* Forgets the member names in 'file' beyond the first 'n'. */
+static void
+ovsdb_log_truncate_names(struct ovsdb_log *file, size_t n)
+{
+    while (file->n_names > n) {
+        char *name = file->names[--file->n_names];
+        shash_find_and_delete(&file->name_index, name);
+        free(name);
+    }
+}
+
+/* Returns true if 's', which is 'length' bytes long, is a UUID in the form
+ * that UUID_FMT produces, and if so stores it in '*uuid'. */
+static bool
+bjson_string_to_uuid(const char *s, size_t length, struct uuid *uuid)
+{
+    size_t i;
+
+    if (length != UUID_LEN) {
+        return false;
+    }
+    for (i = 0; i < UUID_LEN; i++) {
+        if (i == 8 || i == 13 || i == 18 || i == 23
+            ? s[i] != '-'
+            : !((s[i] >= '0' && s[i] <= '9') || (s[i] >= 'a' && s[i] <= 'f'))) {
+            return false;
+        }
+    }
+    return uuid_from_string(uuid, s);
+}
+
+static void
+bjson_put_varint(struct ofpbuf *buf, unsigned long long int value)
+{
+    uint8_t *p = ofpbuf_put_uninit(buf, 10);
+    size_t n = 0;
+
+    while (value >= 0x80) {
+        p[n++] = (value & 0x7f) | 0x80;
+        value >>= 7;
+    }
+    p[n++] = value;
+    buf->size -= 10 - n;
+}
+
+static void
+bjson_put_uuid(struct ofpbuf *buf, const struct uuid *uuid)
+{
+    ovs_be32 *p = ofpbuf_put_uninit(buf, 16);
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        put_unaligned_be32(&p[i], htonl(uuid->parts[i]));
+    }
+}
+
+static void
+bjson_put_bytes(struct ofpbuf *buf, const char *s, size_t length)
+{
+    bjson_put_varint(buf, length);
+    ofpbuf_put(buf, s, length);
+}
+
+static void
+bjson_put_tag(struct ofpbuf *buf, uint8_t tag)
+{
+    ofpbuf_put(buf, &tag, 1);
+}
+
+static void
+bjson_put_name(struct ovsdb_log *file, struct ofpbuf *buf, const char *name)
+{
+    void *index = shash_find_data(&file->name_index, name);
+    size_t length = strlen(name);
+    struct uuid uuid;
+
+    if (index) {
+        bjson_put_varint(buf, BJSON_NAME_INDEX + ((uintptr_t) index - 1));
+    } else if (bjson_string_to_uuid(name, length, &uuid)) {
+        bjson_put_varint(buf, BJSON_NAME_UUID);
+        bjson_put_uuid(buf, &uuid);
+    } else if (file->n_names < BJSON_MAX_NAMES) {
+        bjson_put_varint(buf, BJSON_NAME_DEFINE);
+        bjson_put_bytes(buf, name, length);
+        ovsdb_log_add_name(file, xmemdup0(name, length));
+    } else {
+        bjson_put_varint(buf, BJSON_NAME_LITERAL);
+        bjson_put_bytes(buf, name, length);
+    }
+}
+
+/* Appends the binary encoding of 'json' to 'buf', defining any new object
+ * member names in 'file'. */
+static void
+ovsdb_log_encode_binary(struct ovsdb_log *file, const struct json *json,
+                        struct ofpbuf *buf)
+{
+    switch (json->type) {
+    case JSON_NULL:
+        bjson_put_tag(buf, BJSON_NULL);
+        break;
+
+    case JSON_FALSE:
+        bjson_put_tag(buf, BJSON_FALSE);
+        break;
+
+    case JSON_TRUE:
+        bjson_put_tag(buf, BJSON_TRUE);
+        break;
+
+    case JSON_INTEGER: {
+        unsigned long long int u = json->u.integer;
+
+        bjson_put_tag(buf, BJSON_INTEGER);
+        bjson_put_varint(buf, json->u.integer < 0 ? ~(u << 1) : u << 1);
+        break;
+    }
+
+    case JSON_REAL: {
+        ovs_be64 *p;
+        uint64_t u;
+
+        bjson_put_tag(buf, BJSON_REAL);
+        memcpy(&u, &json->u.real, sizeof u);
+        p = ofpbuf_put_uninit(buf, sizeof *p);
+        put_unaligned_be64(p, htonll(u));
+        break;
+    }
+
+    case JSON_STRING: {
+        size_t length = strlen(json->u.string);
+        struct uuid uuid;
+
+        if (bjson_string_to_uuid(json->u.string, length, &uuid)) {
+            bjson_put_tag(buf, BJSON_UUID);
+            bjson_put_uuid(buf, &uuid);
+        } else {
+            bjson_put_tag(buf, BJSON_STRING);
+            bjson_put_bytes(buf, json->u.string, length);
+        }
+        break;
+    }
+
+    case JSON_ARRAY: {
+        size_t i;
+
+        bjson_put_tag(buf, BJSON_ARRAY);
+        bjson_put_varint(buf, json->u.array.n);
+        for (i = 0; i < json->u.array.n; i++) {
+            ovsdb_log_encode_binary(file, json->u.array.elems[i], buf);
+        }
+        break;
+    }
+
+    case JSON_OBJECT: {
+        struct shash_node *node;
+
+        bjson_put_tag(buf, BJSON_OBJECT);
+        bjson_put_varint(buf, shash_count(json->u.object));
+        SHASH_FOR_EACH (node, json->u.object) {
+            bjson_put_name(file, buf, node->name);
+            ovsdb_log_encode_binary(file, node->data, buf);
+        }
+        break;
+    }
+
+    case JSON_N_TYPES:
+    default:
+        NOT_REACHED();
+    }
+}
+
+/* Binary JSON decoding state. */
+struct bjson_reader {
+    struct ovsdb_log *file;
+    const uint8_t *p;           /* Next byte to decode. */
+    const uint8_t *end;         /* End of record. */
+};
+
+static bool
+bjson_get_varint(struct bjson_reader *r, unsigned long long int *value)
+{
+    int shift;
+
+    *value = 0;
+    for (shift = 0; r->p < r->end && shift < 64; shift += 7) {
+        uint8_t byte = *r->p++;
+
+        *value |= (unsigned long long int) (byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Decodes a UUID from 'r' into 's' in the form that UUID_FMT produces.  This
+ * is equivalent to formatting it with UUID_FMT, but much faster. */
+static bool
+bjson_get_uuid(struct bjson_reader *r, char s[UUID_LEN + 1])
+{
+    static const char hex[] = "0123456789abcdef";
+    int i;
+
+    if (r->end - r->p < 16) {
+        return false;
+    }
+    for (i = 0; i < 16; i++) {
+        uint8_t byte = r->p[i];
+
+        if (i == 4 || i == 6 || i == 8 || i == 10) {
+            *s++ = '-';
+        }
+        *s++ = hex[byte >> 4];
+        *s++ = hex[byte & 15];
+    }
+    *s = '\0';
+    r->p += 16;
+    return true;
+}
+
+static char *
+bjson_get_bytes(struct bjson_reader *r)
+{
+    unsigned long long int length;
+    char *s;
+
+    if (!bjson_get_varint(r, &length) || length > r->end - r->p) {
+        return NULL;
+    }
+    s = xmemdup0((const char *) r->p, length);
+    r->p += length;
+    return s;
+}
+
+/* Decodes an object member name from 'r'.  Returns the name, which the caller
+ * must free, or NULL if 'r' is malformed. */
+static char *
+bjson_get_name(struct bjson_reader *r)
+{
+    struct ovsdb_log *file = r->file;
+    unsigned long long int code;
+    char uuid_s[UUID_LEN + 1];
+    char *name;
+
+    if (!bjson_get_varint(r, &code)) {
+        return NULL;
+    }
+
+    switch (code) {
+    case BJSON_NAME_LITERAL:
+        return bjson_get_bytes(r);
+
+    case BJSON_NAME_DEFINE:
+        name = bjson_get_bytes(r);
+        if (!name || shash_find(&file->name_index, name)) {
+            free(name);
+            return NULL;
+        }
+        ovsdb_log_add_name(file, name);
+        return xstrdup(name);
+
+    case BJSON_NAME_UUID:
+        return bjson_get_uuid(r, uuid_s) ? xstrdup(uuid_s) : NULL;
+
+    default:
+        code -= BJSON_NAME_INDEX;
+        return code < file->n_names ? xstrdup(file->names[code]) : NULL;
+    }
+}
+
+/* Decodes and returns a JSON value from 'r', or returns NULL if 'r' is
+ * malformed. */
+static struct json *
+bjson_decode(struct bjson_reader *r, int depth)
+{
+    unsigned long long int u, n;
+    char uuid_s[UUID_LEN + 1];
+    struct json *json;
+    uint8_t tag;
+    char *s;
+
+    if (r->p >= r->end || depth > BJSON_MAX_DEPTH) {
+        return NULL;
+    }
+
+    tag = *r->p++;
+    switch (tag) {
+    case BJSON_NULL:
+        return json_null_create();
+
+    case BJSON_FALSE:
+        return json_boolean_create(false);
+
+    case BJSON_TRUE:
+        return json_boolean_create(true);
+
+    case BJSON_INTEGER:
+        if (!bjson_get_varint(r, &u)) {
+            return NULL;
+        }
+        return json_integer_create(u & 1 ? ~(u >> 1) : u >> 1);
+
+    case BJSON_REAL: {
+        double d;
+
+        if (r->end - r->p < 8) {
+            return NULL;
+        }
+        u = ntohll(get_unaligned_be64((const ovs_be64 *) r->p));
+        memcpy(&d, &u, sizeof d);
+        r->p += 8;
+        return json_real_create(d);
+    }
+
+    case BJSON_STRING:
+        s = bjson_get_bytes(r);
+        return s ? json_string_create_nocopy(s) : NULL;
+
+    case BJSON_UUID:
+        return bjson_get_uuid(r, uuid_s) ? json_string_create(uuid_s) : NULL;
+
+    case BJSON_ARRAY:
+        /* Every element takes at least one byte. */
+        if (!bjson_get_varint(r, &n) || n > r->end - r->p) {
+            return NULL;
+        }
+        json = json_array_create_empty();
+        while (n-- > 0) {
+            struct json *elem = bjson_decode(r, depth + 1);
+            if (!elem) {
+                json_destroy(json);
+                return NULL;
+            }
+            json_array_add(json, elem);
+        }
+        return json;
+
+    case BJSON_OBJECT:
+        /* Every member takes at least two bytes. */
+        if (!bjson_get_varint(r, &n) || n > (r->end - r->p) / 2) {
+            return NULL;
+        }
+        json = json_object_create();
+        while (n-- > 0) {
+            struct json *value;
+            char *name;
+
+            name = bjson_get_name(r);
+            value = name ? bjson_decode(r, depth + 1) : NULL;
+            if (!value) {
+                free(name);
+                json_destroy(json);
+                return NULL;
+            }
+            /* The encoder never writes duplicate names, so there is no need to
+             * check for them. */
+            shash_add_nocopy(json->u.object, name, value);
+        }
+        return json;
+
+    default:
+        return NULL;
+    }
+}
+
+/* Reads a record in OVSDB_LOG_BINARY format from 'file'.  On success, stores
+ * the record in '*jsonp' (or NULL at end of file) and the offset just past
+ * the record in '*next_offsetp'. */
+static struct ovsdb_error *
+ovsdb_log_read_binary(struct ovsdb_log *file, struct json **jsonp,
+                      off_t *next_offsetp)
+{
+    uint32_t length, expected_crc, actual_crc;
+    off_t data_offset = file->offset + 8;
+    struct bjson_reader r;
+    ovs_be32 header[2];
+    size_t n_names;
+    uint8_t *data;
+    struct json *json;
+    size_t n;
+
+    n = fread(header, 1, sizeof header, file->stream);
+    if (n != sizeof header) {
+        if (ferror(file->stream)) {
+            return ovsdb_io_error(errno, "%s: read failed", file->name);
+        } else if (!n) {
+            return NULL;
+        }
+        return ovsdb_syntax_error(NULL, NULL, "%s: truncated record header "
+                                  "at offset %lld", file->name,
+                                  (long long int) file->offset);
+    }
+    length = ntohl(header[0]);
+    expected_crc = ntohl(header[1]);
+
+    /* Don't trust a large 'length' until we know that the file is really that
+     * long, since it might be corrupt. */
+    if (!length) {
+        return ovsdb_syntax_error(NULL, NULL, "%s: zero-length record at "
+                                  "offset %lld", file->name,
+                                  (long long int) file->offset);
+    } else if (length > 1024 * 1024) {
+        struct stat s;
+
+        if (!fstat(fileno(file->stream), &s)
+            && data_offset + length > s.st_size) {
+            return ovsdb_io_error(EOF, "%s: error reading %"PRIu32" bytes "
+                                  "starting at offset %lld", file->name,
+                                  length, (long long int) data_offset);
+        }
+    }
+
+    data = xmalloc(length);
+    if (fread(data, 1, length, file->stream) != length) {
+        free(data);
+        return ovsdb_io_error(ferror(file->stream) ? errno : EOF,
+                              "%s: error reading %"PRIu32" bytes "
+                              "starting at offset %lld", file->name,
+                              length, (long long int) data_offset);
+    }
+
+    actual_crc = crc32c(data, length);
+    if (actual_crc != expected_crc) {
+        free(data);
+        return ovsdb_syntax_error(NULL, NULL, "%s: %"PRIu32" bytes starting "
+                                  "at offset %lld have CRC-32C %08"PRIx32" "
+                                  "but should have %08"PRIx32,
+                                  file->name, length,
+                                  (long long int) data_offset,
+                                  actual_crc, expected_crc);
+    }
+
+    n_names = file->n_names;
+    r.file = file;
+    r.p = data;
+    r.end = data + length;
+    json = bjson_decode(&r, 0);
+    if (!json || r.p != r.end
+        || (json->type != JSON_OBJECT && json->type != JSON_ARRAY)) {
+        json_destroy(json);
+        free(data);
+        ovsdb_log_truncate_names(file, n_names);
+        return ovsdb_syntax_error(NULL, NULL, "%s: %"PRIu32" bytes starting "
+                                  "at offset %lld are not valid binary JSON",
+                                  file->name, length,
+                                  (long long int) data_offset);
+    }
+    free(data);
+
+    file->prev_n_names = n_names;
+    *jsonp = json;
+    *next_offsetp = data_offset + length;
+    return NULL;
+}
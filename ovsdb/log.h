@@ -16,12 +16,22 @@
 #ifndef OVSDB_LOG_H
 #define OVSDB_LOG_H 1
 
+#include <stdbool.h>
 #include <sys/types.h>
 #include "compiler.h"
 
 struct json;
 struct ovsdb_log;
 
+/* Format of the records in an OVSDB log. */
+enum ovsdb_log_format {
+    OVSDB_LOG_JSON,             /* JSON text, with SHA-1 for integrity. */
+    OVSDB_LOG_BINARY            /* Compact binary, with CRC-32C. */
+};
+
+const char *ovsdb_log_format_to_string(enum ovsdb_log_format);
+bool ovsdb_log_format_from_string(const char *, enum ovsdb_log_format *);
+
 /* Access mode for opening an OVSDB log. */
 enum ovsdb_log_open_mode {
     OVSDB_LOG_READ_ONLY,        /* Open existing file, read-only. */
@@ -34,6 +44,11 @@ struct ovsdb_error *ovsdb_log_open(const char *name, enum ovsdb_log_open_mode,
     WARN_UNUSED_RESULT;
 void ovsdb_log_close(struct ovsdb_log *);
 
+enum ovsdb_log_format ovsdb_log_get_format(const struct ovsdb_log *);
+struct ovsdb_error *ovsdb_log_set_format(struct ovsdb_log *,
+                                         enum ovsdb_log_format)
+    WARN_UNUSED_RESULT;
+
 struct ovsdb_error *ovsdb_log_read(struct ovsdb_log *, struct json **)
     WARN_UNUSED_RESULT;
 void ovsdb_log_unread(struct ovsdb_log *);
@@ -43,6 +58,21 @@ struct ovsdb_error *ovsdb_log_write(struct ovsdb_log *, struct json *)
 struct ovsdb_error *ovsdb_log_commit(struct ovsdb_log *)
     WARN_UNUSED_RESULT;
 
+struct ovsdb_error *ovsdb_log_seek_end(struct ovsdb_log *)
+    WARN_UNUSED_RESULT;
 off_t ovsdb_log_get_offset(const struct ovsdb_log *);
 
+/* Asynchronous commits. */
+struct ovsdb_log_sync {
+    unsigned long long int ticket; /* Requests up to this ticket completed. */
+    unsigned int n_commits;        /* Number of requests completed. */
+    long long int fsync_usec;      /* Microseconds spent in fsync(). */
+    struct ovsdb_error *error;     /* Null if successful. */
+};
+
+void ovsdb_log_enable_async_commit(struct ovsdb_log *, int window_msec);
+unsigned long long int ovsdb_log_commit_async(struct ovsdb_log *);
+bool ovsdb_log_poll_async_commit(struct ovsdb_log *, struct ovsdb_log_sync *);
+void ovsdb_log_wait_async_commit(struct ovsdb_log *);
+
 #endif /* ovsdb/log.h */
@@ -25,6 +25,7 @@
 #include "column.h"
 #include "command-line.h"
 #include "daemon.h"
+#include "dynamic-string.h"
 #include "file.h"
 #include "json.h"
 #include "jsonrpc.h"
@@ -59,9 +60,19 @@ static char *ca_cert_file;
 static bool bootstrap_ca_cert;
 #endif
 
+/* --group-commit: window for group commit, or -1 if disabled. */
+static int group_commit_msec = -1;
+
+/* --compact-ratio, --compact-min-size: thresholds for automatic compaction, or
+ * -1 to use the defaults. */
+static double compact_ratio = -1;
+static long long int compact_min_size = -1;
+
 static unixctl_cb_func ovsdb_server_exit;
 static unixctl_cb_func ovsdb_server_compact;
 static unixctl_cb_func ovsdb_server_reconnect;
+static unixctl_cb_func ovsdb_server_monitor_stats;
+static unixctl_cb_func ovsdb_server_commit_stats;
 
 static void parse_options(int argc, char *argv[], char **file_namep,
                           struct sset *remotes, char **unixctl_pathp,
@@ -134,17 +145,27 @@ main(int argc, char *argv[])
 
     daemonize_complete();
 
+    if (group_commit_msec >= 0) {
+        ovsdb_file_set_group_commit(file, group_commit_msec);
+    }
+    ovsdb_file_set_compaction(file, compact_ratio, compact_min_size);
+
     unixctl_command_register("exit", ovsdb_server_exit, &exiting);
     unixctl_command_register("ovsdb-server/compact", ovsdb_server_compact,
                              file);
     unixctl_command_register("ovsdb-server/reconnect", ovsdb_server_reconnect,
                              jsonrpc);
+    unixctl_command_register("ovsdb-server/monitor-stats",
+                             ovsdb_server_monitor_stats, jsonrpc);
+    unixctl_command_register("ovsdb-server/commit-stats",
+                             ovsdb_server_commit_stats, file);
 
     exiting = false;
     while (!exiting) {
         reconfigure_from_db(jsonrpc, db, &remotes);
         ovsdb_jsonrpc_server_run(jsonrpc);
         unixctl_server_run(unixctl);
+        ovsdb_file_run(file);
         ovsdb_trigger_run(db, time_msec());
         if (run_process && process_exited(run_process)) {
             exiting = true;
@@ -158,6 +179,7 @@ main(int argc, char *argv[])
 
         ovsdb_jsonrpc_server_wait(jsonrpc);
         unixctl_server_wait(unixctl);
+        ovsdb_file_wait(file);
         ovsdb_trigger_wait(db, time_msec());
         if (run_process) {
             process_wait(run_process);
@@ -647,6 +669,35 @@ ovsdb_server_reconnect(struct unixctl_conn *conn, const char *args OVS_UNUSED,
     unixctl_command_reply(conn, 200, NULL);
 }
 
+/* "ovsdb-server/monitor-stats": reports statistics on the monitors that
+ * clients have set up and the updates sent to them. */
+static void
+ovsdb_server_monitor_stats(struct unixctl_conn *conn,
+                           const char *args OVS_UNUSED, void *jsonrpc_)
+{
+    struct ovsdb_jsonrpc_server *jsonrpc = jsonrpc_;
+    struct ds s;
+
+    ds_init(&s);
+    ovsdb_jsonrpc_server_get_monitor_stats(jsonrpc, &s);
+    unixctl_command_reply(conn, 200, ds_cstr(&s));
+    ds_destroy(&s);
+}
+
+/* "ovsdb-server/commit-stats": reports statistics on group commit. */
+static void
+ovsdb_server_commit_stats(struct unixctl_conn *conn,
+                          const char *args OVS_UNUSED, void *file_)
+{
+    const struct ovsdb_file *file = file_;
+    struct ds s;
+
+    ds_init(&s);
+    ovsdb_file_get_commit_stats(file, &s);
+    unixctl_command_reply(conn, 200, ds_cstr(&s));
+    ds_destroy(&s);
+}
+
 static void
 parse_options(int argc, char *argv[], char **file_namep,
               struct sset *remotes, char **unixctl_pathp,
@@ -658,6 +709,9 @@ parse_options(int argc, char *argv[], char **file_namep,
         OPT_UNIXCTL,
         OPT_RUN,
         OPT_BOOTSTRAP_CA_CERT,
+        OPT_GROUP_COMMIT,
+        OPT_COMPACT_RATIO,
+        OPT_COMPACT_MIN_SIZE,
         VLOG_OPTION_ENUMS,
         LEAK_CHECKER_OPTION_ENUMS,
         DAEMON_OPTION_ENUMS
@@ -666,6 +720,9 @@ parse_options(int argc, char *argv[], char **file_namep,
         {"remote",      required_argument, 0, OPT_REMOTE},
         {"unixctl",     required_argument, 0, OPT_UNIXCTL},
         {"run",         required_argument, 0, OPT_RUN},
+        {"group-commit", required_argument, 0, OPT_GROUP_COMMIT},
+        {"compact-ratio", required_argument, 0, OPT_COMPACT_RATIO},
+        {"compact-min-size", required_argument, 0, OPT_COMPACT_MIN_SIZE},
         {"help",        no_argument, 0, 'h'},
         {"version",     no_argument, 0, 'V'},
         DAEMON_LONG_OPTIONS,
@@ -703,6 +760,28 @@ parse_options(int argc, char *argv[], char **file_namep,
             *run_command = optarg;
             break;
 
+        case OPT_GROUP_COMMIT:
+            group_commit_msec = atoi(optarg);
+            if (group_commit_msec < 0) {
+                ovs_fatal(0, "--group-commit argument must be nonnegative");
+            }
+            break;
+
+        case OPT_COMPACT_RATIO:
+            if (!str_to_double(optarg, &compact_ratio) || compact_ratio < 0) {
+                ovs_fatal(0, "--compact-ratio argument must be a nonnegative "
+                          "number");
+            }
+            break;
+
+        case OPT_COMPACT_MIN_SIZE:
+            if (!str_to_llong(optarg, 10, &compact_min_size)
+                || compact_min_size < 0) {
+                ovs_fatal(0, "--compact-min-size argument must be a "
+                          "nonnegative integer");
+            }
+            break;
+
         case 'h':
             usage();
 
@@ -770,6 +849,12 @@ usage(void)
     vlog_usage();
     printf("\nOther options:\n"
            "  --run COMMAND           run COMMAND as subprocess then exit\n"
+           "  --group-commit=MSEC     share fsyncs among durable commits "
+           "within MSEC ms\n"
+           "  --compact-ratio=RATIO   compact when log grows RATIO times "
+           "(default 2)\n"
+           "  --compact-min-size=BYTES  ...and is at least BYTES long "
+           "(default 10 MB)\n"
            "  --unixctl=SOCKET        override default control socket name\n"
            "  -h, --help              display this help message\n"
            "  -V, --version           display version information\n");
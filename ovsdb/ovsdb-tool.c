@@ -110,8 +110,11 @@ usage(void)
            "  create DB SCHEMA   create DB with the given SCHEMA\n"
            "  compact DB [DST]   compact DB in-place (or to DST)\n"
            "  convert DB SCHEMA [DST]   convert DB to SCHEMA (to DST)\n"
+           "  convert-format DB FORMAT [DST]  convert DB to json or binary "
+           "FORMAT\n"
            "  db-version DB      report version of schema used by DB\n"
            "  db-cksum DB        report checksum of schema used by DB\n"
+           "  db-format DB       report format of DB (json or binary)\n"
            "  schema-version SCHEMA  report SCHEMA's schema version\n"
            "  schema-cksum SCHEMA  report SCHEMA's checksum\n"
            "  query DB TRNS      execute read-only transaction on DB\n"
@@ -177,10 +180,24 @@ do_create(int argc OVS_UNUSED, char *argv[])
     json_destroy(json);
 }
 
+static enum ovsdb_log_format
+read_db_format(const char *db_file_name)
+{
+    enum ovsdb_log_format format;
+    struct ovsdb_log *log;
+
+    check_ovsdb_error(ovsdb_log_open(db_file_name, OVSDB_LOG_READ_ONLY,
+                                     false, &log));
+    format = ovsdb_log_get_format(log);
+    ovsdb_log_close(log);
+
+    return format;
+}
+
 static void
 compact_or_convert(const char *src_name, const char *dst_name,
                    const struct ovsdb_schema *new_schema,
-                   const char *comment)
+                   enum ovsdb_log_format format, const char *comment)
 {
     struct lockfile *src_lock;
     struct lockfile *dst_lock;
@@ -209,7 +226,8 @@ compact_or_convert(const char *src_name, const char *dst_name,
     check_ovsdb_error(new_schema
                       ? ovsdb_file_open_as_schema(src_name, new_schema, &db)
                       : ovsdb_file_open(src_name, true, &db, NULL));
-    check_ovsdb_error(ovsdb_file_save_copy(dst_name, false, comment, db));
+    check_ovsdb_error(ovsdb_file_save_copy(dst_name, false, comment, db,
+                                           format));
     ovsdb_destroy(db);
 
     /* Replace source. */
@@ -228,7 +246,8 @@ compact_or_convert(const char *src_name, const char *dst_name,
 static void
 do_compact(int argc OVS_UNUSED, char *argv[])
 {
-    compact_or_convert(argv[1], argv[2], NULL, "compacted by ovsdb-tool");
+    compact_or_convert(argv[1], argv[2], NULL, read_db_format(argv[1]),
+                       "compacted by ovsdb-tool");
 }
 
 static void
@@ -238,11 +257,27 @@ do_convert(int argc OVS_UNUSED, char *argv[])
     struct ovsdb_schema *new_schema;
 
     check_ovsdb_error(ovsdb_schema_from_file(schema_file_name, &new_schema));
-    compact_or_convert(argv[1], argv[3], new_schema,
+    compact_or_convert(argv[1], argv[3], new_schema, read_db_format(argv[1]),
                        "converted by ovsdb-tool");
     ovsdb_schema_destroy(new_schema);
 }
 
+static void
+do_convert_format(int argc OVS_UNUSED, char *argv[])
+{
+    enum ovsdb_log_format format;
+    char *comment;
+
+    if (!ovsdb_log_format_from_string(argv[2], &format)) {
+        ovs_fatal(0, "%s: unknown database format (use \"json\" or "
+                  "\"binary\")", argv[2]);
+    }
+    comment = xasprintf("converted to %s format by ovsdb-tool",
+                        ovsdb_log_format_to_string(format));
+    compact_or_convert(argv[1], argv[3], NULL, format, comment);
+    free(comment);
+}
+
 static void
 do_needs_conversion(int argc OVS_UNUSED, char *argv[])
 {
@@ -279,6 +314,12 @@ do_db_cksum(int argc OVS_UNUSED, char *argv[])
     ovsdb_schema_destroy(schema);
 }
 
+static void
+do_db_format(int argc OVS_UNUSED, char *argv[])
+{
+    puts(ovsdb_log_format_to_string(read_db_format(argv[1])));
+}
+
 static void
 do_schema_version(int argc OVS_UNUSED, char *argv[])
 {
@@ -473,9 +514,11 @@ static const struct command all_commands[] = {
     { "create", 2, 2, do_create },
     { "compact", 1, 2, do_compact },
     { "convert", 2, 3, do_convert },
+    { "convert-format", 2, 3, do_convert_format },
     { "needs-conversion", 2, 2, do_needs_conversion },
     { "db-version", 1, 1, do_db_version },
     { "db-cksum", 1, 1, do_db_cksum },
+    { "db-format", 1, 1, do_db_format },
     { "schema-version", 1, 1, do_schema_version },
     { "schema-cksum", 1, 1, do_schema_cksum },
     { "query", 2, 2, do_query },
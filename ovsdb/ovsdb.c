@@ -329,7 +329,12 @@ ovsdb_create(struct ovsdb_schema *schema)
     db->schema = schema;
     list_init(&db->replicas);
     list_init(&db->triggers);
+    hmap_init(&db->trigger_tables);
+    heap_init(&db->trigger_deadlines);
+    db->trigger_serial = 0;
     db->run_triggers = false;
+    db->commit_seqno = 0;
+    db->durable_seqno = 0;
 
     shash_init(&db->tables);
     SHASH_FOR_EACH (node, &schema->tables) {
@@ -380,6 +385,8 @@ ovsdb_destroy(struct ovsdb *db)
         shash_clear(&db->schema->tables);
 
         ovsdb_schema_destroy(db->schema);
+        hmap_destroy(&db->trigger_tables);
+        heap_destroy(&db->trigger_deadlines);
         free(db);
     }
 }
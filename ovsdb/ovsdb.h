@@ -17,6 +17,7 @@
 #define OVSDB_OVSDB_H 1
 
 #include "compiler.h"
+#include "heap.h"
 #include "hmap.h"
 #include "list.h"
 #include "shash.h"
@@ -59,7 +60,17 @@ struct ovsdb {
 
     /* Triggers. */
     struct list triggers;       /* Contains "struct ovsdb_trigger"s. */
-    bool run_triggers;
+    struct hmap trigger_tables; /* Contains "struct ovsdb_trigger_table"s. */
+    struct heap trigger_deadlines; /* Contains "struct ovsdb_trigger"s. */
+    unsigned long long int trigger_serial; /* Last trigger's 'serial'. */
+    bool run_triggers;          /* Watched tables changed since last run? */
+
+    /* Durable commits that a replica finishes asynchronously.  A replica that
+     * accepts a durable commit without yet making it durable increments
+     * 'commit_seqno', and later reports progress with
+     * ovsdb_trigger_commit_done(), which advances 'durable_seqno'. */
+    unsigned long long int commit_seqno;  /* Last asynchronous commit. */
+    unsigned long long int durable_seqno; /* Last commit known durable. */
 };
 
 struct ovsdb *ovsdb_create(struct ovsdb_schema *);
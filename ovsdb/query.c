@@ -17,15 +17,71 @@
 
 #include "query.h"
 
+#include <stdlib.h>
+
 #include "column.h"
 #include "condition.h"
 #include "row.h"
 #include "table.h"
 
+/* Looks for an index on 'table' all of whose columns 'cnd' requires to have
+ * particular values, through "==" clauses.  If there is one, returns true and
+ * stores into '*rowp' the only row that could satisfy 'cnd', or a null
+ * pointer if no row can.  Otherwise, returns false.
+ *
+ * The table's indexes only reflect committed rows, so this only considers
+ * them if 'table' has not been modified by the transaction in progress. */
+static bool
+ovsdb_query_by_index(const struct ovsdb_table *table,
+                     const struct ovsdb_condition *cnd,
+                     const struct ovsdb_row **rowp)
+{
+    const struct ovsdb_datum **values;
+    bool found = false;
+    size_t i;
+
+    if (table->txn_table || !table->schema->n_indexes || !cnd->n_clauses) {
+        return false;
+    }
+
+    values = xmalloc(shash_count(&table->schema->columns) * sizeof *values);
+    for (i = 0; i < table->schema->n_indexes && !found; i++) {
+        const struct ovsdb_column_set *index = &table->schema->indexes[i];
+        size_t j;
+
+        for (j = 0; j < index->n_columns; j++) {
+            const struct ovsdb_column *column = index->columns[j];
+            size_t k;
+
+            values[j] = NULL;
+            for (k = 0; k < cnd->n_clauses; k++) {
+                const struct ovsdb_clause *c = &cnd->clauses[k];
+                if (c->function == OVSDB_F_EQ && c->column == column) {
+                    values[j] = &c->arg;
+                    break;
+                }
+            }
+            if (!values[j]) {
+                break;
+            }
+        }
+
+        if (j == index->n_columns) {
+            *rowp = ovsdb_table_find_by_index(table, i, values);
+            found = true;
+        }
+    }
+    free(values);
+
+    return found;
+}
+
 void
 ovsdb_query(struct ovsdb_table *table, const struct ovsdb_condition *cnd,
             bool (*output_row)(const struct ovsdb_row *, void *aux), void *aux)
 {
+    const struct ovsdb_row *index_row;
+
     if (cnd->n_clauses > 0
         && cnd->clauses[0].column->index == OVSDB_COL_UUID
         && cnd->clauses[0].function == OVSDB_F_EQ) {
@@ -37,6 +93,11 @@ ovsdb_query(struct ovsdb_table *table, const struct ovsdb_condition *cnd,
         if (row && row->table == table && ovsdb_condition_evaluate(row, cnd)) {
             output_row(row, aux);
         }
+    } else if (ovsdb_query_by_index(table, cnd, &index_row)) {
+        /* Since the index is unique, at most one row can match. */
+        if (index_row && ovsdb_condition_evaluate(index_row, cnd)) {
+            output_row(index_row, aux);
+        }
     } else {
         /* Linear scan. */
         const struct ovsdb_row *row, *next;
@@ -26,12 +26,23 @@
 #include "sort.h"
 #include "table.h"
 
+/* Returns the offset in bytes from the start of a row in 'table' to the
+ * hmap_node for index number 'i'.  Use ovsdb_row_get_index_node() instead of
+ * calling this directly. */
+size_t
+ovsdb_row_index_offset__(const struct ovsdb_table *table, size_t i)
+{
+    size_t n_fields = shash_count(&table->schema->columns);
+    return (offsetof(struct ovsdb_row, fields)
+            + n_fields * sizeof(struct ovsdb_datum)
+            + i * sizeof(struct hmap_node));
+}
+
 static struct ovsdb_row *
 allocate_row(const struct ovsdb_table *table)
 {
-    size_t n_fields = shash_count(&table->schema->columns);
-    size_t row_size = (offsetof(struct ovsdb_row, fields)
-                       + sizeof(struct ovsdb_datum) * n_fields);
+    size_t row_size = ovsdb_row_index_offset__(table,
+                                               table->schema->n_indexes);
     struct ovsdb_row *row = xmalloc(row_size);
     row->table = (struct ovsdb_table *) table;
     row->txn_row = NULL;
@@ -58,6 +58,10 @@ struct ovsdb_row {
      * commit. */
     size_t n_refs;
 
+    /* One datum for each column (shash_count(&table->schema->columns)
+     * of them), followed by one hmap_node for each of the table's indexes
+     * (table->schema->n_indexes of them).  Use ovsdb_row_get_index_node() to
+     * access the latter. */
     struct ovsdb_datum fields[];
 };
 
@@ -114,6 +118,26 @@ ovsdb_row_hash(const struct ovsdb_row *row)
 {
     return uuid_hash(ovsdb_row_get_uuid(row));
 }
+
+size_t ovsdb_row_index_offset__(const struct ovsdb_table *, size_t i);
+
+/* Returns the hmap_node that links 'row' into its table's index number 'i'. */
+static inline struct hmap_node *
+ovsdb_row_get_index_node(struct ovsdb_row *row, size_t i)
+{
+    return (struct hmap_node *) ((char *) row
+                                 + ovsdb_row_index_offset__(row->table, i));
+}
+
+/* Returns the row, in 'table', that contains 'node' as the hmap_node for its
+ * index number 'i'. */
+static inline struct ovsdb_row *
+ovsdb_row_from_index_node(const struct hmap_node *node,
+                          const struct ovsdb_table *table, size_t i)
+{
+    return (struct ovsdb_row *) ((char *) node
+                                 - ovsdb_row_index_offset__(table, i));
+}
 
 /* An unordered collection of rows. */
 struct ovsdb_row_set {
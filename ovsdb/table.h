@@ -22,6 +22,7 @@
 #include "shash.h"
 
 struct json;
+struct ovsdb_datum;
 struct uuid;
 
 /* Schema for a database table. */
@@ -31,6 +32,10 @@ struct ovsdb_table_schema {
     struct shash columns;       /* Contains "struct ovsdb_column *"s. */
     unsigned int max_rows;      /* Maximum number of rows. */
     bool is_root;               /* Part of garbage collection root set? */
+
+    /* Sets of columns whose values must be unique among the table's rows. */
+    struct ovsdb_column_set *indexes;
+    size_t n_indexes;
 };
 
 struct ovsdb_table_schema *ovsdb_table_schema_create(
@@ -55,6 +60,14 @@ struct ovsdb_table {
     struct ovsdb_table_schema *schema;
     struct ovsdb_txn_table *txn_table; /* Only if table is in a transaction. */
     struct hmap rows;           /* Contains "struct ovsdb_row"s. */
+
+    /* An array of schema->n_indexes hmaps, each of which contains "struct
+     * ovsdb_row"s.  indexes[i] contains the committed rows hashed on the
+     * columns in schema->indexes[i], through the hmap_node that
+     * ovsdb_row_get_index_node() returns for 'i'.  Rows modified by a
+     * transaction in progress are not updated until the transaction commits,
+     * so the indexes are accurate only if 'txn_table' is null. */
+    struct hmap *indexes;
 };
 
 struct ovsdb_table *ovsdb_table_create(struct ovsdb_table_schema *);
@@ -62,6 +75,9 @@ void ovsdb_table_destroy(struct ovsdb_table *);
 
 const struct ovsdb_row *ovsdb_table_get_row(const struct ovsdb_table *,
                                             const struct uuid *);
+const struct ovsdb_row *ovsdb_table_find_by_index(
+    const struct ovsdb_table *, size_t index,
+    const struct ovsdb_datum *values[]);
 bool ovsdb_table_put_row(struct ovsdb_table *, struct ovsdb_row *);
 
 #endif /* ovsdb/table.h */
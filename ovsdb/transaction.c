@@ -29,6 +29,7 @@
 #include "ovsdb.h"
 #include "row.h"
 #include "table.h"
+#include "trigger.h"
 #include "uuid.h"
 
 struct ovsdb_txn {
@@ -43,6 +44,11 @@ struct ovsdb_txn_table {
     struct ovsdb_table *table;
     struct hmap txn_rows;       /* Contains "struct ovsdb_txn_row"s. */
 
+    /* This has the same form as the 'indexes' member of struct ovsdb_table,
+     * but it is only used or updated at transaction commit time, from
+     * check_index_uniqueness(). */
+    struct hmap *txn_indexes;
+
     /* Used by for_each_txn_row(). */
     unsigned int serial;        /* Serial number of in-progress iteration. */
     unsigned int n_processed;   /* Number of rows processed. */
@@ -374,6 +380,23 @@ static struct ovsdb_error *
 ovsdb_txn_row_commit(struct ovsdb_txn *txn OVS_UNUSED,
                      struct ovsdb_txn_row *txn_row)
 {
+    size_t n_indexes = txn_row->table->schema->n_indexes;
+    size_t i;
+
+    if (txn_row->old) {
+        for (i = 0; i < n_indexes; i++) {
+            struct hmap_node *node = ovsdb_row_get_index_node(txn_row->old, i);
+            hmap_remove(&txn_row->table->indexes[i], node);
+        }
+    }
+    if (txn_row->new) {
+        for (i = 0; i < n_indexes; i++) {
+            /* check_index_uniqueness() already set 'node->hash'. */
+            struct hmap_node *node = ovsdb_row_get_index_node(txn_row->new, i);
+            hmap_insert(&txn_row->table->indexes[i], node, node->hash);
+        }
+    }
+
     ovsdb_txn_row_prefree(txn_row);
     if (txn_row->new) {
         txn_row->new->n_refs = txn_row->n_refs;
@@ -574,6 +597,129 @@ check_max_rows(struct ovsdb_txn *txn)
     return NULL;
 }
 
+static struct ovsdb_error * WARN_UNUSED_RESULT
+duplicate_index_row(const struct ovsdb_column_set *index,
+                    const struct ovsdb_row *a, const struct ovsdb_row *b)
+{
+    const struct ovsdb_table_schema *ts = a->table->schema;
+    struct ovsdb_column_set data_columns;
+    struct ovsdb_error *error;
+    struct ds columns, values;
+    struct shash_node *node;
+    size_t i;
+
+    /* Put 'a' and 'b' in a predictable order, based on the values of their
+     * ordinary columns, to make error messages reproducible for testing. */
+    ovsdb_column_set_init(&data_columns);
+    SHASH_FOR_EACH (node, &ts->columns) {
+        const struct ovsdb_column *column = node->data;
+        if (column->index != OVSDB_COL_UUID
+            && column->index != OVSDB_COL_VERSION) {
+            ovsdb_column_set_add(&data_columns, column);
+        }
+    }
+    if (ovsdb_row_compare_columns_3way(a, b, &data_columns) > 0) {
+        const struct ovsdb_row *tmp = a;
+        a = b;
+        b = tmp;
+    }
+    ovsdb_column_set_destroy(&data_columns);
+
+    ds_init(&columns);
+    ds_init(&values);
+    for (i = 0; i < index->n_columns; i++) {
+        const struct ovsdb_column *column = index->columns[i];
+
+        if (i) {
+            ds_put_cstr(&columns, ", ");
+            ds_put_cstr(&values, ", ");
+        }
+        ds_put_cstr(&columns, column->name);
+        ovsdb_datum_to_string(&a->fields[column->index], &column->type,
+                              &values);
+    }
+
+    error = ovsdb_error("constraint violation",
+                       "Transaction causes multiple rows in \"%s\" table to "
+                       "have identical values (%s) for index on column(s) "
+                       "%s.  First row has UUID "UUID_FMT", second row has "
+                       "UUID "UUID_FMT".",
+                       ts->name, ds_cstr(&values),
+                       ds_cstr(&columns),
+                       UUID_ARGS(ovsdb_row_get_uuid(a)),
+                       UUID_ARGS(ovsdb_row_get_uuid(b)));
+    ds_destroy(&columns);
+    ds_destroy(&values);
+    return error;
+}
+
+/* Returns the row in 'index', which is index number 'i' in 'row''s table,
+ * whose values for the indexed columns are the same as 'row''s, or a null
+ * pointer if there is none.  'hash' must be the hash of 'row''s values for
+ * the indexed columns. */
+static struct ovsdb_row *
+ovsdb_index_search(struct hmap *index, struct ovsdb_row *row, size_t i,
+                   uint32_t hash)
+{
+    const struct ovsdb_table *table = row->table;
+    const struct ovsdb_column_set *columns = &table->schema->indexes[i];
+    struct hmap_node *node;
+
+    for (node = hmap_first_with_hash(index, hash); node;
+         node = hmap_next_with_hash(node)) {
+        struct ovsdb_row *irow = ovsdb_row_from_index_node(node, table, i);
+        if (ovsdb_row_equal_columns(row, irow, columns)) {
+            return irow;
+        }
+    }
+
+    return NULL;
+}
+
+/* Checks that the row that 'txn_row' will have after the transaction commits
+ * does not have the same values for the columns in any of its table's indexes
+ * as any other row that the table will have after the commit, that is, any
+ * other row that the transaction inserts or modifies or any row that the
+ * transaction leaves untouched. */
+static struct ovsdb_error * WARN_UNUSED_RESULT
+check_index_uniqueness(struct ovsdb_txn *txn OVS_UNUSED,
+                       struct ovsdb_txn_row *txn_row)
+{
+    struct ovsdb_txn_table *txn_table = txn_row->table->txn_table;
+    struct ovsdb_table *table = txn_row->table;
+    struct ovsdb_row *row = txn_row->new;
+    size_t i;
+
+    if (!row) {
+        return NULL;
+    }
+
+    for (i = 0; i < table->schema->n_indexes; i++) {
+        const struct ovsdb_column_set *index = &table->schema->indexes[i];
+        struct ovsdb_row *irow;
+        uint32_t hash;
+
+        hash = ovsdb_row_hash_columns(row, index, 0);
+        irow = ovsdb_index_search(&txn_table->txn_indexes[i], row, i, hash);
+        if (irow) {
+            return duplicate_index_row(index, irow, row);
+        }
+
+        /* A committed row that the transaction modifies or deletes has
+         * nonnull 'txn_row'.  Its new version, if any, is checked through
+         * 'txn_indexes' instead. */
+        irow = ovsdb_index_search(&table->indexes[i], row, i, hash);
+        if (irow && !irow->txn_row) {
+            return duplicate_index_row(index, irow, row);
+        }
+
+        hmap_insert(&txn_table->txn_indexes[i],
+                    ovsdb_row_get_index_node(row, i), hash);
+    }
+
+    return NULL;
+}
+
 struct ovsdb_error *
 ovsdb_txn_commit(struct ovsdb_txn *txn, bool durable)
 {
@@ -620,6 +766,13 @@ ovsdb_txn_commit(struct ovsdb_txn *txn, bool durable)
         return error;
     }
 
+    /* Verify that the indexes will still be unique post-transaction. */
+    error = for_each_txn_row(txn, check_index_uniqueness);
+    if (error) {
+        ovsdb_txn_abort(txn);
+        return error;
+    }
+
     /* Send the commit to each replica. */
     LIST_FOR_EACH (replica, node, &txn->db->replicas) {
         error = (replica->class->commit)(replica, txn, durable);
@@ -634,7 +787,7 @@ ovsdb_txn_commit(struct ovsdb_txn *txn, bool durable)
     }
 
     /* Finalize commit. */
-    txn->db->run_triggers = true;
+    ovsdb_trigger_note_txn(txn->db, txn);
     ovsdb_error_assert(for_each_txn_row(txn, ovsdb_txn_row_commit));
     ovsdb_txn_free(txn);
 
@@ -662,10 +815,16 @@ ovsdb_txn_create_txn_table(struct ovsdb_txn *txn, struct ovsdb_table *table)
 {
     if (!table->txn_table) {
         struct ovsdb_txn_table *txn_table;
+        size_t i;
 
         table->txn_table = txn_table = xmalloc(sizeof *table->txn_table);
         txn_table->table = table;
         hmap_init(&txn_table->txn_rows);
+        txn_table->txn_indexes = xmalloc(table->schema->n_indexes
+                                         * sizeof *txn_table->txn_indexes);
+        for (i = 0; i < table->schema->n_indexes; i++) {
+            hmap_init(&txn_table->txn_indexes[i]);
+        }
         txn_table->serial = serial - 1;
         list_push_back(&txn->txn_tables, &txn_table->node);
     }
@@ -798,7 +957,17 @@ ovsdb_txn_row_prefree(struct ovsdb_txn_row *txn_row)
 static void
 ovsdb_txn_table_destroy(struct ovsdb_txn_table *txn_table)
 {
+    size_t i;
+
     assert(hmap_is_empty(&txn_table->txn_rows));
+
+    /* The rows in 'txn_indexes' have either been moved into the table's own
+     * indexes or destroyed by now, so just free the hmaps' buckets. */
+    for (i = 0; i < txn_table->table->schema->n_indexes; i++) {
+        hmap_destroy(&txn_table->txn_indexes[i]);
+    }
+    free(txn_table->txn_indexes);
+
     txn_table->table->txn_table = NULL;
     hmap_destroy(&txn_table->txn_rows);
     list_remove(&txn_table->node);
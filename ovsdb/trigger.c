@@ -1,4 +1,4 @@
-/* Copyright (c) 2009, 2010 Nicira Networks
+/* Copyright (c) 2009, 2010, 2011 Nicira Networks
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -19,15 +19,48 @@
 
 #include <assert.h>
 #include <limits.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include "bitmap.h"
+#include "column.h"
+#include "hash.h"
 #include "json.h"
 #include "jsonrpc.h"
 #include "ovsdb.h"
+#include "ovsdb-error.h"
 #include "poll-loop.h"
+#include "row.h"
+#include "table.h"
+#include "transaction.h"
+
+/* A table that at least one blocked trigger watches. */
+struct ovsdb_trigger_table {
+    struct hmap_node hmap_node; /* In struct ovsdb's 'trigger_tables'. */
+    const struct ovsdb_table *table;
+    struct list watches;        /* Contains "struct ovsdb_trigger_watch"es. */
+
+    /* Changes committed since the last ovsdb_trigger_run(). */
+    bool dirty;                 /* Any change at all? */
+    bool rows_changed;          /* Rows inserted or deleted? */
+    unsigned long *changed;     /* Columns modified in existing rows. */
+};
+
+/* A trigger's interest in a table. */
+struct ovsdb_trigger_watch {
+    struct list node;           /* In ovsdb_trigger_table's 'watches'. */
+    struct ovsdb_trigger_table *tt;
+    struct ovsdb_trigger *trigger;
+    const struct ovsdb_table *table;
+    unsigned long *columns;     /* Columns of interest, null for all. */
+};
 
 static bool ovsdb_trigger_try(struct ovsdb *db, struct ovsdb_trigger *,
                               long long int now);
 static void ovsdb_trigger_complete(struct ovsdb_trigger *);
+static void ovsdb_trigger_block(struct ovsdb_trigger *);
+static void ovsdb_trigger_unblock(struct ovsdb_trigger *);
+static ovsdb_txn_row_cb_func ovsdb_trigger_note_change;
 
 void
 ovsdb_trigger_init(struct ovsdb *db, struct ovsdb_trigger *trigger,
@@ -40,12 +73,21 @@ ovsdb_trigger_init(struct ovsdb *db, struct ovsdb_trigger *trigger,
     trigger->result = NULL;
     trigger->created = now;
     trigger->timeout_msec = LLONG_MAX;
+    trigger->commit_seqno = 0;
+    trigger->db = db;
+    trigger->serial = ++db->trigger_serial;
+    trigger->watches = NULL;
+    trigger->n_watches = 0;
+    trigger->watching = false;
+    trigger->retry = false;
+    trigger->has_deadline = false;
     ovsdb_trigger_try(db, trigger, now);
 }
 
 void
 ovsdb_trigger_destroy(struct ovsdb_trigger *trigger)
 {
+    ovsdb_trigger_unblock(trigger);
     list_remove(&trigger->node);
     json_destroy(trigger->request);
     json_destroy(trigger->result);
@@ -54,7 +96,15 @@ ovsdb_trigger_destroy(struct ovsdb_trigger *trigger)
 bool
 ovsdb_trigger_is_complete(const struct ovsdb_trigger *trigger)
 {
-    return trigger->result != NULL;
+    return trigger->result != NULL && !trigger->commit_seqno;
+}
+
+/* Returns true if 'trigger''s transaction has committed but its result is
+ * being held until the commit becomes durable. */
+bool
+ovsdb_trigger_is_committing(const struct ovsdb_trigger *trigger)
+{
+    return trigger->commit_seqno != 0;
 }
 
 struct json *
@@ -65,44 +115,146 @@ ovsdb_trigger_steal_result(struct ovsdb_trigger *trigger)
     return result;
 }
 
+static int
+compare_triggers(const void *a_, const void *b_)
+{
+    const struct ovsdb_trigger *const *a = a_;
+    const struct ovsdb_trigger *const *b = b_;
+
+    return (*a)->serial < (*b)->serial ? -1 : (*a)->serial > (*b)->serial;
+}
+
+static bool
+ovsdb_trigger_watch_is_triggered(const struct ovsdb_trigger_watch *w)
+{
+    const struct ovsdb_trigger_table *tt = w->tt;
+    size_t n_longs;
+    size_t i;
+
+    if (tt->rows_changed || !w->columns) {
+        return true;
+    }
+
+    n_longs = bitmap_n_longs(shash_count(&w->table->schema->columns));
+    for (i = 0; i < n_longs; i++) {
+        if (w->columns[i] & tt->changed[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Adds 't' to the 'n' triggers in '*retry', unless it is already there. */
+static void
+schedule_retry(struct ovsdb_trigger *t, struct ovsdb_trigger ***retry,
+               size_t *n, size_t *allocated)
+{
+    if (!t->retry) {
+        t->retry = true;
+        if (*n >= *allocated) {
+            *retry = x2nrealloc(*retry, allocated, sizeof **retry);
+        }
+        (*retry)[(*n)++] = t;
+    }
+}
+
+/* Retries the triggers in 'db' that might now be able to complete: those that
+ * watch a table or column that a transaction changed since the last call, and
+ * those whose timeouts have expired.  Other blocked triggers are not
+ * examined. */
 void
 ovsdb_trigger_run(struct ovsdb *db, long long int now)
 {
-    struct ovsdb_trigger *t, *next;
-    bool run_triggers;
+    struct ovsdb_trigger **retry = NULL;
+    size_t n_retry = 0, allocated_retry = 0;
+    struct ovsdb_trigger_table *tt;
+    struct heap_node *node;
+    size_t i;
 
-    run_triggers = db->run_triggers;
-    db->run_triggers = false;
-    LIST_FOR_EACH_SAFE (t, next, node, &db->triggers) {
-        if (run_triggers || now - t->created >= t->timeout_msec) {
-            ovsdb_trigger_try(db, t, now);
+    if (db->run_triggers) {
+        db->run_triggers = false;
+        HMAP_FOR_EACH (tt, hmap_node, &db->trigger_tables) {
+            if (tt->dirty) {
+                struct ovsdb_trigger_watch *w;
+                size_t n_columns;
+
+                LIST_FOR_EACH (w, node, &tt->watches) {
+                    if (ovsdb_trigger_watch_is_triggered(w)) {
+                        schedule_retry(w->trigger, &retry, &n_retry,
+                                       &allocated_retry);
+                    }
+                }
+
+                n_columns = shash_count(&tt->table->schema->columns);
+                memset(tt->changed, 0, bitmap_n_bytes(n_columns));
+                tt->rows_changed = tt->dirty = false;
+            }
         }
     }
+
+    while ((node = heap_min(&db->trigger_deadlines)) != NULL
+           && node->priority <= now) {
+        struct ovsdb_trigger *t = CONTAINER_OF(node, struct ovsdb_trigger,
+                                               deadline_node);
+        heap_remove(&db->trigger_deadlines, node);
+        t->has_deadline = false;
+        schedule_retry(t, &retry, &n_retry, &allocated_retry);
+    }
+
+    /* Retry in order of creation, as if we examined every trigger.  If a
+     * retried trigger commits a change that unblocks another, the other is
+     * retried on the next call. */
+    qsort(retry, n_retry, sizeof *retry, compare_triggers);
+    for (i = 0; i < n_retry; i++) {
+        retry[i]->retry = false;
+        ovsdb_trigger_try(db, retry[i], now);
+    }
+    free(retry);
 }
 
 void
-ovsdb_trigger_wait(struct ovsdb *db, long long int now)
+ovsdb_trigger_wait(struct ovsdb *db, long long int now OVS_UNUSED)
 {
     if (db->run_triggers) {
         poll_immediate_wake();
     } else {
-        long long int deadline = LLONG_MAX;
-        struct ovsdb_trigger *t;
-
-        LIST_FOR_EACH (t, node, &db->triggers) {
-            if (t->created < LLONG_MAX - t->timeout_msec) {
-                long long int t_deadline = t->created + t->timeout_msec;
-                if (deadline > t_deadline) {
-                    deadline = t_deadline;
-                    if (now >= deadline) {
-                        break;
-                    }
-                }
-            }
+        const struct heap_node *node = heap_min(&db->trigger_deadlines);
+        if (node) {
+            poll_timer_wait_until(node->priority);
         }
+    }
+}
+
+/* Called just before 'txn' commits to 'db', to note changes to the tables
+ * and columns that blocked triggers are watching. */
+void
+ovsdb_trigger_note_txn(struct ovsdb *db, const struct ovsdb_txn *txn)
+{
+    if (!hmap_is_empty(&db->trigger_tables)) {
+        ovsdb_txn_for_each_change(txn, ovsdb_trigger_note_change, db);
+    }
+}
 
-        if (deadline < LLONG_MAX) {
-            poll_timer_wait_until(deadline);
+/* Reports that all of the asynchronous durable commits in 'db' numbered up to
+ * 'seqno' have been written to disk or, if 'error' is nonnull, that writing
+ * them failed.  Completes the triggers whose results were held for those
+ * commits, adding 'error', if any, to their results. */
+void
+ovsdb_trigger_commit_done(struct ovsdb *db, unsigned long long int seqno,
+                          const struct ovsdb_error *error)
+{
+    struct ovsdb_trigger *t, *next;
+
+    if (seqno > db->durable_seqno) {
+        db->durable_seqno = seqno;
+    }
+    LIST_FOR_EACH_SAFE (t, next, node, &db->triggers) {
+        if (t->commit_seqno && t->commit_seqno <= seqno) {
+            if (error) {
+                json_array_add(t->result, ovsdb_error_to_json(error));
+            }
+            t->commit_seqno = 0;
+            ovsdb_trigger_complete(t);
         }
     }
 }
@@ -110,12 +262,23 @@ ovsdb_trigger_wait(struct ovsdb *db, long long int now)
 static bool
 ovsdb_trigger_try(struct ovsdb *db, struct ovsdb_trigger *t, long long int now)
 {
+    unsigned long long int commit_seqno = db->commit_seqno;
+
     t->result = ovsdb_execute(db, t->request, now - t->created,
                               &t->timeout_msec);
     if (t->result) {
+        ovsdb_trigger_unblock(t);
+        if (db->commit_seqno != commit_seqno
+            && db->commit_seqno > db->durable_seqno) {
+            /* The transaction committed, but it is not yet durable.  Hold the
+             * result until it is. */
+            t->commit_seqno = db->commit_seqno;
+            return false;
+        }
         ovsdb_trigger_complete(t);
         return true;
     } else {
+        ovsdb_trigger_block(t);
         return false;
     }
 }
@@ -127,3 +290,232 @@ ovsdb_trigger_complete(struct ovsdb_trigger *t)
     list_remove(&t->node);
     list_push_back(t->completion, &t->node);
 }
+
+static struct ovsdb_trigger_table *
+ovsdb_trigger_table_find(const struct ovsdb *db,
+                         const struct ovsdb_table *table)
+{
+    struct ovsdb_trigger_table *tt;
+
+    HMAP_FOR_EACH_WITH_HASH (tt, hmap_node, hash_pointer(table, 0),
+                             &db->trigger_tables) {
+        if (tt->table == table) {
+            return tt;
+        }
+    }
+    return NULL;
+}
+
+static bool
+ovsdb_trigger_note_change(const struct ovsdb_row *old,
+                          const struct ovsdb_row *new,
+                          const unsigned long int *changed, void *db_)
+{
+    struct ovsdb *db = db_;
+    const struct ovsdb_table *table = (old ? old : new)->table;
+    struct ovsdb_trigger_table *tt;
+
+    tt = ovsdb_trigger_table_find(db, table);
+    if (tt) {
+        if (old && new) {
+            size_t n_columns = shash_count(&table->schema->columns);
+            size_t i;
+
+            for (i = 0; i < bitmap_n_longs(n_columns); i++) {
+                tt->changed[i] |= changed[i];
+            }
+        } else {
+            tt->rows_changed = true;
+        }
+        tt->dirty = true;
+        db->run_triggers = true;
+    }
+    return true;
+}
+
+/* Sets the bit in 'columns' for each of the columns in 'ts' named in 'json',
+ * which must be an array of column names or, if 'conditions' is true, an
+ * array of conditions [<column>, <function>, <value>].  Returns false if
+ * 'json' is malformed or names an unknown column. */
+static bool
+ovsdb_trigger_parse_columns(const struct ovsdb_table_schema *ts,
+                            const struct json *json, bool conditions,
+                            unsigned long *columns)
+{
+    const struct json_array *array;
+    size_t i;
+
+    if (json->type != JSON_ARRAY) {
+        return false;
+    }
+
+    array = json_array(json);
+    for (i = 0; i < array->n; i++) {
+        const struct ovsdb_column *column;
+        const struct json *name = array->elems[i];
+
+        if (conditions) {
+            if (name->type != JSON_ARRAY || !json_array(name)->n) {
+                return false;
+            }
+            name = json_array(name)->elems[0];
+        }
+        if (name->type != JSON_STRING) {
+            return false;
+        }
+
+        column = ovsdb_table_schema_get_column(ts, json_string(name));
+        if (!column) {
+            return false;
+        }
+        bitmap_set1(columns, column->index);
+    }
+    return true;
+}
+
+/* Returns a bitmap of the columns in 'table' that the "wait" operation 'op'
+ * examines, or a null pointer if it examines all of them or we cannot tell.
+ * Inserting or deleting rows always matters to a "wait", so only modified
+ * rows can be filtered by column. */
+static unsigned long *
+ovsdb_trigger_wait_columns(const struct ovsdb_table *table,
+                           const struct json *op)
+{
+    const struct ovsdb_table_schema *ts = table->schema;
+    const struct json *where, *columns_json;
+    unsigned long *columns;
+
+    where = shash_find_data(json_object(op), "where");
+    columns_json = shash_find_data(json_object(op), "columns");
+    if (!where || !columns_json) {
+        return NULL;
+    }
+
+    columns = bitmap_allocate(shash_count(&ts->columns));
+    if (!ovsdb_trigger_parse_columns(ts, where, true, columns)
+        || !ovsdb_trigger_parse_columns(ts, columns_json, false, columns)) {
+        bitmap_free(columns);
+        return NULL;
+    }
+    return columns;
+}
+
+/* Registers watches for each table that 't''s request operates on: the
+ * columns that a "wait" operation examines, all columns for any other
+ * operation, since an earlier operation in the same transaction can affect
+ * what a "wait" sees.
+ *
+ * Operations that are malformed or that name an unknown table are skipped:
+ * executing one of those fails the whole request, so if one of them precedes
+ * the "wait" that blocked, the trigger cannot be blocked at all, and if one
+ * follows it, it does not affect whether the trigger stays blocked. */
+static void
+ovsdb_trigger_watch_request(struct ovsdb_trigger *t)
+{
+    const struct json_array *ops;
+    size_t i;
+
+    if (t->request->type != JSON_ARRAY) {
+        return;
+    }
+
+    ops = json_array(t->request);
+    t->watches = xmalloc(ops->n * sizeof *t->watches);
+    for (i = 1; i < ops->n; i++) {
+        const struct json *op = ops->elems[i];
+        const struct json *op_name, *table_name;
+        struct ovsdb_trigger_table *tt;
+        struct ovsdb_trigger_watch *w;
+        struct ovsdb_table *table;
+
+        if (op->type != JSON_OBJECT) {
+            continue;
+        }
+        table_name = shash_find_data(json_object(op), "table");
+        if (!table_name || table_name->type != JSON_STRING) {
+            continue;
+        }
+        table = ovsdb_get_table(t->db, json_string(table_name));
+        if (!table) {
+            continue;
+        }
+
+        tt = ovsdb_trigger_table_find(t->db, table);
+        if (!tt) {
+            tt = xmalloc(sizeof *tt);
+            hmap_insert(&t->db->trigger_tables, &tt->hmap_node,
+                        hash_pointer(table, 0));
+            tt->table = table;
+            list_init(&tt->watches);
+            tt->dirty = tt->rows_changed = false;
+            tt->changed = bitmap_allocate(
+                shash_count(&table->schema->columns));
+        }
+
+        w = &t->watches[t->n_watches++];
+        list_push_back(&tt->watches, &w->node);
+        w->tt = tt;
+        w->trigger = t;
+        w->table = table;
+        op_name = shash_find_data(json_object(op), "op");
+        w->columns = (op_name && op_name->type == JSON_STRING
+                      && !strcmp(json_string(op_name), "wait")
+                      ? ovsdb_trigger_wait_columns(table, op)
+                      : NULL);
+    }
+}
+
+/* Called when 't' cannot complete yet, to make sure that it will be retried
+ * when a table that it depends on changes or when its timeout expires. */
+static void
+ovsdb_trigger_block(struct ovsdb_trigger *t)
+{
+    struct heap *deadlines = &t->db->trigger_deadlines;
+
+    if (!t->watching) {
+        ovsdb_trigger_watch_request(t);
+        t->watching = true;
+    }
+
+    if (t->created < LLONG_MAX - t->timeout_msec) {
+        long long int deadline = t->created + t->timeout_msec;
+        if (t->has_deadline) {
+            heap_change(deadlines, &t->deadline_node, deadline);
+        } else {
+            heap_insert(deadlines, &t->deadline_node, deadline);
+            t->has_deadline = true;
+        }
+    } else if (t->has_deadline) {
+        heap_remove(deadlines, &t->deadline_node);
+        t->has_deadline = false;
+    }
+}
+
+/* Unregisters 't''s watches and deadline, if any. */
+static void
+ovsdb_trigger_unblock(struct ovsdb_trigger *t)
+{
+    size_t i;
+
+    for (i = 0; i < t->n_watches; i++) {
+        struct ovsdb_trigger_watch *w = &t->watches[i];
+        struct ovsdb_trigger_table *tt = w->tt;
+
+        list_remove(&w->node);
+        if (list_is_empty(&tt->watches)) {
+            hmap_remove(&t->db->trigger_tables, &tt->hmap_node);
+            bitmap_free(tt->changed);
+            free(tt);
+        }
+        bitmap_free(w->columns);
+    }
+    free(t->watches);
+    t->watches = NULL;
+    t->n_watches = 0;
+    t->watching = false;
+
+    if (t->has_deadline) {
+        heap_remove(&t->db->trigger_deadlines, &t->deadline_node);
+        t->has_deadline = false;
+    }
+}
@@ -16,9 +16,13 @@
 #ifndef OVSDB_TRIGGER_H
 #define OVSDB_TRIGGER_H 1
 
+#include "heap.h"
 #include "list.h"
 
 struct ovsdb;
+struct ovsdb_error;
+struct ovsdb_trigger_watch;
+struct ovsdb_txn;
 
 struct ovsdb_trigger {
     struct list node;           /* !result: in struct ovsdb "triggers" list;
@@ -28,6 +32,19 @@ struct ovsdb_trigger {
     struct json *result;        /* Result (null if none yet). */
     long long int created;      /* Time created. */
     long long int timeout_msec; /* Max wait duration. */
+    unsigned long long int commit_seqno; /* Nonzero: 'result' is held until
+                                          * this commit becomes durable. */
+
+    /* While the trigger is blocked, it is retried only when one of the tables
+     * and columns in 'watches' changes or when its deadline passes. */
+    struct ovsdb *db;
+    unsigned long long int serial; /* Creation order, to retry fairly. */
+    struct ovsdb_trigger_watch *watches;
+    size_t n_watches;
+    bool watching;              /* 'watches' registered with 'db'? */
+    bool retry;                 /* Scheduled by ovsdb_trigger_run()? */
+    struct heap_node deadline_node; /* In 'db''s 'trigger_deadlines' heap. */
+    bool has_deadline;          /* 'deadline_node' in heap? */
 };
 
 void ovsdb_trigger_init(struct ovsdb *, struct ovsdb_trigger *,
@@ -36,9 +53,14 @@ void ovsdb_trigger_init(struct ovsdb *, struct ovsdb_trigger *,
 void ovsdb_trigger_destroy(struct ovsdb_trigger *);
 
 bool ovsdb_trigger_is_complete(const struct ovsdb_trigger *);
+bool ovsdb_trigger_is_committing(const struct ovsdb_trigger *);
 struct json *ovsdb_trigger_steal_result(struct ovsdb_trigger *);
 
 void ovsdb_trigger_run(struct ovsdb *, long long int now);
 void ovsdb_trigger_wait(struct ovsdb *, long long int now);
 
+void ovsdb_trigger_note_txn(struct ovsdb *, const struct ovsdb_txn *);
+void ovsdb_trigger_commit_done(struct ovsdb *, unsigned long long int seqno,
+                               const struct ovsdb_error *);
+
 #endif /* ovsdb/trigger.h */
@@ -136,12 +136,13 @@ class IdlSchema(DbSchema):
 
 class TableSchema(object):
     def __init__(self, name, columns, mutable=True, max_rows=sys.maxint,
-                 is_root=True):
+                 is_root=True, indexes=None):
         self.name = name
         self.columns = columns
         self.mutable = mutable
         self.max_rows = max_rows
         self.is_root = is_root
+        self.indexes = indexes or []
 
     @staticmethod
     def from_json(json, name):
@@ -150,6 +151,7 @@ class TableSchema(object):
         mutable = parser.get_optional("mutable", [bool], True)
         max_rows = parser.get_optional("maxRows", [int])
         is_root = parser.get_optional("isRoot", [bool], False)
+        indexes_json = parser.get_optional("indexes", [list], [])
         parser.finish()
 
         if max_rows == None:
@@ -170,7 +172,27 @@ class TableSchema(object):
             columns[columnName] = ColumnSchema.from_json(columnJson,
                                                          columnName)
 
-        return TableSchema(name, columns, mutable, max_rows, is_root)
+        indexes = []
+        for index in indexes_json:
+            if (type(index) != list
+                or [x for x in index if type(x) not in [str, unicode]]
+                or len(set(index)) != len(index)):
+                raise error.Error("array of distinct column names expected",
+                                  json)
+            for column_name in index:
+                if column_name in ["_uuid", "_version"]:
+                    continue
+                elif column_name not in columns:
+                    raise error.Error("%s is not a valid column name"
+                                      % column_name, json)
+                elif not columns[column_name].persistent:
+                    raise error.Error("ephemeral columns (such as %s) may "
+                                      "not be indexed" % column_name, json)
+            if not index:
+                raise error.Error("index must have at least one column", json)
+            indexes.append(index)
+
+        return TableSchema(name, columns, mutable, max_rows, is_root, indexes)
 
     def to_json(self, default_is_root=False):
         """Returns this table schema serialized into JSON.
@@ -198,6 +220,11 @@ class TableSchema(object):
         if self.max_rows != sys.maxint:
             json["maxRows"] = self.max_rows
 
+        if self.indexes:
+            json["indexes"] = []
+            for index in self.indexes:
+                json["indexes"].append(index)
+
         return json
 
 class ColumnSchema(object):
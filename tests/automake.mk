@@ -27,6 +27,7 @@ TESTSUITE_AT = \
 	tests/reconnect.at \
 	tests/ofproto-macros.at \
 	tests/ofproto.at \
+	tests/dpif-netdev.at \
 	tests/ovsdb.at \
 	tests/ovsdb-log.at \
 	tests/ovsdb-types.at \
@@ -47,6 +48,7 @@ TESTSUITE_AT = \
 	tests/ovsdb-idl.at \
 	tests/ovsdb-idl-py.at \
 	tests/ovs-vsctl.at \
+	tests/bridge.at \
 	tests/interface-reconfigure.at
 TESTSUITE = $(srcdir)/tests/testsuite
 DISTCLEANFILES += tests/atconfig tests/atlocal
@@ -69,16 +71,21 @@ lcov_wrappers = \
 	tests/lcov/test-classifier \
 	tests/lcov/test-csum \
 	tests/lcov/test-file_name \
+	tests/lcov/test-flow-mod \
 	tests/lcov/test-flows \
 	tests/lcov/test-hash \
+	tests/lcov/test-heap \
 	tests/lcov/test-hmap \
 	tests/lcov/test-json \
 	tests/lcov/test-jsonrpc \
 	tests/lcov/test-list \
 	tests/lcov/test-lockfile \
 	tests/lcov/test-multipath \
+	tests/lcov/test-netdev-linux \
 	tests/lcov/test-ovsdb \
 	tests/lcov/test-packets \
+	tests/lcov/test-pinsched \
+	tests/lcov/test-pool \
 	tests/lcov/test-random \
 	tests/lcov/test-reconnect \
 	tests/lcov/test-sha1 \
@@ -121,16 +128,21 @@ valgrind_wrappers = \
 	tests/valgrind/test-classifier \
 	tests/valgrind/test-csum \
 	tests/valgrind/test-file_name \
+	tests/valgrind/test-flow-mod \
 	tests/valgrind/test-flows \
 	tests/valgrind/test-hash \
+	tests/valgrind/test-heap \
 	tests/valgrind/test-hmap \
 	tests/valgrind/test-json \
 	tests/valgrind/test-jsonrpc \
 	tests/valgrind/test-list \
 	tests/valgrind/test-lockfile \
 	tests/valgrind/test-multipath \
+	tests/valgrind/test-netdev-linux \
 	tests/valgrind/test-ovsdb \
 	tests/valgrind/test-packets \
+	tests/valgrind/test-pinsched \
+	tests/valgrind/test-pool \
 	tests/valgrind/test-random \
 	tests/valgrind/test-reconnect \
 	tests/valgrind/test-sha1 \
@@ -195,6 +207,10 @@ noinst_PROGRAMS += tests/test-file_name
 tests_test_file_name_SOURCES = tests/test-file_name.c
 tests_test_file_name_LDADD = lib/libopenvswitch.a
 
+noinst_PROGRAMS += tests/test-flow-mod
+tests_test_flow_mod_SOURCES = tests/test-flow-mod.c
+tests_test_flow_mod_LDADD = lib/libopenvswitch.a
+
 noinst_PROGRAMS += tests/test-flows
 tests_test_flows_SOURCES = tests/test-flows.c
 tests_test_flows_LDADD = lib/libopenvswitch.a
@@ -204,6 +220,10 @@ noinst_PROGRAMS += tests/test-hash
 tests_test_hash_SOURCES = tests/test-hash.c
 tests_test_hash_LDADD = lib/libopenvswitch.a
 
+noinst_PROGRAMS += tests/test-heap
+tests_test_heap_SOURCES = tests/test-heap.c
+tests_test_heap_LDADD = lib/libopenvswitch.a
+
 noinst_PROGRAMS += tests/test-hmap
 tests_test_hmap_SOURCES = tests/test-hmap.c
 tests_test_hmap_LDADD = lib/libopenvswitch.a
@@ -228,10 +248,24 @@ noinst_PROGRAMS += tests/test-multipath
 tests_test_multipath_SOURCES = tests/test-multipath.c
 tests_test_multipath_LDADD = lib/libopenvswitch.a
 
+if HAVE_NETLINK
+noinst_PROGRAMS += tests/test-netdev-linux
+tests_test_netdev_linux_SOURCES = tests/test-netdev-linux.c
+tests_test_netdev_linux_LDADD = lib/libopenvswitch.a
+endif
+
 noinst_PROGRAMS += tests/test-packets
 tests_test_packets_SOURCES = tests/test-packets.c
 tests_test_packets_LDADD = lib/libopenvswitch.a
 
+noinst_PROGRAMS += tests/test-pinsched
+tests_test_pinsched_SOURCES = tests/test-pinsched.c
+tests_test_pinsched_LDADD = ofproto/libofproto.a lib/libopenvswitch.a
+
+noinst_PROGRAMS += tests/test-pool
+tests_test_pool_SOURCES = tests/test-pool.c
+tests_test_pool_LDADD = lib/libopenvswitch.a
+
 noinst_PROGRAMS += tests/test-random
 tests_test_random_SOURCES = tests/test-random.c
 tests_test_random_LDADD = lib/libopenvswitch.a
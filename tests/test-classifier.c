@@ -34,6 +34,7 @@
 #include "flow.h"
 #include "ofp-util.h"
 #include "packets.h"
+#include "timeval.h"
 #include "unaligned.h"
 
 #undef NDEBUG
@@ -341,6 +342,30 @@ get_value(unsigned int *x, unsigned n_values)
     return rem;
 }
 
+/* Initializes 'flow' with a random combination of the test values. */
+static void
+make_random_flow(struct flow *flow)
+{
+    unsigned int x;
+
+    memset(flow, 0, sizeof *flow);
+    x = rand () % N_FLOW_VALUES;
+    flow->nw_src = nw_src_values[get_value(&x, N_NW_SRC_VALUES)];
+    flow->nw_dst = nw_dst_values[get_value(&x, N_NW_DST_VALUES)];
+    flow->tun_id = tun_id_values[get_value(&x, N_TUN_ID_VALUES)];
+    flow->in_port = in_port_values[get_value(&x, N_IN_PORT_VALUES)];
+    flow->vlan_tci = vlan_tci_values[get_value(&x, N_VLAN_TCI_VALUES)];
+    flow->dl_type = dl_type_values[get_value(&x, N_DL_TYPE_VALUES)];
+    flow->tp_src = tp_src_values[get_value(&x, N_TP_SRC_VALUES)];
+    flow->tp_dst = tp_dst_values[get_value(&x, N_TP_DST_VALUES)];
+    memcpy(flow->dl_src, dl_src_values[get_value(&x, N_DL_SRC_VALUES)],
+           ETH_ADDR_LEN);
+    memcpy(flow->dl_dst, dl_dst_values[get_value(&x, N_DL_DST_VALUES)],
+           ETH_ADDR_LEN);
+    flow->nw_proto = nw_proto_values[get_value(&x, N_NW_PROTO_VALUES)];
+    flow->nw_tos = nw_tos_values[get_value(&x, N_NW_TOS_VALUES)];
+}
+
 static void
 compare_classifiers(struct classifier *cls, struct tcls *tcls)
 {
@@ -351,24 +376,8 @@ compare_classifiers(struct classifier *cls, struct tcls *tcls)
     for (i = 0; i < confidence; i++) {
         struct cls_rule *cr0, *cr1;
         struct flow flow;
-        unsigned int x;
-
-        x = rand () % N_FLOW_VALUES;
-        flow.nw_src = nw_src_values[get_value(&x, N_NW_SRC_VALUES)];
-        flow.nw_dst = nw_dst_values[get_value(&x, N_NW_DST_VALUES)];
-        flow.tun_id = tun_id_values[get_value(&x, N_TUN_ID_VALUES)];
-        flow.in_port = in_port_values[get_value(&x, N_IN_PORT_VALUES)];
-        flow.vlan_tci = vlan_tci_values[get_value(&x, N_VLAN_TCI_VALUES)];
-        flow.dl_type = dl_type_values[get_value(&x, N_DL_TYPE_VALUES)];
-        flow.tp_src = tp_src_values[get_value(&x, N_TP_SRC_VALUES)];
-        flow.tp_dst = tp_dst_values[get_value(&x, N_TP_DST_VALUES)];
-        memcpy(flow.dl_src, dl_src_values[get_value(&x, N_DL_SRC_VALUES)],
-               ETH_ADDR_LEN);
-        memcpy(flow.dl_dst, dl_dst_values[get_value(&x, N_DL_DST_VALUES)],
-               ETH_ADDR_LEN);
-        flow.nw_proto = nw_proto_values[get_value(&x, N_NW_PROTO_VALUES)];
-        flow.nw_tos = nw_tos_values[get_value(&x, N_NW_TOS_VALUES)];
 
+        make_random_flow(&flow);
         cr0 = classifier_lookup(cls, &flow);
         cr1 = tcls_lookup(tcls, &flow);
         assert((cr0 == NULL) == (cr1 == NULL));
@@ -408,9 +417,12 @@ check_tables(const struct classifier *cls,
     int found_rules = 0;
     int found_dups = 0;
     int found_rules2 = 0;
+    unsigned int prev_max_priority;
 
     flow_wildcards_init_exact(&exact_wc);
     HMAP_FOR_EACH (table, hmap_node, &cls->tables) {
+        unsigned int max_priority = 0;
+        unsigned int max_count = 0;
         const struct cls_rule *head;
 
         assert(!hmap_is_empty(&table->rules));
@@ -420,6 +432,13 @@ check_tables(const struct classifier *cls,
             unsigned int prev_priority = UINT_MAX;
             const struct cls_rule *rule;
 
+            if (head->priority > max_priority || !max_count) {
+                max_priority = head->priority;
+                max_count = 1;
+            } else if (head->priority == max_priority) {
+                max_count++;
+            }
+
             found_rules++;
             LIST_FOR_EACH (rule, list, &head->list) {
                 assert(rule->priority < prev_priority);
@@ -429,9 +448,12 @@ check_tables(const struct classifier *cls,
                 assert(classifier_find_rule_exactly(cls, rule) == rule);
             }
         }
+        assert(table->max_priority == max_priority);
+        assert(table->max_count == max_count);
     }
 
     assert(found_tables == hmap_count(&cls->tables));
+    assert(found_tables == list_size(&cls->tables_priority));
     assert(n_tables == -1 || n_tables == hmap_count(&cls->tables));
     assert(n_rules == -1 || found_rules == n_rules);
     assert(n_dups == -1 || found_dups == n_dups);
@@ -441,6 +463,12 @@ check_tables(const struct classifier *cls,
         found_rules2++;
     }
     assert(found_rules == found_rules2);
+
+    prev_max_priority = UINT_MAX;
+    LIST_FOR_EACH (table, list_node, &cls->tables_priority) {
+        assert(table->max_priority <= prev_max_priority);
+        prev_max_priority = table->max_priority;
+    }
 }
 
 static struct test_rule *
@@ -454,6 +482,11 @@ make_rule(int wc_fields, unsigned int priority, int value_pat)
     for (f = &cls_fields[0]; f < &cls_fields[CLS_N_FIELDS]; f++) {
         int f_idx = f - cls_fields;
         int value_idx = (value_pat & (1u << f_idx)) != 0;
+
+        if (wc_fields & (1u << f_idx)) {
+            continue;
+        }
+
         memcpy((char *) &rule->cls_rule.flow + f->ofs,
                values[f_idx][value_idx], f->len);
 
@@ -880,6 +913,78 @@ test_many_rules_in_five_tables(int argc OVS_UNUSED, char *argv[] OVS_UNUSED)
     test_many_rules_in_n_tables(5);
 }
 
+/* Measures the rate of classifier_lookup() calls, for classifiers with an
+ * increasing number of tables, and prints the results.
+ *
+ * The optional argument is the number of lookups to time for each number of
+ * tables (default 1000000). */
+static void
+benchmark(int argc, char *argv[])
+{
+    enum { RULES_PER_TABLE = 4 };
+    int n_lookups = argc > 1 ? atoi(argv[1]) : 1000000;
+    int n_tables;
+
+    srand(0);
+    for (n_tables = 1; n_tables <= 1024; n_tables *= 2) {
+        struct test_rule *rule, *next_rule;
+        struct cls_cursor cursor;
+        struct classifier cls;
+        long long int start, elapsed;
+        struct flow *flows;
+        int *wcfs;
+        int n_hits;
+        int i;
+
+        classifier_init(&cls);
+        wcfs = xmalloc(n_tables * sizeof *wcfs);
+        for (i = 0; i < n_tables; i++) {
+            int j;
+
+            do {
+                wcfs[i] = rand() & ((1u << CLS_N_FIELDS) - 1);
+            } while (!wcfs[i] || array_contains(wcfs, i, wcfs[i]));
+
+            for (j = 0; j < RULES_PER_TABLE; j++) {
+                int value_pat = rand() & ((1u << CLS_N_FIELDS) - 1);
+
+                rule = make_rule(wcfs[i], rand() % (UINT16_MAX + 1),
+                                 value_pat);
+                free(test_rule_from_cls_rule(
+                         classifier_insert(&cls, &rule->cls_rule)));
+            }
+        }
+        free(wcfs);
+
+        flows = xmalloc(1024 * sizeof *flows);
+        for (i = 0; i < 1024; i++) {
+            make_random_flow(&flows[i]);
+        }
+
+        n_hits = 0;
+        time_refresh();
+        start = time_msec();
+        for (i = 0; i < n_lookups; i++) {
+            n_hits += classifier_lookup(&cls, &flows[i % 1024]) != NULL;
+        }
+        time_refresh();
+        elapsed = MAX(time_msec() - start, 1);
+
+        printf("%5d tables, %5d rules: %10lld lookups/s (%d%% hits)\n",
+               n_tables, classifier_count(&cls),
+               n_lookups * 1000LL / elapsed,
+               n_lookups ? (int) (n_hits * 100LL / n_lookups) : 0);
+
+        free(flows);
+        cls_cursor_init(&cursor, &cls, NULL);
+        CLS_CURSOR_FOR_EACH_SAFE (rule, next_rule, cls_rule, &cursor) {
+            classifier_remove(&cls, &rule->cls_rule);
+            free(rule);
+        }
+        classifier_destroy(&cls);
+    }
+}
+
 static const struct command commands[] = {
     {"empty", 0, 0, test_empty},
     {"destroy-null", 0, 0, test_destroy_null},
@@ -889,6 +994,7 @@ static const struct command commands[] = {
     {"many-rules-in-one-table", 0, 0, test_many_rules_in_one_table},
     {"many-rules-in-two-tables", 0, 0, test_many_rules_in_two_tables},
     {"many-rules-in-five-tables", 0, 0, test_many_rules_in_five_tables},
+    {"benchmark", 0, 1, benchmark},
     {NULL, 0, 0, NULL},
 };
 
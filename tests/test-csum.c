@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "crc32c.h"
 #include "random.h"
 #include "unaligned.h"
 #include "util.h"
@@ -132,6 +133,36 @@ test_rfc1624(void)
     mark('#');
 }
 
+/* Check crc32c() against the examples in RFC 3720 section B.4 and the usual
+ * "123456789" check value. */
+static void
+test_crc32c(void)
+{
+    uint8_t data[32];
+    int i;
+
+    memset(data, 0, sizeof data);
+    assert(crc32c(data, sizeof data) == 0x8a9136aa);
+
+    memset(data, 0xff, sizeof data);
+    assert(crc32c(data, sizeof data) == 0x62a8ab43);
+
+    for (i = 0; i < sizeof data; i++) {
+        data[i] = i;
+    }
+    assert(crc32c(data, sizeof data) == 0x46dd794e);
+
+    for (i = 0; i < sizeof data; i++) {
+        data[i] = 31 - i;
+    }
+    assert(crc32c(data, sizeof data) == 0x113fdb5c);
+
+    assert(crc32c("123456789", 9) == 0xe3069283);
+    assert(crc32c("", 0) == 0);
+
+    mark('#');
+}
+
 int
 main(void)
 {
@@ -193,6 +224,7 @@ main(void)
     }
 
     test_rfc1624();
+    test_crc32c();
 
     /* Test recalc_csum16(). */
     for (i = 0; i < 32; i++) {
@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2011 Nicira Networks.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* A test for encoding and decoding flow_mods, in ofp-util.c and nx-match.c. */
+
+#include <config.h>
+#include <netinet/icmp6.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "byte-order.h"
+#include "classifier.h"
+#include "command-line.h"
+#include "ofp-util.h"
+#include "ofpbuf.h"
+#include "openflow/nicira-ext.h"
+#include "openflow/openflow.h"
+#include "packets.h"
+#include "random.h"
+#include "timeval.h"
+#include "util.h"
+
+#undef NDEBUG
+#include <assert.h>
+
+/* Initializes 'rule' as one of a handful of kinds of rules typical of what a
+ * controller installs, with random field values.  If 'nxm' is true, some of
+ * the rules use fields or masks that only NXM can express. */
+static void
+make_random_rule(struct cls_rule *rule, bool nxm)
+{
+    uint8_t mac[ETH_ADDR_LEN];
+
+    cls_rule_init_catchall(rule, random_uint16());
+    cls_rule_set_in_port(rule, random_range(48) + 1);
+
+    switch (random_range(nxm ? 6 : 4)) {
+    case 0:
+        /* L2 learning. */
+        random_bytes(mac, sizeof mac);
+        mac[0] &= ~1;
+        cls_rule_set_dl_src(rule, mac);
+        random_bytes(mac, sizeof mac);
+        cls_rule_set_dl_dst(rule, mac);
+        cls_rule_set_dl_vlan(rule, htons(random_range(4095)));
+        break;
+
+    case 1:
+        /* TCP 5-tuple, with a CIDR source. */
+        cls_rule_set_dl_type(rule, htons(ETH_TYPE_IP));
+        cls_rule_set_nw_src_masked(rule, htonl(random_uint32()),
+                                   htonl(0xffffff00));
+        cls_rule_set_nw_dst(rule, htonl(random_uint32()));
+        cls_rule_set_nw_proto(rule, IPPROTO_TCP);
+        cls_rule_set_tp_src(rule, htons(random_uint16()));
+        cls_rule_set_tp_dst(rule, htons(random_uint16()));
+        break;
+
+    case 2:
+        /* UDP with a ToS. */
+        cls_rule_set_dl_type(rule, htons(ETH_TYPE_IP));
+        cls_rule_set_nw_tos(rule, random_uint8() & ~3);
+        cls_rule_set_nw_dst(rule, htonl(random_uint32()));
+        cls_rule_set_nw_proto(rule, IPPROTO_UDP);
+        cls_rule_set_tp_dst(rule, htons(random_uint16()));
+        break;
+
+    case 3:
+        /* ARP. */
+        cls_rule_set_dl_type(rule, htons(ETH_TYPE_ARP));
+        cls_rule_set_nw_proto(rule, ARP_OP_REQUEST);
+        cls_rule_set_nw_src(rule, htonl(random_uint32()));
+        cls_rule_set_nw_dst(rule, htonl(random_uint32()));
+        break;
+
+    case 4:
+        /* Tunnel ID, registers, and an Ethernet multicast bit. */
+        cls_rule_set_tun_id_masked(rule, htonll(random_uint32()),
+                                   htonll(UINT32_MAX));
+        cls_rule_set_reg(rule, 0, random_uint32());
+        cls_rule_set_reg_masked(rule, 1, random_uint32(), 0xffff0000);
+        memset(mac, 0, sizeof mac);
+        mac[0] = random_uint8() & 1;
+        rule->wc.wildcards &= ~FWW_ETH_MCAST;
+        memcpy(rule->flow.dl_dst, mac, sizeof mac);
+        break;
+
+    case 5:
+        /* ICMPv6 neighbor solicitation. */
+        {
+            struct in6_addr addr, mask;
+
+            cls_rule_set_dl_type(rule, htons(ETH_TYPE_IPV6));
+            random_bytes(&addr, sizeof addr);
+            memset(&mask, 0xff, 8);
+            memset((char *) &mask + 8, 0, 8);
+            cls_rule_set_ipv6_src_masked(rule, &addr, &mask);
+            random_bytes(&addr, sizeof addr);
+            cls_rule_set_ipv6_dst(rule, &addr);
+            cls_rule_set_nw_proto(rule, IPPROTO_ICMPV6);
+            cls_rule_set_icmp_type(rule, ND_NEIGHBOR_SOLICIT);
+            cls_rule_set_icmp_code(rule, 0);
+            random_bytes(&addr, sizeof addr);
+            cls_rule_set_nd_target(rule, addr);
+            random_bytes(mac, sizeof mac);
+            cls_rule_set_arp_sha(rule, mac);
+        }
+        break;
+
+    default:
+        NOT_REACHED();
+    }
+}
+
+/* Encodes a random flow_mod in 'flow_format' and returns it. */
+static struct ofpbuf *
+make_random_flow_mod(enum nx_flow_format flow_format, struct flow_mod *fm)
+{
+    static struct ofp_action_output output;
+
+    make_random_rule(&fm->cr, flow_format == NXFF_NXM);
+    fm->cookie = htonll(random_uint32());
+    fm->command = OFPFC_ADD;
+    fm->idle_timeout = random_range(60);
+    fm->hard_timeout = 0;
+    fm->buffer_id = UINT32_MAX;
+    fm->out_port = OFPP_NONE;
+    fm->flags = 0;
+
+    output.type = htons(OFPAT_OUTPUT);
+    output.len = htons(sizeof output);
+    output.port = htons(random_range(48) + 1);
+    fm->actions = (union ofp_action *) &output;
+    fm->n_actions = 1;
+
+    return ofputil_encode_flow_mod(fm, flow_format);
+}
+
+static enum nx_flow_format
+parse_flow_format(const char *s)
+{
+    if (!strcmp(s, "openflow10")) {
+        return NXFF_OPENFLOW10;
+    } else if (!strcmp(s, "nxm")) {
+        return NXFF_NXM;
+    } else {
+        ovs_fatal(0, "%s: unknown flow format (use \"openflow10\" or "
+                  "\"nxm\")", s);
+    }
+}
+
+/* Encodes many random flow_mods in each flow format, decodes them again, and
+ * checks that the decoded flow_mods are the same as the originals. */
+static void
+test_round_trip(int argc OVS_UNUSED, char *argv[] OVS_UNUSED)
+{
+    static const enum nx_flow_format formats[] = { NXFF_OPENFLOW10, NXFF_NXM };
+    int i, j;
+
+    for (i = 0; i < ARRAY_SIZE(formats); i++) {
+        for (j = 0; j < 10000; j++) {
+            struct flow_mod in, out;
+            struct ofpbuf *msg;
+            int error;
+
+            msg = make_random_flow_mod(formats[i], &in);
+            error = ofputil_decode_flow_mod(&out, msg->data, formats[i]);
+            if (error || !cls_rule_equal(&in.cr, &out.cr)) {
+                char *in_s = cls_rule_to_string(&in.cr);
+                char *out_s = cls_rule_to_string(&out.cr);
+                ovs_fatal(0, "%s flow_mod did not round-trip (error %x):\n"
+                          "  in: %s\n out: %s",
+                          ofputil_flow_format_to_string(formats[i]),
+                          error, in_s, out_s);
+            }
+            assert(in.cookie == out.cookie);
+            assert(in.command == out.command);
+            assert(in.idle_timeout == out.idle_timeout);
+            assert(in.buffer_id == out.buffer_id);
+            assert(in.out_port == out.out_port);
+            assert(out.n_actions == 1);
+            assert(!memcmp(in.actions, out.actions, sizeof *out.actions));
+            ofpbuf_delete(msg);
+        }
+    }
+}
+
+/* Decodes a stream of flow_mods in the flow format named by argv[1]
+ * ("openflow10" or "nxm") and prints the rate.  The optional argv[2] is the
+ * number of flow_mods to decode (default 1000000).
+ *
+ * The stream holds up to 65536 distinct flow_mods back to back, as they would
+ * arrive on a connection, and is decoded repeatedly until the requested number
+ * of flow_mods have been decoded.  That is enough to keep the stream out of
+ * cache without needing hundreds of megabytes of memory. */
+static void
+benchmark(int argc, char *argv[])
+{
+    enum nx_flow_format flow_format = parse_flow_format(argv[1]);
+    int n_msgs = argc > 2 ? atoi(argv[2]) : 1000000;
+    int n_distinct = MIN(n_msgs, 65536);
+    long long int start, elapsed;
+    struct ofpbuf stream;
+    int i, n_decoded;
+
+    random_set_seed(1);
+    ofpbuf_init(&stream, 0);
+    for (i = 0; i < n_distinct; i++) {
+        struct flow_mod fm;
+        struct ofpbuf *msg;
+
+        msg = make_random_flow_mod(flow_format, &fm);
+        ofpbuf_put(&stream, msg->data, msg->size);
+        ofpbuf_delete(msg);
+    }
+
+    time_refresh();
+    start = time_msec();
+    n_decoded = 0;
+    while (n_decoded < n_msgs) {
+        const uint8_t *p = stream.data;
+        const uint8_t *end = p + stream.size;
+
+        while (p < end && n_decoded < n_msgs) {
+            const struct ofp_header *oh = (const struct ofp_header *) p;
+            struct flow_mod fm;
+
+            if (ofputil_decode_flow_mod(&fm, oh, flow_format)) {
+                ovs_fatal(0, "decoding flow_mod failed");
+            }
+            p += ntohs(oh->length);
+            n_decoded++;
+        }
+    }
+    time_refresh();
+    elapsed = MAX(time_msec() - start, 1);
+
+    printf("%s: %d flow_mods in %lld ms (%lld msgs/s, %zu bytes/msg)\n",
+           argv[1], n_decoded, elapsed, n_decoded * 1000LL / elapsed,
+           stream.size / n_distinct);
+    ofpbuf_uninit(&stream);
+}
+
+static const struct command commands[] = {
+    {"round-trip", 0, 0, test_round_trip},
+    {"benchmark", 1, 2, benchmark},
+    {NULL, 0, 0, NULL},
+};
+
+int
+main(int argc, char *argv[])
+{
+    set_program_name(argv[0]);
+    run_command(argc - 1, argv + 1, commands);
+    return 0;
+}
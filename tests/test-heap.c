@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2011 Nicira Networks.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* A non-exhaustive test for some of the functions and macros declared in
+ * heap.h. */
+
+#include <config.h>
+#include "heap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "random.h"
+#include "util.h"
+
+#undef NDEBUG
+#include <assert.h>
+
+/* Sample heap element. */
+struct element {
+    struct heap_node heap_node;
+    bool in_heap;
+};
+
+/* Verifies that 'heap' satisfies the heap property, that it contains exactly
+ * the elements in 'elements' that are marked 'in_heap', and that each node's
+ * 'idx' is correct. */
+static void
+check_heap(const struct heap *heap, const struct element elements[], size_t n)
+{
+    size_t n_in_heap;
+    size_t i;
+
+    for (i = 1; i <= heap->n; i++) {
+        assert(heap->array[i]->idx == i);
+        if (i > 1) {
+            assert(heap->array[i / 2]->priority <= heap->array[i]->priority);
+        }
+    }
+
+    n_in_heap = 0;
+    for (i = 0; i < n; i++) {
+        if (elements[i].in_heap) {
+            const struct heap_node *node = &elements[i].heap_node;
+            assert(node->idx >= 1 && node->idx <= heap->n);
+            assert(heap->array[node->idx] == node);
+            n_in_heap++;
+        }
+    }
+    assert(n_in_heap == heap_count(heap));
+}
+
+static int
+compare_priorities(const void *a_, const void *b_)
+{
+    const long long int *a = a_;
+    const long long int *b = b_;
+    return *a < *b ? -1 : *a > *b;
+}
+
+/* Inserts elements with random priorities, then pops them all and checks that
+ * they come out in order. */
+static void
+test_heap_insert_pop(void)
+{
+    enum { N = 100 };
+    struct element elements[N];
+    long long int priorities[N];
+    struct heap heap;
+    size_t i;
+
+    for (i = 0; i < N; i++) {
+        elements[i].in_heap = false;
+    }
+
+    heap_init(&heap);
+    for (i = 0; i < N; i++) {
+        priorities[i] = random_range(N / 2);
+        heap_insert(&heap, &elements[i].heap_node, priorities[i]);
+        elements[i].in_heap = true;
+        check_heap(&heap, elements, N);
+    }
+    qsort(priorities, N, sizeof *priorities, compare_priorities);
+
+    for (i = 0; i < N; i++) {
+        struct heap_node *node = heap_pop(&heap);
+        struct element *e = CONTAINER_OF(node, struct element, heap_node);
+
+        assert(node->priority == priorities[i]);
+        e->in_heap = false;
+        check_heap(&heap, elements, N);
+    }
+    assert(heap_is_empty(&heap));
+    assert(heap_pop(&heap) == NULL);
+    heap_destroy(&heap);
+}
+
+/* Applies random insertions, removals, and priority changes. */
+static void
+test_heap_random_ops(void)
+{
+    enum { N = 50 };
+    struct element elements[N];
+    struct heap heap;
+    int i;
+
+    for (i = 0; i < N; i++) {
+        elements[i].in_heap = false;
+    }
+
+    heap_init(&heap);
+    for (i = 0; i < 10000; i++) {
+        struct element *e = &elements[random_range(N)];
+        long long int priority = random_range(1000) - 500;
+
+        if (!e->in_heap) {
+            heap_insert(&heap, &e->heap_node, priority);
+            e->in_heap = true;
+        } else if (random_range(2)) {
+            heap_remove(&heap, &e->heap_node);
+            e->in_heap = false;
+        } else {
+            heap_change(&heap, &e->heap_node, priority);
+            assert(e->heap_node.priority == priority);
+        }
+        check_heap(&heap, elements, N);
+    }
+
+    heap_clear(&heap);
+    assert(heap_is_empty(&heap));
+    assert(heap_min(&heap) == NULL);
+    heap_destroy(&heap);
+}
+
+static void
+run_test(void (*function)(void))
+{
+    function();
+    printf(".");
+}
+
+int
+main(void)
+{
+    run_test(test_heap_insert_pop);
+    run_test(test_heap_random_ops);
+    printf("\n");
+    return 0;
+}
@@ -22,7 +22,11 @@
 #include <errno.h>
 #include <getopt.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include "dynamic-string.h"
+#include "timeval.h"
 #include "util.h"
 
 /* --pretty: If set, the JSON output is pretty-printed, instead of printed as
@@ -33,6 +37,21 @@ static int pretty = 0;
  * instead of exactly one object or array. */
 static int multiple = 0;
 
+/* --arena: If set, JSON is parsed into this arena instead of with malloc(). */
+static struct json_arena *arena;
+
+/* --benchmark: If nonzero, the number of times to parse the input for timing,
+ * instead of printing it. */
+static int benchmark_iterations = 0;
+
+static struct json_parser *
+create_parser(int flags)
+{
+    return (arena
+            ? json_parser_create_arena(flags, arena)
+            : json_parser_create(flags));
+}
+
 static bool
 print_and_free_json(struct json *json)
 {
@@ -46,7 +65,11 @@ print_and_free_json(struct json *json)
         free(s);
         ok = true;
     }
-    json_destroy(json);
+    if (arena) {
+        json_arena_clear(arena);
+    } else {
+        json_destroy(json);
+    }
     return ok;
 }
 
@@ -83,7 +106,7 @@ parse_multiple(FILE *stream)
             used++;
         } else {
             if (!parser) {
-                parser = json_parser_create(0);
+                parser = create_parser(0);
             }
 
             used += json_parser_feed(parser, &buffer[used], n - used);
@@ -103,6 +126,90 @@ parse_multiple(FILE *stream)
     return ok;
 }
 
+static void
+read_stream(FILE *stream, struct ds *input)
+{
+    char buffer[BUFSIZ];
+    size_t n;
+
+    ds_init(input);
+    while ((n = fread(buffer, 1, sizeof buffer, stream)) > 0) {
+        ds_put_buffer(input, buffer, n);
+    }
+    if (ferror(stream)) {
+        ovs_fatal(errno, "Error reading input file");
+    }
+}
+
+static struct json *
+parse_buffer(const char *buffer, size_t n)
+{
+    struct json_parser *parser = create_parser(JSPF_TRAILER);
+    json_parser_feed(parser, buffer, n);
+    return json_parser_finish(parser);
+}
+
+/* Parses the contents of 'stream', a single JSON object or array,
+ * 'benchmark_iterations' times with malloc() and then the same number of
+ * times with an arena, and reports the parsing speed of each.
+ *
+ * A realistic input is the reply to an OVSDB "select" of a large table, e.g.
+ * as printed by "ovsdb-client transact". */
+static bool
+benchmark(FILE *stream)
+{
+    struct json *expected;
+    struct ds input;
+    int pass;
+
+    read_stream(stream, &input);
+    expected = parse_buffer(ds_cstr(&input), input.length);
+    if (expected->type == JSON_STRING) {
+        printf("error: %s\n", expected->u.string);
+        return false;
+    }
+
+    for (pass = 0; pass < 2; pass++) {
+        long long int start, elapsed;
+        double mbytes;
+        int i;
+
+        arena = pass ? json_arena_create() : NULL;
+
+        time_refresh();
+        start = time_msec();
+        for (i = 0; i < benchmark_iterations; i++) {
+            struct json *json = parse_buffer(input.string, input.length);
+
+            if (i == 0 && !json_equal(json, expected)) {
+                printf("error: %s parse differs from first parse\n",
+                       arena ? "arena" : "malloc");
+                return false;
+            }
+
+            if (arena) {
+                json_arena_clear(arena);
+            } else {
+                json_destroy(json);
+            }
+        }
+        time_refresh();
+        elapsed = MAX(time_msec() - start, 1);
+
+        mbytes = (double) input.length * benchmark_iterations / 1e6;
+        printf("%s: %zu bytes parsed %d times in %lld ms: %.1f MB/s\n",
+               pass ? "arena" : "malloc", input.length,
+               benchmark_iterations, elapsed, mbytes * 1000.0 / elapsed);
+
+        json_arena_destroy(arena);
+        arena = NULL;
+    }
+
+    json_destroy(expected);
+    ds_destroy(&input);
+    return true;
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -116,6 +223,9 @@ main(int argc, char *argv[])
         static const struct option options[] = {
             {"pretty", no_argument, &pretty, 1},
             {"multiple", no_argument, &multiple, 1},
+            {"arena", no_argument, NULL, 'a'},
+            {"benchmark", required_argument, NULL, 'b'},
+            {NULL, 0, NULL, 0},
         };
         int option_index = 0;
         int c = getopt_long (argc, argv, "", options, &option_index);
@@ -127,6 +237,19 @@ main(int argc, char *argv[])
         case 0:
             break;
 
+        case 'a':
+            if (!arena) {
+                arena = json_arena_create();
+            }
+            break;
+
+        case 'b':
+            benchmark_iterations = atoi(optarg);
+            if (benchmark_iterations <= 0) {
+                ovs_fatal(0, "--benchmark requires a positive argument");
+            }
+            break;
+
         case '?':
             exit(1);
 
@@ -136,8 +259,8 @@ main(int argc, char *argv[])
     }
 
     if (argc - optind != 1) {
-        ovs_fatal(0, "usage: %s [--pretty] [--multiple] INPUT.json",
-                  program_name);
+        ovs_fatal(0, "usage: %s [--pretty] [--multiple] [--arena] "
+                  "[--benchmark=N] INPUT.json", program_name);
     }
 
     input_file = argv[optind];
@@ -146,13 +269,23 @@ main(int argc, char *argv[])
         ovs_fatal(errno, "Cannot open \"%s\"", input_file);
     }
 
-    if (multiple) {
+    if (benchmark_iterations) {
+        ok = benchmark(stream);
+    } else if (multiple) {
         ok = parse_multiple(stream);
+    } else if (arena) {
+        struct ds input;
+
+        read_stream(stream, &input);
+        ok = print_and_free_json(parse_buffer(ds_cstr(&input),
+                                              input.length));
+        ds_destroy(&input);
     } else {
         ok = print_and_free_json(json_from_stream(stream));
     }
 
     fclose(stream);
+    json_arena_destroy(arena);
 
     return !ok;
 }
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2011 Nicira Networks.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* A test for netdev-linux's PACKET_MMAP rings.  Run as root with the names of
+ * the two ends of a veth pair. */
+
+#include <config.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "command-line.h"
+#include "netdev.h"
+#include "netdev-linux.h"
+#include "ofpbuf.h"
+#include "packets.h"
+#include "timeval.h"
+#include "util.h"
+#include "vlog.h"
+
+#undef NDEBUG
+#include <assert.h>
+
+#define N_THREADS 4             /* Sending threads. */
+#define N_ROUNDS 500            /* Rounds of sending. */
+#define N_PER_ROUND 16          /* Packets sent per thread per round. */
+#define N_PER_THREAD (N_ROUNDS * N_PER_ROUND)
+#define PAYLOAD_LEN 200         /* Bytes of payload in each packet. */
+#define TEST_ETH_TYPE 0x88b5    /* IEEE 802 local experimental Ethertype. */
+
+/* Payload of each test packet, following the Ethernet header. */
+struct test_payload {
+    uint8_t thread;             /* Sending thread. */
+    uint8_t pad;
+    uint16_t seq;               /* Sequence number within thread. */
+    uint8_t data[PAYLOAD_LEN - 4];  /* Derived from 'thread' and 'seq'. */
+};
+
+static struct netdev *tx_netdev;
+static pthread_barrier_t sent_barrier, received_barrier;
+
+static void
+fill_payload(struct test_payload *p, int thread, int seq)
+{
+    size_t i;
+
+    p->thread = thread;
+    p->pad = 0;
+    p->seq = seq;
+    for (i = 0; i < sizeof p->data; i++) {
+        p->data[i] = thread * 31 + seq * 7 + i;
+    }
+}
+
+static void
+compose_test_packet(struct ofpbuf *b, int thread, int seq)
+{
+    static const uint8_t src[ETH_ADDR_LEN] = { 0x00, 0x23, 0x20, 0, 0, 1 };
+    struct eth_header *eh;
+
+    ofpbuf_clear(b);
+    eh = ofpbuf_put_uninit(b, sizeof *eh);
+    memcpy(eh->eth_dst, eth_addr_broadcast, ETH_ADDR_LEN);
+    memcpy(eh->eth_src, src, ETH_ADDR_LEN);
+    eh->eth_type = htons(TEST_ETH_TYPE);
+    fill_payload(ofpbuf_put_uninit(b, sizeof(struct test_payload)),
+                 thread, seq);
+}
+
+/* Body of a sending thread.  Sends N_PER_ROUND packets per round on
+ * 'tx_netdev', concurrently with the other sending threads, then waits for
+ * the main thread to receive them before starting the next round. */
+static void *
+send_thread(void *thread_)
+{
+    int thread = (intptr_t) thread_;
+    struct ofpbuf b;
+    int round;
+
+    ofpbuf_init(&b, ETH_HEADER_LEN + sizeof(struct test_payload));
+    for (round = 0; round < N_ROUNDS; round++) {
+        int i;
+
+        for (i = 0; i < N_PER_ROUND; i++) {
+            int seq = round * N_PER_ROUND + i;
+            int error;
+
+            compose_test_packet(&b, thread, seq);
+            while ((error = netdev_send(tx_netdev, &b)) == EAGAIN) {
+                sched_yield();
+            }
+            if (error) {
+                ovs_fatal(error, "thread %d: send failed", thread);
+            }
+        }
+        pthread_barrier_wait(&sent_barrier);
+        pthread_barrier_wait(&received_barrier);
+    }
+    ofpbuf_uninit(&b);
+
+    return NULL;
+}
+
+/* Receives test packets on 'rx_netdev' until 'n' new ones have arrived,
+ * checking that each one is intact and has not been received before. */
+static void
+receive_round(struct netdev *rx_netdev,
+              unsigned char seen[N_THREADS][N_PER_THREAD], int n, int round)
+{
+    long long int deadline = time_msec() + 10000;
+    struct ofpbuf b;
+
+    ofpbuf_init(&b, 2048);
+    while (n > 0) {
+        const struct eth_header *eh;
+        struct test_payload expected;
+        const struct test_payload *p;
+        int error;
+
+        ofpbuf_clear(&b);
+        error = netdev_recv(rx_netdev, &b);
+        if (error == EAGAIN) {
+            if (time_msec() > deadline) {
+                ovs_fatal(0, "round %d: %d packets never arrived", round, n);
+            }
+            sched_yield();
+            continue;
+        } else if (error) {
+            ovs_fatal(error, "receive failed");
+        }
+
+        eh = b.data;
+        if (b.size < ETH_HEADER_LEN || eh->eth_type != htons(TEST_ETH_TYPE)) {
+            continue;
+        }
+        if (b.size < ETH_HEADER_LEN + sizeof *p) {
+            ovs_fatal(0, "round %d: received %zu-byte packet",
+                      round, b.size);
+        }
+        p = (const struct test_payload *) (eh + 1);
+        if (p->thread >= N_THREADS || p->seq >= N_PER_THREAD) {
+            ovs_fatal(0, "round %d: bad packet from thread %d seq %d",
+                      round, p->thread, p->seq);
+        }
+        fill_payload(&expected, p->thread, p->seq);
+        if (memcmp(p, &expected, sizeof *p)) {
+            ovs_fatal(0, "round %d: corrupted packet from thread %d seq %d",
+                      round, p->thread, p->seq);
+        }
+        if (seen[p->thread][p->seq]++) {
+            ovs_fatal(0, "round %d: duplicate packet from thread %d seq %d",
+                      round, p->thread, p->seq);
+        }
+        n--;
+    }
+    ofpbuf_uninit(&b);
+}
+
+static struct netdev *
+open_netdev(const char *name, bool mmap_rings)
+{
+    struct netdev_options options;
+    struct netdev *netdev;
+    int error;
+
+    memset(&options, 0, sizeof options);
+    options.name = name;
+    options.type = "system";
+    options.ethertype = NETDEV_ETH_TYPE_ANY;
+
+    netdev_linux_set_mmap_rings(mmap_rings);
+    error = netdev_open(&options, &netdev);
+    if (error) {
+        ovs_fatal(error, "%s: open failed", name);
+    }
+    error = netdev_turn_flags_on(netdev, NETDEV_UP, false);
+    if (error) {
+        ovs_fatal(error, "%s: could not bring up", name);
+    }
+    return netdev;
+}
+
+/* Sends packets from N_THREADS threads at once on argv[1], which uses
+ * PACKET_MMAP rings, and checks that every one of them arrives exactly once,
+ * intact, on argv[2]. */
+static void
+test_concurrent_send(int argc OVS_UNUSED, char *argv[])
+{
+    static unsigned char seen[N_THREADS][N_PER_THREAD];
+    pthread_t threads[N_THREADS];
+    struct netdev *rx_netdev;
+    int round;
+    int i;
+
+    rx_netdev = open_netdev(argv[2], false);
+    tx_netdev = open_netdev(argv[1], true);
+
+    pthread_barrier_init(&sent_barrier, NULL, N_THREADS + 1);
+    pthread_barrier_init(&received_barrier, NULL, N_THREADS + 1);
+    for (i = 0; i < N_THREADS; i++) {
+        int error = pthread_create(&threads[i], NULL, send_thread,
+                                   (void *) (intptr_t) i);
+        if (error) {
+            ovs_fatal(error, "failed to create thread");
+        }
+    }
+    for (round = 0; round < N_ROUNDS; round++) {
+        pthread_barrier_wait(&sent_barrier);
+        receive_round(rx_netdev, seen, N_THREADS * N_PER_ROUND, round);
+        pthread_barrier_wait(&received_barrier);
+    }
+    for (i = 0; i < N_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    netdev_close(tx_netdev);
+    netdev_close(rx_netdev);
+}
+
+static const struct command commands[] = {
+    {"concurrent-send", 2, 2, test_concurrent_send},
+    {NULL, 0, 0, NULL},
+};
+
+int
+main(int argc, char *argv[])
+{
+    set_program_name(argv[0]);
+    vlog_set_levels(NULL, VLF_ANY_FACILITY, VLL_EMER);
+    run_command(argc - 1, argv + 1, commands);
+    return 0;
+}
@@ -17,11 +17,14 @@
 #include <config.h>
 
 #include <assert.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <getopt.h>
 #include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "command-line.h"
 #include "dynamic-string.h"
@@ -119,6 +122,8 @@ usage(void)
            "usage: %s [OPTIONS] COMMAND [ARG...]\n\n"
            "  log-io FILE FLAGS COMMAND...\n"
            "    open FILE with FLAGS, run COMMANDs\n"
+           "  benchmark-log FILE\n"
+           "    compare reading FILE's records in json and binary formats\n"
            "  default-atoms\n"
            "    test ovsdb_atom_default()\n"
            "  default-data\n"
@@ -183,7 +188,10 @@ usage(void)
            "    connect to SERVER and dump the contents of the database\n"
            "    as seen initially by the IDL implementation and after\n"
            "    executing each TRANSACTION.  (Each TRANSACTION must modify\n"
-           "    the database or this command will hang.)\n",
+           "    the database or this command will hang.)\n"
+           "  idl-track SERVER [TRANSACTION...]\n"
+           "    same as \"idl\" but also prints the rows and columns in the\n"
+           "    \"simple\" table that the IDL reports as changed\n",
            program_name, program_name);
     vlog_usage();
     printf("\nOther options:\n"
@@ -300,6 +308,8 @@ do_log_io(int argc, char *argv[])
             json_destroy(json);
         } else if (!strcmp(command, "commit")) {
             error = ovsdb_log_commit(log);
+        } else if (!strcmp(command, "binary")) {
+            error = ovsdb_log_set_format(log, OVSDB_LOG_BINARY);
         } else {
             ovs_fatal(0, "unknown log-io command \"%s\"", command);
         }
@@ -316,6 +326,94 @@ do_log_io(int argc, char *argv[])
     ovsdb_log_close(log);
 }
 
+/* Copies the records in 'src_name', unchanged, to a new log 'dst_name' in the
+ * given 'format'. */
+static void
+copy_log(const char *src_name, const char *dst_name,
+         enum ovsdb_log_format format)
+{
+    struct ovsdb_log *src, *dst;
+    struct json *json;
+
+    check_ovsdb_error(ovsdb_log_open(src_name, OVSDB_LOG_READ_ONLY, false,
+                                     &src));
+    check_ovsdb_error(ovsdb_log_open(dst_name, OVSDB_LOG_CREATE, false,
+                                     &dst));
+    check_ovsdb_error(ovsdb_log_set_format(dst, format));
+    for (;;) {
+        check_ovsdb_error(ovsdb_log_read(src, &json));
+        if (!json) {
+            break;
+        }
+        check_ovsdb_error(ovsdb_log_write(dst, json));
+        json_destroy(json);
+    }
+    check_ovsdb_error(ovsdb_log_commit(dst));
+    ovsdb_log_close(dst);
+    ovsdb_log_close(src);
+}
+
+/* Reads all of the records in log 'name' and discards them. */
+static void
+read_log(const char *name)
+{
+    struct ovsdb_log *log;
+    struct json *json;
+
+    check_ovsdb_error(ovsdb_log_open(name, OVSDB_LOG_READ_ONLY, false, &log));
+    do {
+        check_ovsdb_error(ovsdb_log_read(log, &json));
+        json_destroy(json);
+    } while (json);
+    ovsdb_log_close(log);
+}
+
+/* Copies the records in the database in argv[1] into new files in each log
+ * format, without compacting them, then reports the size of each file, how
+ * long it takes just to read its records, and how long it takes to read it in
+ * as a database, as ovsdb-server does when it starts. */
+static void
+do_benchmark_log(int argc OVS_UNUSED, char *argv[])
+{
+    static const enum ovsdb_log_format formats[] = {
+        OVSDB_LOG_JSON, OVSDB_LOG_BINARY
+    };
+    size_t i;
+
+    for (i = 0; i < ARRAY_SIZE(formats); i++) {
+        const char *format_name = ovsdb_log_format_to_string(formats[i]);
+        long long int start, read_msec, open_msec;
+        struct ovsdb *db;
+        struct stat s;
+        char *name;
+
+        name = xasprintf("%s.%s", argv[1], format_name);
+        unlink(name);
+        copy_log(argv[1], name, formats[i]);
+        if (stat(name, &s)) {
+            ovs_fatal(errno, "%s: stat failed", name);
+        }
+
+        time_refresh();
+        start = time_msec();
+        read_log(name);
+        time_refresh();
+        read_msec = time_msec() - start;
+
+        start = time_msec();
+        check_ovsdb_error(ovsdb_file_open(name, true, &db, NULL));
+        time_refresh();
+        open_msec = time_msec() - start;
+        ovsdb_destroy(db);
+
+        printf("%s: %lld bytes, records read in %lld ms, "
+               "database read in %lld ms\n", format_name,
+               (long long int) s.st_size, read_msec, open_msec);
+        unlink(name);
+        free(name);
+    }
+}
+
 static void
 do_default_atoms(int argc OVS_UNUSED, char *argv[] OVS_UNUSED)
 {
@@ -475,6 +573,26 @@ do_parse_atom_strings(int argc, char *argv[])
     ovsdb_base_type_destroy(&base);
 }
 
+/* Checks that ovsdb_datum_to_json_ds() serializes 'datum' the same way as
+ * json_to_ds() serializes 'json', the corresponding ovsdb_datum_to_json()
+ * output. */
+static void
+check_datum_to_json_ds(const struct ovsdb_datum *datum,
+                       const struct ovsdb_type *type, const struct json *json)
+{
+    struct ds expected = DS_EMPTY_INITIALIZER;
+    struct ds actual = DS_EMPTY_INITIALIZER;
+
+    json_to_ds(json, 0, &expected);
+    ovsdb_datum_to_json_ds(datum, type, &actual);
+    if (strcmp(ds_cstr(&expected), ds_cstr(&actual))) {
+        ovs_fatal(0, "ovsdb_datum_to_json_ds() produced %s instead of %s",
+                  ds_cstr(&actual), ds_cstr(&expected));
+    }
+    ds_destroy(&expected);
+    ds_destroy(&actual);
+}
+
 static void
 do_parse_data__(int argc, char *argv[],
                 struct ovsdb_error *
@@ -498,7 +616,9 @@ do_parse_data__(int argc, char *argv[],
         check_ovsdb_error(parse(&datum, &type, json, NULL));
         json_destroy(json);
 
-        print_and_free_json(ovsdb_datum_to_json(&datum, &type));
+        json = ovsdb_datum_to_json(&datum, &type);
+        check_datum_to_json_ds(&datum, &type, json);
+        print_and_free_json(json);
 
         ovsdb_datum_destroy(&datum, &type);
     }
@@ -1109,7 +1229,7 @@ do_query_distinct(int argc OVS_UNUSED, char *argv[])
 
     /* Parse column set. */
     json = parse_json(argv[4]);
-    check_ovsdb_error(ovsdb_column_set_from_json(json, table, &columns));
+    check_ovsdb_error(ovsdb_column_set_from_json(json, table->schema, &columns));
     json_destroy(json);
 
     /* Parse rows, add to table. */
@@ -1648,6 +1768,33 @@ print_idl(struct ovsdb_idl *idl, int step)
     }
 }
 
+/* Prints the changes to the "simple" table in 'idl' since 'seqno', as reported
+ * by the IDL's change tracking. */
+static void
+print_idl_changes(struct ovsdb_idl *idl, unsigned int seqno, int step)
+{
+    const struct idltest_simple *s;
+
+    if (ovsdb_idl_table_rows_changed(idl, &idltest_table_simple, seqno)) {
+        printf("%03d: simple rows inserted or deleted\n", step);
+    }
+    IDLTEST_SIMPLE_FOR_EACH (s, idl) {
+        if (ovsdb_idl_row_changed(&s->header_, seqno)) {
+            size_t i;
+
+            printf("%03d: changed i=%"PRId64" columns=[", step, s->i);
+            for (i = 0; i < IDLTEST_SIMPLE_N_COLUMNS; i++) {
+                const struct ovsdb_idl_column *column
+                    = &idltest_simple_columns[i];
+                if (ovsdb_idl_column_changed(&s->header_, column, seqno)) {
+                    printf(" %s", column->name);
+                }
+            }
+            printf(" ]\n");
+        }
+    }
+}
+
 static void
 parse_uuids(const struct json *json, struct ovsdb_symbol_table *symtab,
             size_t *n)
@@ -1833,6 +1980,9 @@ idl_set(struct ovsdb_idl *idl, char *commands, int step)
     ovsdb_idl_txn_destroy(txn);
 }
 
+/* Whether do_idl() should also print the changes reported by the IDL. */
+static bool track_changes;
+
 static void
 do_idl(int argc, char *argv[])
 {
@@ -1882,6 +2032,9 @@ do_idl(int argc, char *argv[])
             }
 
             /* Print update. */
+            if (track_changes) {
+                print_idl_changes(idl, seqno, step);
+            }
             print_idl(idl, step++);
         }
         seqno = ovsdb_idl_get_seqno(idl);
@@ -1917,13 +2070,24 @@ do_idl(int argc, char *argv[])
         ovsdb_idl_wait(idl);
         poll_block();
     }
+    if (track_changes) {
+        print_idl_changes(idl, seqno, step);
+    }
     print_idl(idl, step++);
     ovsdb_idl_destroy(idl);
     printf("%03d: done\n", step);
 }
 
+static void
+do_idl_track(int argc, char *argv[])
+{
+    track_changes = true;
+    do_idl(argc, argv);
+}
+
 static struct command all_commands[] = {
     { "log-io", 2, INT_MAX, do_log_io },
+    { "benchmark-log", 1, 1, do_benchmark_log },
     { "default-atoms", 0, 0, do_default_atoms },
     { "default-data", 0, 0, do_default_data },
     { "parse-atomic-type", 1, 1, do_parse_atomic_type },
@@ -1949,6 +2113,7 @@ static struct command all_commands[] = {
     { "execute", 2, INT_MAX, do_execute },
     { "trigger", 2, INT_MAX, do_trigger },
     { "idl", 1, INT_MAX, do_idl },
+    { "idl-track", 1, INT_MAX, do_idl_track },
     { "help", 0, INT_MAX, do_help },
     { NULL, 0, 0, NULL },
 };
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2011 Nicira Networks.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* A test for the packet-in scheduler in ofproto/pinsched.c. */
+
+#include <config.h>
+#include "ofproto/pinsched.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "dynamic-string.h"
+#include "ofpbuf.h"
+#include "timeval.h"
+#include "util.h"
+
+#undef NDEBUG
+#include <assert.h>
+
+/* pinsched callback that appends a space and the one-character name of each
+ * packet that it is passed to the "struct ds" in 'ds_'. */
+static void
+record_packet(struct ofpbuf *packet, void *ds_)
+{
+    struct ds *ds = ds_;
+
+    ds_put_format(ds, " %c", *(char *) packet->data);
+    ofpbuf_delete(packet);
+}
+
+static void
+send_packet(struct pinsched *ps, uint16_t port_no,
+            enum ofp_packet_in_reason reason, char name, struct ds *ds)
+{
+    struct ofpbuf *packet = ofpbuf_new(1);
+    ofpbuf_put(packet, &name, 1);
+    pinsched_send(ps, port_no, reason, packet, record_packet, ds);
+}
+
+/* Fills a scheduler past its burst limit with table misses from one port and
+ * controller actions from another, then prints the order in which it drops
+ * and sends them.
+ *
+ * The rate limit of 1 packet per second means that nothing gets sent until
+ * the test raises the limit, as long as the test takes less than about 900 ms
+ * to fill the queues. */
+static void
+test_wfq(void)
+{
+    struct pinsched_stats stats;
+    struct pinsched *ps;
+    struct ds sent;
+    char c;
+
+    ds_init(&sent);
+    ps = pinsched_create(1, 12);
+    for (c = 'a'; c <= 'h'; c++) {
+        send_packet(ps, 1, OFPR_NO_MATCH, c, &sent);
+    }
+    for (c = 'A'; c <= 'H'; c++) {
+        send_packet(ps, 2, OFPR_ACTION, c, &sent);
+    }
+    assert(!sent.length);
+
+    pinsched_get_stats(ps, &stats);
+    printf("queued %llu, dropped %llu, queue length %d\n",
+           stats.n_limited, stats.n_dropped, stats.n_queued);
+
+    pinsched_set_limits(ps, 1000000, 12);
+    while (stats.n_queued) {
+        time_refresh();
+        pinsched_run(ps, record_packet, &sent);
+        pinsched_get_stats(ps, &stats);
+    }
+    printf("sent:%s\n", ds_cstr(&sent));
+    printf("sent %llu after queuing, %llu without\n",
+           stats.n_sent, stats.n_normal);
+
+    ds_destroy(&sent);
+    pinsched_destroy(ps);
+}
+
+int
+main(int argc OVS_UNUSED, char *argv[])
+{
+    set_program_name(argv[0]);
+    test_wfq();
+    return 0;
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2011 Nicira Networks.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* A test for the fixed-size object pools declared in pool.h. */
+
+#include <config.h>
+#include "pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include "command-line.h"
+#include "timeval.h"
+#include "util.h"
+
+#undef NDEBUG
+#include <assert.h>
+
+/* Allocates many objects from a pool, checks that they do not overlap, frees
+ * them, and checks that the pool reuses them without growing. */
+static void
+test_pool(int argc OVS_UNUSED, char *argv[] OVS_UNUSED)
+{
+    enum { N = 5000, SIZE = 100 };
+    struct pool pool;
+    unsigned char **objs;
+    size_t n_slabs;
+    int i;
+
+    pool_init(&pool, "test", SIZE);
+    objs = xmalloc(N * sizeof *objs);
+    for (i = 0; i < N; i++) {
+        objs[i] = pool_zalloc(&pool);
+        assert(!((uintptr_t) objs[i] % 8));
+        assert(objs[i][0] == 0 && objs[i][SIZE - 1] == 0);
+        memset(objs[i], i & 0xff, SIZE);
+    }
+    assert(pool.n_in_use == N);
+    for (i = 0; i < N; i++) {
+        assert(objs[i][0] == (i & 0xff) && objs[i][SIZE - 1] == (i & 0xff));
+    }
+
+    n_slabs = pool.n_slabs;
+    for (i = 0; i < N; i++) {
+        pool_free(&pool, objs[i]);
+    }
+    pool_free(&pool, NULL);
+    assert(pool.n_in_use == 0);
+
+    for (i = 0; i < N; i++) {
+        objs[i] = pool_alloc(&pool);
+    }
+    assert(pool.n_slabs == n_slabs);
+    assert(pool.n_allocs == 2 * N);
+
+    free(objs);
+    pool_destroy(&pool);
+}
+
+/* Allocates buffers of every size up to beyond the largest size class from a
+ * pool set, fills them, and frees them again. */
+static void
+test_pool_set(int argc OVS_UNUSED, char *argv[] OVS_UNUSED)
+{
+    enum { MAX_SIZE = POOL_SET_MAX_SIZE * 2 };
+    unsigned char *bufs[MAX_SIZE + 1];
+    unsigned char data[MAX_SIZE];
+    struct pool_set set;
+    size_t size;
+    int i;
+
+    for (i = 0; i < MAX_SIZE; i++) {
+        data[i] = i;
+    }
+
+    pool_set_init(&set, "test");
+    for (size = 0; size <= MAX_SIZE; size++) {
+        bufs[size] = pool_set_memdup(&set, data, size);
+    }
+    for (size = 0; size <= MAX_SIZE; size++) {
+        assert(!memcmp(bufs[size], data, size));
+        pool_set_free(&set, bufs[size], size);
+    }
+    for (i = 0; i < POOL_SET_N_CLASSES; i++) {
+        assert(set.classes[i].n_in_use == 0);
+        assert(set.classes[i].obj_size >= POOL_SET_MIN_SIZE << i);
+    }
+    pool_set_free(&set, NULL, 0);
+    pool_set_destroy(&set);
+}
+
+/* Simulates the churn of facets and their actions that ofproto sees as
+ * upcalls create facets and expiration deletes them, allocating either with
+ * malloc() or from pools, and prints the rate, the number of calls to malloc()
+ * per simulated upcall, and the process's peak RSS.
+ *
+ * The first argument is "malloc" or "pool".  The optional second argument is
+ * the number of upcalls to simulate (default 10000000). */
+static void
+benchmark(int argc, char *argv[])
+{
+    enum { N_LIVE = 100000, OBJ_SIZE = 440 };
+    bool use_pool = !strcmp(argv[1], "pool");
+    int n_upcalls = argc > 2 ? atoi(argv[2]) : 10000000;
+    struct pool_set actions_pool;
+    long long int start, elapsed;
+    unsigned long long n_mallocs;
+    struct pool obj_pool;
+    struct rusage usage;
+    size_t *sizes;
+    void **objs;
+    void **acts;
+    int i;
+
+    if (!use_pool && strcmp(argv[1], "malloc")) {
+        ovs_fatal(0, "%s: unknown allocator (use \"malloc\" or \"pool\")",
+                  argv[1]);
+    }
+
+    pool_init(&obj_pool, "benchmark-objs", OBJ_SIZE);
+    pool_set_init(&actions_pool, "benchmark-actions");
+    objs = xzalloc(N_LIVE * sizeof *objs);
+    acts = xzalloc(N_LIVE * sizeof *acts);
+    sizes = xzalloc(N_LIVE * sizeof *sizes);
+
+    srand(0);
+    n_mallocs = 0;
+    time_refresh();
+    start = time_msec();
+    for (i = 0; i < n_upcalls; i++) {
+        int j = rand() % N_LIVE;
+        size_t size = 8 + (rand() % 8) * 12;
+
+        if (use_pool) {
+            pool_set_free(&actions_pool, acts[j], sizes[j]);
+            pool_free(&obj_pool, objs[j]);
+            objs[j] = pool_alloc(&obj_pool);
+            acts[j] = pool_set_alloc(&actions_pool, size);
+        } else {
+            free(acts[j]);
+            free(objs[j]);
+            objs[j] = xmalloc(OBJ_SIZE);
+            acts[j] = xmalloc(size);
+            n_mallocs += 2;
+        }
+        memset(objs[j], 0, OBJ_SIZE);
+        sizes[j] = size;
+    }
+    time_refresh();
+    elapsed = MAX(time_msec() - start, 1);
+
+    if (use_pool) {
+        n_mallocs = obj_pool.n_slabs;
+        for (i = 0; i < POOL_SET_N_CLASSES; i++) {
+            n_mallocs += actions_pool.classes[i].n_slabs;
+        }
+    }
+    getrusage(RUSAGE_SELF, &usage);
+    printf("%s: %lld upcalls/s, %.4f mallocs/upcall, peak RSS %ld kB\n",
+           argv[1], n_upcalls * 1000LL / elapsed,
+           n_upcalls ? (double) n_mallocs / n_upcalls : 0.0,
+           usage.ru_maxrss);
+
+    for (i = 0; i < N_LIVE; i++) {
+        if (use_pool) {
+            pool_set_free(&actions_pool, acts[i], sizes[i]);
+            pool_free(&obj_pool, objs[i]);
+        } else {
+            free(acts[i]);
+            free(objs[i]);
+        }
+    }
+    free(objs);
+    free(acts);
+    free(sizes);
+    pool_set_destroy(&actions_pool);
+    pool_destroy(&obj_pool);
+}
+
+static const struct command commands[] = {
+    {"pool", 0, 0, test_pool},
+    {"pool-set", 0, 0, test_pool_set},
+    {"benchmark", 1, 2, benchmark},
+    {NULL, 0, 0, NULL},
+};
+
+int
+main(int argc, char *argv[])
+{
+    set_program_name(argv[0]);
+    run_command(argc - 1, argv + 1, commands);
+    return 0;
+}
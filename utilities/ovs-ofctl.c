@@ -43,6 +43,7 @@
 #include "ofpbuf.h"
 #include "openflow/nicira-ext.h"
 #include "openflow/openflow.h"
+#include "poll-loop.h"
 #include "random.h"
 #include "stream-ssl.h"
 #include "timeval.h"
@@ -55,6 +56,9 @@ VLOG_DEFINE_THIS_MODULE(ofctl);
 /* --strict: Use strict matching for flow mod commands? */
 static bool strict;
 
+/* --batch: Send add-flows and replace-flows changes as one flow_mod batch? */
+static bool batch;
+
 /* -F, --flow-format: Flow format to use.  Either one of NXFF_* to force a
  * particular flow format or -1 to let ovs-ofctl choose intelligently. */
 static int preferred_flow_format = -1;
@@ -82,11 +86,13 @@ parse_options(int argc, char *argv[])
 {
     enum {
         OPT_STRICT = UCHAR_MAX + 1,
+        OPT_BATCH,
         VLOG_OPTION_ENUMS
     };
     static struct option long_options[] = {
         {"timeout", required_argument, 0, 't'},
         {"strict", no_argument, 0, OPT_STRICT},
+        {"batch", no_argument, 0, OPT_BATCH},
         {"flow-format", required_argument, 0, 'F'},
         {"more", no_argument, 0, 'm'},
         {"help", no_argument, 0, 'h'},
@@ -139,6 +145,10 @@ parse_options(int argc, char *argv[])
             strict = true;
             break;
 
+        case OPT_BATCH:
+            batch = true;
+            break;
+
         VLOG_OPTION_HANDLERS
         STREAM_SSL_OPTION_HANDLERS
 
@@ -176,13 +186,17 @@ usage(void)
            "\nFor OpenFlow switches and controllers:\n"
            "  probe VCONN                 probe whether VCONN is up\n"
            "  ping VCONN [N]              latency of N-byte echos\n"
-           "  benchmark VCONN N COUNT     bandwidth of COUNT N-byte echos\n"
+           "  benchmark VCONN N COUNT [WINDOW]\n"
+           "                              bandwidth of COUNT N-byte echos,\n"
+           "                              with WINDOW outstanding at a time\n"
            "where each SWITCH is an active OpenFlow connection method.\n",
            program_name, program_name);
     vconn_usage(true, false, false);
     vlog_usage();
     printf("\nOther options:\n"
            "  --strict                    use strict match for flow commands\n"
+           "  --batch                     apply add-flows, replace-flows changes\n"
+           "                              as a single batch\n"
            "  -F, --flow-format=FORMAT    force particular flow format\n"
            "  -m, --more                  be more verbose printing OpenFlow\n"
            "  -t, --timeout=SECS          give up after SECS seconds\n"
@@ -384,6 +398,72 @@ transact_noreply(struct vconn *vconn, struct ofpbuf *request)
     transact_multiple_noreply(vconn, &requests);
 }
 
+/* Sends the flow_mods in 'requests' (along with any other messages among them,
+ * e.g. to set the flow format) to 'vconn' inside a single NXT_FLOW_MOD_BATCH,
+ * then waits for the switch to apply them.  If an error occurs, prints it and
+ * exits with an error.
+ *
+ * Unlike transact_multiple_noreply(), this does not wait for a round trip
+ * after each request. */
+static void
+transact_flow_mod_batch(struct vconn *vconn, struct list *requests)
+{
+    struct ofpbuf *request, *barrier;
+    ovs_be32 barrier_xid;
+
+    list_push_front(requests,
+                    &ofputil_make_flow_mod_batch(NXFMB_OPEN)->list_node);
+    list_push_back(requests,
+                   &ofputil_make_flow_mod_batch(NXFMB_COMMIT)->list_node);
+    make_openflow(sizeof(struct ofp_header), OFPT_BARRIER_REQUEST, &barrier);
+    barrier_xid = ((struct ofp_header *) barrier->data)->xid;
+    list_push_back(requests, &barrier->list_node);
+
+    for (;;) {
+        struct ofpbuf *reply;
+        int retval;
+
+        vconn_run(vconn);
+        while (!list_is_empty(requests)) {
+            request = ofpbuf_from_list(list_pop_front(requests));
+            update_openflow_length(request);
+            retval = vconn_send(vconn, request);
+            if (retval == EAGAIN) {
+                list_push_front(requests, &request->list_node);
+                break;
+            } else if (retval) {
+                ovs_fatal(retval, "talking to %s", vconn_get_name(vconn));
+            }
+        }
+
+        /* Keep reading while sending, because the switch stops reading
+         * requests when its replies back up. */
+        while ((retval = vconn_recv(vconn, &reply)) == 0) {
+            const struct ofp_header *oh = reply->data;
+
+            if (oh->type == OFPT_ERROR) {
+                ofp_print(stderr, reply->data, reply->size, verbosity + 2);
+                exit(1);
+            } else if (oh->type == OFPT_BARRIER_REPLY
+                       && oh->xid == barrier_xid) {
+                ofpbuf_delete(reply);
+                return;
+            }
+            ofpbuf_delete(reply);
+        }
+        if (retval != EAGAIN) {
+            ovs_fatal(retval, "talking to %s", vconn_get_name(vconn));
+        }
+
+        vconn_run_wait(vconn);
+        if (!list_is_empty(requests)) {
+            vconn_send_wait(vconn);
+        }
+        vconn_recv_wait(vconn);
+        poll_block();
+    }
+}
+
 static void
 do_show(int argc OVS_UNUSED, char *argv[])
 {
@@ -643,7 +723,12 @@ do_flow_mod_file__(int argc OVS_UNUSED, char *argv[], uint16_t command)
     open_vconn(argv[1], &vconn);
     while (parse_ofp_flow_mod_file(&requests, &flow_format, file, command)) {
         check_final_format_for_flow_mod(flow_format);
-        transact_multiple_noreply(vconn, &requests);
+        if (!batch) {
+            transact_multiple_noreply(vconn, &requests);
+        }
+    }
+    if (batch) {
+        transact_flow_mod_batch(vconn, &requests);
     }
     vconn_close(vconn);
 
@@ -852,15 +937,16 @@ do_ping(int argc, char *argv[])
 }
 
 static void
-do_benchmark(int argc OVS_UNUSED, char *argv[])
+do_benchmark(int argc, char *argv[])
 {
     size_t max_payload = 65535 - sizeof(struct ofp_header);
     struct timeval start, end;
     unsigned int payload_size, message_size;
+    struct ofpbuf **requests;
     struct vconn *vconn;
     double duration;
-    int count;
-    int i;
+    int n_sent, n_received, n_pending;
+    int count, window;
 
     payload_size = atoi(argv[2]);
     if (payload_size > max_payload) {
@@ -870,22 +956,76 @@ do_benchmark(int argc OVS_UNUSED, char *argv[])
 
     count = atoi(argv[3]);
 
+    window = argc > 4 ? atoi(argv[4]) : 1;
+    if (window < 1) {
+        ovs_fatal(0, "window must be at least 1");
+    }
+    requests = xmalloc(window * sizeof *requests);
+
     printf("Sending %d packets * %u bytes (with header) = %u bytes total\n",
            count, message_size, count * message_size);
 
     open_vconn(argv[1], &vconn);
     xgettimeofday(&start);
-    for (i = 0; i < count; i++) {
-        struct ofpbuf *request, *reply;
-        struct ofp_header *rq_hdr;
+    n_sent = n_received = n_pending = 0;
+    for (;;) {
+        struct ofpbuf *reply;
+        int retval;
+
+        /* Keep up to 'window' requests outstanding.  Requests that the vconn
+         * has not yet accepted stay at the front of 'requests', so that each
+         * group of new requests is handed to the vconn at once. */
+        while (n_sent < count && n_sent - n_received < window) {
+            struct ofp_header *rq_hdr;
+
+            rq_hdr = make_openflow(message_size, OFPT_ECHO_REQUEST,
+                                   &requests[n_pending++]);
+            memset(rq_hdr + 1, 0, payload_size);
+            n_sent++;
+        }
 
-        rq_hdr = make_openflow(message_size, OFPT_ECHO_REQUEST, &request);
-        memset(rq_hdr + 1, 0, payload_size);
-        run(vconn_transact(vconn, request, &reply), "transact");
-        ofpbuf_delete(reply);
+        vconn_run(vconn);
+        if (n_pending) {
+            size_t n_accepted;
+
+            retval = vconn_send_batch(vconn, requests, n_pending,
+                                      &n_accepted);
+            if (retval && retval != EAGAIN) {
+                ovs_fatal(retval, "send");
+            }
+            n_pending -= n_accepted;
+            memmove(requests, &requests[n_accepted],
+                    n_pending * sizeof *requests);
+        }
+
+        /* Collect replies without blocking, so that we never stop reading
+         * while the peer waits for us to drain its replies. */
+        while ((retval = vconn_recv(vconn, &reply)) == 0) {
+            const struct ofp_header *rpy_hdr = reply->data;
+            if (rpy_hdr->type == OFPT_ECHO_REPLY) {
+                n_received++;
+            }
+            ofpbuf_delete(reply);
+        }
+        if (retval != EAGAIN) {
+            ovs_fatal(retval, "receive");
+        } else if (n_received >= count) {
+            break;
+        } else if (n_sent - n_received < window && n_sent < count) {
+            /* Replies opened up the window for more requests. */
+            continue;
+        }
+
+        vconn_run_wait(vconn);
+        if (n_pending) {
+            vconn_send_wait(vconn);
+        }
+        vconn_recv_wait(vconn);
+        poll_block();
     }
     xgettimeofday(&end);
     vconn_close(vconn);
+    free(requests);
 
     duration = ((1000*(double)(end.tv_sec - start.tv_sec))
                 + (.001*(end.tv_usec - start.tv_usec)));
@@ -1223,7 +1363,11 @@ do_replace_flows(int argc OVS_UNUSED, char *argv[])
                               &requests);
         }
     }
-    transact_multiple_noreply(vconn, &requests);
+    if (batch) {
+        transact_flow_mod_batch(vconn, &requests);
+    } else {
+        transact_multiple_noreply(vconn, &requests);
+    }
     vconn_close(vconn);
 
     fte_free_all(&cls);
@@ -1438,7 +1582,7 @@ static const struct command all_commands[] = {
     { "mod-port", 3, 3, do_mod_port },
     { "probe", 1, 1, do_probe },
     { "ping", 1, 2, do_ping },
-    { "benchmark", 3, 3, do_benchmark },
+    { "benchmark", 3, 4, do_benchmark },
     { "help", 0, INT_MAX, do_help },
 
     /* Undocumented commands for testing. */
@@ -63,6 +63,7 @@ struct ofsettings {
     char *dp_name;              /* Name of local datapath. */
     char *dp_type;              /* Type of local datapath. */
     struct sset ports;          /* Set of ports to add to datapath (if any). */
+    size_t facet_budget;        /* Max memory for facets, 0 for no limit. */
 
     /* Description strings. */
     const char *mfr_desc;       /* Manufacturer. */
@@ -165,6 +166,7 @@ main(int argc, char *argv[])
     }
     ofproto_set_controllers(ofproto, s.controllers, s.n_controllers);
     ofproto_set_fail_mode(ofproto, s.fail_mode);
+    ofproto_set_facet_budget(ofproto, s.facet_budget);
 
     daemonize_complete();
 
@@ -242,6 +244,7 @@ parse_options(int argc, char *argv[], struct ofsettings *s)
         OPT_IN_BAND,
         OPT_NETFLOW,
         OPT_PORTS,
+        OPT_FACET_BUDGET,
         OPT_UNIXCTL,
         OPT_ENABLE_DUMMY,
         VLOG_OPTION_ENUMS,
@@ -269,6 +272,7 @@ parse_options(int argc, char *argv[], struct ofsettings *s)
         {"in-band",     no_argument, 0, OPT_IN_BAND},
         {"netflow",     required_argument, 0, OPT_NETFLOW},
         {"ports",       required_argument, 0, OPT_PORTS},
+        {"facet-budget", required_argument, 0, OPT_FACET_BUDGET},
         {"unixctl",     required_argument, 0, OPT_UNIXCTL},
         {"enable-dummy", no_argument, 0, OPT_ENABLE_DUMMY},
         {"verbose",     optional_argument, 0, 'v'},
@@ -309,6 +313,7 @@ parse_options(int argc, char *argv[], struct ofsettings *s)
     s->max_idle = 0;
     sset_init(&s->netflow);
     sset_init(&s->ports);
+    s->facet_budget = 0;
     for (;;) {
         int c;
 
@@ -427,12 +432,16 @@ parse_options(int argc, char *argv[], struct ofsettings *s)
             parse_ports(optarg, &s->ports);
             break;
 
+        case OPT_FACET_BUDGET:
+            s->facet_budget = MAX(atoll(optarg), 0);
+            break;
+
         case OPT_UNIXCTL:
             s->unixctl_path = optarg;
             break;
 
         case OPT_ENABLE_DUMMY:
-            dummy_enable();
+            dummy_enable(false);
             break;
 
         case 'h':
@@ -539,6 +548,7 @@ usage(void)
            "                          (a passive OpenFlow connection method)\n"
            "  --out-of-band           controller connection is out-of-band\n"
            "  --netflow=HOST:PORT     configure NetFlow output target\n"
+           "  --facet-budget=BYTES    max memory for cached exact-match flows\n"
            "\nRate-limiting of \"packet-in\" messages to the controller:\n"
            "  --rate-limit[=PACKETS]  max rate, in packets/s (default: 1000)\n"
            "  --burst-limit=BURST     limit on packet credit for idle time\n");
@@ -80,6 +80,7 @@ COVERAGE_DEFINE(bridge_process_flow);
 COVERAGE_DEFINE(bridge_process_cfm);
 COVERAGE_DEFINE(bridge_process_lacp);
 COVERAGE_DEFINE(bridge_reconfigure);
+COVERAGE_DEFINE(bridge_reconfigure_incremental);
 COVERAGE_DEFINE(bridge_lacp_update);
 
 struct dst {
@@ -201,6 +202,7 @@ struct port {
 
 struct bridge {
     struct list node;           /* Node in global list of bridges. */
+    struct list reconfigure_node; /* Used by bridge_reconfigure_bridges(). */
     char *name;                 /* User-specified arbitrary name. */
     struct mac_learning *ml;    /* MAC learning table. */
     uint8_t ea[ETH_ADDR_LEN];   /* Bridge Ethernet Address. */
@@ -239,6 +241,12 @@ static struct list all_bridges = LIST_INITIALIZER(&all_bridges);
 /* OVSDB IDL used to obtain configuration. */
 static struct ovsdb_idl *idl;
 
+/* The IDL sequence number as of the most recent reconfiguration, so that the
+ * next one can tell which rows changed since then.  'reconfigured' is false
+ * until the first reconfiguration. */
+static unsigned int reconfigured_seqno;
+static bool reconfigured;
+
 /* Each time this timer expires, the bridge fetches systems and interface
  * statistics and pushes them into the database. */
 #define STATS_INTERVAL (5 * 1000) /* In milliseconds. */
@@ -258,6 +266,11 @@ static int bridge_run_one(struct bridge *);
 static size_t bridge_get_controllers(const struct bridge *br,
                                      struct ovsrec_controller ***controllersp);
 static void bridge_reconfigure_one(struct bridge *);
+static void bridge_reconfigure_bridges(const struct ovsrec_open_vswitch *,
+                                       struct list *bridges);
+static bool bridge_reconfigure_incremental(const struct ovsrec_open_vswitch *,
+                                           unsigned int seqno);
+static int bridge_sflow_sub_id(const struct bridge *);
 static void bridge_reconfigure_remotes(struct bridge *,
                                        const struct sockaddr_in *managers,
                                        size_t n_managers);
@@ -271,6 +284,8 @@ static uint64_t bridge_pick_datapath_id(struct bridge *,
                                         const uint8_t bridge_ea[ETH_ADDR_LEN],
                                         struct iface *hw_addr_iface);
 static uint64_t dpid_from_hash(const void *, size_t nbytes);
+static const char *bridge_get_other_config(const struct ovsrec_bridge *,
+                                           const char *key);
 
 static unixctl_cb_func bridge_unixctl_fdb_show;
 static unixctl_cb_func cfm_unixctl_show;
@@ -287,6 +302,10 @@ static void port_run(struct port *);
 static void port_wait(struct port *);
 static struct port *port_create(struct bridge *, const char *name);
 static void port_reconfigure(struct port *, const struct ovsrec_port *);
+static bool port_check_changes(const struct bridge *,
+                               const struct ovsrec_port *, unsigned int seqno,
+                               struct port **portp);
+static void port_reconfigure_incremental(struct port *);
 static void port_del_ifaces(struct port *, const struct ovsrec_port *);
 static void port_destroy(struct port *);
 static struct port *port_lookup(const struct bridge *, const char *name);
@@ -311,6 +330,7 @@ static struct iface *iface_find(const char *name);
 static struct iface *iface_from_dp_ifidx(const struct bridge *,
                                          uint16_t dp_ifidx);
 static void iface_set_mac(struct iface *);
+static void iface_set_netdev_config(struct iface *);
 static void iface_set_ofport(const struct ovsrec_interface *, int64_t ofport);
 static void iface_update_qos(struct iface *, const struct ovsrec_qos *);
 static void iface_update_cfm(struct iface *);
@@ -347,6 +367,7 @@ bridge_init(const char *remote)
     ovsdb_idl_omit(idl, &ovsrec_open_vswitch_col_system_version);
 
     ovsdb_idl_omit_alert(idl, &ovsrec_bridge_col_datapath_id);
+    ovsdb_idl_omit_alert(idl, &ovsrec_bridge_col_status);
     ovsdb_idl_omit(idl, &ovsrec_bridge_col_external_ids);
 
     ovsdb_idl_omit(idl, &ovsrec_port_col_external_ids);
@@ -593,15 +614,11 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
     struct shash old_br, new_br;
     struct shash_node *node;
     struct bridge *br, *next;
-    struct sockaddr_in *managers;
-    size_t n_managers;
+    struct list bridges;
     size_t i;
-    int sflow_bridge_number;
 
     COVERAGE_INC(bridge_reconfigure);
 
-    collect_in_band_managers(ovs_cfg, &managers, &n_managers);
-
     /* Collect old and new bridges. */
     shash_init(&old_br);
     shash_init(&new_br);
@@ -643,7 +660,31 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
     shash_destroy(&new_br);
 
     /* Reconfigure all bridges. */
+    list_init(&bridges);
     LIST_FOR_EACH (br, node, &all_bridges) {
+        list_push_back(&bridges, &br->reconfigure_node);
+    }
+    bridge_reconfigure_bridges(ovs_cfg, &bridges);
+}
+
+/* Reconfigures each of the bridges in 'bridges', which must be a list of
+ * "struct bridge"s linked through their 'reconfigure_node' members, according
+ * to 'ovs_cfg'.  Bridges not in 'bridges' are left untouched, so it must
+ * include every bridge whose datapath might gain an interface that another
+ * bridge's datapath would lose. */
+static void
+bridge_reconfigure_bridges(const struct ovsrec_open_vswitch *ovs_cfg,
+                           struct list *bridges)
+{
+    struct shash_node *node;
+    struct sockaddr_in *managers;
+    struct bridge *br;
+    size_t n_managers;
+    size_t i;
+
+    collect_in_band_managers(ovs_cfg, &managers, &n_managers);
+
+    LIST_FOR_EACH (br, reconfigure_node, bridges) {
         bridge_reconfigure_one(br);
     }
 
@@ -652,7 +693,7 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
      * The kernel will reject any attempt to add a given port to a datapath if
      * that port already belongs to a different datapath, so we must do all
      * port deletions before any port additions. */
-    LIST_FOR_EACH (br, node, &all_bridges) {
+    LIST_FOR_EACH (br, reconfigure_node, bridges) {
         struct dpif_port_dump dump;
         struct shash want_ifaces;
         struct dpif_port dpif_port;
@@ -671,7 +712,7 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
         }
         shash_destroy(&want_ifaces);
     }
-    LIST_FOR_EACH (br, node, &all_bridges) {
+    LIST_FOR_EACH (br, reconfigure_node, bridges) {
         struct shash cur_ifaces, want_ifaces;
         struct dpif_port_dump dump;
         struct dpif_port dpif_port;
@@ -770,14 +811,7 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
                     iface->up = iface->enabled;
                 }
             } else if (iface && iface->netdev) {
-                struct shash args;
-
-                shash_init(&args);
-                shash_from_ovs_idl_map(iface->cfg->key_options,
-                                       iface->cfg->value_options,
-                                       iface->cfg->n_options, &args);
-                netdev_set_config(iface->netdev, &args);
-                shash_destroy(&args);
+                iface_set_netdev_config(iface);
             }
         }
         shash_destroy(&want_ifaces);
@@ -789,13 +823,13 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
         }
         shash_destroy(&cur_ifaces);
     }
-    sflow_bridge_number = 0;
-    LIST_FOR_EACH (br, node, &all_bridges) {
+    LIST_FOR_EACH (br, reconfigure_node, bridges) {
         uint8_t ea[8];
         uint64_t dpid;
         struct iface *local_iface;
         struct iface *hw_addr_iface;
         char *dpid_string;
+        const char *budget;
 
         bridge_fetch_dp_ifaces(br);
 
@@ -901,7 +935,7 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
                 oso.header_len = *sflow_cfg->header;
             }
 
-            oso.sub_id = sflow_bridge_number++;
+            oso.sub_id = bridge_sflow_sub_id(br);
             oso.agent_device = sflow_cfg->agent;
 
             oso.control_ip = NULL;
@@ -919,6 +953,11 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
             ofproto_set_sflow(br->ofproto, NULL);
         }
 
+        /* Set the facet memory budget. */
+        budget = bridge_get_other_config(br->cfg, "facet-memory-budget");
+        ofproto_set_facet_budget(br->ofproto,
+                                 budget ? MAX(atoll(budget), 0) : 0);
+
         /* Update the controller and related settings.  It would be more
          * straightforward to call this from bridge_reconfigure_one(), but we
          * can't do it there for two reasons.  First, and most importantly, at
@@ -930,7 +969,7 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
          * the datapath ID before the controller. */
         bridge_reconfigure_remotes(br, managers, n_managers);
     }
-    LIST_FOR_EACH (br, node, &all_bridges) {
+    LIST_FOR_EACH (br, reconfigure_node, bridges) {
         struct port *port;
 
         HMAP_FOR_EACH (port, hmap_node, &br->ports) {
@@ -952,13 +991,13 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
             }
         }
     }
-    LIST_FOR_EACH (br, node, &all_bridges) {
+    LIST_FOR_EACH (br, reconfigure_node, bridges) {
         iterate_and_prune_ifaces(br, set_iface_properties, NULL);
     }
 
     /* Some reconfiguration operations require the bridge to have been run at
      * least once.  */
-    LIST_FOR_EACH (br, node, &all_bridges) {
+    LIST_FOR_EACH (br, reconfigure_node, bridges) {
         struct iface *iface;
 
         bridge_run_one(br);
@@ -975,6 +1014,122 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
     daemonize_complete();
 }
 
+/* Returns the sFlow sub-ID for 'br', which must have sFlow configured.  Each
+ * bridge with sFlow gets a distinct sub-ID according to its position in the
+ * list of all bridges. */
+static int
+bridge_sflow_sub_id(const struct bridge *br)
+{
+    const struct bridge *b;
+    int sub_id = 0;
+
+    LIST_FOR_EACH (b, node, &all_bridges) {
+        if (b == br) {
+            break;
+        } else if (b->cfg->sflow) {
+            sub_id++;
+        }
+    }
+    return sub_id;
+}
+
+/* Attempts to apply the database changes made since 'seqno', a value
+ * previously returned by ovsdb_idl_get_seqno(), by reconfiguring only the
+ * bridges and ports whose rows changed.
+ *
+ * Returns true if successful.  Returns false, without changing anything, if
+ * the changes are beyond what this function can handle: rows were inserted or
+ * deleted, columns that add, remove, rename, or move bridges, ports, or
+ * interfaces changed, or a table other than Open_vSwitch, Bridge, Port, and
+ * Interface changed.  The caller must then fall back to bridge_reconfigure().
+ */
+static bool
+bridge_reconfigure_incremental(const struct ovsrec_open_vswitch *ovs_cfg,
+                               unsigned int seqno)
+{
+    struct port **ports;
+    size_t n_ports, allocated_ports;
+    struct list bridges;
+    struct bridge *br;
+    size_t i;
+
+    for (i = 0; i < OVSREC_N_TABLES; i++) {
+        const struct ovsdb_idl_table_class *tc = &ovsrec_table_classes[i];
+
+        if (ovsdb_idl_table_rows_changed(idl, tc, seqno)) {
+            return false;
+        } else if (tc != &ovsrec_table_open_vswitch
+                   && tc != &ovsrec_table_bridge
+                   && tc != &ovsrec_table_port
+                   && tc != &ovsrec_table_interface
+                   && ovsdb_idl_table_changed(idl, tc, seqno)) {
+            return false;
+        }
+    }
+
+    /* "ovs-vsctl" increments "next_cfg" with every change, so allow that, but
+     * nothing else, to change in the Open_vSwitch table. */
+    for (i = 0; i < OVSREC_OPEN_VSWITCH_N_COLUMNS; i++) {
+        const struct ovsdb_idl_column *column = &ovsrec_open_vswitch_columns[i];
+
+        if (column != &ovsrec_open_vswitch_col_next_cfg
+            && ovsdb_idl_column_changed(&ovs_cfg->header_, column, seqno)) {
+            return false;
+        }
+    }
+
+    /* Collect the bridges and ports to reconfigure.  A port on a bridge that
+     * needs reconfiguration gets reconfigured along with its bridge. */
+    list_init(&bridges);
+    ports = NULL;
+    n_ports = allocated_ports = 0;
+    LIST_FOR_EACH (br, node, &all_bridges) {
+        const struct ovsrec_bridge *br_cfg = br->cfg;
+
+        if (ovsdb_idl_row_changed(&br_cfg->header_, seqno)) {
+            if (ovsdb_idl_column_changed(&br_cfg->header_,
+                                         &ovsrec_bridge_col_name, seqno)
+                || ovsdb_idl_column_changed(&br_cfg->header_,
+                                            &ovsrec_bridge_col_ports, seqno)
+                || ovsdb_idl_column_changed(&br_cfg->header_,
+                                            &ovsrec_bridge_col_datapath_type,
+                                            seqno)
+                || ovsdb_idl_column_changed(&br_cfg->header_,
+                                            &ovsrec_bridge_col_sflow, seqno)) {
+                free(ports);
+                return false;
+            }
+            list_push_back(&bridges, &br->reconfigure_node);
+        } else {
+            for (i = 0; i < br_cfg->n_ports; i++) {
+                struct port *port;
+
+                if (!port_check_changes(br, br_cfg->ports[i], seqno, &port)) {
+                    free(ports);
+                    return false;
+                } else if (port) {
+                    if (n_ports >= allocated_ports) {
+                        ports = x2nrealloc(ports, &allocated_ports,
+                                           sizeof *ports);
+                    }
+                    ports[n_ports++] = port;
+                }
+            }
+        }
+    }
+
+    COVERAGE_INC(bridge_reconfigure_incremental);
+    if (!list_is_empty(&bridges)) {
+        bridge_reconfigure_bridges(ovs_cfg, &bridges);
+    }
+    for (i = 0; i < n_ports; i++) {
+        port_reconfigure_incremental(ports[i]);
+    }
+    free(ports);
+
+    return true;
+}
+
 static const char *
 get_ovsrec_key_value(const struct ovsdb_idl_row *row,
                      const struct ovsdb_idl_column *column,
@@ -1294,8 +1449,11 @@ iface_refresh_cfm_stats(struct iface *iface)
     return changed;
 }
 
+/* Updates 'iface''s statistics column from 'stats', which should have been
+ * obtained from 'iface->netdev'.  Errors in obtaining statistics set 'stats'
+ * to all-1s, which is handled correctly here. */
 static void
-iface_refresh_stats(struct iface *iface)
+iface_refresh_stats(struct iface *iface, const struct netdev_stats *stats)
 {
     struct iface_stat {
         char *name;
@@ -1322,19 +1480,10 @@ iface_refresh_stats(struct iface *iface)
     int64_t values[N_STATS];
     int n;
 
-    struct netdev_stats stats;
-
-    if (iface_is_synthetic(iface)) {
-        return;
-    }
-
-    /* Intentionally ignore return value, since errors will set 'stats' to
-     * all-1s, and we will deal with that correctly below. */
-    netdev_get_stats(iface->netdev, &stats);
-
     n = 0;
     for (s = iface_stats; s < &iface_stats[N_STATS]; s++) {
-        uint64_t value = *(uint64_t *) (((char *) &stats) + s->offset);
+        uint64_t value = *(const uint64_t *) (((const char *) stats)
+                                              + s->offset);
         if (value != UINT64_MAX) {
             keys[n] = s->name;
             values[n] = value;
@@ -1345,6 +1494,63 @@ iface_refresh_stats(struct iface *iface)
     ovsrec_interface_set_statistics(iface->cfg, keys, values, n);
 }
 
+/* Refreshes the statistics for every interface on every bridge.
+ *
+ * The statistics for all of the interfaces are obtained with a single call to
+ * netdev_get_stats_multiple(), which allows, e.g., the Linux netdev provider
+ * to fetch them all with one Netlink dump instead of a request per interface.
+ * The statistics column is write-only, so the IDL leaves out of the
+ * transaction any interface whose counters did not change. */
+static void
+iface_refresh_all_stats(void)
+{
+    const struct netdev **netdevs;
+    struct netdev_stats *stats;
+    struct iface **ifaces;
+    size_t n, allocated;
+    struct bridge *br;
+    int *errors;
+    size_t i;
+
+    ifaces = NULL;
+    n = allocated = 0;
+    LIST_FOR_EACH (br, node, &all_bridges) {
+        struct port *port;
+
+        HMAP_FOR_EACH (port, hmap_node, &br->ports) {
+            struct iface *iface;
+
+            LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
+                if (!iface_is_synthetic(iface)) {
+                    if (n >= allocated) {
+                        ifaces = x2nrealloc(ifaces, &allocated, sizeof *ifaces);
+                    }
+                    ifaces[n++] = iface;
+                }
+            }
+        }
+    }
+
+    netdevs = xmalloc(n * sizeof *netdevs);
+    for (i = 0; i < n; i++) {
+        netdevs[i] = ifaces[i]->netdev;
+    }
+    stats = xmalloc(n * sizeof *stats);
+    errors = xmalloc(n * sizeof *errors);
+
+    /* Intentionally ignore 'errors', since errors will set the corresponding
+     * 'stats' to all-1s, which iface_refresh_stats() handles correctly. */
+    netdev_get_stats_multiple(netdevs, n, stats, errors);
+    for (i = 0; i < n; i++) {
+        iface_refresh_stats(ifaces[i], &stats[i]);
+    }
+
+    free(errors);
+    free(stats);
+    free(netdevs);
+    free(ifaces);
+}
+
 static void
 refresh_system_stats(const struct ovsrec_open_vswitch *cfg)
 {
@@ -1374,6 +1580,29 @@ nx_role_to_str(enum nx_role role)
     }
 }
 
+static void
+bridge_refresh_status(const struct bridge *br)
+{
+    unsigned long long int n_evictions;
+    size_t n_facets, n_bytes;
+    char *keys[3], *values[3];
+    size_t i;
+
+    ofproto_get_facet_usage(br->ofproto, &n_facets, &n_bytes, &n_evictions);
+
+    keys[0] = "facets";
+    values[0] = xasprintf("%zu", n_facets);
+    keys[1] = "facet_memory";
+    values[1] = xasprintf("%zu", n_bytes);
+    keys[2] = "facet_evictions";
+    values[2] = xasprintf("%llu", n_evictions);
+    ovsrec_bridge_set_status(br->cfg, keys, values, ARRAY_SIZE(keys));
+
+    for (i = 0; i < ARRAY_SIZE(values); i++) {
+        free(values[i]);
+    }
+}
+
 static void
 bridge_refresh_controller_status(const struct bridge *br)
 {
@@ -1445,7 +1674,10 @@ bridge_run(void)
             struct ovsdb_idl_txn *txn = ovsdb_idl_txn_create(idl);
 
             bridge_configure_once(cfg);
-            bridge_reconfigure(cfg);
+            if (datapath_destroyed || !reconfigured
+                || !bridge_reconfigure_incremental(cfg, reconfigured_seqno)) {
+                bridge_reconfigure(cfg);
+            }
 
             ovsrec_open_vswitch_set_cur_cfg(cfg, cfg->next_cfg);
             ovsdb_idl_txn_commit(txn);
@@ -1457,6 +1689,8 @@ bridge_run(void)
 
             bridge_reconfigure(&null_cfg);
         }
+        reconfigured_seqno = ovsdb_idl_get_seqno(idl);
+        reconfigured = true;
     }
 
     /* Refresh system and interface stats if necessary. */
@@ -1465,6 +1699,7 @@ bridge_run(void)
             struct ovsdb_idl_txn *txn;
 
             txn = ovsdb_idl_txn_create(idl);
+            iface_refresh_all_stats();
             LIST_FOR_EACH (br, node, &all_bridges) {
                 struct port *port;
 
@@ -1472,11 +1707,11 @@ bridge_run(void)
                     struct iface *iface;
 
                     LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
-                        iface_refresh_stats(iface);
                         iface_refresh_status(iface);
                     }
                 }
                 bridge_refresh_controller_status(br);
+                bridge_refresh_status(br);
             }
             refresh_system_stats(cfg);
             ovsdb_idl_txn_commit(txn);
@@ -4309,6 +4544,98 @@ port_reconfigure(struct port *port, const struct ovsrec_port *cfg)
     }
 }
 
+/* Checks whether 'port_cfg', one of the ports configured on 'br', or any of its
+ * interfaces changed after 'seqno'.  Returns false if they changed in a way
+ * that port_reconfigure_incremental() cannot apply, e.g. because an interface
+ * was added, removed, renamed, or changed type, because the port's fake bond
+ * interface was turned on or off, because the port's or an interface's MAC
+ * address changed (which can change the bridge's Ethernet address and
+ * datapath ID), or because the port or one of its interfaces failed to be
+ * configured previously.  Otherwise, returns true
+ * and sets '*portp' to the port that needs to be reconfigured, or to NULL if
+ * nothing changed. */
+static bool
+port_check_changes(const struct bridge *br, const struct ovsrec_port *port_cfg,
+                   unsigned int seqno, struct port **portp)
+{
+    struct port *port;
+    bool changed;
+    size_t i;
+
+    *portp = NULL;
+
+    changed = ovsdb_idl_row_changed(&port_cfg->header_, seqno);
+    for (i = 0; !changed && i < port_cfg->n_interfaces; i++) {
+        changed = ovsdb_idl_row_changed(&port_cfg->interfaces[i]->header_,
+                                        seqno);
+    }
+    if (!changed) {
+        return true;
+    }
+
+    port = port_lookup(br, port_cfg->name);
+    if (!port || port->cfg != port_cfg
+        || port->n_ifaces != port_cfg->n_interfaces
+        || ovsdb_idl_column_changed(&port_cfg->header_,
+                                    &ovsrec_port_col_name, seqno)
+        || ovsdb_idl_column_changed(&port_cfg->header_,
+                                    &ovsrec_port_col_interfaces, seqno)
+        || ovsdb_idl_column_changed(&port_cfg->header_,
+                                    &ovsrec_port_col_bond_fake_iface, seqno)
+        || ovsdb_idl_column_changed(&port_cfg->header_,
+                                    &ovsrec_port_col_mac, seqno)) {
+        return false;
+    }
+    for (i = 0; i < port_cfg->n_interfaces; i++) {
+        const struct ovsrec_interface *if_cfg = port_cfg->interfaces[i];
+        struct iface *iface = port_lookup_iface(port, if_cfg->name);
+
+        if (!iface || iface->cfg != if_cfg || !iface->netdev
+            || ovsdb_idl_column_changed(&if_cfg->header_,
+                                        &ovsrec_interface_col_name, seqno)
+            || ovsdb_idl_column_changed(&if_cfg->header_,
+                                        &ovsrec_interface_col_type, seqno)
+            || ovsdb_idl_column_changed(&if_cfg->header_,
+                                        &ovsrec_interface_col_mac, seqno)) {
+            return false;
+        }
+    }
+
+    *portp = port;
+    return true;
+}
+
+/* Applies changes to the configuration of 'port' and its interfaces, whose
+ * set of interfaces must not have changed, without reconfiguring the rest of
+ * its bridge.  This performs the same per-port and per-interface steps as
+ * bridge_reconfigure(). */
+static void
+port_reconfigure_incremental(struct port *port)
+{
+    struct iface *iface;
+
+    port_reconfigure(port, port->cfg);
+
+    LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
+        iface_set_netdev_config(iface);
+        if (port->monitor) {
+            netdev_monitor_add(port->monitor, iface->netdev);
+        }
+    }
+    if (!port->monitor) {
+        port->miimon_next_update = 0;
+    }
+
+    port_update_lacp(port);
+    port_update_bonding(port);
+
+    LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
+        iface_update_qos(iface, port->cfg->qos);
+        set_iface_properties(port->bridge, iface, NULL);
+        iface_update_cfm(iface);
+    }
+}
+
 static void
 port_destroy(struct port *port)
 {
@@ -4548,6 +4875,21 @@ iface_from_dp_ifidx(const struct bridge *br, uint16_t dp_ifidx)
     return NULL;
 }
 
+/* Passes the options configured for 'iface' in the database along to its
+ * network device. */
+static void
+iface_set_netdev_config(struct iface *iface)
+{
+    struct shash args;
+
+    shash_init(&args);
+    shash_from_ovs_idl_map(iface->cfg->key_options,
+                           iface->cfg->value_options,
+                           iface->cfg->n_options, &args);
+    netdev_set_config(iface->netdev, &args);
+    shash_destroy(&args);
+}
+
 /* Set Ethernet address of 'iface', if one is specified in the configuration
  * file. */
 static void
@@ -133,7 +133,7 @@ parse_options(int argc, char *argv[])
         {"peer-ca-cert", required_argument, 0, OPT_PEER_CA_CERT},
         {"bootstrap-ca-cert", required_argument, 0, OPT_BOOTSTRAP_CA_CERT},
 #endif
-        {"enable-dummy", no_argument, 0, OPT_ENABLE_DUMMY},
+        {"enable-dummy", optional_argument, 0, OPT_ENABLE_DUMMY},
         {0, 0, 0, 0},
     };
     char *short_options = long_options_to_short_options(long_options);
@@ -182,7 +182,7 @@ parse_options(int argc, char *argv[])
 #endif
 
         case OPT_ENABLE_DUMMY:
-            dummy_enable();
+            dummy_enable(optarg && !strcmp(optarg, "override"));
             break;
 
         case '?':